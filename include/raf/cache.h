@@ -9,7 +9,11 @@
  */
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <dmlc/memory_io.h>
 #include <sys/stat.h>
 #include "./file.h"
@@ -149,54 +153,172 @@ class HashKey {
 #undef RAF_DEF_PRIMITIVE
 #undef RAF_APPEND_BYTES
 
+/*!
+ * \brief A thread-safe and insert-only cache. Reads are lock-free, as the cache sits on the op
+ * dispatch path and is rarely written after warmup.
+ *
+ * Entries are immutable and never freed until the cache is destroyed, and the hash table only
+ * holds atomic pointers to them. A writer (serialized by a mutex) publishes a new entry with a
+ * release store to an empty slot, or publishes a larger table with all entries when the table
+ * is half full. Readers acquire the current table and probe it without any lock. Retired tables
+ * are kept until the cache is destroyed, which at most doubles the table memory, so a reader
+ * never accesses a freed table.
+ */
 template <typename T>
 class MetaCache {
  public:
+  MetaCache() {
+    tables_.emplace_back(std::make_unique<Table>(kInitialCapacity));
+    table_.store(tables_.back().get(), std::memory_order_release);
+  }
+
   ~MetaCache() = default;
 
-  bool Has(const std::vector<uint8_t>& key) {
-    const std::string key_str(key.begin(), key.end());
-    return Has(key_str);
+  bool Has(const std::vector<uint8_t>& key) const {
+    return Get(key.data(), key.size()) != nullptr;
   }
 
-  bool Has(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mu_);
-    return cached_.count(key);
+  bool Has(const std::string& key) const {
+    return Get(key.data(), key.size()) != nullptr;
   }
 
-  const T* Get(const std::vector<uint8_t>& key) {
-    const std::string key_str(key.begin(), key.end());
-    return Get(key_str);
+  const T* Get(const std::vector<uint8_t>& key) const {
+    return Get(key.data(), key.size());
   }
 
-  const T* Get(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mu_);
-    auto iter = cached_.find(key);
-    if (iter == cached_.end()) {
-      return nullptr;
+  const T* Get(const std::string& key) const {
+    return Get(key.data(), key.size());
+  }
+
+  /*!
+   * \brief Look up a key given as a byte span without copying it.
+   * \param data The pointer to the key bytes.
+   * \param size The number of key bytes.
+   * \return The pointer to the cached value, which is valid until the cache is destroyed, or
+   * nullptr if the key is not cached.
+   */
+  const T* Get(const void* data, size_t size) const {
+    uint64_t hash = HashBytes(data, size);
+    const Table* table = table_.load(std::memory_order_acquire);
+    size_t mask = table->capacity - 1;
+    for (size_t i = hash & mask, n = 0; n < table->capacity; i = (i + 1) & mask, ++n) {
+      const Entry* entry = table->slots[i].load(std::memory_order_acquire);
+      if (entry == nullptr) {
+        return nullptr;
+      }
+      if (entry->Match(hash, data, size)) {
+        return &entry->value;
+      }
     }
-    return &iter->second;
+    return nullptr;
   }
 
   void Set(const std::vector<uint8_t>& key, T val) {
-    const std::string key_str(key.begin(), key.end());
-    Set(key_str, val);
+    Set(key.data(), key.size(), std::move(val));
   }
 
   void Set(const std::string& key, T val) {
+    Set(key.data(), key.size(), std::move(val));
+  }
+
+  void Set(const void* data, size_t size, T val) {
     std::lock_guard<std::mutex> lock(mu_);
-    auto iter = cached_.find(key);
-    if (iter != cached_.end()) {
+    if (Get(data, size) != nullptr) {
       LOG(FATAL) << "KeyError: The key is already cached!";
       throw;
     }
-    cached_.emplace(key, val);
+    const char* bytes = static_cast<const char*>(data);
+    entries_.emplace_back(std::make_unique<Entry>(std::string(bytes, bytes + size),
+                                                  HashBytes(data, size), std::move(val)));
+    Table* table = table_.load(std::memory_order_relaxed);
+    if (entries_.size() * 2 > table->capacity) {
+      // Build a larger table with all entries and publish it at once.
+      tables_.emplace_back(std::make_unique<Table>(table->capacity * 2));
+      table = tables_.back().get();
+      for (const auto& entry : entries_) {
+        Insert(table, entry.get());
+      }
+      table_.store(table, std::memory_order_release);
+    } else {
+      Insert(table, entries_.back().get());
+    }
   }
 
  private:
-  /*! \brief The cache mapping from string key to value. */
-  std::unordered_map<std::string, T> cached_;
-  /*! \brief The thread-safe lock. */
+  /*! \brief An immutable cache entry. */
+  struct Entry {
+    Entry(std::string key, uint64_t hash, T value)
+        : key(std::move(key)), hash(hash), value(std::move(value)) {
+    }
+
+    bool Match(uint64_t h, const void* data, size_t size) const {
+      return hash == h && key.size() == size &&
+             (size == 0 || std::memcmp(key.data(), data, size) == 0);
+    }
+
+    /*! \brief The key bytes. */
+    const std::string key;
+    /*! \brief The hash of the key. */
+    const uint64_t hash;
+    /*! \brief The cached value. */
+    const T value;
+  };
+
+  /*! \brief An open-addressing hash table with linear probing. */
+  struct Table {
+    explicit Table(size_t capacity)
+        : capacity(capacity), slots(new std::atomic<const Entry*>[capacity]) {
+      for (size_t i = 0; i < capacity; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    /*! \brief The number of slots, which is a power of 2. */
+    const size_t capacity;
+    /*! \brief The slots pointing to the entries. */
+    std::unique_ptr<std::atomic<const Entry*>[]> slots;
+  };
+
+  /*! \brief Hash the key bytes 8 bytes at a time. The data may be null if size is 0. */
+  static uint64_t HashBytes(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const uint64_t mul = 0x9ddfea08eb382d69ULL;
+    uint64_t hash = size * mul;
+    if (size == 0) {
+      return hash;
+    }
+    uint64_t word;
+    for (; size >= 8; bytes += 8, size -= 8) {
+      std::memcpy(&word, bytes, 8);
+      hash = (hash ^ word) * mul;
+      hash ^= hash >> 47;
+    }
+    word = 0;
+    std::memcpy(&word, bytes, size);
+    hash = (hash ^ word) * mul;
+    hash ^= hash >> 47;
+    return hash * mul;
+  }
+
+  static void Insert(Table* table, const Entry* entry) {
+    size_t mask = table->capacity - 1;
+    for (size_t i = entry->hash & mask;; i = (i + 1) & mask) {
+      if (table->slots[i].load(std::memory_order_relaxed) == nullptr) {
+        table->slots[i].store(entry, std::memory_order_release);
+        return;
+      }
+    }
+  }
+
+  /*! \brief The initial number of slots. */
+  static constexpr size_t kInitialCapacity = 16;
+  /*! \brief The current table read by lookups. */
+  std::atomic<Table*> table_;
+  /*! \brief All tables including the retired ones, which are freed with the cache. */
+  std::vector<std::unique_ptr<Table>> tables_;
+  /*! \brief All entries. */
+  std::vector<std::unique_ptr<Entry>> entries_;
+  /*! \brief The lock to serialize writers. */
   std::mutex mu_;
 };
 
@@ -205,6 +327,55 @@ class MetaCacheMetric {
   virtual std::unordered_map<std::string, size_t> GetMetric() = 0;
 };
 
+/*!
+ * \brief The on-disk store of a persistent cache. Entries are addressed by the SHA-256 digest of
+ * the key and the TVM version, written to a private temporary directory and published with an
+ * atomic rename. An index file shared via mmap tracks the size and the last access of entries to
+ * evict the least recently used ones. The store is safe to share by multiple processes on the
+ * same host.
+ */
+class PersistStore {
+ public:
+  /*!
+   * \brief Open or create a store.
+   * \param path The root directory of the store.
+   * \param capacity The maximum total size in bytes of the entries. 0 means no limit.
+   */
+  PersistStore(const std::string& path, int64_t capacity);
+  ~PersistStore();
+
+  /*!
+   * \brief Look up an entry and mark it as recently used.
+   * \param key The cache key.
+   * \return The directory of the entry, or an empty string if the key is not stored.
+   */
+  std::string Lookup(const std::string& key);
+
+  /*!
+   * \brief Create a private temporary directory to write a new entry into.
+   * \return The temporary directory.
+   */
+  std::string BeginWrite();
+
+  /*!
+   * \brief Publish an entry written by BeginWrite and evict entries if the store is full.
+   * \param key The cache key.
+   * \param tmp_dir The temporary directory returned by BeginWrite.
+   * \return The number of evicted entries.
+   */
+  int Commit(const std::string& key, const std::string& tmp_dir);
+
+  /*!
+   * \brief Discard the temporary directory of a failed write.
+   * \param tmp_dir The temporary directory returned by BeginWrite.
+   */
+  void Abort(const std::string& tmp_dir);
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
 template <typename T>
 class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
  public:
@@ -231,8 +402,12 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
     CreateDir(cache_path);
     path_ = cache_path + "/" + persist_name_;
 
-    // Create the directory for this cache.
-    CreateDir(path_);
+    // The size limit in bytes of this cache. 0 means no limit.
+    int64_t capacity = 0;
+    if (const char* val = getenv("RAF_PERSIST_CACHE_SIZE_LIMIT")) {
+      capacity = atoll(val);
+    }
+    store_ = std::make_unique<PersistStore>(path_, capacity);
   }
 
   const T* Get(const std::vector<uint8_t>& key) {
@@ -241,14 +416,14 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
   }
 
   const T* Get(const std::string& key) {
-    AddMetric("CacheGet", 1);
+    num_gets_.fetch_add(1, std::memory_order_relaxed);
 
     // Cache hit.
     if (auto val = MetaCache<T>::Get(key)) {
-      AddMetric("CacheHit", 1);
+      num_hits_.fetch_add(1, std::memory_order_relaxed);
       return val;
     }
-    AddMetric("CacheMiss", 1);
+    num_misses_.fetch_add(1, std::memory_order_relaxed);
     if (!persist_) {
       return nullptr;
     }
@@ -256,10 +431,14 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
     // Cache miss, try to load from the persistent cache.
     std::lock_guard<std::mutex> lock(mu_);
 
-    auto persist_path = GetPersistPath(key);
+    // Another thread may have loaded the entry while waiting for the lock.
+    if (auto val = MetaCache<T>::Get(key)) {
+      return val;
+    }
 
     // Persistent cache miss.
-    if (!DirExists(persist_path)) {
+    auto persist_path = store_->Lookup(key);
+    if (persist_path.empty()) {
       AddMetric("PersistCacheMiss", 1);
       return nullptr;
     }
@@ -270,7 +449,7 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
       return MetaCache<T>::Get(key);
     } catch (dmlc::Error& e) {
       AddMetric("PersistCacheLoadFailure", 1);
-      LOG(WARNING) << "Failed to load persist entry " << path_ << ": " << e.what();
+      LOG(WARNING) << "Failed to load persist entry " << persist_path << ": " << e.what();
       return nullptr;
     }
     return nullptr;
@@ -282,7 +461,7 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
   }
 
   void Set(const std::string& key, T val) {
-    AddMetric("CacheSet", 1);
+    num_sets_.fetch_add(1, std::memory_order_relaxed);
     MetaCache<T>::Set(key, val);
     if (!persist_) {
       return;
@@ -290,41 +469,56 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
 
     std::lock_guard<std::mutex> lock(mu_);
 
-    auto persist_path = GetPersistPath(key);
-    CreateDir(persist_path);
-
-    // Persist the cache value.
+    // Persist the cache value to a temporary directory, and then publish it at once, so that
+    // other processes never see a partially written entry.
+    auto tmp_path = store_->BeginWrite();
     try {
-      if (!val.Save(persist_path)) {
-        throw;
+      if (!val.Save(tmp_path)) {
+        LOG(FATAL) << "Failed to save the entry";
       }
     } catch (dmlc::Error& e) {
+      store_->Abort(tmp_path);
       AddMetric("PersistCacheSaveFailure", 1);
       LOG(WARNING) << "Failed to persist cache entry to " << path_ << ": " << e.what();
       return;
     }
-
-    std::ofstream metadata_file(persist_path + "/timestamp");
-    metadata_file << std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())
-                  << std::endl;
-    metadata_file.close();
+    AddMetric("PersistCacheEvict", store_->Commit(key, tmp_path));
   }
 
   std::unordered_map<std::string, size_t> GetMetric() override {
-    return metrics_;
+    std::unordered_map<std::string, size_t> metrics;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      metrics = metrics_;
+    }
+    AddCounter(&metrics, "CacheGet", num_gets_);
+    AddCounter(&metrics, "CacheHit", num_hits_);
+    AddCounter(&metrics, "CacheMiss", num_misses_);
+    AddCounter(&metrics, "CacheSet", num_sets_);
+    return metrics;
   }
 
  private:
-  inline std::string GetPersistPath(const std::string& key) {
-    const size_t hashed_key = std::hash<std::string>{}(key);
-    return path_ + "/" + std::to_string(hashed_key);
-  }
-
+  /*! \brief Add a metric of the persistent path. The caller must hold mu_. */
   inline void AddMetric(const std::string name, size_t val) {
     metrics_[name] += val;
   }
 
-  /*! \brief The cache metrics for analysis. */
+  /*! \brief Report a counter. Counters that are still zero are left out, like unused metrics. */
+  static void AddCounter(std::unordered_map<std::string, size_t>* metrics, const std::string& name,
+                         const std::atomic<size_t>& counter) {
+    size_t val = counter.load(std::memory_order_relaxed);
+    if (val > 0) {
+      (*metrics)[name] = val;
+    }
+  }
+
+  /*! \brief The counters of the lookups and inserts, which run without the lock. */
+  std::atomic<size_t> num_gets_{0};
+  std::atomic<size_t> num_hits_{0};
+  std::atomic<size_t> num_misses_{0};
+  std::atomic<size_t> num_sets_{0};
+  /*! \brief The metrics of the persistent path for analysis, guarded by mu_. */
   std::unordered_map<std::string, size_t> metrics_;
   /*! \brief Persist directory name. */
   std::string persist_name_;
@@ -332,6 +526,8 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
   std::string path_;
   /*! \brief Whether to presist values. */
   bool persist_ = false;
+  /*! \brief The on-disk store of the persisted values. */
+  std::unique_ptr<PersistStore> store_;
   /*! \brief The thread-safe lock. */
   std::mutex mu_;
 };
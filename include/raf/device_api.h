@@ -8,6 +8,7 @@
  * \brief Unified low-level API for heterogeneous devices
  */
 #pragma once
+#include <functional>
 #include <memory>
 #include "./device.h"
 
@@ -106,6 +107,17 @@ class DeviceAPI {
    */
   virtual void* GetStream() = 0;
 
+  /*!
+   * \brief Launch a host task on a stream, which runs after the pending workloads on that stream.
+   * By default the task runs right away on the calling thread, which suits devices like CUDA whose
+   * tasks only issue kernels to the current stream. CPU runs the task on the thread of the stream.
+   * \param stream The stream to launch the task on, or nullptr to run it on the calling thread.
+   * \param task The task to launch.
+   */
+  virtual void LaunchOnStream(void* stream, std::function<void()> task) {
+    task();
+  }
+
   /*!
    * \brief Create an event on given device.
    * \param dev The device to create the event.
@@ -176,5 +188,13 @@ class DeviceAPI {
   static std::shared_ptr<DeviceAPI> Get(DevType device_type);
 };
 
+/*!
+ * \brief The number of threads a parallel kernel launched from the current thread may use on CPU,
+ * i.e., the size of its TVM thread pool. The workers of CPU streams share the cores, so their pools
+ * are smaller than tvm::runtime::threading::MaxConcurrency().
+ * \return The number of threads.
+ */
+int CPUThreadPoolSize();
+
 }  // namespace device_api
 }  // namespace raf
@@ -28,7 +28,6 @@ class Executor {
   virtual ~Executor() = default;
   virtual void OnBind(const op::OpEnv* op_env) = 0;
   virtual void OnDestruct(const op::OpEnv* op_env) = 0;
-  virtual void RequestWorkspace(requests::Requests* request, int index) = 0;
   virtual void RequestStream(requests::Requests* request, int index) = 0;
   virtual void RequestDistributed(requests::Requests* request, int index) = 0;
 };
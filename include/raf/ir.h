@@ -190,6 +190,10 @@ using tvm::relay::attr::kSkipOptimization;
 constexpr const char* kDialect = "Dialect";
 /*! \brief Mark the fusion pattern name. */
 constexpr const char* kPatternName = "PatternName";
+/*! \brief The size in bytes of the static memory arena planned for the function. */
+constexpr const char* kArenaSize = "ArenaSize";
+/*! \brief The alignment in bytes of the static memory arena planned for the function. */
+constexpr const char* kArenaAlignment = "ArenaAlignment";
 }  // namespace attr
 
 }  // namespace ir
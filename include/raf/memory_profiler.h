@@ -8,6 +8,11 @@
  * \brief memory profiler
  */
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -21,6 +26,10 @@
   }
 
 namespace raf {
+namespace memory_pool {
+class Memory;
+}  // namespace memory_pool
+
 namespace memory_profiler {
 
 using FloatPair = std::pair<float, float>;
@@ -56,6 +65,68 @@ struct MemoryStat {
   int num_gc = 0;
 };
 
+/*! \brief Where an allocation is made, e.g., the VM instruction that allocates the memory. */
+struct AllocationSite {
+  /*! \brief The function of the VM instruction, or empty for allocations outside the VM. */
+  std::string function;
+  /*! \brief The pc of the VM instruction, or -1. */
+  int64_t pc = -1;
+  /*! \brief The opcode or the op name of the VM instruction. */
+  std::string name;
+};
+
+/*!
+ * \brief Attribute the allocations of the current thread to the given site during the lifetime
+ * of this object. Scopes can be nested.
+ */
+class AllocationSiteScope {
+ public:
+  explicit AllocationSiteScope(AllocationSite site);
+  ~AllocationSiteScope();
+
+ private:
+  /*! \brief The enclosing site of the current thread. */
+  const AllocationSite* prev_;
+  /*! \brief The site of this scope. */
+  AllocationSite site_;
+};
+
+/*! \brief An allocation from the memory pool, from its allocation to its release. */
+struct AllocationEvent {
+  /*! \brief The requested bytes. */
+  int64_t requested_bytes = 0;
+  /*! \brief The bytes rounded by the memory pool, see MemoryPool::GetAllocBytes. */
+  int64_t rounded_bytes = 0;
+  /*! \brief The time of the allocation in microseconds since the recording starts. */
+  double alloc_us = 0;
+  /*! \brief The time of the release in microseconds, or -1 if the memory is still alive. */
+  double free_us = -1;
+  /*! \brief The sequence number of the allocation, which orders all events of the device. */
+  int64_t alloc_seq = 0;
+  /*! \brief The sequence number of the release, or INT64_MAX if the memory is still alive. */
+  int64_t free_seq = INT64_MAX;
+  /*! \brief Where the memory is allocated. */
+  AllocationSite site;
+};
+
+/*! \brief The allocation events of a device. */
+struct AllocationTimeline {
+  /*! \brief The allocation events, indexed by their IDs. */
+  std::vector<AllocationEvent> events;
+  /*! \brief The next sequence number. */
+  int64_t next_seq = 0;
+  /*! \brief The requested and the rounded bytes of the live allocations. */
+  int64_t live_requested_bytes = 0;
+  int64_t live_rounded_bytes = 0;
+  /*! \brief The sequence number and the live bytes when the live rounded bytes peak. */
+  int64_t peak_seq = -1;
+  int64_t peak_requested_bytes = 0;
+  int64_t peak_rounded_bytes = 0;
+  double peak_us = 0;
+  /*! \brief The bytes of the memory pool when the live rounded bytes peak. */
+  int64_t peak_pool_bytes = 0;
+};
+
 /*! \brief The memory profiler for all devices. */
 class MemoryProfiler {
  public:
@@ -95,11 +166,62 @@ class MemoryProfiler {
    */
   std::string GetMemoryTrace(const Device& device);
 
+  /*! \brief Enable or disable recording every allocation from the memory pools. */
+  void SetRecordEvents(bool record);
+
+  bool IsRecordingEvents() {
+    return is_recording_events_.load(std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Record an allocation from the memory pool. The release of the allocation is recorded
+   * when the returned memory and all its copies are destroyed.
+   * \param device The device of the memory.
+   * \param mem The allocated memory.
+   * \param requested_bytes The requested bytes.
+   * \param rounded_bytes The bytes rounded by the memory pool.
+   * \return The memory that records its release.
+   */
+  std::shared_ptr<memory_pool::Memory> RecordAlloc(const Device& device,
+                                                   std::shared_ptr<memory_pool::Memory> mem,
+                                                   int64_t requested_bytes, int64_t rounded_bytes);
+
+  /*!
+   * \brief Analyze the allocation events of the given device.
+   * \param device The device to analyze.
+   * \return The analysis in JSON, including the peak live bytes, the allocations that are alive
+   * at the peak, the internal fragmentation due to the rounding of the memory pool, and the
+   * fragmentation of the memory pool at the peak.
+   */
+  std::string GetAllocationReport(const Device& device);
+
+  /*!
+   * \brief Get the allocation events of all devices in the Chrome trace format, which can be
+   * loaded by chrome://tracing or Perfetto.
+   */
+  std::string GetAllocationChromeTrace();
+
  private:
+  /*! \brief Record the release of an allocation, unless the events are reset after it. */
+  void RecordFree(const std::string& device_str, size_t id, uint64_t generation);
+
+  /*! \brief The microseconds since the recording starts. */
+  double NowUs();
+
   /*! \brief Mapping from device string to memory stats. */
   std::unordered_map<std::string, MemoryStat> memory_stats_;
   /*! \brief Whether the profiling is enabled. */
   bool is_profiling_ = false;
+  /*! \brief Whether the allocation events are recorded. */
+  std::atomic<bool> is_recording_events_{false};
+  /*! \brief Mapping from device string to the allocation events. */
+  std::unordered_map<std::string, AllocationTimeline> timelines_;
+  /*! \brief The number of times the allocation events are reset. */
+  uint64_t generation_ = 0;
+  /*! \brief The time when the recording starts. */
+  std::chrono::steady_clock::time_point start_time_;
+  /*! \brief The mutex to protect the allocation events. */
+  std::mutex events_mu_;
 };
 }  // namespace memory_profiler
 }  // namespace raf
@@ -83,7 +83,17 @@ class OpEnv {
     return !error_msgs.empty();
   }
 
-  void RequestWorkspace(void** dest, const Device& device, int64_t nbytes);
+  /*!
+   * \brief Request a workspace of nbytes on the device for every execution of the OpEnv.
+   * \return The index to look up the workspace of the running execution with GetWorkspace.
+   */
+  int RequestWorkspace(const Device& device, int64_t nbytes);
+  /*!
+   * \brief Get the workspace bound to the execution on the calling thread by WorkspaceBinding.
+   * OpEnvs are shared by the executions of all contexts, so the workspace is never stored in them.
+   * \param index The index returned by RequestWorkspace, or -1 to get a null workspace.
+   */
+  static void* GetWorkspace(int index);
   void RequestStream(void** dest, const Device& device, int tag_idx);
   void RequestDistributed(void** dest, const std::string& name, const value::Value rank_list);
 
@@ -102,6 +112,25 @@ class OpEnv {
 
 using OpEnvPtr = std::shared_ptr<OpEnv>;
 
+/*!
+ * \brief Bind the workspace of one execution to the calling thread until the binding is destroyed.
+ * The workspace is indexed in the order of RequestWorkspace, and bindings on a thread must be
+ * destroyed in the reverse order of their creation.
+ */
+class WorkspaceBinding {
+ public:
+  WorkspaceBinding() = default;
+  explicit WorkspaceBinding(std::vector<void*> workspace);
+  WorkspaceBinding(WorkspaceBinding&& other);
+  WorkspaceBinding(const WorkspaceBinding&) = delete;
+  WorkspaceBinding& operator=(const WorkspaceBinding&) = delete;
+  ~WorkspaceBinding();
+
+ private:
+  std::vector<void*> workspace_;
+  bool bound_ = false;
+};
+
 /*!
  * \brief Registry to make an OpEnv for an operator.
  */
@@ -153,7 +182,7 @@ ir::Array<value::Value> GetListArgs(const ir::Attrs& attrs);
 /*!
  * \brief Find an unallocated name for the given name.
  * \param name The given name
- * \return An unallocated name with a unique suffix attached
+ * \return An unallocated name with a unique suffix attached. It is safe to call concurrently.
  */
 std::string GetUniqueName(std::string name);
 /*!
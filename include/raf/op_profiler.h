@@ -11,6 +11,8 @@
 
 #pragma once
 #include "raf/cache.h"
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
 #include "op.h"
 #include "op_utils.h"
 #include <unordered_map>
@@ -39,11 +41,15 @@ class OpWithData {
   std::vector<Value> inputs;
   Value output;
   int64_t workspace_size = 0;  // Workspace memory size in bytes.
+  std::vector<std::shared_ptr<memory_pool::Memory>> workspace;
 
   OpWithData(const Device device, const Expr& op, const int stream_id = -1);
 
   ~OpWithData();
 
+  /*! \brief Execute the op on the dummy data with its workspace bound. */
+  void Execute();
+
   bool profilable() const {
     return op_env != nullptr;
   }
@@ -226,9 +232,15 @@ class CPUOpProfiler : public OpProfiler {
  public:
   CPUOpProfiler(const Device& device) : OpProfiler(device) {
     CHECK_EQ(device.device_type(), DevType::kCPU()) << "CPUOpProfiler only supports CPU devices!";
+    cpu_api_ = device_api::DeviceAPI::Get(DevType::kCPU());
   }
 
   virtual ~CPUOpProfiler() {
+    for (auto id_n_stream : streams_) {
+      if (id_n_stream.second != nullptr) {
+        cpu_api_->FreeStream(device_, id_n_stream.second);
+      }
+    }
   }
 
  private:
@@ -254,6 +266,11 @@ class CPUOpProfiler : public OpProfiler {
   virtual std::vector<float> RunOpGroup(const std::vector<OpWithDataPtr>& op_with_datas,
                                         int32_t warmup = 10, int32_t exec_number = 10,
                                         int32_t repeat = 1);
+
+  /*! \brief Stream ID to CPU stream. */
+  std::unordered_map<int, void*> streams_;
+  /*! \brief CPU device API. */
+  std::shared_ptr<device_api::DeviceAPI> cpu_api_;
 };
 
 #ifdef RAF_USE_CUDA
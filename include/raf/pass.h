@@ -9,6 +9,8 @@
  */
 #pragma once
 
+#include <string>
+#include <unordered_map>
 #include "tvm/ir/transform.h"
 #include "tvm/relay/analysis.h"
 #include "tvm/relay/dataflow_matcher.h"
@@ -39,11 +41,14 @@ using tvm::transform::PassNode;
  * \param opt_level The optimization level of the function pass.
  * \param name The name of the function pass.
  * \param required The list of the passes that the function pass is dependent on.
+ * \param parallel Whether the pass only reads and rewrites the given function, so the functions
+ * of a module can be transformed concurrently when "raf.pass.num_parallel_threads" is set.
  * \return The created function pass.
  */
 TVM_DLL Pass
 CreateRAFFunctionPass(const TypedPackedFunc<Function(Function, IRModule, PassContext)>& pass_func,
-                      int opt_level, String name, tvm::Array<String> required);
+                      int opt_level, String name, tvm::Array<String> required,
+                      bool parallel = false);
 
 /*!
  * \brief A special trace pass that prints the header and IR to LOG(INFO).
@@ -200,6 +205,31 @@ Pass FromRelay(ir::Array<tvm::String> disabled_pass = {});
  */
 Pass InlineBackward();
 
+/*!
+ * \brief A pass that stores the activations saved for the backward closure in a compressed form
+ * (float16, bfloat16 or blockwise int8) until their uses in backward. It has to be applied after
+ * AutoDiff and before InlineBackward.
+ * \return The created pass.
+ */
+Pass CompressActivation();
+
+/*!
+ * \brief A pass that makes main also return the absolute maximum of each float32 activation fed
+ * to a matmul, dense, batch_matmul or conv2d, to calibrate the ranges of the activations for
+ * Quantize. Main returns (original outputs, (ranges...)), and the other functions are untouched.
+ * \return The created pass.
+ */
+Pass CollectQuantizeRanges();
+
+/*!
+ * \brief A pass that rewrites the float32 matmul, dense, batch_matmul and conv2d in main to their
+ * int8 counterparts. Constant operands (i.e., weights) are quantized at compile time, and the
+ * others are quantized at runtime with the ranges calibrated by CollectQuantizeRanges.
+ * \param ranges The ranges of the activations in the order of CollectQuantizeRanges.
+ * \return The created pass.
+ */
+Pass Quantize(ir::Array<tvm::FloatImm> ranges);
+
 /*!
  * \brief Substitute variables in expr
  * \param expr The expression
@@ -438,6 +468,20 @@ ir::Expr InferTypeWithValues(const ir::Expr& func, const ir::Array<value::Value>
  */
 ir::Expr InferTypeWithModule(const ir::Expr& expr, const ir::IRModule& module);
 
+/*!
+ * \brief Estimate the peak bytes that each function of a module allocates from the memory pools
+ * when it runs in the VM, including the static arenas and the rounding of the memory pools. The
+ * module must have run ManifestAlloc and MemoryPlan.
+ * \param mod The module.
+ * \param device The device to build the ops, which is used to get their workspace sizes.
+ * \param include_workspace Whether to build the ops to account their workspace.
+ * \return Map from the function name to its peak bytes, or -1 if the peak depends on dynamic
+ * shapes.
+ */
+std::unordered_map<std::string, int64_t> EstimatePeakMemory(const ir::IRModule& mod,
+                                                            const Device& device,
+                                                            bool include_workspace);
+
 /*!
  * \brief Eliminate dead code in the give expression
  * \param expr The expression.
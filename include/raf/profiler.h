@@ -9,8 +9,11 @@
  */
 #pragma once
 #include <dmlc/concurrentqueue.h>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <array>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <string>
@@ -31,9 +34,16 @@
 
 #define WITH_BASE_PROFILER_LEVEL(LEVEL, DEVICE, NAME, CAT, ARGS, CODE_SNIPPET)                \
   {                                                                                           \
-    bool _profiling = raf::profiler::Profiler::Get()->IsProfiling(LEVEL);                     \
-    if (_profiling) {                                                                         \
-      auto& _pool = raf::profiler::Profiler::Get()->HelperPool();                             \
+    auto* _profiler = raf::profiler::Profiler::Get();                                         \
+    if (_profiler->IsSampling(LEVEL)) {                                                       \
+      if (_profiler->ShouldSample()) {                                                        \
+        raf::profiler::SampledScope _sampled_scope(NAME, CAT);                                \
+        CODE_SNIPPET                                                                          \
+      } else {                                                                                \
+        CODE_SNIPPET                                                                          \
+      }                                                                                       \
+    } else if (_profiler->IsProfiling(LEVEL)) {                                               \
+      auto& _pool = _profiler->HelperPool();                                                  \
       auto _phelper_index = _pool.size();                                                     \
       _pool.push_back(raf::profiler::ProfilerHelper(DEVICE.device_id(), DEVICE.device_type(), \
                                                     NAME, CAT, ARGS));                        \
@@ -151,6 +161,90 @@ class DeviceStats {
   ~DeviceStats();
 };
 
+/*!
+ * \brief An event recorded in the sampling mode. It is plain old data with the name and the
+ * category interned, so that recording it does not allocate.
+ */
+struct SampledEvent {
+  /*! \brief The start time in microseconds. */
+  uint64_t start_time;
+  /*! \brief The end time in microseconds. */
+  uint64_t end_time;
+  /*! \brief The interned name. */
+  uint32_t name_id;
+  /*! \brief The interned category. */
+  uint32_t category_id;
+};
+
+/*!
+ * \brief A fixed-size lock-free ring buffer of the events recorded by a thread. The owner thread is
+ * the only producer, and the flusher is the only consumer. Events are dropped when it is full.
+ */
+class EventRingBuffer {
+ public:
+  explicit EventRingBuffer(size_t capacity) : events_(capacity) {
+  }
+
+  /*! \brief The number of events the buffer can hold. */
+  inline size_t capacity() const {
+    return events_.size();
+  }
+
+  /*! \brief Mark that the owner thread no longer pushes events, e.g., when it exits. */
+  inline void Release() {
+    released_.store(true, std::memory_order_release);
+  }
+
+  /*! \brief Whether the owner thread has released the buffer. */
+  inline bool released() const {
+    return released_.load(std::memory_order_acquire);
+  }
+
+  /*! \brief Hand a released and drained buffer over to a new owner thread. */
+  inline void Reuse() {
+    released_.store(false, std::memory_order_relaxed);
+  }
+
+  /*! \brief Push an event, or drop it if the buffer is full. Only called by the owner thread. */
+  inline void Push(const SampledEvent& event) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= events_.size()) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    events_[head % events_.size()] = event;
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  /*! \brief Pop all events in the buffer to f. Only called by one consumer at a time. */
+  template <typename F>
+  inline void Drain(F f) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    for (; tail < head; ++tail) {
+      f(events_[tail % events_.size()]);
+    }
+    tail_.store(tail, std::memory_order_release);
+  }
+
+  /*! \brief Get and reset the number of dropped events. */
+  inline uint64_t TakeDropped() {
+    return dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
+ private:
+  /*! \brief The events. */
+  std::vector<SampledEvent> events_;
+  /*! \brief The number of pushed events, which is written by the producer. */
+  alignas(64) std::atomic<uint64_t> head_{0};
+  /*! \brief The number of popped events, which is written by the consumer. */
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  /*! \brief The number of dropped events. */
+  std::atomic<uint64_t> dropped_{0};
+  /*! \brief Whether the owner thread has released the buffer. */
+  std::atomic<bool> released_{false};
+};
+
 class ProfilerHelper {
  public:
   ProfilerHelper(int dev_id, raf::DevType dev_type, std::string name, std::string categories,
@@ -198,9 +292,45 @@ class Profiler {
   std::vector<ProfileStat> GetProfileStats();
 
   inline bool IsProfiling(int level) {
-    return profile_level_ >= level;
+    return profile_level_ >= level && sampling_rate_ == 0;
+  }
+
+  /*! \brief Whether the events of the level are profiled in the sampling mode. */
+  inline bool IsSampling(int level) {
+    return profile_level_ >= level && sampling_rate_ > 0;
   }
 
+  /*! \brief Whether the calling thread should record its next event in the sampling mode. */
+  inline bool ShouldSample() {
+    static thread_local uint64_t counter = 0;
+    int rate = sampling_rate_.load(std::memory_order_relaxed);
+    return rate > 0 && ++counter % rate == 0;
+  }
+
+  /*!
+   * \brief Enable the sampling mode, which records 1 in sampling_rate events to the ring buffer of
+   * each thread without synchronizing the devices, and flushes them in a background thread.
+   * \param profile_level The profiling level.
+   * \param sampling_rate Record 1 in sampling_rate events of each thread.
+   * \param buffer_size The number of events of the ring buffer of each thread.
+   */
+  void EnableSampling(int profile_level, int sampling_rate, size_t buffer_size);
+
+  /*! \brief Disable the sampling mode, and flush the events recorded so far. */
+  void DisableSampling();
+
+  /*! \brief Move the events in the ring buffers to the profile statistics. */
+  void FlushSampledEvents();
+
+  /*! \brief Get the interned ID of a name or a category. */
+  uint32_t InternName(const std::string& name);
+
+  /*! \brief Get the ring buffer of the calling thread. */
+  const std::shared_ptr<EventRingBuffer>& ThreadBuffer();
+
+  /*! \brief Get the number of the ring buffers owned by threads or waiting to be drained. */
+  size_t NumThreadBuffers();
+
   void CollectStat() {
     for (int i = 0; i < helpers_.size(); i++) {
       helpers_[i].collect();
@@ -231,6 +361,68 @@ class Profiler {
   std::recursive_mutex m_;
   /*! \brief The helper pool. */
   std::vector<ProfilerHelper> helpers_;
+  /*! \brief Record 1 in sampling_rate_ events in the sampling mode, or 0 if it is disabled. */
+  std::atomic<int> sampling_rate_{0};
+  /*! \brief The number of events of the ring buffer of each thread. */
+  size_t buffer_size_{0};
+  /*! \brief The generation of the ring buffers, which is bumped when the buffer size changes. */
+  std::atomic<uint64_t> buffer_generation_{0};
+  /*!
+   * \brief The ring buffers of all threads. The buffers released by their owner threads, e.g., on
+   * thread exit or on generation change, are removed once they are drained.
+   */
+  std::vector<std::shared_ptr<EventRingBuffer>> buffers_;
+  /*! \brief The drained buffers of the current size to be reused by new threads. */
+  std::vector<std::shared_ptr<EventRingBuffer>> free_buffers_;
+  /*! \brief The mutex of the ring buffers. */
+  std::mutex buffer_mu_;
+  /*! \brief The interned names, indexed by their IDs. */
+  std::vector<std::string> names_;
+  /*! \brief The map from the interned names to their IDs. */
+  std::unordered_map<std::string, uint32_t> name_ids_;
+  /*! \brief The mutex of the interned names. */
+  std::mutex name_mu_;
+  /*! \brief The background thread to flush the ring buffers. */
+  std::thread flusher_;
+  /*! \brief Whether the flusher should stop. */
+  bool stop_flusher_{false};
+  /*! \brief The condition variable to wake up the flusher. */
+  std::condition_variable flusher_cv_;
+  /*! \brief The mutex of the flusher. */
+  std::mutex flush_mu_;
+  /*! \brief The mutex to drain the ring buffers, which only have one consumer at a time. */
+  std::mutex drain_mu_;
+};
+
+/*!
+ * \brief Record the lifetime of the scope as a sampled event in the sampling mode. It is only
+ * created after Profiler::ShouldSample, so the name and the category of the events that are not
+ * sampled are neither evaluated nor interned.
+ */
+class SampledScope {
+ public:
+  template <typename TName, typename TCategory>
+  SampledScope(const TName& name, const TCategory& category) {
+    Profiler* profiler = Profiler::Get();
+    event_.name_id = profiler->InternName(name);
+    event_.category_id = profiler->InternName(category);
+    buffer_ = profiler->ThreadBuffer();
+    event_.start_time = ProfileStat::NowInMicrosec();
+  }
+
+  ~SampledScope() {
+    event_.end_time = ProfileStat::NowInMicrosec();
+    buffer_->Push(event_);
+  }
+
+ private:
+  /*!
+   * \brief The ring buffer of the thread, which is kept alive in case the thread takes a new one
+   * of another size within the scope.
+   */
+  std::shared_ptr<EventRingBuffer> buffer_;
+  /*! \brief The event to record. */
+  SampledEvent event_;
 };
 
 inline void ProfilerHelper::start() {
@@ -93,6 +93,9 @@ class Stream final {
 
   static std::shared_ptr<Stream> Get(const Device& dev, int tag_idx, int index);
 
+  /*! \brief Create a stream owned by the caller instead of shared through the pool. */
+  static std::shared_ptr<Stream> Create(const Device& dev);
+
   void Wait() const;
 
  private:
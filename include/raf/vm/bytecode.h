@@ -150,6 +150,9 @@ struct Instruction {
       Index device_id;
       /*! \brief Allocate storage alloc_async if available. */
       bool alloc_async;
+      /*! \brief The offset into the static memory arena of the function, or -1 if the
+       * storage is allocated from the memory pool. */
+      Index arena_offset;
     } alloc_storage;
     struct /* AllocTensor Operands */ {
       /*! \brief The storage to allocate from. */
@@ -400,11 +403,12 @@ struct Instruction {
    * \param device_id The device ID.
    * \param dst The destination to place the storage.
    * \param alloc_async Allocate storage async if available.
+   * \param arena_offset The offset into the static memory arena, or -1 if not in the arena.
    * \return The alloc storage instruction.
    */
   static Instruction AllocStorage(RegName size, RegName alignment, DLDataType dtype_hint,
                                   DevType device_type, Index device_id, RegName dst,
-                                  bool alloc_async = true);
+                                  bool alloc_async = true, Index arena_offset = -1);
 
   /*!
    * \brief Free a tensor or a storage.
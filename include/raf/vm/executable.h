@@ -9,6 +9,9 @@
  */
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -37,6 +40,12 @@ struct VMFunction;
  *  - Primitive name section, containing the function name of the primitive ops
  *  used by the virtual machine.
  *  - Code section, handling the VM functions and bytecode.
+ *  - Data section, holding the data of the constant tensors. It starts at a page boundary, so
+ *  that the constants can be used in place when the file is mapped to memory.
+ *
+ * A section table in front of the constants and the functions records where each of them is, so
+ * that the loaded executable only deserializes the constants and the instructions of the
+ * functions that are actually used, on their first use.
  */
 class Executable : public tvm::runtime::ModuleNode {
  public:
@@ -61,12 +70,25 @@ class Executable : public tvm::runtime::ModuleNode {
   /*!
    * \brief Load the saved VM executable.
    *
-   * \param code The bytecode in string.
+   * \param code The bytecode in string, which is kept by the executable to deserialize the
+   * constants and the functions on demand.
    * \param lib The compiled runtime library.
    *
    * \return exe The constructed executable.
    */
-  static tvm::runtime::Module Load(const std::string& code, const tvm::runtime::Module lib);
+  static tvm::runtime::Module Load(std::string code, const tvm::runtime::Module lib);
+
+  /*!
+   * \brief Load the saved VM executable from a file. The file is mapped to memory, and the
+   * constant tensors in its data section are used in place without copying, so the processes
+   * loading the same file share the physical pages of the constants.
+   *
+   * \param path The path of the file written with the bytes returned by Save.
+   * \param lib The compiled runtime library.
+   *
+   * \return exe The constructed executable.
+   */
+  static tvm::runtime::Module LoadFile(const std::string& path, const tvm::runtime::Module lib);
 
   /*!
    * \brief Get the serialized form of the `functions`. This is
@@ -125,6 +147,24 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   int GetFunctionArity(std::string func) const;
 
+  /*!
+   * \brief Get the size of the static memory arena of the VM function, which is an upper bound
+   * of the peak memory of the storages planned into the arena.
+   * \param func Function name.
+   * \return The arena size in bytes, or 0 if the function does not use a static arena.
+   */
+  int64_t GetArenaSize(std::string func) const;
+
+  /*!
+   * \brief Get the peak memory of the VM function estimated at compile time, which includes the
+   * storages, the static arenas, the rounding of the memory pools and the callees. The workspace
+   * of the ops is only included if the executable is compiled with the pass config
+   * "raf.vm.peak_memory.include_workspace".
+   * \param func Function name.
+   * \return The peak memory in bytes, or -1 if it is unknown, e.g., due to dynamic shapes.
+   */
+  int64_t GetPeakMemory(std::string func) const;
+
   /*!
    * \brief Get the parameter name given the function name and parameter index.
    * \param func Function name.
@@ -133,6 +173,35 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   std::string GetFunctionParameterName(std::string func, uint32_t index) const;
 
+  /*!
+   * \brief Get the VM function. The instructions of a function loaded from the section table are
+   * deserialized on the first call, which is thread-safe.
+   * \param func_index The index of the function.
+   * \return The VM function.
+   */
+  const VMFunction& GetVMFunction(Index func_index) const;
+
+  /*!
+   * \brief Get the number of instructions of the VM function without deserializing them.
+   * \param func_index The index of the function.
+   * \return The number of instructions.
+   */
+  size_t GetNumInstructions(Index func_index) const;
+
+  /*!
+   * \brief Get the number of functions whose instructions have been deserialized.
+   * \return The number of loaded functions.
+   */
+  size_t GetNumLoadedFunctions() const;
+
+  /*!
+   * \brief Get a constant in the constant pool. The constants loaded from the section table are
+   * deserialized on the first call, which is thread-safe.
+   * \param const_index The index of the constant.
+   * \return The constant.
+   */
+  const Value& GetConstant(Index const_index) const;
+
   virtual ~Executable() {
   }
 
@@ -143,7 +212,10 @@ class Executable : public tvm::runtime::ModuleNode {
   /*! \brief The runtime module/library that contains both the host and also the device
    * code when executing on non-CPU devices. */
   tvm::runtime::Module lib;
-  /*! \brief The global constant pool. */
+  /*!
+   * \brief The global constant pool. The constants not deserialized yet are undefined, so
+   * they should be accessed with GetConstant.
+   */
   std::vector<Value> constants;
   /*! \brief A map from globals (as strings) to their index in the function map. */
   std::unordered_map<std::string, Index> global_map;
@@ -151,7 +223,10 @@ class Executable : public tvm::runtime::ModuleNode {
    * corresponds to the position of the `packed_funcs` list in a `VirtualMachine` object.
    */
   std::unordered_map<std::string, Index> primitive_map;
-  /*! \brief The virtual machine's function table. */
+  /*!
+   * \brief The virtual machine's function table. The instructions of a function not deserialized
+   * yet are empty, so they should be accessed with GetVMFunction.
+   */
   std::vector<VMFunction> functions;
 
  private:
@@ -162,12 +237,64 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   void SaveGlobalSection(dmlc::Stream* strm);
 
+  /*! \brief A constant tensor whose data is in the data section. */
+  struct DataSectionTensor {
+    /*! \brief The index in the constant pool. */
+    size_t index;
+    DLDataType dtype;
+    std::vector<int64_t> shape;
+    /*! \brief The offset in bytes to the start of the data section. */
+    uint64_t offset;
+    uint64_t nbytes;
+
+    /*! \brief Load the tensor info, without the data. Return false on failure. */
+    bool Load(dmlc::Stream* strm);
+    /*! \brief Save the tensor info, without the data. */
+    void Save(dmlc::Stream* strm) const;
+  };
+
+  /*! \brief The location of a constant or the instructions of a function in the payload. */
+  struct Section {
+    /*! \brief The offset in bytes to the start of the payload, which follows the section table. */
+    uint64_t offset;
+    uint64_t size;
+  };
+
   /*!
-   * \brief Save the constant pool.
+   * \brief Load the saved VM executable from the bytes.
+   *
+   * \param data The pointer to the bytes.
+   * \param size The number of bytes.
+   * \param lib The compiled runtime library.
+   * \param source The owner of the bytes. With a section table, it is kept by the executable,
+   * because the bytes are deserialized on demand after loading.
+   * \param in_place Whether the constant tensors can refer to the bytes in place, which requires
+   * the data section to be aligned. Otherwise, each constant tensor is copied on its first use.
+   *
+   * \return exe The constructed executable.
+   */
+  static tvm::runtime::Module Load(const char* data, size_t size, const tvm::runtime::Module lib,
+                                   std::shared_ptr<void> source, bool in_place);
+
+  /*!
+   * \brief Save the constant pool. The data of the compact tensors are not saved inline.
    *
    * \param strm The input stream.
+   * \param tensors The tensors to be saved in the data section.
+   * \param sections The location of each constant in the stream.
    */
-  void SaveConstantSection(dmlc::Stream* strm);
+  void SaveConstantSection(dmlc::SeekStream* strm, std::vector<DataSectionTensor>* tensors,
+                           std::vector<Section>* sections);
+
+  /*!
+   * \brief Save the data of the constant tensors at the end of the file.
+   *
+   * \param strm The input stream.
+   * \param pos The number of bytes written to the stream.
+   * \param tensors The tensors returned by SaveConstantSection.
+   */
+  void SaveDataSection(dmlc::Stream* strm, size_t pos,
+                       const std::vector<DataSectionTensor>& tensors);
 
   /*!
    * \brief Save primitive op names.
@@ -177,11 +304,23 @@ class Executable : public tvm::runtime::ModuleNode {
   void SavePrimitiveOpNames(dmlc::Stream* strm);
 
   /*!
-   * \brief Save the vm functions.
+   * \brief Save the instructions of the vm functions.
    *
    * \param strm The input stream.
+   * \param sections The location of the instructions of each function in the stream.
    */
-  void SaveCodeSection(dmlc::Stream* strm);
+  void SaveCodeSection(dmlc::SeekStream* strm, std::vector<Section>* sections);
+
+  /*!
+   * \brief Save the section table, with the headers of the vm functions.
+   *
+   * \param strm The input stream.
+   * \param constant_sections The location of each constant in the payload.
+   * \param function_sections The location of the instructions of each function in the payload.
+   * \param payload_size The size of the payload in bytes.
+   */
+  void SaveSectionTable(dmlc::Stream* strm, const std::vector<Section>& constant_sections,
+                        const std::vector<Section>& function_sections, uint64_t payload_size);
 
   /*!
    * \brief Load the globals.
@@ -191,11 +330,40 @@ class Executable : public tvm::runtime::ModuleNode {
   void LoadGlobalSection(dmlc::Stream* strm);
 
   /*!
-   * \brief Load the constant pool.
+   * \brief Load the constant pool. The tensors in the data section are left undefined.
    *
    * \param strm The input stream.
+   * \param format_version The format version of the file.
+   * \param tensors The tensors to be loaded from the data section.
+   */
+  void LoadConstantSection(dmlc::Stream* strm, uint64_t format_version,
+                           std::vector<DataSectionTensor>* tensors);
+
+  /*!
+   * \brief Load the constant tensors from the data section.
+   *
+   * \param data The pointer to the data section.
+   * \param size The size of the data section.
+   * \param tensors The tensors returned by LoadConstantSection.
+   * \param mapping The owner of the data section if the tensors can refer to it in place, or
+   * nullptr to copy the tensors.
+   */
+  void LoadDataSection(const char* data, size_t size,
+                       const std::vector<DataSectionTensor>& tensors,
+                       std::shared_ptr<void> mapping);
+
+  /*!
+   * \brief Load a constant tensor from the data section.
+   *
+   * \param data The pointer to the data section.
+   * \param size The size of the data section.
+   * \param tensor The tensor info.
+   * \param mapping The owner of the data section if the tensor can refer to it in place, or
+   * nullptr to copy the tensor.
    */
-  void LoadConstantSection(dmlc::Stream* strm);
+  static Value LoadDataSectionTensor(const char* data, size_t size,
+                                     const DataSectionTensor& tensor,
+                                     const std::shared_ptr<void>& mapping);
 
   /*!
    * \brief Load primitive op names.
@@ -211,8 +379,45 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   void LoadCodeSection(dmlc::Stream* strm);
 
+  /*!
+   * \brief Load the section table and the headers of the vm functions. The constants and the
+   * instructions are left to be deserialized on demand.
+   *
+   * \param strm The input stream.
+   * \return The size of the payload in bytes.
+   */
+  uint64_t LoadSectionTable(dmlc::Stream* strm);
+
+  /*! \brief Deserialize a constant from the payload. */
+  void LoadConstant(Index const_index);
+
+  /*! \brief Deserialize the instructions of a function from the payload. */
+  void LoadFunction(Index func_index);
+
   /*! \brief The serialized bytecode. */
   std::string code_;
+  /*! \brief The owner of the loaded bytes, which are kept to deserialize the payload on demand. */
+  std::shared_ptr<void> source_;
+  /*! \brief Whether the constant tensors refer to the loaded bytes in place. */
+  bool source_in_place_ = false;
+  /*! \brief The start of the payload in the loaded bytes. */
+  const char* payload_ = nullptr;
+  /*! \brief The start of the data section in the loaded bytes. */
+  const char* data_section_ = nullptr;
+  /*! \brief The size of the data section. */
+  size_t data_section_size_ = 0;
+  /*! \brief The location of each constant in the payload. */
+  std::vector<Section> constant_sections_;
+  /*! \brief The location of the instructions of each function in the payload. */
+  std::vector<Section> function_sections_;
+  /*! \brief The number of instructions of each function in the payload. */
+  std::vector<size_t> num_instructions_;
+  /*! \brief Whether each constant has been deserialized, or nullptr if all of them have been. */
+  std::unique_ptr<std::once_flag[]> constant_once_;
+  /*! \brief Whether each function has been deserialized, or nullptr if all of them have been. */
+  std::unique_ptr<std::once_flag[]> function_once_;
+  /*! \brief The number of functions deserialized from the payload. */
+  std::atomic<size_t> num_loaded_functions_{0};
 };
 
 }  // namespace vm
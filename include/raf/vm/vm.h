@@ -9,9 +9,12 @@
  */
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "bytecode.h"
@@ -63,6 +66,15 @@ struct VMFunction {
   std::vector<Instruction> instructions;
   /*! \brief The size of the frame for this function */
   Index register_file_size;
+  /*! \brief The size in bytes of the static memory arena of this function. 0 means the
+   * function allocates all its storages from the memory pool. */
+  int64_t arena_size{0};
+  /*! \brief The alignment in bytes of the static memory arena. */
+  int64_t arena_alignment{0};
+  /*! \brief The estimated peak bytes allocated from the memory pools when the function runs,
+   * including its callees and the rounding of the pools. -1 means unknown, e.g., due to dynamic
+   * shapes. */
+  int64_t peak_memory{-1};
 
   VMFunction(const std::string& name, std::vector<std::string> params,
              std::vector<Instruction> instructions, Index register_file_size)
@@ -98,6 +110,8 @@ struct VMFrame {
   std::vector<Value> register_file;
   /*! \brief Indicate whether each register is constant. */
   std::vector<bool> is_const;
+  /*! \brief The static memory arena of this invocation, taken at its first planned storage. */
+  std::shared_ptr<Memory> arena;
 
   VMFrame(Index caller_func_index, Index caller_pc, RegName caller_ret_reg, Index num_args,
           Index register_file_size)
@@ -110,6 +124,27 @@ struct VMFrame {
   }
 };
 
+/*! \brief An OpEnv to be built ahead of time, which is collected by Precompile. */
+struct PrecompileTask {
+  /*! \brief The function table index of the InvokeJit instruction. */
+  Index func_index;
+  /*! \brief The program counter of the InvokeJit instruction. */
+  Index pc;
+  /*! \brief The key in the OpEnv cache of the instruction. */
+  std::string key;
+  /*! \brief The call values to dispatch. */
+  CallValues call;
+};
+
+/*!
+ * \brief A captured execution plan on CPU: the flat sequence of OpEnvs with their resolved
+ * arguments, recorded from one run and replayed for later runs with the same input shapes.
+ */
+class CPUPlan;
+
+/*! \brief The per-instruction latency statistics, see EnableInstructionStats. */
+class InstructionStats;
+
 /*!
  * \brief VMContextObj holds the runtime data for an execution in the VM.
  */
@@ -137,12 +172,32 @@ class VMContextObj : public ValueObj {
   std::vector<std::shared_ptr<Event>> barrier_events;
   /*! \brief The streams used in runtime. */
   std::vector<std::vector<std::shared_ptr<Stream>>> streams;
+  /*! \brief The CPU stream of the latest op writing each tensor buffer, which is waited before
+   * the VM reads the buffer on the host. */
+  std::unordered_map<const void*, std::shared_ptr<Stream>> cpu_stream_producers;
   /*! \brief The index of the barrier event to use for next stream barrier. */
   Index current_barrier_event_index{0};
   /*! \brief The index of current device id to launch kernels. */
   Index current_device_id{0};
   /*! \brief The index of current working stream into cuda_streams. 0 indicates default stream. */
   Index current_stream_id{0};
+  /*!
+   * \brief The static memory arenas of the returned invocations indexed by function index, which
+   * are reused by the next invocations of the same functions.
+   */
+  std::vector<std::shared_ptr<Memory>> arenas;
+  /*! \brief If set, InvokeJit collects the OpEnvs to build instead of executing them. */
+  std::vector<PrecompileTask>* precompile_tasks{nullptr};
+  /*! \brief The outputs of the kernels skipped by the walk of Precompile, whose contents are
+   * unknown until the kernels run. */
+  std::unordered_set<Value, ObjectPtrHash, ObjectPtrEqual> precompile_unknown;
+  /*! \brief If set, InvokeJit records the executed OpEnvs into this plan. */
+  CPUPlan* cpu_plan{nullptr};
+  /*! \brief If set, the instructions executed in this run are recorded into the statistics. */
+  std::shared_ptr<InstructionStats> stats;
+  /*! \brief The inputs of the InvokeJit being executed. The buffer is reused by the following
+   * InvokeJit instructions, so that reusing a cached OpEnv does not allocate. */
+  std::vector<Value> jit_inputs;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("func_index", &func_index);
@@ -159,7 +214,8 @@ class VMContextObj : public ValueObj {
  * \brief VMContext is the wrapper for the VMContextObj and provides additional
  *   APIs to access and update the runtime context.
  *
- * The APIs in the VMContext are NOT thread safe.
+ * The APIs in the VMContext are NOT thread safe, so a context must not be shared by
+ * threads. Different contexts can run on the same VirtualMachine concurrently.
  */
 class VMContext : public Value {
  public:
@@ -212,9 +268,32 @@ class VMContext : public Value {
 
 using OpEnvCache = MetaCache<OpEnvPtr>;
 
+/*!
+ * \brief An entry of the per-instruction inline OpEnv cache. It records the shape and dtype
+ * fingerprint of the registers accessed by an InvokeJit instruction, so that a following
+ * invocation with the same fingerprint can reuse the OpEnv without building the string key.
+ */
+struct OpEnvCacheEntry {
+  /*! \brief The flattened shape/dtype fingerprint of the input and output registers. */
+  std::vector<int64_t> fingerprint;
+  /*! \brief The cached OpEnv. */
+  OpEnvPtr op_env;
+  /*! \brief The string key in the OpEnv cache, which is also used in profiling. */
+  std::string key;
+};
+
+using OpEnvCacheEntryPtr = std::shared_ptr<const OpEnvCacheEntry>;
+
 /*! \brief The OpEnv cache for a VM function. */
 class VMFuncOpEnvCache {
  public:
+  /*!
+   * \brief Create the OpEnv cache for a VM function.
+   * \param num_instructions The number of instructions in the VM function.
+   */
+  explicit VMFuncOpEnvCache(size_t num_instructions = 0) : inline_cache_(num_instructions) {
+  }
+
   /*!
    * \brief Get the OpEnv cache for a given instruction.
    * \param pc The program counter
@@ -222,6 +301,21 @@ class VMFuncOpEnvCache {
    */
   std::shared_ptr<OpEnvCache> Get(Index pc);
 
+  /*!
+   * \brief Get the inline cache entry for a given instruction. This is lock-free and does not
+   * allocate memory.
+   * \param pc The program counter.
+   * \return The last entry used by the instruction, or nullptr if there is none.
+   */
+  OpEnvCacheEntryPtr GetInline(Index pc) const;
+
+  /*!
+   * \brief Update the inline cache entry for a given instruction.
+   * \param pc The program counter.
+   * \param entry The new entry.
+   */
+  void SetInline(Index pc, OpEnvCacheEntryPtr entry);
+
   /*!
    * \brief Clear the OpEnv cache.
    */
@@ -230,6 +324,8 @@ class VMFuncOpEnvCache {
  private:
   /*! \brief Cache map from instruction index to OpEnv cache. */
   std::unordered_map<Index, std::shared_ptr<OpEnvCache>> cache_map_;
+  /*! \brief The inline cache entries indexed by the instruction index. */
+  std::vector<OpEnvCacheEntryPtr> inline_cache_;
   /*! \brief The mutex for the cache_map_. */
   std::mutex mu_;
 };
@@ -247,8 +343,11 @@ class VMFuncOpEnvCache {
  */
 class VirtualMachine : public tvm::runtime::ModuleNode {
  public:
-  VirtualMachine(bool enable_cuda_graph, bool dryrun)
-      : exec_(nullptr), dryrun_(dryrun), enable_cuda_graph_(enable_cuda_graph) {
+  VirtualMachine(bool enable_cuda_graph, bool dryrun, bool enable_cpu_plan = false)
+      : exec_(nullptr),
+        dryrun_(dryrun),
+        enable_cuda_graph_(enable_cuda_graph),
+        enable_cpu_plan_(enable_cpu_plan) {
 #ifndef RAF_USE_CUDA
     if (enable_cuda_graph) {
       LOG(WARNING) << "Because CUDA is not enabled in RAF, CUDA graph will be disabled in the VM.";
@@ -334,6 +433,43 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * \return A list of latency numbers in milliseconds (length of the list equals 'repeat').
    */
   Array<FloatValue> Profile(VMContext ctx, int warmup, int number, int repeat);
+  /*!
+   * \brief Build the OpEnvs of all InvokeJit instructions ahead of time, so that the first run
+   * does not compile kernels one by one. The function is walked with the inputs in the context
+   * without executing any kernel, and the collected OpEnvs are built in parallel. Only the
+   * branches taken with the (uninitialized) tensor data are walked, so OpEnvs in other branches
+   * are still built on the first use. It must not run concurrently with other runs.
+   * \param ctx The runtime context, which determines the input shapes.
+   * \param num_threads The number of threads to build with. Non-positive means all cores.
+   * \return The number of OpEnvs built.
+   */
+  int Precompile(VMContext ctx, int num_threads);
+  /*!
+   * \brief Enable or disable the per-instruction statistics. When enabled, every run records the
+   * call count, latency histogram, allocated bytes and workspace bytes of each instruction, with
+   * a few relaxed atomic updates per instruction. Enabling it again resets the statistics. It
+   * takes effect from the next run.
+   * \param enable Whether to enable the statistics.
+   */
+  void EnableInstructionStats(bool enable);
+  /*!
+   * \brief Get the per-instruction statistics in JSON, with the instructions that ran and their
+   * aggregation by the op name. Empty if the statistics are not enabled.
+   */
+  std::string GetInstructionStats();
+  /*!
+   * \brief Get the per-instruction statistics aggregated by the op name as a table, sorted by
+   * the total time.
+   * \param top The maximal number of rows, or non-positive for all rows.
+   */
+  std::string GetInstructionStatsTable(int top);
+  /*!
+   * \brief Enable or disable the inline OpEnv cache of InvokeJit. When disabled, every InvokeJit
+   * looks up its OpEnv by the key built from its registers. It is enabled by default, and only
+   * disabled to measure the dispatch overhead without it.
+   * \param enable Whether to enable the inline cache.
+   */
+  void EnableInlineCache(bool enable);
 
  protected:
   /*! \brief Get device for params. */
@@ -352,9 +488,62 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
                                        bool alloc_async = true) const;
   /*! \brief Run VM dispatch loop. */
   virtual void RunLoop(VMContext& ctx);
-  /*! \brief Prepare an OpEnv with its inputs and output */
-  virtual std::tuple<OpEnvPtr, std::vector<Value>, Value, std::string> PrepareOpEnv(
-      const VMContext& ctx, const Instruction& instr);
+  /*!
+   * \brief Run the context with the captured CPU plan of its function, replaying the plan if the
+   * input shapes match, or capturing a new plan otherwise.
+   * \param ctx The runtime context.
+   * \param ret The return value if the run is done.
+   * \return Whether the run is done. Otherwise it should be interpreted.
+   */
+  bool RunCPUPlan(VMContext& ctx, Value* ret);
+  /*! \brief Replay a captured CPU plan with the inputs of the context. */
+  Value ReplayCPUPlan(const VMContext& ctx, CPUPlan* plan);
+  /*!
+   * \brief Check whether the function can be captured as a CPU plan, i.e., neither it nor the
+   * functions it calls have control flow, dynamic shape or multi-stream instructions. The result
+   * is memoized, and the caller must hold cpu_plan_mu_.
+   */
+  bool CPUPlanSupported(Index func_index);
+  /*!
+   * \brief Allocate the constant pool before the first run. The constants are copied to the
+   * device on their first load.
+   */
+  void InitConstPool();
+  /*!
+   * \brief Prepare an OpEnv with its output, and fill its inputs into the given buffer, whose
+   * previous contents are discarded. The returned cache entry holds the OpEnv cache key of this
+   * invocation. The OpEnv is shared by all contexts, so it must not be mutated. The workspace of
+   * each execution is bound to the thread by BindWorkspace.
+   */
+  virtual std::tuple<OpEnvPtr, Value, OpEnvCacheEntryPtr> PrepareOpEnv(
+      const VMContext& ctx, const Instruction& instr, std::vector<Value>* inputs);
+  /*!
+   * \brief Look up the OpEnv cache of an InvokeJit instruction with the string key built from its
+   * registers, create a new OpEnv on cache miss, and refresh the inline cache of the instruction.
+   */
+  OpEnvCacheEntryPtr LookupOpEnv(const VMContext& ctx, const Instruction& instr,
+                                 const Value& output);
+  /*! \brief Dispatch the call to an OpEnv. It does not access the VM context. */
+  OpEnvPtr BuildOpEnv(const CallValues& call);
+  /*! \brief Bind the stream and distributed requests of a newly built OpEnv. */
+  void InitOpEnvRequests(const VMContext& ctx, const OpEnvPtr& op_env);
+  /*!
+   * \brief Allocate the workspace requested by an OpEnv for one execution and bind it to the
+   * calling thread until the returned binding is destroyed.
+   * \param ctx The VM context.
+   * \param op_env The OpEnv to execute.
+   * \param memory The workspace memory allocated from the context, which the caller holds until
+   * the execution is done.
+   */
+  op::WorkspaceBinding BindWorkspace(const VMContext& ctx, const OpEnvPtr& op_env,
+                                     std::vector<std::shared_ptr<Memory>>* memory);
+  /*!
+   * \brief Launch an OpEnv to the current CPU stream of the context, which executes it on the
+   * worker thread of the stream after the ops launched to the stream before.
+   */
+  void LaunchOnCPUStream(const VMContext& ctx, const OpEnvPtr& op_env,
+                         const std::vector<Value>& inputs, const Value& output,
+                         const std::string& key);
   /*! \brief Handle Move instruction*/
   virtual void HandleMove(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle LoadConst instruction*/
@@ -417,12 +606,36 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * corresponding VM function. It's a map from pc to the OpEnv cache.
    */
   std::vector<std::shared_ptr<VMFuncOpEnvCache>> op_env_cache_;
+  /*! \brief Whether each constant in the pool has been copied to the device. */
+  std::unique_ptr<std::once_flag[]> const_pool_once_;
+  /*! \brief Whether the constant pool has been allocated. */
+  std::atomic<bool> const_pool_ready_{false};
+  /*! \brief The mutex to allocate the constant pool. */
+  std::mutex const_pool_mu_;
+  /*! \brief The mutex to build OpEnvs on cache misses. */
+  std::mutex op_env_build_mu_;
   /*! \brief Indicates whether to dryrun (skip op execution). */
   bool dryrun_ = false;
   /*! \brief Indicates whether CUDA is used. */
   bool use_cuda_ = false;
   /*! \brief Indicates whether CUDA Graph is enabled when VM is initialized. */
   bool enable_cuda_graph_ = false;
+  /*! \brief Indicates whether to capture and replay the execution plans on CPU. */
+  bool enable_cpu_plan_ = false;
+  /*! \brief Indicates whether InvokeJit reuses the OpEnv of its inline cache. */
+  std::atomic<bool> enable_inline_cache_{true};
+  /*! \brief Whether each entry function can be captured as a CPU plan, see CPUPlanSupported. */
+  std::unordered_map<Index, bool> cpu_plan_supported_;
+  /*! \brief The captured CPU plans indexed by the function index. */
+  std::unordered_map<Index, std::shared_ptr<CPUPlan>> cpu_plans_;
+  /*! \brief The mutex to capture and replay the CPU plans, which are not reentrant. */
+  std::mutex cpu_plan_mu_;
+  /*! \brief The number of the captured CPU plans, guarded by cpu_plan_mu_. */
+  int64_t num_cpu_plan_captures_ = 0;
+  /*! \brief The number of the replays of the CPU plans, guarded by cpu_plan_mu_. */
+  int64_t num_cpu_plan_replays_ = 0;
+  /*! \brief The per-instruction statistics, or nullptr if they are not enabled. */
+  std::shared_ptr<InstructionStats> instr_stats_;
 
 #ifdef RAF_USE_CUDA
   /*!
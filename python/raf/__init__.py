@@ -9,6 +9,7 @@ from ._core.ndarray import array, ndarray
 from ._op.imp import *  # pylint: disable=redefined-builtin
 from . import frontend
 from . import amp
+from . import quantization
 from . import random
 from . import build
 from . import ir
@@ -119,17 +119,26 @@ class VMExecutor:
 
     dryrun: bool
         Whether to create a dryrun VM that skips the op execution.
+
+    enable_cpu_plan: bool
+        Whether to capture and replay the execution plan on CPU.
     """
 
-    def __init__(self, mod, device, enable_cuda_graph=False, dryrun=False):
+    def __init__(self, mod, device, enable_cuda_graph=False, dryrun=False, enable_cpu_plan=False):
         if mod is None:
             raise RuntimeError("Must provide module to get VM executor.")
         if "gpu" not in device and "cuda" not in device:
             enable_cuda_graph = False
+        else:
+            enable_cpu_plan = False
         self.device = Device(device)
         self.executable = vm.compile(mod, self.device)
         self.vm = vm.VirtualMachine(
-            self.executable, self.device, enable_cuda_graph=enable_cuda_graph, dryrun=dryrun
+            self.executable,
+            self.device,
+            enable_cuda_graph=enable_cuda_graph,
+            dryrun=dryrun,
+            enable_cpu_plan=enable_cpu_plan,
         )
 
     @staticmethod
@@ -3,6 +3,8 @@
 
 """RAF virtual machine and utility functions."""
 # pylint: disable=no-self-use
+import json
+
 import numpy as np
 import tvm
 
@@ -27,6 +29,9 @@ class Executable:
         self._get_stats = self.mod["get_stats"]
         self._get_function_arity = self.mod["get_function_arity"]
         self._get_function_param_name = self.mod["get_function_param_name"]
+        self._get_arena_size = self.mod["get_arena_size"]
+        self._get_peak_memory = self.mod["get_peak_memory"]
+        self._get_num_loaded_functions = self.mod["get_num_loaded_functions"]
 
     def save(self):
         """Save the RAF VM Executable.
@@ -58,6 +63,9 @@ class Executable:
          - Code section. The VM functions, including bytecode, are sitting in
          this section.
 
+         - Data section. The data of the constant tensors, starting at a page
+         boundary so that :py:meth:`load_exec_file` can map them to memory.
+
         Examples
         --------
 
@@ -126,6 +134,32 @@ class Executable:
 
         return Executable(_ffi.vm.Load_Executable(bytecode, lib))
 
+    @staticmethod
+    def load_exec_file(path, lib):
+        """Construct an executable from a file with the saved bytecode. The file is mapped to
+        memory and the constant tensors are used in place, so loading a large executable does
+        not copy its constants, and the processes loading the same file share their memory.
+
+        Parameters
+        ----------
+        path : str
+            The path of the file with the bytecode returned by :py:meth:`save`.
+
+        lib : :py:class:`~tvm.runtime.Module`
+            The runtime module that contains the generated code.
+
+        Returns
+        -------
+        exec: Executable
+            An executable constructed using the provided artifacts.
+        """
+        if lib is not None and not isinstance(lib, tvm.runtime.Module):
+            raise TypeError(
+                "lib is expected to be the type of tvm.runtime.Module"
+                + ", but received {}".format(type(lib))
+            )
+        return Executable(_ffi.vm.Load_ExecutableFile(str(path), lib))
+
     @property
     def lib(self):
         """Get the library that contains hardware dependent code.
@@ -241,6 +275,55 @@ class Executable:
         self._function_params[func_name] = params
         return params
 
+    def get_arena_size(self, func_name="main"):
+        """Get the size of the static memory arena of a VM function, which is planned at
+        compile time when "raf.memory_plan.static_arena" is enabled.
+
+        Parameters
+        ----------
+        func_name: str
+            The function name.
+
+        Returns
+        -------
+        ret : int
+            The arena size in bytes, or 0 if the function does not use a static arena.
+        """
+        ret = self._get_arena_size(func_name)
+        assert ret >= 0, "Cannot find function %s" % func_name
+        return ret
+
+    def get_peak_memory(self, func_name="main"):
+        """Get the peak memory of a VM function estimated at compile time, which includes the
+        storages, the static arenas, the rounding of the memory pools and the callees. The
+        workspace of the ops is only included when the executable is compiled with
+        "raf.vm.peak_memory.include_workspace" enabled.
+
+        Parameters
+        ----------
+        func_name: str
+            The function name.
+
+        Returns
+        -------
+        ret : int
+            The peak memory in bytes, or -1 if it is unknown, e.g., due to dynamic shapes.
+        """
+        assert func_name in self.globals, "Cannot find function %s" % func_name
+        return self._get_peak_memory(func_name)
+
+    @property
+    def num_loaded_functions(self):
+        """Get the number of VM functions whose bytecode has been deserialized. A loaded
+        executable deserializes the bytecode of a function on its first invocation.
+
+        Returns
+        -------
+        ret : int
+            The number of loaded functions.
+        """
+        return self._get_num_loaded_functions()
+
 
 class VMCompiler:
     """Compiler that compiles RAF IRModule to Executable."""
@@ -436,19 +519,30 @@ class VirtualMachine:
 
     dryrun: bool
         Whether to create a dryrun VM that skips the op execution.
+
+    enable_cpu_plan: bool
+        Whether to capture the ops executed on CPU into a plan and replay the plan for the later
+        runs with the same input shapes. Only executables without control flow, dynamic shapes
+        and multiple streams are captured.
     """
 
-    def __init__(self, exe, device, enable_cuda_graph=False, dryrun=False):
+    def __init__(self, exe, device, enable_cuda_graph=False, dryrun=False, enable_cpu_plan=False):
         if not isinstance(exe, Executable):
             raise TypeError(
                 "mod is expected to be the type of Executable, but received {}".format(type(exe))
             )
-        self.module = _ffi.vm.VirtualMachine(exe.module, enable_cuda_graph, dryrun)
+        self.module = _ffi.vm.VirtualMachine(exe.module, enable_cuda_graph, dryrun, enable_cpu_plan)
         self._exec = exe
         self._set_devices = self.module["set_devices"]
         self._prepare_context = self.module["prepare_context"]
         self._run = self.module["run"]
         self._profile = self.module["profile"]
+        self._precompile = self.module["precompile"]
+        self._enable_instruction_stats = self.module["enable_instruction_stats"]
+        self._get_instruction_stats = self.module["get_instruction_stats"]
+        self._get_instruction_stats_table = self.module["get_instruction_stats_table"]
+        self._get_cpu_plan_stats = self.module["get_cpu_plan_stats"]
+        self._enable_inline_cache = self.module["enable_inline_cache"]
         self._set_devices(device)
 
     def prepare_context(self, func_name, *args, **kwargs):
@@ -508,6 +602,34 @@ class VirtualMachine:
         ctx = self.prepare_context(func_name, *args, **kwargs)
         return self._run(ctx)
 
+    def precompile(self, *args, func_name="main", num_threads=0, **kwargs):
+        """Build the kernels of all ops in the function in parallel ahead of the first run.
+        Only the kernels with statically known inputs are built. The walk stops at the first
+        instruction that depends on the contents of a kernel output, e.g., a data-dependent
+        branch or shape, and the rest of the kernels are built when they run.
+
+        Parameters
+        ----------
+        args : list[raf.ndarray] or list[np.ndarray]
+            The arguments to the function, which determine the shapes of the kernels.
+
+        func_name : str
+            The name of function to precompile.
+
+        num_threads : int
+            The number of threads to build kernels. Non-positive means all cores. Default 0.
+
+        kwargs: dict of str to raf.ndarray or np.ndarray
+            Named arguments to the function.
+
+        Returns
+        -------
+        result : int
+            The number of kernels built.
+        """
+        ctx = self.prepare_context(func_name, *args, **kwargs)
+        return self._precompile(ctx, num_threads)
+
     def profile(self, *args, func_name="main", warmup=5, number=10, repeat=10, **kwargs):
         """Profile the virtual machine.
 
@@ -543,3 +665,68 @@ class VirtualMachine:
         ctx = self.prepare_context(func_name, *args, **kwargs)
         result = [v.value for v in self._profile(ctx, warmup, number, repeat)]
         return result
+
+    def enable_instruction_stats(self, enable=True):
+        """Enable or disable the per-instruction statistics of the later runs. Enabling them again
+        resets the statistics.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to enable the statistics. Default True.
+        """
+        self._enable_instruction_stats(enable)
+
+    def enable_inline_cache(self, enable=True):
+        """Enable or disable the inline OpEnv cache of the InvokeJit instructions. When disabled,
+        every InvokeJit looks up its OpEnv by the key built from its arguments. It is enabled by
+        default.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to enable the inline cache. Default True.
+        """
+        self._enable_inline_cache(enable)
+
+    def get_instruction_stats(self):
+        """Get the per-instruction statistics.
+
+        Returns
+        -------
+        result : Dict[str, Any]
+            The statistics, where "instructions" is the list of the instructions that ran, with
+            their function, pc, name, count, latencies in microseconds, allocated bytes, workspace
+            bytes and the number of the invocations that hit the inline OpEnv cache, and "ops"
+            maps each op name to the aggregation of its instructions.
+            Empty if the statistics are not enabled.
+        """
+        stats = self._get_instruction_stats()
+        return json.loads(stats) if stats else {}
+
+    def instruction_stats_table(self, top=0):
+        """Get the per-instruction statistics aggregated by the op name as a table, sorted by
+        the total time.
+
+        Parameters
+        ----------
+        top : int
+            The maximal number of rows. Non-positive means all rows. Default 0.
+
+        Returns
+        -------
+        result : str
+            The table.
+        """
+        return self._get_instruction_stats_table(top)
+
+    def get_cpu_plan_stats(self):
+        """Get the number of the CPU plans captured and replayed by the runs so far.
+
+        Returns
+        -------
+        result : Dict[str, int]
+            The number of the captured plans as "captures", and the number of the replays as
+            "replays".
+        """
+        return {key: value.value for key, value in self._get_cpu_plan_stats().items()}
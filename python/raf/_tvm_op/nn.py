@@ -11,6 +11,7 @@ from .._lib import register_compute
 from .._lib import generic_func
 from .._lib import tvm as _tvm
 from .._lib import _reg
+from .._lib import _op
 from .._lib import strategy
 from .._lib import random
 
@@ -18,7 +19,75 @@ _topi = _tvm.topi  # pylint: disable=no-member
 
 _reg.register_injective_schedule("raf.op.tvm.pad")
 
-_reg.register_strategy("raf.op.tvm.dense", strategy.dense_strategy)
+
+def compute_matmul_bf16(data, weight, transpose_a=False, transpose_b=False):
+    """Matmul of bfloat16 tensors. The result is accumulated in float32 and casted to bfloat16
+    at the end, because accumulating in bfloat16 with 8-bit mantissa loses too much precision.
+    """
+    m = data.shape[1] if transpose_a else data.shape[0]
+    red = data.shape[0] if transpose_a else data.shape[1]
+    n = weight.shape[0] if transpose_b else weight.shape[1]
+    k = _tvm.te.reduce_axis((0, red), name="k")
+
+    def _fcompute(i, j):
+        lhs = data[k, i] if transpose_a else data[i, k]
+        rhs = weight[j, k] if transpose_b else weight[k, j]
+        return _tvm.te.sum(lhs.astype("float32") * rhs.astype("float32"), axis=k)
+
+    acc = _tvm.te.compute((m, n), _fcompute, name="matmul_acc", tag="matmul_bf16")
+    return _topi.cast(acc, "bfloat16")
+
+
+def schedule_matmul_bf16_cpu(outs):
+    """Tile the float32 accumulator so that each 8x16 tile stays in 8 vector registers of 16
+    float32 lanes (AVX-512), and vectorize the output cast to bfloat16.
+    """
+    outs = [outs] if isinstance(outs, _tvm.te.tensor.Tensor) else outs
+    sch = _tvm.te.create_schedule([x.op for x in outs])
+    out = outs[0]
+
+    def _callback(op):
+        if op.tag != "matmul_bf16" or len(out.shape) != 2:
+            return
+        acc = op.output(0)
+        y, x = sch[out].op.axis
+        yo, xo, _, xi = sch[out].tile(y, x, 8, 16)
+        fused = sch[out].fuse(yo, xo)
+        sch[out].parallel(fused)
+        sch[out].vectorize(xi)
+
+        sch[acc].compute_at(sch[out], fused)
+        acc_y, acc_x = sch[acc].op.axis
+        ko, ki = sch[acc].split(sch[acc].op.reduce_axis[0], factor=4)
+        sch[acc].reorder(ko, acc_y, ki, acc_x)
+        sch[acc].unroll(ki)
+        sch[acc].vectorize(acc_x)
+
+    _topi.utils.traverse_inline(sch, out.op, _callback)
+    return sch
+
+
+@generic_func
+def dense_strategy(attrs, inputs, out_type, target):
+    return strategy.dense_strategy(attrs, inputs, out_type, target)
+
+
+@dense_strategy.register("cpu")
+def dense_strategy_cpu(attrs, inputs, out_type, target):
+    if inputs[0].dtype != "bfloat16":
+        return strategy.dense_strategy(attrs, inputs, out_type, target)
+    strat = _op.OpStrategy()
+    strat.add_implementation(
+        lambda attrs, inputs, out_type: [
+            compute_matmul_bf16(inputs[0], inputs[1], transpose_b=True)
+        ],
+        lambda attrs, outs, target: schedule_matmul_bf16_cpu(outs),
+        name="dense_bf16.raf",
+    )
+    return strat
+
+
+_reg.register_strategy("raf.op.tvm.dense", dense_strategy)
 
 
 def compute_matmul_general(attr, inputs, output_type, transpose_a=False, transpose_b=False):
@@ -27,6 +96,8 @@ def compute_matmul_general(attr, inputs, output_type, transpose_a=False, transpo
     else:
         raise ValueError("Invalid input")
     assert len(data.shape) == 2 and len(weight.shape) == 2, "only support 2-dim dense"
+    if data.dtype == "bfloat16":
+        return [compute_matmul_bf16(data, weight, transpose_a, transpose_b)]
     return [_topi.matmul(data, weight, transp_a=transpose_a, transp_b=transpose_b)]
 
 
@@ -50,10 +121,22 @@ def compute_matmul_tt(attr, inputs, output_type):
     return compute_matmul_general(attr, inputs, output_type, transpose_a=True, transpose_b=True)
 
 
-_reg.register_injective_schedule("raf.op.tvm.matmul")
-_reg.register_injective_schedule("raf.op.tvm.matmul_tn")
-_reg.register_injective_schedule("raf.op.tvm.matmul_nt")
-_reg.register_injective_schedule("raf.op.tvm.matmul_tt")
+@generic_func
+def schedule_matmul(attrs, outs, target):
+    return strategy.schedule_injective(attrs, outs, target)
+
+
+@schedule_matmul.register("cpu")
+def schedule_matmul_cpu(attrs, outs, target):
+    if outs[0].dtype == "bfloat16":
+        return schedule_matmul_bf16_cpu(outs)
+    return strategy.schedule_injective(attrs, outs, target)
+
+
+_reg.register_schedule("raf.op.tvm.matmul", schedule_matmul)
+_reg.register_schedule("raf.op.tvm.matmul_tn", schedule_matmul)
+_reg.register_schedule("raf.op.tvm.matmul_nt", schedule_matmul)
+_reg.register_schedule("raf.op.tvm.matmul_tt", schedule_matmul)
 
 
 def compute_batch_matmul_general(attr, inputs, output_type, transpose_a=False, transpose_b=False):
@@ -97,6 +180,36 @@ _reg.register_injective_schedule("raf.op.tvm.batch_matmul_tt")
 _reg.register_strategy("raf.op.tvm.batch_matmul_nt", strategy.batch_matmul_strategy)
 
 
+@register_compute("raf.op.tvm.quantized_matmul")
+@register_compute("raf.op.tvm.quantized_batch_matmul")
+def compute_quantized_gemm(attr, inputs, output_type):
+    """Multiply int8 tensors and accumulate the products in int32. The batch dimension of
+    3-D inputs is broadcast if either of them is 1.
+    """
+    data, weight = inputs
+    transpose_a, transpose_b = attr.transpose_a, attr.transpose_b
+    batched = len(data.shape) == 3
+    red = data.shape[-2] if transpose_a else data.shape[-1]
+    k = _tvm.te.reduce_axis((0, red), name="k")
+
+    def _index(tensor, batch, row, col):
+        if not batched:
+            return tensor[row, col]
+        return tensor[0 if int(tensor.shape[0]) == 1 else batch, row, col]
+
+    def _fcompute(*indices):
+        batch, i, j = indices if batched else (None,) + tuple(indices)
+        lhs = _index(data, batch, k, i) if transpose_a else _index(data, batch, i, k)
+        rhs = _index(weight, batch, j, k) if transpose_b else _index(weight, batch, k, j)
+        return _tvm.te.sum(lhs.astype("int32") * rhs.astype("int32"), axis=k)
+
+    return [_tvm.te.compute(output_type.shape, _fcompute, name="quantized_gemm")]
+
+
+_reg.register_injective_schedule("raf.op.tvm.quantized_matmul")
+_reg.register_injective_schedule("raf.op.tvm.quantized_batch_matmul")
+
+
 @register_compute("raf.op.tvm.softmax", level=15)
 def compute_softmax(attr, inputs, output_type):
     return [_topi.nn.softmax(inputs[0])]
@@ -688,6 +801,23 @@ _reg.register_schedule("raf.op.tvm.layer_norm_train_dx", schedule_generic)
 
 _reg.register_strategy("raf.op.tvm.conv2d", strategy.conv2d_strategy)
 
+
+@register_compute("raf.op.tvm.quantized_conv2d")
+def compute_quantized_conv2d(attr, inputs, output_type):
+    data, kernel = inputs
+    assert attr.data_layout == "NCHW" and attr.kernel_layout == "OIHW", "only support NCHW"
+    strides, padding, dilation = attr.strides, attr.padding, attr.dilation
+    if attr.groups == 1:
+        out = _topi.nn.conv2d_nchw(data, kernel, strides, padding, dilation, attr.out_dtype)
+    else:
+        out = _topi.nn.group_conv2d_nchw(
+            data, kernel, strides, padding, dilation, attr.groups, attr.out_dtype
+        )
+    return [out]
+
+
+_reg.register_injective_schedule("raf.op.tvm.quantized_conv2d")
+
 _reg.register_strategy("raf.op.tvm.conv2d_transpose", strategy.conv2d_transpose_strategy)
 
 
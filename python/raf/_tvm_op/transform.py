@@ -3,10 +3,14 @@
 
 # pylint: disable=missing-function-docstring, undefined-loop-variable, unused-argument, invalid-name
 """Compute definition and schedules for data transform operators"""
+from functools import reduce
+import operator
+
 import numpy as np
 
 from raf._tvm_op.nn import schedule_generic
 from .._lib import register_compute
+from .._lib import generic_func
 from .._lib import strategy
 from .._lib import tvm as _tvm  # pylint: disable=unused-import
 from .._lib import _reg
@@ -134,8 +138,6 @@ _reg.register_injective_schedule("raf.op.tvm.concatenate")
 _reg.register_injective_schedule("raf.op.tvm.reverse")
 _reg.register_injective_schedule("raf.op.tvm.stack")
 _reg.register_injective_schedule("raf.op.tvm.squeeze")
-_reg.register_injective_schedule("raf.op.tvm.cast")
-_reg.register_injective_schedule("raf.op.tvm.cast_like")
 _reg.register_injective_schedule("raf.op.tvm.reshape")
 _reg.register_broadcast_schedule("raf.op.tvm.broadcast_to")
 _reg.register_broadcast_schedule("raf.op.tvm.broadcast_to_like")
@@ -151,6 +153,33 @@ _reg.register_injective_schedule("raf.op.tvm.strided_set")
 _reg.register_reduce_schedule("raf.op.tvm.collapse_sum_like")
 
 
+@generic_func
+def schedule_cast(attrs, outs, target):
+    return strategy.schedule_injective(attrs, outs, target)
+
+
+@schedule_cast.register("cpu")
+def schedule_cast_cpu(attrs, outs, target):
+    """TVM lowers casts between float32 and bfloat16 to integer bit operations (round to nearest
+    even), so we vectorize them by 16 lanes to convert one 512-bit float32 vector at a time.
+    """
+    out = outs[0]
+    dtypes = [out.dtype] + [inp.dtype for inp in out.op.input_tensors]
+    if "bfloat16" not in dtypes or not out.shape:
+        return strategy.schedule_injective(attrs, outs, target)
+    sch = _tvm.te.create_schedule([x.op for x in outs])
+    _tvm.te.schedule.AutoInlineInjective(sch)
+    fused = sch[out].fuse(*sch[out].op.axis)
+    outer, inner = sch[out].split(fused, factor=16)
+    sch[out].parallel(outer)
+    sch[out].vectorize(inner)
+    return sch
+
+
+_reg.register_schedule("raf.op.tvm.cast", schedule_cast)
+_reg.register_schedule("raf.op.tvm.cast_like", schedule_cast)
+
+
 @register_compute("raf.op.tvm.take_dx")
 def take_dx_compute(attrs, inputs, output_type):
     x, dy, indices = inputs
@@ -448,3 +477,117 @@ def group_cast_compute(attrs, inputs, output_type):
 
 
 _reg.register_injective_schedule("raf.op.tvm.group_cast")
+
+
+@register_compute("raf.op.tvm.quantize_blockwise")
+def quantize_blockwise_compute(attrs, inputs, output_type):
+    x = inputs[0]
+    n_blocks, block_size = [int(dim) for dim in output_type.fields[0].shape]
+    size = reduce(operator.mul, [int(dim) for dim in x.shape], 1)
+    flat = _topi.reshape(x, (size,))
+
+    def fblock(b, i):
+        idx = b * block_size + i
+        return _tvm.tir.if_then_else(
+            idx < size, flat[idx].astype("float32"), _tvm.tir.const(0, "float32")
+        )
+
+    # Each block is scaled by its absolute max to fit into [-127, 127].
+    blocks = _tvm.te.compute((n_blocks, block_size), fblock)
+    amax = _topi.max(_topi.abs(blocks), axis=1)
+    scale = _tvm.te.compute(
+        (n_blocks,),
+        lambda b: _tvm.tir.if_then_else(amax[b] > 0, amax[b] / 127.0, _tvm.tir.const(1, "float32")),
+    )
+    data = _tvm.te.compute(
+        (n_blocks, block_size),
+        lambda b, i: _tvm.tir.round(blocks[b, i] / scale[b]).astype("int8"),
+    )
+    return [data, scale]
+
+
+_reg.register_schedule("raf.op.tvm.quantize_blockwise", schedule_generic)
+
+
+@register_compute("raf.op.tvm.dequantize_blockwise")
+def dequantize_blockwise_compute(attrs, inputs, output_type):
+    data, scale = inputs
+    block_size = int(data.shape[1])
+    shape = [int(dim) for dim in output_type.shape]
+    size = reduce(operator.mul, shape, 1)
+    flat = _tvm.te.compute(
+        (size,),
+        lambda i: (
+            data[i // block_size, i % block_size].astype("float32") * scale[i // block_size]
+        ).astype(output_type.dtype),
+    )
+    return [_topi.reshape(flat, shape)]
+
+
+_reg.register_injective_schedule("raf.op.tvm.dequantize_blockwise")
+
+
+def _quantize_scale(scale, indices, axis):
+    """Get the scale of the element at the given indices. A scale with a single element is
+    shared by the whole tensor, otherwise it is indexed by the channel along the axis.
+    """
+    if reduce(operator.mul, [int(dim) for dim in scale.shape], 1) == 1:
+        return scale[(0,) * len(scale.shape)]
+    axis = axis + len(indices) if axis < 0 else axis
+    return scale[indices[axis]]
+
+
+def _round_to_int8(x, dtype):
+    """Round to the nearest even integer and saturate to [-127, 127]."""
+    x = _tvm.tir.nearbyint(x)
+    x = _tvm.te.max(_tvm.te.min(x, _tvm.tir.const(127, x.dtype)), _tvm.tir.const(-127, x.dtype))
+    return x.astype(dtype)
+
+
+@register_compute("raf.op.tvm.quantize")
+def quantize_compute(attrs, inputs, output_type):
+    x, scale = inputs
+    axis = int(attrs.axis)
+    return [
+        _tvm.te.compute(
+            x.shape,
+            lambda *i: _round_to_int8(
+                x[i].astype("float32") / _quantize_scale(scale, i, axis), output_type.dtype
+            ),
+        )
+    ]
+
+
+_reg.register_injective_schedule("raf.op.tvm.quantize")
+
+
+@register_compute("raf.op.tvm.dequantize")
+def dequantize_compute(attrs, inputs, output_type):
+    x, scale = inputs
+    axis = int(attrs.axis)
+    return [
+        _tvm.te.compute(
+            x.shape,
+            lambda *i: (x[i].astype("float32") * _quantize_scale(scale, i, axis)).astype(
+                output_type.dtype
+            ),
+        )
+    ]
+
+
+_reg.register_injective_schedule("raf.op.tvm.dequantize")
+
+
+@register_compute("raf.op.tvm.requantize")
+def requantize_compute(attrs, inputs, output_type):
+    x, in_scale, out_scale = inputs
+    axis = int(attrs.axis)
+
+    def _fcompute(*i):
+        multiplier = _quantize_scale(in_scale, i, axis) / _quantize_scale(out_scale, i, axis)
+        return _round_to_int8(x[i].astype("float32") * multiplier, output_type.dtype)
+
+    return [_tvm.te.compute(x.shape, _fcompute)]
+
+
+_reg.register_injective_schedule("raf.op.tvm.requantize")
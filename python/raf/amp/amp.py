@@ -4,11 +4,11 @@
 """Functions for enabling AMP (automatic mixed precision)."""
 # pylint: disable=protected-access
 from raf._ffi.pass_ import AutoCast, InferType
-from raf._lib import relay
+from raf._lib import relay, PassContext
 from raf.frontend.model import FrameworkModel
 
 
-def autocast(model, args=None):
+def autocast(model, args=None, amp_dtype=None):
     """Convert a model running in single precison to half precision.
 
     Parameters
@@ -18,10 +18,26 @@ def autocast(model, args=None):
 
     args: Optional[List[raf.ndarray]]
         The input data of the model.
+
+    amp_dtype: Optional[str]
+        The AMP dtype, which could be float16 or bfloat16. If not specified, use "raf.amp.dtype"
+        in the current pass context, which is float16 by default.
     """
     args = args if args is not None else []
     mod = model._internal(*args).mod
-    mod = AutoCast()(mod)
+    if amp_dtype is None:
+        mod = AutoCast()(mod)
+    else:
+        curr = PassContext.current()
+        config = dict(curr.config)
+        config["raf.amp.dtype"] = amp_dtype
+        with PassContext(
+            opt_level=curr.opt_level,
+            required_pass=curr.required_pass,
+            disabled_pass=curr.disabled_pass,
+            config=config,
+        ):
+            mod = AutoCast()(mod)
     mod = InferType()(mod)
     return FrameworkModel(mod, mod, model.state(), dict())
 
@@ -19,6 +19,12 @@ github.com/tensorflow/tensorflow/blob/v2.5.0/tensorflow/core/grappler/optimizers
 Note that since the infer list is the majority, we make it as the default behavior
 and do not need to specify them here.
 
+Since bfloat16 has the same exponent range as float32, it does not suffer from the overflow
+issues of float16, so some ops that are never casted with float16 are casted with bfloat16.
+On the other hand, bfloat16 is mainly used on CPU, where the ops that do not have a
+bfloat16 kernel accumulating in float32 (e.g., conv2d) remain in float32.
+Use `amp_dtype_cast` to register a rule that depends on the AMP dtype.
+
 TODO(@comaniac): We need to consider the accumulation dtype, which may be different to the output
 dtype. However, we need to make sure the ops will use the desired dtype for accumulation in advance.
 """
@@ -101,13 +107,32 @@ def generic_cast(cast_to_amp, castable_arg_num_or_list):
     return _gen
 
 
+def amp_dtype_cast(fp16_cast_rule, bf16_cast_rule):
+    """Use different cast rules for float16 and bfloat16.
+
+    Parameters
+    ----------
+    fp16_cast_rule : Callable[[List[Expr], Type, str], List[Type]]
+        The cast rule function when the AMP dtype is float16.
+
+    bf16_cast_rule : Callable[[List[Expr], Type, str], List[Type]]
+        The cast rule function when the AMP dtype is bfloat16.
+
+    Returns
+    -------
+    gen: Callable[[List[Expr], Type, str], List[Type]]
+        The cast rule function.
+    """
+
+    def _gen(args, ret_type, amp_dtype):
+        if amp_dtype == "bfloat16":
+            return bf16_cast_rule(args, ret_type, amp_dtype)
+        return fp16_cast_rule(args, ret_type, amp_dtype)
+
+    return _gen
+
+
 # Always cast.
-register_op_cast_rule("raf.op.conv2d", generic_cast(True, 2))
-register_op_cast_rule("raf.op.conv2d_dx", generic_cast(True, 3))
-register_op_cast_rule("raf.op.conv2d_dw", generic_cast(True, 3))
-register_op_cast_rule("raf.op.conv2d_transpose", generic_cast(True, 2))
-register_op_cast_rule("raf.op.conv2d_transpose_dx", generic_cast(True, 3))
-register_op_cast_rule("raf.op.conv2d_transpose_dw", generic_cast(True, 3))
 register_op_cast_rule("raf.op.matmul", generic_cast(True, 2))
 register_op_cast_rule("raf.op.dense", generic_cast(True, 2))
 register_op_cast_rule("raf.op.matmul_nt", generic_cast(True, 2))
@@ -118,10 +143,23 @@ register_op_cast_rule("raf.op.batch_matmul_nt", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_tn", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_tt", generic_cast(True, 2))
 
+# Always cast with float16. Unlike matmul and dense, conv2d does not accumulate bfloat16 inputs
+# in float32, so it remains in float32 with bfloat16.
+for fp16_only_op, castable_arg_num in [
+    ("raf.op.conv2d", 2),
+    ("raf.op.conv2d_dx", 3),
+    ("raf.op.conv2d_dw", 3),
+    ("raf.op.conv2d_transpose", 2),
+    ("raf.op.conv2d_transpose_dx", 3),
+    ("raf.op.conv2d_transpose_dw", 3),
+]:
+    register_op_cast_rule(
+        fp16_only_op,
+        amp_dtype_cast(generic_cast(True, castable_arg_num), generic_cast(False, castable_arg_num)),
+    )
+
 # Never cast.
 register_op_cast_rule("raf.op.arange", generic_cast(False, 3))
-register_op_cast_rule("raf.op.exp", generic_cast(False, 1))
-register_op_cast_rule("raf.op.power", generic_cast(False, 1))
 register_op_cast_rule("raf.op.softmax", generic_cast(False, 1))
 register_op_cast_rule("raf.op.softmax_dx", generic_cast(False, 2))
 register_op_cast_rule("raf.op.lans", generic_cast(False, 2))
@@ -146,13 +184,6 @@ register_op_cast_rule("raf.op.cross_entropy_dtrue", generic_cast(False, 2))
 register_op_cast_rule("raf.op.take_dx", generic_cast(3, False))
 register_op_cast_rule("raf.op.embedding_dx", generic_cast(2, False))
 
-# FIXME: These ops should support float16, but the current TVM code results in
-# either runtime error or mismatch outputs.
-register_op_cast_rule("raf.op.atan", generic_cast(False, 1))
-register_op_cast_rule("raf.op.tanh", generic_cast(False, 1))
-register_op_cast_rule("raf.op.tanh_dx", generic_cast(False, 3))
-register_op_cast_rule("raf.op.rsqrt", generic_cast(False, 1))
-
 # These ops needs to accumulate the result in float32, so we never cast them,
 # and expect they will be fused with the cast ops.
 register_op_cast_rule("raf.op.multiply", generic_cast(False, 2))
@@ -326,6 +357,19 @@ register_op_cast_rule("raf.op.shape_as_tensor", infer_cast(1))
 register_op_cast_rule("raf.op.embedding", infer_cast(2))
 register_op_cast_rule("raf.op.take", infer_cast(2))
 
+# These ops easily overflow with float16 so we never cast them, but bfloat16 has the same
+# exponent range as float32, so they follow the input dtype with bfloat16.
+register_op_cast_rule("raf.op.exp", amp_dtype_cast(generic_cast(False, 1), infer_cast(1)))
+register_op_cast_rule("raf.op.power", amp_dtype_cast(generic_cast(False, 1), infer_cast(2)))
+
+# FIXME: These ops should support float16, but the current TVM code results in
+# either runtime error or mismatch outputs. TVM computes bfloat16 element-wise ops
+# in float32, so they do not have this issue.
+register_op_cast_rule("raf.op.atan", amp_dtype_cast(generic_cast(False, 1), infer_cast(1)))
+register_op_cast_rule("raf.op.tanh", amp_dtype_cast(generic_cast(False, 1), infer_cast(1)))
+register_op_cast_rule("raf.op.tanh_dx", amp_dtype_cast(generic_cast(False, 3), infer_cast(3)))
+register_op_cast_rule("raf.op.rsqrt", amp_dtype_cast(generic_cast(False, 1), infer_cast(1)))
+
 # Special cases.
 
 
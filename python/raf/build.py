@@ -68,11 +68,13 @@ def build_with(backend):  # pylint: disable=too-many-return-statements
     -------
     Whether the backend is built with RAF.
     """
-    assert backend in ["tvm", "cuda", "cudnn", "cutlass", "cublas", "nccl"], (
+    assert backend in ["tvm", "cpu", "cuda", "cudnn", "cutlass", "cublas", "nccl"], (
         "Invalid backend: %s" % backend
     )
     if backend == "tvm":
         return True  # it seems like that we always build with TVM
+    if backend == "cpu":
+        return True
     if backend == "cuda":
         return with_cuda() is not None
     if backend == "cublas":
@@ -11,7 +11,7 @@ from .._core.ir_ext import ExtendedVar
 from ..model.trace import _get_func_inputs
 from ..model import Model, trace
 from .._ffi.pass_ import AutoDiff, InlineBackward, Substitute, InferType, FoldConstant
-from .._ffi.pass_ import DeadCodeElimination, AutoDataParallel
+from .._ffi.pass_ import DeadCodeElimination, AutoDataParallel, CompressActivation
 from .._ffi.binding import BindSymbol
 from .._lib import tvm
 
@@ -79,7 +79,9 @@ def with_autodiff(model):
             if dist.get_config().enable_data_parallel:
                 # TODO: Refactor AutoDataParallel to let it work on the IR after InlineBackward.
                 passes += [AutoDataParallel()]
-            passes += [InferType(), FoldConstant(), DeadCodeElimination(), InlineBackward()]
+            # Activation compression is enabled by the "raf.compress_activation.dtype" config.
+            passes += [InferType(), FoldConstant(), DeadCodeElimination(), CompressActivation()]
+            passes += [InlineBackward()]
             seq = RAFSequential(passes, name="with_autodiff")
             mod = seq(mod)
             inputs = _get_func_inputs(record, args, kwargs)
@@ -0,0 +1,130 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Post-training int8 quantization for CPU inference."""
+# pylint: disable=protected-access
+import numpy as np
+
+from raf._core.executor import VMExecutor
+from raf._core.module import IRModule
+from raf._ffi.pass_ import CollectQuantizeRanges, Quantize, Substitute
+from raf._lib import relay, PassContext
+from raf.frontend.model import FrameworkModel
+from raf.ir.constant import const
+
+
+def _as_args(batch):
+    return list(batch) if isinstance(batch, (list, tuple)) else [batch]
+
+
+def _freeze_params(model, args):
+    """Trace the model in inference mode and bind its parameters as constants, so that the
+    weights can be quantized at compile time. The main function of the returned module only
+    takes the inputs of the model. The mode of the model is restored afterwards.
+    """
+    is_train = model._BaseModel__is_train
+    model.infer_mode()
+    try:
+        record = model._internal(*args)
+    finally:
+        if is_train:
+            model.train_mode()
+    func = record.mod["main"]
+    vmap = {}
+    inputs = []
+    for param in func.params:
+        if param.name_hint in record.named_params:
+            vmap[param] = const(record.named_params[param.name_hint])
+        else:
+            inputs.append(param)
+    return IRModule.from_expr(relay.Function(inputs, Substitute(func.body, vmap)))
+
+
+def _calibrate(mod, batches, device, method):
+    if method not in ("max", "avg"):
+        raise ValueError("Unsupported calibration method %s. Candidates are max and avg" % method)
+    mod = CollectQuantizeRanges()(mod)
+    executor = VMExecutor(mod, device).make_executor()
+    batch_ranges = []
+    for args in batches:
+        out = executor(*args)
+        batch_ranges.append([float(rng.numpy()) for rng in out[1]])
+    batch_ranges = np.array(batch_ranges, dtype="float32").reshape(len(batches), -1)
+    ranges = batch_ranges.max(axis=0) if method == "max" else batch_ranges.mean(axis=0)
+    return [float(rng) for rng in ranges]
+
+
+def calibrate(model, dataset, device="cpu", method="max"):
+    """Calibrate the ranges of the activations fed to matmul, dense, batch_matmul and conv2d.
+
+    Parameters
+    ----------
+    model : raf.model.BaseModel
+        The model running in single precision.
+
+    dataset : Iterable[Union[raf.ndarray, Tuple[raf.ndarray]]]
+        The calibration batches, each of which is the inputs of the model.
+
+    device : str
+        The device to run the calibration on.
+
+    method : str
+        How the ranges of the batches are combined, which could be "max" for the maximum of the
+        absolute maximums of the batches, or "avg" for their average, which is less sensitive to
+        outliers.
+
+    Returns
+    -------
+    ranges : List[float]
+        The range of each activation, in the order expected by raf._ffi.pass_.Quantize.
+    """
+    batches = [_as_args(batch) for batch in dataset]
+    if not batches:
+        raise ValueError("The calibration dataset is empty")
+    return _calibrate(_freeze_params(model, batches[0]), batches, device, method)
+
+
+def quantize(model, dataset, device="cpu", method="max", per_channel=True):
+    """Quantize a model running in single precision to int8 for CPU inference. The weights of
+    matmul, dense, batch_matmul and conv2d are quantized at compile time, and their activations
+    are quantized at runtime with the ranges calibrated on the dataset. The quantized model can be
+    compiled and serialized like any other model.
+
+    Parameters
+    ----------
+    model : raf.model.BaseModel
+        The model running in single precision.
+
+    dataset : Iterable[Union[raf.ndarray, Tuple[raf.ndarray]]]
+        The calibration batches, each of which is the inputs of the model.
+
+    device : str
+        The device to run the calibration on.
+
+    method : str
+        The calibration method, which could be "max" or "avg". See :py:func:`calibrate`.
+
+    per_channel : bool
+        Whether the weights have one scale per output channel instead of one per tensor.
+
+    Returns
+    -------
+    ret : raf.frontend.FrameworkModel
+        The quantized model, which only takes the inputs of the original model.
+    """
+    batches = [_as_args(batch) for batch in dataset]
+    if not batches:
+        raise ValueError("The calibration dataset is empty")
+    mod = _freeze_params(model, batches[0])
+    ranges = _calibrate(mod, batches, device, method)
+    curr = PassContext.current()
+    config = dict(curr.config)
+    config["raf.quantize.per_channel"] = per_channel
+    with PassContext(
+        opt_level=curr.opt_level,
+        required_pass=curr.required_pass,
+        disabled_pass=curr.disabled_pass,
+        config=config,
+    ):
+        qmod = Quantize(ranges)(mod)
+    return FrameworkModel(qmod, qmod, {}, {})
@@ -2,19 +2,31 @@
 # SPDX-License-Identifier: Apache-2.0
 
 """Memory Profiler."""
+import json
 
 from raf._ffi.memory_profiler import EnableMemoryProfiler, DisableMemoryeProfiler
 from raf._ffi.memory_profiler import ResetMemoryProfiler, GetMaxMemoryInfo, GetMemoryTrace
+from raf._ffi.memory_profiler import SetRecordAllocationEvents, GetAllocationReport
+from raf._ffi.memory_profiler import GetAllocationChromeTrace
 
 
-def start():
-    """Enable the profiler in backend to start profiling."""
+def start(record_allocations=False):
+    """Enable the profiler in backend to start profiling.
+
+    Parameters
+    ----------
+    record_allocations: bool
+        Whether to also record every allocation from the memory pools, with its requested and
+        rounded bytes, the VM instruction that allocates it and its lifetime. Default False.
+    """
     EnableMemoryProfiler()
+    SetRecordAllocationEvents(record_allocations)
 
 
 def stop():
     """Disable the profiler in backend to stop profiling."""
     DisableMemoryeProfiler()
+    SetRecordAllocationEvents(False)
 
 
 def reset():
@@ -53,3 +65,37 @@ def get_memory_trace(device):
         The complete trace in a string.
     """
     return GetMemoryTrace(device)
+
+
+def get_allocation_report(device):
+    """Analyze the recorded allocations of a device. See start(record_allocations=True).
+
+    Parameters
+    ----------
+    device: Device
+        The device to analyze.
+
+    Returns
+    -------
+    ret: Dict[str, Any]
+        The analysis, including the peak live bytes ("peak_requested_bytes" and
+        "peak_rounded_bytes"), the allocations alive at the peak ("live_at_peak"), the internal
+        fragmentation due to the rounding of the memory pool ("internal_fragmentation"), and the
+        fragmentation of the memory pool at the peak ("pool_fragmentation"). Empty if nothing is
+        recorded.
+    """
+    report = GetAllocationReport(device)
+    return json.loads(report) if report else {}
+
+
+def dump_allocation_trace(path):
+    """Dump the recorded allocations of all devices to a file in the Chrome trace format, which
+    can be viewed by chrome://tracing or Perfetto.
+
+    Parameters
+    ----------
+    path: str
+        The path of the file.
+    """
+    with open(path, "w") as filep:
+        filep.write(GetAllocationChromeTrace())
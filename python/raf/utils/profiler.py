@@ -4,19 +4,32 @@
 """Runtime profiler"""
 import json
 from raf import build
-from raf._ffi.profiler import EnableProfiler, DisableProfiler
+from raf._ffi.profiler import EnableProfiler, EnableSamplingProfiler, DisableProfiler
 from raf._ffi.profiler import CollectBaseProfile, CollectCudaProfile, GetProfile
 
 
-def start(prof_level=1):
+def start(prof_level=1, sampling_rate=0, buffer_size=65536):
     """Enable the profiler in backend and start to profile the execution from now.
 
     Parameters
     ----------
     prof_level : int
         Specify the profiling level.
+
+    sampling_rate : int
+        If positive, profile in the sampling mode, which records 1 in sampling_rate events of
+        each thread to a fixed-size ring buffer without synchronizing the device, so it barely
+        perturbs the execution. The events only have the host time and no arguments, and are
+        flushed in the background. Default: 0, which profiles every event with device sync.
+
+    buffer_size : int
+        The number of events of the ring buffer of each thread in the sampling mode. The events
+        are dropped when a buffer is full before it is flushed.
     """
-    EnableProfiler(prof_level)
+    if sampling_rate > 0:
+        EnableSamplingProfiler(prof_level, sampling_rate, buffer_size)
+    else:
+        EnableProfiler(prof_level)
 
 
 def stop():
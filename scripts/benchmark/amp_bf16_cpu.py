@@ -0,0 +1,73 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Compare the latency and accuracy of float32 and bfloat16 AMP inference on CPU.
+
+The bfloat16 speedup depends on the CPU. Use a target with AVX512-BF16 or AMX
+(e.g., "llvm -mcpu=sapphirerapids") to let LLVM use the native bfloat16 instructions.
+
+Usage:
+    python3 scripts/benchmark/amp_bf16_cpu.py --model mlp --batch-size 64
+    python3 scripts/benchmark/amp_bf16_cpu.py --model resnet --batch-size 8
+"""
+# pylint: disable=protected-access
+import argparse
+
+import numpy as np
+
+import raf
+from raf.testing import mlp, resnet, profile_vm_model, run_vm_model
+
+MLP_CONFIG = (784, 10, 1024, 1024)
+RESNET_BLOCKS = [3, 4, 6, 3]
+
+
+def get_model_n_args(name, batch_size):
+    """Get the model in inference mode and its input."""
+    if name == "mlp":
+        model, _ = mlp.get_model(MLP_CONFIG, train=False)
+        (args, _) = mlp.get_input(MLP_CONFIG, batch_size=batch_size, train=False)
+    elif name == "resnet":
+        model, _ = resnet.get_model(RESNET_BLOCKS, train=False)
+        (args, _) = resnet.get_input(batch_size=batch_size, device="cpu", train=False)
+    else:
+        raise ValueError("Unsupported model: %s" % name)
+    return model, list(args)
+
+
+def benchmark(name, batch_size, warmup, number, repeat):
+    """Run float32 and bfloat16 models, and report the latency and accuracy."""
+    model, args = get_model_n_args(name, batch_size)
+    device = "cpu"
+    with raf.ir.PassContext(config={"raf.amp.out_dtype": "float32"}):
+        amp_model = raf.amp.autocast(model, args, amp_dtype="bfloat16")
+
+    ref = run_vm_model(model, device, args).numpy()
+    out = run_vm_model(amp_model, device, args).numpy()
+    fp32_ms = np.mean(profile_vm_model(model, device, args, 3, False, warmup, number, repeat))
+    bf16_ms = np.mean(profile_vm_model(amp_model, device, args, 3, False, warmup, number, repeat))
+
+    max_abs_err = np.max(np.abs(out - ref))
+    rel_err = np.linalg.norm(out - ref) / max(np.linalg.norm(ref), 1e-12)
+    top1_match = np.mean(np.argmax(out, axis=-1) == np.argmax(ref, axis=-1))
+    print("Model: %s, batch size: %d" % (name, batch_size))
+    print("FP32 (ms): %.3f" % fp32_ms)
+    print("BF16 (ms): %.3f (%.2fx)" % (bf16_ms, fp32_ms / bf16_ms))
+    print("Max abs error: %.4e, relative L2 error: %.4e" % (max_abs_err, rel_err))
+    print("Top-1 agreement with FP32: %.2f%%" % (top1_match * 100))
+
+
+def main():
+    """Entry point."""
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--model", choices=["mlp", "resnet"], default="mlp")
+    parser.add_argument("--batch-size", type=int, default=64)
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--number", type=int, default=10)
+    parser.add_argument("--repeat", type=int, default=3)
+    args = parser.parse_args()
+    benchmark(args.model, args.batch_size, args.warmup, args.number, args.repeat)
+
+
+if __name__ == "__main__":
+    main()
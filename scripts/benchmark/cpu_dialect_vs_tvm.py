@@ -0,0 +1,76 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Compare the latency of the CPU dialect kernels with the TVM generated kernels.
+
+Each op runs alone in the VM with either dialect preferred, and the outputs are checked to match.
+
+Usage:
+    python3 scripts/benchmark/cpu_dialect_vs_tvm.py
+    python3 scripts/benchmark/cpu_dialect_vs_tvm.py --op matmul --number 20
+"""
+# pylint: disable=protected-access
+import argparse
+import time
+
+import raf
+from raf._op.dialect import DialectPreference
+from raf.testing import check, get_vm_executor, randn_torch, run_vm_executor
+
+WORKLOADS = [
+    ("matmul", raf._op.sym.matmul, [[64, 64], [64, 64]]),
+    ("matmul", raf._op.sym.matmul, [[512, 512], [512, 512]]),
+    ("dense", raf._op.sym.dense, [[32, 1024], [4096, 1024]]),
+    ("batch_matmul", raf._op.sym.batch_matmul, [[16, 128, 64], [16, 64, 128]]),
+    ("softmax", raf._op.sym.softmax, [[512, 1024]]),
+    ("layer_norm", raf._op.sym.layer_norm, [[512, 1024]]),
+    ("gelu", raf._op.sym.gelu, [[512, 4096]]),
+]
+
+
+def benchmark(name, op, shapes, warmup, number):
+    """Run an op with the TVM and the CPU dialect, and report the latency of each."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, *args):
+            return op(*args)
+
+    model = TestModel()
+    args = [randn_torch(shape)[0] for shape in shapes]
+    record = model._internal(*args)
+    results, latency = {}, {}
+    for dialect in ["tvm", "cpu"]:
+        with DialectPreference([dialect]):
+            executor = get_vm_executor(record.mod, "cpu")
+            for _ in range(warmup):
+                results[dialect] = run_vm_executor(executor, record, args, "cpu")
+            start = time.time()
+            for _ in range(number):
+                run_vm_executor(executor, record, args, "cpu")
+            latency[dialect] = (time.time() - start) / number * 1000
+    check(results["cpu"], results["tvm"], rtol=1e-4, atol=1e-4)
+    print(
+        "%s %s: tvm %.3f ms, cpu %.3f ms, speedup %.2fx"
+        % (name, shapes, latency["tvm"], latency["cpu"], latency["tvm"] / latency["cpu"])
+    )
+
+
+def main():
+    """Entry point."""
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--op", choices=sorted({w[0] for w in WORKLOADS}), default=None)
+    parser.add_argument("--warmup", type=int, default=2)
+    parser.add_argument("--number", type=int, default=10)
+    args = parser.parse_args()
+    print("ISA: %s" % raf._ffi.backend.cpu.GetISA())
+    for name, op, shapes in WORKLOADS:
+        if args.op is None or args.op == name:
+            benchmark(name, op, shapes, max(args.warmup, 1), args.number)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,68 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Compare the time to load a VM executable by copying its bytes and by mapping its file.
+
+Usage:
+    python3 scripts/benchmark/load_exec_file.py
+    python3 scripts/benchmark/load_exec_file.py --size 4096 --number 20
+"""
+# pylint: disable=protected-access
+import argparse
+import time
+
+import numpy as np
+import tvm
+from tvm import relay
+
+import raf
+from raf._core.executor import VMExecutor
+from raf._core.vm import Executable
+
+
+def save_exec(size, tmp):
+    """Build an executable with two square constants, and save it to the temporary directory."""
+    shape = (size, size)
+    x = raf.ir.var("x", shape=shape)
+    y = raf.ir.op.add(x, raf.ir.const(np.random.randn(*shape).astype("float32")))
+    y = raf.ir.op.add(y, raf.ir.const(np.random.randn(*shape).astype("float32")))
+    mod = raf.ir.IRModule()
+    mod["main"] = relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    code, lib = VMExecutor(mod, "cpu").executable.save()
+    lib_path = tmp.relpath("lib.so")
+    lib.export_library(lib_path)
+    code_path = tmp.relpath("code.ro")
+    with open(code_path, "wb") as fo:
+        fo.write(code)
+    return code_path, tvm.runtime.load_module(lib_path), len(code)
+
+
+def measure(load, number):
+    """Return the mean latency of a load in milliseconds."""
+    start = time.time()
+    for _ in range(number):
+        load()
+    return (time.time() - start) / number * 1e3
+
+
+def main():
+    """Entry point."""
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--size", type=int, default=1024)
+    parser.add_argument("--number", type=int, default=10)
+    args = parser.parse_args()
+    tmp = tvm.contrib.utils.tempdir()
+    code_path, lib, nbytes = save_exec(args.size, tmp)
+
+    def load_copy():
+        with open(code_path, "rb") as fi:
+            Executable.load_exec(bytearray(fi.read()), lib)
+
+    copy_ms = measure(load_copy, args.number)
+    mmap_ms = measure(lambda: Executable.load_exec_file(code_path, lib), args.number)
+    print("Load %d bytes: %.3f ms with copy, %.3f ms with mmap" % (nbytes, copy_ms, mmap_ms))
+
+
+if __name__ == "__main__":
+    main()
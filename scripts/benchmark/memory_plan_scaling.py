@@ -0,0 +1,72 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Measure how the time of MemoryPlan grows with the depth of a model whose layer outputs all stay
+live until the end.
+
+The live-in set of a line grows with the depth, so the planning time should grow linearly with
+the number of layers. Copying the live-in set of each line would make it grow quadratically.
+
+Usage:
+    python3 scripts/benchmark/memory_plan_scaling.py
+    python3 scripts/benchmark/memory_plan_scaling.py --num-layers 64 512 2048 --repeat 5
+"""
+# pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+import argparse
+import time
+
+import raf
+from raf._ffi.pass_ import InferType, ManifestAlloc, MemoryPlan
+from raf.testing import randn
+
+
+class LiveOutputs(raf.Model):
+    """A chain of matmul and relu, whose layer outputs are all concatenated at the end."""
+
+    def build(self, num_layers):
+        self.num_layers = num_layers
+
+    @raf.model.trace
+    def forward(self, x, w):
+        outs = []
+        for _ in range(self.num_layers):
+            x = raf.relu(raf.matmul(x, w))
+            outs.append(x)
+        return raf.concatenate(outs)
+
+
+def measure(num_layers, repeat):
+    """Return the best time of MemoryPlan in milliseconds."""
+    model = LiveOutputs(num_layers)
+    model.infer_mode()
+    m_x, _ = randn((8, 32))
+    m_w, _ = randn((32, 32))
+    mod = InferType()(model._internal(m_x, m_w).mod)
+    mod = InferType()(ManifestAlloc()(mod))
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.time()
+        MemoryPlan()(mod)
+        best = min(best, time.time() - start)
+    return best * 1e3
+
+
+def main():
+    """Entry point."""
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--num-layers", type=int, nargs="+", default=[64, 512])
+    parser.add_argument("--repeat", type=int, default=3)
+    args = parser.parse_args()
+    base = None
+    for num_layers in args.num_layers:
+        latency = measure(num_layers, args.repeat)
+        if base is None:
+            base = (num_layers, latency)
+        print(
+            "%d layers: %.1f ms, %.1fx the time of %d layers"
+            % (num_layers, latency, latency / base[1], base[0])
+        )
+
+
+if __name__ == "__main__":
+    main()
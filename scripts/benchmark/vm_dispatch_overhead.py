@@ -0,0 +1,72 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Compare the VM dispatch overhead per InvokeJit with and without the inline OpEnv cache.
+
+The VM runs in dryrun mode, which skips the op execution, so the latency of a run is the dispatch
+overhead of its instructions.
+
+Usage:
+    python3 scripts/benchmark/vm_dispatch_overhead.py
+    python3 scripts/benchmark/vm_dispatch_overhead.py --num-layers 16 64 256 --number 200
+"""
+# pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+import argparse
+
+import raf
+from raf._core.executor import VMExecutor
+from raf.testing import randn
+
+
+class ReluChain(raf.Model):
+    """A chain of relu, which is dispatched as one InvokeJit per layer without fusion."""
+
+    def build(self, num_layers):
+        self.num_layers = num_layers
+
+    @raf.model.trace
+    def forward(self, x):
+        for _ in range(self.num_layers):
+            x = raf.relu(x)
+        return x
+
+
+def measure(num_layers, warmup, number, repeat):
+    """Return the number of InvokeJit instructions, and the overhead per InvokeJit in
+    microseconds with and without the inline cache."""
+    model = ReluChain(num_layers)
+    model.infer_mode()
+    device = "cpu"
+    m_x, _ = randn([1, 4], device=device)
+    mod = model._internal(m_x).mod
+    with raf.ir.PassContext(disabled_pass=["FuseTVM", "FuseDialect"]):
+        executor = VMExecutor(mod, device, dryrun=True)
+    num_instrs = executor.executable.bytecode.count("invoke_jit")
+    overheads = []
+    for enable in [True, False]:
+        executor.vm.enable_inline_cache(enable)
+        latency = executor.vm.profile(m_x, warmup=warmup, number=number, repeat=repeat)
+        overheads.append(min(latency) * 1000 / num_instrs)
+    return num_instrs, overheads[0], overheads[1]
+
+
+def main():
+    """Entry point."""
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--num-layers", type=int, nargs="+", default=[16, 64])
+    parser.add_argument("--warmup", type=int, default=10)
+    parser.add_argument("--number", type=int, default=100)
+    parser.add_argument("--repeat", type=int, default=5)
+    args = parser.parse_args()
+    for num_layers in args.num_layers:
+        num_instrs, cached_us, lookup_us = measure(
+            num_layers, args.warmup, args.number, args.repeat
+        )
+        print(
+            "%d InvokeJit: %.3f us per InvokeJit with the inline cache, %.3f us with LookupOpEnv"
+            % (num_instrs, cached_us, lookup_us)
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -10,6 +10,7 @@ OPS = [
     Op(name="adv_index_dx", schema_name="adv_index_dx"),
     Op(name="atan", schema_name="unary"),
     Op(name="conv2d", schema_name="conv"),
+    Op(name="quantized_conv2d", schema_name="conv"),
     Op(name="conv2d_transpose", schema_name="conv_trans"),
     Op(name="max_pool2d", schema_name="pool"),
     Op(name="avg_pool2d", schema_name="pool"),
@@ -83,6 +84,8 @@ OPS = [
     Op(name="matmul_tn", schema_name="binary"),
     Op(name="matmul_tt", schema_name="binary"),
     Op(name="batch_matmul", schema_name="binary"),
+    Op(name="quantized_matmul", schema_name="quantized_gemm"),
+    Op(name="quantized_batch_matmul", schema_name="quantized_gemm"),
     Op(name="batch_matmul_nt", schema_name="binary"),
     Op(name="batch_matmul_tn", schema_name="binary"),
     Op(name="batch_matmul_tt", schema_name="binary"),
@@ -165,6 +168,11 @@ OPS = [
     Op(name="cast", schema_name="cast"),
     Op(name="cast_like", schema_name="binary_like"),
     Op(name="group_cast", schema_name="group_cast"),
+    Op(name="quantize_blockwise", schema_name="quantize_blockwise"),
+    Op(name="dequantize_blockwise", schema_name="dequantize_blockwise"),
+    Op(name="quantize", schema_name="quantize"),
+    Op(name="dequantize", schema_name="dequantize"),
+    Op(name="requantize", schema_name="requantize"),
     Op(name="gather", schema_name="gather"),
     Op(name="gather_dx", schema_name="gather_dx"),
     Op(name="gather_nd", schema_name="gather_nd"),
@@ -40,6 +40,12 @@ SCHEMAS = {
         ),
         Arg(name="out_layout", cxx_type="std::string", cxx_default='"NCHW"', py_default='"NCHW"'),
     ],
+    "nn.h::quantized_gemm": [
+        Arg(name="x1", cxx_type="value::BaseTensorValue"),
+        Arg(name="x2", cxx_type="value::BaseTensorValue"),
+        Arg(name="transpose_a", cxx_type="bool", cxx_default=False),
+        Arg(name="transpose_b", cxx_type="bool", cxx_default=False),
+    ],
     "nn.h::conv_trans": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="w", cxx_type="value::BaseTensorValue"),
@@ -534,6 +540,35 @@ SCHEMAS = {
         ),
         Arg(name="dtype", cxx_type="std::string"),
     ],
+    "transform.h::quantize_blockwise": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="block_size", cxx_type="int", cxx_default=256),
+    ],
+    "transform.h::dequantize_blockwise": [
+        Arg(name="data", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="shape", cxx_type="std::vector<int64_t>", cxx_normalizer="IntTuple"),
+        Arg(name="dtype", cxx_type="std::string", cxx_default='"float32"'),
+    ],
+    "transform.h::quantize": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="axis", cxx_type="int", cxx_default=-1),
+        Arg(name="dtype", cxx_type="std::string", cxx_default='"int8"'),
+    ],
+    "transform.h::dequantize": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="axis", cxx_type="int", cxx_default=-1),
+        Arg(name="dtype", cxx_type="std::string", cxx_default='"float32"'),
+    ],
+    "transform.h::requantize": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="in_scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="out_scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="axis", cxx_type="int", cxx_default=-1),
+        Arg(name="dtype", cxx_type="std::string", cxx_default='"int8"'),
+    ],
     "transform.h::strided_slice": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="begin", cxx_type="value::Value"),
@@ -867,6 +902,7 @@ SCHEMAS = {
         Arg(name="device_id", cxx_type="int"),
         Arg(name="dtype", cxx_type="std::string", cxx_default='"float32"', py_default='"float32"'),
         Arg(name="alloc_async", cxx_type="bool", cxx_default=True),
+        Arg(name="arena_offset", cxx_type="int64_t", cxx_default=-1),
     ],
     "vm.h::alloc_tensor": [
         Arg(name="storage", cxx_type="value::BaseTensorValue"),
@@ -0,0 +1,160 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/common/sha256.h
+ * \brief A self-contained SHA-256 implementation for content-addressed keys.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace raf {
+namespace common {
+namespace sha256 {
+
+/*! \brief Incremental SHA-256 hasher (FIPS 180-4). */
+class SHA256 {
+ public:
+  SHA256() {
+    state_ = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+              0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  }
+
+  void Update(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    total_bytes_ += size;
+    while (size > 0) {
+      size_t n = std::min(size, sizeof(block_) - block_size_);
+      std::memcpy(block_ + block_size_, bytes, n);
+      block_size_ += n;
+      bytes += n;
+      size -= n;
+      if (block_size_ == sizeof(block_)) {
+        Transform(block_);
+        block_size_ = 0;
+      }
+    }
+  }
+
+  void Update(const std::string& data) {
+    Update(data.data(), data.size());
+  }
+
+  /*! \brief Finish hashing and return the 32-byte digest. */
+  std::array<uint8_t, 32> Finalize() {
+    uint64_t total_bits = total_bytes_ * 8;
+    uint8_t pad = 0x80;
+    Update(&pad, 1);
+    pad = 0;
+    while (block_size_ != 56) {
+      Update(&pad, 1);
+    }
+    uint8_t length[8];
+    for (int i = 0; i < 8; ++i) {
+      length[i] = static_cast<uint8_t>(total_bits >> (56 - 8 * i));
+    }
+    Update(length, 8);
+    std::array<uint8_t, 32> digest;
+    for (int i = 0; i < 8; ++i) {
+      for (int j = 0; j < 4; ++j) {
+        digest[i * 4 + j] = static_cast<uint8_t>(state_[i] >> (24 - 8 * j));
+      }
+    }
+    return digest;
+  }
+
+ private:
+  static inline uint32_t RotR(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+  }
+
+  void Transform(const uint8_t* chunk) {
+    static const uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+        0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+        0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+        0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+        0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+        0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+        0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+        0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+        0xc67178f2};
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = (static_cast<uint32_t>(chunk[i * 4]) << 24) |
+             (static_cast<uint32_t>(chunk[i * 4 + 1]) << 16) |
+             (static_cast<uint32_t>(chunk[i * 4 + 2]) << 8) |
+             static_cast<uint32_t>(chunk[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+      uint32_t s0 = RotR(w[i - 15], 7) ^ RotR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = RotR(w[i - 2], 17) ^ RotR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+    for (int i = 0; i < 64; ++i) {
+      uint32_t s1 = RotR(e, 6) ^ RotR(e, 11) ^ RotR(e, 25);
+      uint32_t ch = (e & f) ^ (~e & g);
+      uint32_t t1 = h + s1 + ch + k[i] + w[i];
+      uint32_t s0 = RotR(a, 2) ^ RotR(a, 13) ^ RotR(a, 22);
+      uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+      uint32_t t2 = s0 + maj;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+    state_[5] += f;
+    state_[6] += g;
+    state_[7] += h;
+  }
+
+  /*! \brief The intermediate hash value. */
+  std::array<uint32_t, 8> state_;
+  /*! \brief The partially filled message block. */
+  uint8_t block_[64];
+  /*! \brief The number of bytes in the partial block. */
+  size_t block_size_ = 0;
+  /*! \brief The total number of bytes hashed. */
+  uint64_t total_bytes_ = 0;
+};
+
+/*! \brief Format a digest as a lowercase hex string. */
+inline std::string ToHex(const std::array<uint8_t, 32>& digest) {
+  static const char* hex = "0123456789abcdef";
+  std::string ret(digest.size() * 2, '0');
+  for (size_t i = 0; i < digest.size(); ++i) {
+    ret[i * 2] = hex[digest[i] >> 4];
+    ret[i * 2 + 1] = hex[digest[i] & 0xf];
+  }
+  return ret;
+}
+
+/*! \brief Return the SHA-256 digest of the data as a lowercase hex string. */
+inline std::string HexDigest(const std::string& data) {
+  SHA256 hasher;
+  hasher.Update(data);
+  return ToHex(hasher.Finalize());
+}
+
+}  // namespace sha256
+}  // namespace common
+}  // namespace raf
@@ -7,7 +7,17 @@
  * \file src/device_api/cpu/cpu.cc
  * \brief CPU device API
  */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_set>
+#include <tvm/runtime/threading_backend.h>
 #include "raf/device_api.h"
 #include "raf/registry.h"
 
@@ -15,6 +25,177 @@ namespace raf {
 namespace device_api {
 namespace cpu {
 
+/*! \brief The number of live CPU streams, whose workers share the cores. */
+std::atomic<int> num_live_streams{0};
+
+/*! \brief The size of the TVM thread pool of the current thread, or 0 if not configured. */
+thread_local int thread_pool_size = 0;
+
+/*!
+ * \brief Resize the TVM thread pool of the current thread. Every thread launching parallel kernels
+ * owns a pool, so the workers of the streams take a fair share of the cores each.
+ */
+void ConfigureThreadPool(int size) {
+  static const auto* fconfig = tvm::runtime::Registry::Get("runtime.config_threadpool");
+  if (fconfig == nullptr) {
+    return;
+  }
+  // The affinity mode 1 is kBig, which the pools use by default.
+  (*fconfig)(1, size);
+  thread_pool_size = size;
+}
+
+/*!
+ * \brief A CPU stream is an ordered queue of host tasks executed by a dedicated worker thread.
+ * Tasks on different streams run concurrently, and tasks on the same stream run in order.
+ */
+class CPUStream {
+ public:
+  CPUStream() : worker_([this]() { Loop(); }) {
+    ++num_live_streams;
+  }
+
+  ~CPUStream() {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      stopping_ = true;
+    }
+    task_cv_.notify_all();
+    worker_.join();
+    --num_live_streams;
+  }
+
+  void Enqueue(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      tasks_.push_back(std::move(task));
+      ++num_enqueued_;
+    }
+    task_cv_.notify_one();
+  }
+
+  /*! \brief Block until all tasks enqueued so far are done, and rethrow the first failure. */
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mu_);
+    uint64_t target = num_enqueued_;
+    done_cv_.wait(lock, [&]() { return num_done_ >= target; });
+    if (!error_.empty()) {
+      std::string error = std::move(error_);
+      error_.clear();
+      lock.unlock();
+      LOG(FATAL) << "A task on the CPU stream failed: " << error;
+    }
+  }
+
+ private:
+  void Loop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        task_cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      int pool_size = std::max(1, tvm::runtime::threading::MaxConcurrency() /
+                                      std::max(1, num_live_streams.load()));
+      if (pool_size != thread_pool_size) {
+        ConfigureThreadPool(pool_size);
+      }
+      std::string error;
+      try {
+        task();
+      } catch (const std::exception& e) {
+        error = e.what();
+      }
+      // Release what the task holds before it is done, so that Wait also covers the release.
+      task = nullptr;
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (error_.empty()) {
+          error_ = std::move(error);
+        }
+        ++num_done_;
+      }
+      done_cv_.notify_all();
+    }
+  }
+
+  /*! \brief Protects all the fields below. */
+  std::mutex mu_;
+  /*! \brief Notified when a task is enqueued or the stream is stopping. */
+  std::condition_variable task_cv_;
+  /*! \brief Notified when a task is done. */
+  std::condition_variable done_cv_;
+  /*! \brief The pending tasks. */
+  std::deque<std::function<void()>> tasks_;
+  /*! \brief The number of tasks ever enqueued. */
+  uint64_t num_enqueued_{0};
+  /*! \brief The number of tasks done. Tasks are done in the order they are enqueued. */
+  uint64_t num_done_{0};
+  /*! \brief The message of the first failed task that has not been reported by Wait. */
+  std::string error_;
+  /*! \brief Whether the stream is being destroyed. */
+  bool stopping_{false};
+  /*! \brief The worker thread, which is started last so that the fields above are ready. */
+  std::thread worker_;
+};
+
+/*!
+ * \brief A CPU event is a completion fence. Every record bumps its generation, and a waiter only
+ * waits for the generations recorded before it starts waiting, as cudaStreamWaitEvent does.
+ */
+class CPUEvent {
+ public:
+  /*! \brief Start a new generation and return it. */
+  uint64_t Record() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return ++num_recorded_;
+  }
+
+  /*! \brief Mark a generation, and all the earlier ones, as completed. */
+  void Complete(uint64_t generation) {
+    // Notify under the lock, because a waiter may free the event as soon as it wakes up.
+    std::lock_guard<std::mutex> lock(mu_);
+    if (generation > num_completed_) {
+      num_completed_ = generation;
+      time_ = std::chrono::steady_clock::now();
+    }
+    cv_.notify_all();
+  }
+
+  /*! \brief The latest recorded generation, which is 0 if the event has never been recorded. */
+  uint64_t Latest() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return num_recorded_;
+  }
+
+  /*! \brief Block until the given generation is completed. */
+  void Wait(uint64_t generation) {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [&]() { return num_completed_ >= generation; });
+  }
+
+  /*! \brief The time when the latest generation completed. */
+  std::chrono::steady_clock::time_point Time() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return time_;
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  uint64_t num_recorded_{0};
+  uint64_t num_completed_{0};
+  std::chrono::steady_clock::time_point time_;
+};
+
+/*! \brief The current stream of each thread, as set by SetStream. */
+thread_local void* current_stream = nullptr;
+
 class CPUDeviceAPI final : public DeviceAPI {
  public:
   CPUDeviceAPI() = default;
@@ -45,7 +226,8 @@ class CPUDeviceAPI final : public DeviceAPI {
 
   void* AllocMemoryAsync(int64_t nbytes, void* stream,
                          int64_t alignment = kDefaultMemoryAlignment) {
-    throw;
+    // The memory is not touched until the tasks on the stream use it.
+    return AllocMemory(nbytes, alignment);
   }
 
   void FreeMemory(void* ptr) override {
@@ -57,7 +239,11 @@ class CPUDeviceAPI final : public DeviceAPI {
   }
 
   void FreeMemoryAsync(void* ptr, void* stream) {
-    throw;
+    if (stream == nullptr) {
+      FreeMemory(ptr);
+    } else {
+      static_cast<CPUStream*>(stream)->Enqueue([this, ptr]() { FreeMemory(ptr); });
+    }
   }
 
   void CopyDataFromTo(DLTensor* from, DLTensor* to, void* stream) {
@@ -72,51 +258,90 @@ class CPUDeviceAPI final : public DeviceAPI {
   }
 
   void* CreateStream(const Device&) override {
-    throw;
+    auto* stream = new CPUStream();
+    std::lock_guard<std::mutex> lock(streams_mu_);
+    streams_.insert(stream);
+    return stream;
   }
 
   void FreeStream(const Device&, void* stream) override {
-    throw;
+    {
+      std::lock_guard<std::mutex> lock(streams_mu_);
+      streams_.erase(static_cast<CPUStream*>(stream));
+    }
+    // The destructor finishes the pending tasks.
+    delete static_cast<CPUStream*>(stream);
   }
 
   void SetStream(const Device&, void* stream) override {
-    throw;
+    current_stream = stream;
   }
 
   void* GetStream() override {
-    return nullptr;
+    return current_stream;
+  }
+
+  void LaunchOnStream(void* stream, std::function<void()> task) override {
+    if (stream == nullptr) {
+      task();
+    } else {
+      static_cast<CPUStream*>(stream)->Enqueue(std::move(task));
+    }
   }
 
   void* CreateEvent(const Device& dev, uint32_t flags) override {
-    throw;
+    return new CPUEvent();
   }
 
   void FreeEvent(const Device& dev, void* event) {
-    throw;
+    WaitEvent(event);
+    delete static_cast<CPUEvent*>(event);
   }
 
   float EventElapsedTimeInMilliSeconds(void* start_event, void* end_event) override {
-    throw;
+    std::chrono::duration<float, std::milli> elapsed =
+        static_cast<CPUEvent*>(end_event)->Time() - static_cast<CPUEvent*>(start_event)->Time();
+    return elapsed.count();
   }
 
   void EventRecordOnStream(void* event, void* stream) override {
-    throw;
+    auto* cpu_event = static_cast<CPUEvent*>(event);
+    uint64_t generation = cpu_event->Record();
+    if (stream == nullptr) {
+      // Like the legacy default stream of CUDA, an event on the null stream covers the work issued
+      // to all streams, which the stream barrier of the VM relies on.
+      WaitAllStreams();
+      cpu_event->Complete(generation);
+    } else {
+      static_cast<CPUStream*>(stream)->Enqueue(
+          [cpu_event, generation]() { cpu_event->Complete(generation); });
+    }
   }
 
   void StreamWaitEvent(void* stream, void* event) override {
-    throw;
+    auto* cpu_event = static_cast<CPUEvent*>(event);
+    uint64_t generation = cpu_event->Latest();
+    if (stream == nullptr) {
+      cpu_event->Wait(generation);
+    } else {
+      static_cast<CPUStream*>(stream)->Enqueue(
+          [cpu_event, generation]() { cpu_event->Wait(generation); });
+    }
   }
 
   void WaitDevice(const Device&) override {
-    // Do nothing
+    WaitAllStreams();
   }
 
   void WaitStream(void* stream) override {
-    throw;
+    if (stream != nullptr) {
+      static_cast<CPUStream*>(stream)->Wait();
+    }
   }
 
   void WaitEvent(void* event) {
-    throw;
+    auto* cpu_event = static_cast<CPUEvent*>(event);
+    cpu_event->Wait(cpu_event->Latest());
   }
 
   void SetDevice(const int device_id) override {
@@ -126,10 +351,30 @@ class CPUDeviceAPI final : public DeviceAPI {
   static void* make() {
     return new CPUDeviceAPI();
   }
+
+ private:
+  void WaitAllStreams() {
+    // Hold the lock so that no stream is freed while being waited.
+    std::lock_guard<std::mutex> lock(streams_mu_);
+    for (auto* stream : streams_) {
+      stream->Wait();
+    }
+  }
+
+  /*! \brief Protects streams_. */
+  std::mutex streams_mu_;
+  /*! \brief The live streams, which are waited by WaitDevice. */
+  std::unordered_set<CPUStream*> streams_;
 };
 
 RAF_REGISTER_GLOBAL("raf.device_api._make.cpu").set_body_typed(CPUDeviceAPI::make);
 
 }  // namespace cpu
+
+int CPUThreadPoolSize() {
+  return cpu::thread_pool_size > 0 ? cpu::thread_pool_size
+                                   : tvm::runtime::threading::MaxConcurrency();
+}
+
 }  // namespace device_api
 }  // namespace raf
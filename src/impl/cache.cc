@@ -0,0 +1,534 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/cache.cc
+ * \brief The on-disk store of persistent caches.
+ *
+ * A store at <path> has the following layout:
+ *   <path>/v<n>/index       A fixed-size hash table of entries (see IndexHeader and IndexSlot),
+ *                           shared by all processes via mmap and guarded by flock on itself.
+ *   <path>/v<n>/entries/<digest>
+ *                           The directory of an entry, named by the hex SHA-256 digest of the
+ *                           TVM version and the key.
+ *   <path>/tmp/<owner>      The private directory of a store instance, created by mkdtemp(3).
+ *                           It holds the flock'ed file "lock" while the instance is open, and
+ *                           the directories <n> of its in-flight writes and evictions.
+ *
+ * The index and the entries are namespaced by the layout version <n> (see kIndexVersion), so
+ * processes of different versions can share a store without removing the entries of each other.
+ *
+ * An entry is written to a temporary directory and published by rename(2), which is atomic, so
+ * readers never see a partially written entry. The index is only a hint: an entry missing on the
+ * disk is dropped from the index on lookup, and an entry published by a process that crashed
+ * before updating the index is indexed when a store is opened, so it counts toward the capacity.
+ * Temporary directories left by dead processes are removed when a store is opened. An owner
+ * directory is
+ * stale once its lock can be taken, which does not depend on PIDs that may be reused or belong to
+ * another PID namespace sharing the store. To cover the short window between creating an owner
+ * directory and locking it, only the directories older than kStaleTmpDirSeconds are removed.
+ */
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "tvm/runtime/c_runtime_api.h"
+#include "raf/cache.h"
+#include "raf/file.h"
+#include "../common/sha256.h"
+
+namespace raf {
+namespace op {
+
+using common::sha256::SHA256;
+using common::sha256::ToHex;
+
+namespace {
+
+/*! \brief The magic number of the index file. */
+constexpr uint64_t kIndexMagic = 0x5241465043414348;  // "RAFPCACH"
+/*!
+ * \brief The version of the index and the entry layout. Bump it when the layout changes, so that
+ * the store is accessed in a new namespace.
+ */
+constexpr uint32_t kIndexVersion = 1;
+/*! \brief The number of slots in the index. */
+constexpr uint32_t kIndexNumSlots = 16384;
+/*! \brief The maximum number of entries, which keeps the probe sequences short. */
+constexpr int64_t kIndexMaxEntries = kIndexNumSlots / 2;
+/*! \brief The minimum age in seconds of an unlocked temporary directory to be removed. */
+constexpr int64_t kStaleTmpDirSeconds = 600;
+
+struct IndexHeader {
+  /*! \brief The magic number. */
+  uint64_t magic;
+  /*! \brief The index version. */
+  uint32_t version;
+  /*! \brief The number of slots. */
+  uint32_t num_slots;
+  /*! \brief The logical clock, which is increased on each access. */
+  int64_t clock;
+  /*! \brief The total size in bytes of the indexed entries. */
+  int64_t total_bytes;
+  /*! \brief The number of indexed entries. */
+  int64_t num_entries;
+  /*! \brief The number of removed slots, which still continue probe sequences. */
+  int64_t num_tombstones;
+};
+
+enum SlotState : uint32_t {
+  kEmpty = 0,
+  kUsed = 1,
+  kTombstone = 2,
+};
+
+struct IndexSlot {
+  /*! \brief The SHA-256 digest of the entry. */
+  uint8_t digest[32];
+  /*! \brief The size in bytes of the entry. */
+  int64_t nbytes;
+  /*! \brief The logical clock of the last access. */
+  int64_t last_access;
+  /*! \brief The slot state. */
+  uint32_t state;
+  uint32_t reserved;
+};
+
+using Digest = std::array<uint8_t, 32>;
+
+Digest GetDigest(const std::string& key) {
+  SHA256 hasher;
+  hasher.Update("tvm-" TVM_VERSION);
+  hasher.Update("\0", 1);
+  hasher.Update(key);
+  return hasher.Finalize();
+}
+
+/*! \brief Parse the name of an entry directory, i.e., the inverse of ToHex. */
+bool ParseDigest(const std::string& hex, Digest* digest) {
+  if (hex.size() != digest->size() * 2) {
+    return false;
+  }
+  auto parse = [](char c) {
+    if (c >= '0' && c <= '9') {
+      return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+      return c - 'a' + 10;
+    }
+    return -1;
+  };
+  for (size_t i = 0; i < digest->size(); ++i) {
+    int hi = parse(hex[i * 2]);
+    int lo = parse(hex[i * 2 + 1]);
+    if (hi < 0 || lo < 0) {
+      return false;
+    }
+    (*digest)[i] = static_cast<uint8_t>(hi << 4 | lo);
+  }
+  return true;
+}
+
+/*! \brief Apply a function to each child of a directory except "." and "..". */
+template <typename F>
+void ForEachChild(const std::string& dir, F f) {
+  DIR* d = opendir(dir.c_str());
+  if (d == nullptr) {
+    return;
+  }
+  while (struct dirent* child = readdir(d)) {
+    std::string name = child->d_name;
+    if (name != "." && name != "..") {
+      f(name);
+    }
+  }
+  closedir(d);
+}
+
+int64_t GetDirSize(const std::string& dir) {
+  int64_t ret = 0;
+  ForEachChild(dir, [&](const std::string& name) {
+    std::string path = dir + "/" + name;
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0) {
+      ret += S_ISDIR(st.st_mode) ? GetDirSize(path) : st.st_size;
+    }
+  });
+  return ret;
+}
+
+void RemoveDir(const std::string& dir) {
+  ForEachChild(dir, [&](const std::string& name) {
+    std::string path = dir + "/" + name;
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+      RemoveDir(path);
+    } else {
+      unlink(path.c_str());
+    }
+  });
+  rmdir(dir.c_str());
+}
+
+/*! \brief Hold an exclusive flock on a file, which excludes other processes. */
+class FileLock {
+ public:
+  explicit FileLock(int fd) : fd_(fd) {
+    while (flock(fd_, LOCK_EX) != 0) {
+      CHECK_EQ(errno, EINTR) << "Failed to lock the cache index: " << strerror(errno);
+    }
+  }
+  ~FileLock() {
+    flock(fd_, LOCK_UN);
+  }
+
+ private:
+  int fd_;
+};
+
+}  // namespace
+
+class PersistStore::Impl {
+ public:
+  Impl(const std::string& path, int64_t capacity)
+      : path_(path), root_(path + "/v" + std::to_string(kIndexVersion)), capacity_(capacity) {
+    CreateDir(path_);
+    CreateDir(root_);
+    CreateDir(root_ + "/entries");
+    CreateDir(path_ + "/tmp");
+    auto index_path = root_ + "/index";
+    fd_ = open(index_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0664);
+    CHECK_GE(fd_, 0) << "Failed to open " << index_path << ": " << strerror(errno);
+
+    FileLock lock(fd_);
+    size_t nbytes = sizeof(IndexHeader) + sizeof(IndexSlot) * kIndexNumSlots;
+    struct stat st;
+    CHECK_EQ(fstat(fd_, &st), 0) << "Failed to stat " << index_path << ": " << strerror(errno);
+    if (static_cast<size_t>(st.st_size) != nbytes) {
+      // A new or broken index. Extending the file fills it with zeros.
+      CHECK_EQ(ftruncate(fd_, 0), 0) << strerror(errno);
+      CHECK_EQ(ftruncate(fd_, nbytes), 0) << strerror(errno);
+    }
+    void* addr = mmap(nullptr, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    CHECK(addr != MAP_FAILED) << "Failed to mmap " << index_path << ": " << strerror(errno);
+    mapped_nbytes_ = nbytes;
+    header_ = static_cast<IndexHeader*>(addr);
+    slots_ = reinterpret_cast<IndexSlot*>(header_ + 1);
+    if (header_->magic != kIndexMagic || header_->version != kIndexVersion ||
+        header_->num_slots != kIndexNumSlots) {
+      // A new or broken index. The entries on the disk are indexed again below.
+      std::memset(addr, 0, nbytes);
+      header_->magic = kIndexMagic;
+      header_->version = kIndexVersion;
+      header_->num_slots = kIndexNumSlots;
+    }
+    RemoveStaleTmpDirs();
+    CreateOwnerDir();
+    IndexOrphans();
+  }
+
+  ~Impl() {
+    RemoveDir(owner_dir_);
+    close(owner_fd_);
+    munmap(header_, mapped_nbytes_);
+    close(fd_);
+  }
+
+  std::string Lookup(const std::string& key) {
+    auto digest = GetDigest(key);
+    std::lock_guard<std::mutex> guard(mu_);
+    FileLock lock(fd_);
+    IndexSlot* slot = Find(digest);
+    if (slot == nullptr) {
+      return "";
+    }
+    auto dir = GetEntryDir(digest);
+    if (!DirExists(dir)) {
+      // The entry has been removed behind the index.
+      RemoveSlot(slot);
+      return "";
+    }
+    slot->last_access = ++header_->clock;
+    return dir;
+  }
+
+  std::string BeginWrite() {
+    auto dir = GetTmpDir();
+    CreateDir(dir);
+    return dir;
+  }
+
+  int Commit(const std::string& key, const std::string& tmp_dir) {
+    auto digest = GetDigest(key);
+    auto dir = GetEntryDir(digest);
+    int64_t nbytes = GetDirSize(tmp_dir);
+    std::lock_guard<std::mutex> guard(mu_);
+    FileLock lock(fd_);
+    if (rename(tmp_dir.c_str(), dir.c_str()) != 0) {
+      // Another process has published the same entry. Keep the published one.
+      int err = errno;
+      RemoveDir(tmp_dir);
+      if (!DirExists(dir)) {
+        LOG(WARNING) << "Failed to publish cache entry " << dir << ": " << strerror(err);
+        return 0;
+      }
+      nbytes = GetDirSize(dir);
+    }
+    IndexSlot* slot = Find(digest);
+    if (slot != nullptr) {
+      header_->total_bytes -= slot->nbytes;
+    } else {
+      slot = Insert(digest);
+    }
+    slot->nbytes = nbytes;
+    slot->last_access = ++header_->clock;
+    header_->total_bytes += nbytes;
+    return Evict(slot);
+  }
+
+  void Abort(const std::string& tmp_dir) {
+    RemoveDir(tmp_dir);
+  }
+
+ private:
+  std::string GetEntryDir(const Digest& digest) {
+    return root_ + "/entries/" + ToHex(digest);
+  }
+
+  /*!
+   * \brief Index the published entries that are missing in the index, e.g., left by a process
+   * that crashed between publishing an entry and updating the index, and evict entries if the
+   * store is full. They are indexed as the least recently used ones. The caller holds the lock.
+   */
+  void IndexOrphans() {
+    auto entries_dir = root_ + "/entries";
+    ForEachChild(entries_dir, [&](const std::string& name) {
+      Digest digest;
+      auto dir = entries_dir + "/" + name;
+      // Inserting may evict entries while the directory is being listed.
+      if (!ParseDigest(name, &digest) || Find(digest) != nullptr || !DirExists(dir)) {
+        return;
+      }
+      int64_t nbytes = GetDirSize(dir);
+      IndexSlot* slot = Insert(digest);
+      slot->nbytes = nbytes;
+      slot->last_access = 0;
+      header_->total_bytes += nbytes;
+    });
+    Evict(nullptr);
+  }
+
+  /*! \brief Get a new temporary path owned by this store instance. */
+  std::string GetTmpDir() {
+    return owner_dir_ + "/" + std::to_string(tmp_counter_++);
+  }
+
+  /*! \brief Create the owner directory of this store instance and hold its lock. */
+  void CreateOwnerDir() {
+    std::string dir = path_ + "/tmp/XXXXXX";
+    CHECK(mkdtemp(&dir[0]) != nullptr) << "Failed to create a directory in " << path_ << "/tmp: "
+                                       << strerror(errno);
+    owner_dir_ = dir;
+    auto lock_path = owner_dir_ + "/lock";
+    owner_fd_ = open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0664);
+    CHECK_GE(owner_fd_, 0) << "Failed to open " << lock_path << ": " << strerror(errno);
+    CHECK_EQ(flock(owner_fd_, LOCK_EX | LOCK_NB), 0)
+        << "Failed to lock " << lock_path << ": " << strerror(errno);
+  }
+
+  uint32_t GetHomeSlot(const Digest& digest) {
+    uint64_t h;
+    std::memcpy(&h, digest.data(), sizeof(h));
+    return h % kIndexNumSlots;
+  }
+
+  IndexSlot* Find(const Digest& digest) {
+    for (uint32_t i = 0, idx = GetHomeSlot(digest); i < kIndexNumSlots; ++i) {
+      IndexSlot* slot = &slots_[(idx + i) % kIndexNumSlots];
+      if (slot->state == kEmpty) {
+        return nullptr;
+      }
+      if (slot->state == kUsed && std::memcmp(slot->digest, digest.data(), digest.size()) == 0) {
+        return slot;
+      }
+    }
+    return nullptr;
+  }
+
+  IndexSlot* Insert(const Digest& digest) {
+    // Keep at least half of the slots empty, so that probe sequences are short and always end.
+    if (header_->num_entries >= kIndexMaxEntries) {
+      RemoveEntry(FindLRU(nullptr));
+    }
+    if (header_->num_entries + header_->num_tombstones >= kIndexMaxEntries) {
+      Rehash();
+    }
+    for (uint32_t i = 0, idx = GetHomeSlot(digest);; ++i) {
+      IndexSlot* slot = &slots_[(idx + i) % kIndexNumSlots];
+      if (slot->state != kUsed) {
+        if (slot->state == kTombstone) {
+          header_->num_tombstones--;
+        }
+        std::memcpy(slot->digest, digest.data(), digest.size());
+        slot->state = kUsed;
+        slot->nbytes = 0;
+        header_->num_entries++;
+        return slot;
+      }
+    }
+  }
+
+  /*! \brief Re-insert all entries to drop the tombstones. */
+  void Rehash() {
+    std::vector<IndexSlot> used;
+    for (uint32_t i = 0; i < kIndexNumSlots; ++i) {
+      if (slots_[i].state == kUsed) {
+        used.push_back(slots_[i]);
+      }
+    }
+    std::memset(slots_, 0, sizeof(IndexSlot) * kIndexNumSlots);
+    header_->num_tombstones = 0;
+    for (const auto& slot : used) {
+      Digest digest;
+      std::memcpy(digest.data(), slot.digest, digest.size());
+      for (uint32_t i = 0, idx = GetHomeSlot(digest);; ++i) {
+        IndexSlot* dst = &slots_[(idx + i) % kIndexNumSlots];
+        if (dst->state == kEmpty) {
+          *dst = slot;
+          break;
+        }
+      }
+    }
+  }
+
+  IndexSlot* FindLRU(const IndexSlot* keep) {
+    IndexSlot* ret = nullptr;
+    for (uint32_t i = 0; i < kIndexNumSlots; ++i) {
+      IndexSlot* slot = &slots_[i];
+      if (slot->state == kUsed && slot != keep &&
+          (ret == nullptr || slot->last_access < ret->last_access)) {
+        ret = slot;
+      }
+    }
+    return ret;
+  }
+
+  /*! \brief Evict the least recently used entries except the given one to fit the capacity. */
+  int Evict(const IndexSlot* keep) {
+    int num_evicted = 0;
+    while (capacity_ > 0 && header_->total_bytes > capacity_) {
+      IndexSlot* slot = FindLRU(keep);
+      if (slot == nullptr) {
+        break;
+      }
+      RemoveEntry(slot);
+      num_evicted++;
+    }
+    return num_evicted;
+  }
+
+  void RemoveEntry(IndexSlot* slot) {
+    Digest digest;
+    std::memcpy(digest.data(), slot->digest, digest.size());
+    // Move the entry out of the entries directory first, so that it disappears at once.
+    auto tmp_dir = GetTmpDir();
+    if (rename(GetEntryDir(digest).c_str(), tmp_dir.c_str()) == 0) {
+      RemoveDir(tmp_dir);
+    }
+    RemoveSlot(slot);
+  }
+
+  void RemoveSlot(IndexSlot* slot) {
+    header_->total_bytes -= slot->nbytes;
+    header_->num_entries--;
+    header_->num_tombstones++;
+    slot->state = kTombstone;
+  }
+
+  /*!
+   * \brief Remove the temporary directories whose owners no longer exist, i.e., the owner
+   * directories whose lock can be taken and the directories without a lock, e.g., left by a
+   * crash before the lock was created. Recently modified directories are kept.
+   */
+  void RemoveStaleTmpDirs() {
+    auto tmp_root = path_ + "/tmp";
+    time_t now = time(nullptr);
+    ForEachChild(tmp_root, [&](const std::string& name) {
+      auto dir = tmp_root + "/" + name;
+      auto lock_path = dir + "/lock";
+      struct stat st;
+      int fd = open(lock_path.c_str(), O_RDWR | O_CLOEXEC);
+      if (fd < 0) {
+        if (stat(dir.c_str(), &st) == 0 && now - st.st_mtime >= kStaleTmpDirSeconds) {
+          RemoveDir(dir);
+        }
+        return;
+      }
+      if (flock(fd, LOCK_EX | LOCK_NB) == 0 && fstat(fd, &st) == 0 &&
+          now - st.st_mtime >= kStaleTmpDirSeconds) {
+        RemoveDir(dir);
+      }
+      close(fd);
+    });
+  }
+
+  /*! \brief The root directory of the store. */
+  std::string path_;
+  /*! \brief The directory of the index and the entries of kIndexVersion. */
+  std::string root_;
+  /*! \brief The maximum total size in bytes of the entries. 0 means no limit. */
+  int64_t capacity_;
+  /*! \brief The file descriptor of the index file. */
+  int fd_ = -1;
+  /*! \brief The size in bytes of the mapped index file. */
+  size_t mapped_nbytes_ = 0;
+  /*! \brief The mapped index header. */
+  IndexHeader* header_ = nullptr;
+  /*! \brief The mapped index slots. */
+  IndexSlot* slots_ = nullptr;
+  /*! \brief The owner directory of this store instance, which contains its temporary paths. */
+  std::string owner_dir_;
+  /*! \brief The file descriptor of the lock file in the owner directory. */
+  int owner_fd_ = -1;
+  /*! \brief The counter to name temporary directories. */
+  std::atomic<int64_t> tmp_counter_{0};
+  /*! \brief The lock among threads, as flock does not exclude threads sharing a descriptor. */
+  std::mutex mu_;
+};
+
+PersistStore::PersistStore(const std::string& path, int64_t capacity)
+    : impl_(std::make_unique<Impl>(path, capacity)) {
+}
+
+PersistStore::~PersistStore() = default;
+
+std::string PersistStore::Lookup(const std::string& key) {
+  return impl_->Lookup(key);
+}
+
+std::string PersistStore::BeginWrite() {
+  return impl_->BeginWrite();
+}
+
+int PersistStore::Commit(const std::string& key, const std::string& tmp_dir) {
+  return impl_->Commit(key, tmp_dir);
+}
+
+void PersistStore::Abort(const std::string& tmp_dir) {
+  impl_->Abort(tmp_dir);
+}
+
+}  // namespace op
+}  // namespace raf
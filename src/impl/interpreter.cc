@@ -280,13 +280,16 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
                             bool use_upper_bound) {
     const Op& op = Downcast<OpValue>(call->callee)->op;
     std::shared_ptr<Requests> req = op_env->GetRequests();
+    std::vector<std::shared_ptr<Memory>> workspace;
+    std::vector<void*> workspace_data;
     {
       // note: Request workspace, workspace is kind of special memory which will be freed once
       // this op is done.
       WITH_BASE_PROFILER(call->device, op->name, "WorkspaceRequest",
                          {"Count: " + std::to_string(req->workspace.size())}, {
-                           for (int i = 0, n = req->workspace.size(); i < n; ++i) {
-                             RequestWorkspace(req.get(), i);
+                           for (const auto& entry : req->workspace) {
+                             workspace.push_back(Memory::Alloc(entry.device, entry.nbytes));
+                             workspace_data.push_back(workspace.back()->data);
                            }
                          });
 
@@ -311,7 +314,10 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
     }
 
     // note: Execute the Operator.
-    WITH_BASE_PROFILER(call->device, op->name, "CUDA_CALL", {}, { op_env->Execute(call); });
+    {
+      WorkspaceBinding binding(std::move(workspace_data));
+      WITH_BASE_PROFILER(call->device, op->name, "CUDA_CALL", {}, { op_env->Execute(call); });
+    }
 
     {
       // note: Force op to run synchronously.
@@ -319,10 +325,7 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
         req->stream[i].stream->Wait();
       }
       // note: Free the workspace of this op.
-      WITH_BASE_PROFILER(call->device, op->name, "WorkspaceClear", {}, {
-        req->workspace.clear();
-        req->workspace.shrink_to_fit();
-      });
+      WITH_BASE_PROFILER(call->device, op->name, "WorkspaceClear", {}, { workspace.clear(); });
 
       req->stream.clear();
       req->stream.shrink_to_fit();
@@ -373,14 +376,6 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
   void OnDestruct(const op::OpEnv* op_env) override {
   }
 
-  void RequestWorkspace(Requests* req, int index) override {
-    Requests::WorkspaceRequest& entry = req->workspace[index];
-    CHECK(entry.memory == nullptr);
-    std::shared_ptr<Memory> memory = Memory::Alloc(entry.device, entry.nbytes);
-    *entry.dest = memory->data;
-    entry.memory = memory;
-  }
-
   void RequestStream(Requests* req, int index) override {
     Requests::StreamRequest& entry = req->stream[index];
     std::shared_ptr<Stream> stream = Stream::Get(entry.device, entry.tag_idx, entry.stream_idx);
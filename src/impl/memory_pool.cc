@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include "raf/device.h"
 #include "raf/memory_pool.h"
+#include "raf/memory_profiler.h"
 #include "raf/registry.h"
 
 #ifdef RAF_USE_CUDA
@@ -75,6 +76,16 @@ class MemoryPoolManager {
   PerDeviceStore<MemoryPool, false> reg;
 };
 
+/*! \brief Record the allocation if the memory profiler records the allocation events. */
+inline std::shared_ptr<Memory> RecordAlloc(const Device& dev, MemoryPool* pool,
+                                           std::shared_ptr<Memory> mem, int64_t nbytes) {
+  auto* profiler = memory_profiler::MemoryProfiler::Get();
+  if (nbytes > 0 && profiler->IsRecordingEvents()) {
+    return profiler->RecordAlloc(dev, std::move(mem), nbytes, pool->GetAllocBytes(nbytes));
+  }
+  return mem;
+}
+
 int64_t Memory::GetAllocBytes(const Device& dev, int64_t nbytes) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
   return mgr->GetPool(dev, "")->GetAllocBytes(nbytes);
@@ -82,20 +93,27 @@ int64_t Memory::GetAllocBytes(const Device& dev, int64_t nbytes) {
 
 std::shared_ptr<Memory> Memory::Alloc(const Device& dev, int64_t nbytes, int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
-  return mgr->GetPool(dev, "")->Alloc(nbytes, alignment);
+  MemoryPool* pool = mgr->GetPool(dev, "");
+  return RecordAlloc(dev, pool, pool->Alloc(nbytes, alignment), nbytes);
 }
 
 std::shared_ptr<Memory> Memory::AllocAsync(const Device& dev, int64_t nbytes, void* stream,
                                            int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
-  return mgr->GetPool(dev, "")->AllocAsync(nbytes, stream, alignment);
+  MemoryPool* pool = mgr->GetPool(dev, "");
+  return RecordAlloc(dev, pool, pool->AllocAsync(nbytes, stream, alignment), nbytes);
 }
 
 std::vector<std::shared_ptr<Memory> > Memory::AllocBatch(const Device& dev,
                                                          const std::vector<int64_t>& nbytes,
                                                          int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
-  return mgr->GetPool(dev, "")->AllocBatch(nbytes, alignment);
+  MemoryPool* pool = mgr->GetPool(dev, "");
+  auto mems = pool->AllocBatch(nbytes, alignment);
+  for (size_t i = 0; i < mems.size(); ++i) {
+    mems[i] = RecordAlloc(dev, pool, std::move(mems[i]), nbytes[i]);
+  }
+  return mems;
 }
 
 std::pair<float, float> Memory::GetPoolSize(const Device& dev) {
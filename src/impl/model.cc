@@ -7,6 +7,16 @@
  * \file model.cc
  * \brief Helpers for running models.
  */
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "raf/binding.h"
 #include "raf/ir.h"
 #include "raf/value.h"
@@ -14,6 +24,7 @@
 #include "raf/executor.h"
 #include "raf/pass.h"
 #include "raf/dist_config.h"
+#include "raf/cache.h"
 
 namespace raf {
 namespace model {
@@ -30,13 +41,76 @@ using pass::AutoDiff;
 using pass::BindParam;
 using pass::CanonicalizeOps;
 using pass::FoldConstant;
+using raf::op::PackedMetricMap;
+
+/*!
+ * \brief The cache of the optimized modules of RunModel, so that a model called in a loop is only
+ * optimized once. The modules are indexed by the structural hash of the module together with the
+ * types of the arguments, which of them require gradients, and the configs that affect the passes.
+ */
+class OptimizedModuleCache : public raf::op::MetaCacheMetric {
+ public:
+  static OptimizedModuleCache* Get() {
+    static OptimizedModuleCache* inst = new OptimizedModuleCache();
+    return inst;
+  }
+
+  /*!
+   * \brief Get the optimized module from the cache, or optimize the module and cache the result.
+   * \param mod The module to be optimized.
+   * \param key The key of the arguments and the configs.
+   * \param optimize The function to optimize the module.
+   * \return The optimized module.
+   */
+  IRModule GetOrOptimize(const IRModule& mod, const std::string& key,
+                         const std::function<IRModule()>& optimize) {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto it = cache_.find(key);
+      if (it != cache_.end()) {
+        // The key includes the structural hash, so check the structural equality for collisions.
+        for (const auto& entry : it->second) {
+          if (entry.first.same_as(mod) || tvm::StructuralEqual()(entry.first, mod)) {
+            metrics_["CacheHit"]++;
+            return entry.second;
+          }
+        }
+      }
+      metrics_["CacheMiss"]++;
+    }
+    IRModule optimized = optimize();
+    std::lock_guard<std::mutex> lock(mu_);
+    cache_[key].emplace_back(mod, optimized);
+    return optimized;
+  }
+
+  /*! \brief Remove all cached modules. The metrics are kept. */
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    cache_.clear();
+  }
+
+  std::unordered_map<std::string, size_t> GetMetric() override {
+    std::lock_guard<std::mutex> lock(mu_);
+    return metrics_;
+  }
+
+ private:
+  /*! \brief Map from the key to the pairs of the original and the optimized modules. */
+  std::unordered_map<std::string, std::vector<std::pair<IRModule, IRModule>>> cache_;
+  /*! \brief The cache metrics for analysis. */
+  std::unordered_map<std::string, size_t> metrics_;
+  /*! \brief The lock of the cache and the metrics. */
+  std::mutex mu_;
+};
 
 ObjectRef RunModel(ir::IRModule mod, Array<Expr> args) {
-  ir::IRModule updated_mod = ir::IRModule(mod->functions);
   std::vector<GradTape> grads;
   ir::Array<Bool> requires_grads;
   grads.reserve(args.size());
   bool requires_grad = false;
+  raf::op::HashKey key;
+  key << static_cast<uint64_t>(tvm::StructuralHash()(mod));
   for (const Expr& arg : args) {
     if (const auto* a = arg.as<VarNode>()) {
       if (const auto* bound = binding::LookupBinding(a).as<NDArrayBindingObj>()) {
@@ -45,45 +119,65 @@ ObjectRef RunModel(ir::IRModule mod, Array<Expr> args) {
         }
         requires_grads.push_back(Bool(bound->tape.defined()));
         grads.push_back(bound->tape);
+        if (const auto* tv = bound->value.as<TensorValueObj>()) {
+          const DLTensor* tensor = tv->tensor.operator->();
+          key << *tensor << tensor->device;
+        }
+        key << bound->tape.defined();
+        continue;
       }
     }
+    key << "unbound";
+  }
+  bool enable_data_parallel = distributed::DistConfig::Global()->enable_data_parallel;
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  key << enable_data_parallel << static_cast<int64_t>(pass_ctx->opt_level);
+  for (const auto& name : pass_ctx->disabled_pass) {
+    key << std::string(name);
   }
 
-  // TODO - Revisit which passes require update due to presence of module
+  auto optimize = [&](ir::IRModule updated_mod) {
+    Array<tvm::transform::Pass> passes;
+    // run canonicalize ops pass (it needs "inter type pass" to work properly.)
+    passes.push_back(CanonicalizeOps());
+    // run const folding pass to avoid AD on constant ops
+    passes.push_back(FoldConstant());
+    if (!requires_grad) {
+      // TODO(haibin): add simplify inference pass - simplify the compute of
+      // BN, LN, Dropout, GN, etc.
+      raf::pass::RAFSequential seq(passes, "interpreter_infer_optimize");
+      return seq(updated_mod);
+    }
+    // run auto diff pass
+    passes.push_back(AutoDiff(requires_grads));
+    // run auto parallel
+    if (enable_data_parallel) {
+      passes.push_back(AutoDataParallel());
+    }
+    // run const folding pass
+    passes.push_back(FoldConstant());
+    raf::pass::RAFSequential seq(passes, "interpreter_optimize");
+    return seq(updated_mod);
+  };
+  ir::IRModule updated_mod;
+  if (pass_ctx->GetConfig<Bool>("raf.model.cache_optimized_module", Bool(true)).value()) {
+    // The parameters are not bound to their values, so that the optimized module is reusable.
+    updated_mod = OptimizedModuleCache::Get()->GetOrOptimize(
+        mod, std::string(key.byte_vector.begin(), key.byte_vector.end()),
+        [&]() { return optimize(ir::IRModule(mod->functions)); });
+  } else {
+    // Bind the parameters without gradients as constants to fold them, which is only worth it
+    // when the module is optimized for a single call.
+    updated_mod = ir::IRModule(mod->functions);
+    Function func = Downcast<Function>(updated_mod->Lookup("main"));
+    func = Downcast<Function>(BindParam(func, args));
+    updated_mod->Add(updated_mod->GetGlobalVar("main"), func);
+    updated_mod = optimize(updated_mod);
+  }
   Function func = Downcast<Function>(updated_mod->Lookup("main"));
-  func = Downcast<Function>(BindParam(func, args));
-  auto gvar = updated_mod->GetGlobalVar("main");
-  updated_mod->Add(gvar, func);
-
   if (!requires_grad) {
-    // TODO(haibin): add simplify inference pass - simplify the compute of
-    // BN, LN, Dropout, GN, etc.
-    raf::pass::RAFSequential seq({CanonicalizeOps(), FoldConstant()}, "interpreter_infer_optimize");
-    updated_mod = seq(updated_mod);
-    func = Downcast<Function>(updated_mod->Lookup("main"));
-    auto call_node = Call(func, args);
-    return DeTuple(Interpret(call_node, updated_mod));
+    return DeTuple(Interpret(Call(func, args), updated_mod));
   }
-
-  // Glob the needed passes.
-  Array<tvm::transform::Pass> passes;
-  // run canonicalize ops pass (it needs "inter type pass" to work properly.)
-  passes.push_back(CanonicalizeOps());
-  // run const folding pass to avoid AD on constant ops
-  passes.push_back(FoldConstant());
-  // run auto diff pass
-  passes.push_back(AutoDiff(requires_grads));
-
-  // run auto parallel
-  if (distributed::DistConfig::Global()->enable_data_parallel) {
-    passes.push_back(AutoDataParallel());
-  }
-
-  // run const folding pass
-  passes.push_back(FoldConstant());
-  raf::pass::RAFSequential seq(passes, "interpreter_optimize");
-  updated_mod = seq(updated_mod);
-  func = Downcast<Function>(updated_mod->Lookup("main"));
   TupleValue result = Downcast<TupleValue>(Interpret(Call(func, args), updated_mod));
   CHECK_EQ(result->fields.size(), 2U);
   return DeStruct(/*value=*/result->fields[0],
@@ -91,7 +185,20 @@ ObjectRef RunModel(ir::IRModule mod, Array<Expr> args) {
                   /*prev_tapes=*/{grads.begin(), grads.end()});
 }
 
+PackedMetricMap DumpModelCacheMetric() {
+  PackedMetricMap ret;
+  for (const auto& it : OptimizedModuleCache::Get()->GetMetric()) {
+    ret.Set(it.first, it.second);
+  }
+  return ret;
+}
+
 RAF_REGISTER_GLOBAL("raf.model.RunModel").set_body_typed(RunModel);
+RAF_REGISTER_GLOBAL("raf.model.DumpModelCacheMetric").set_body_typed(DumpModelCacheMetric);
+RAF_REGISTER_GLOBAL("raf.model.ClearModelCache").set_body_typed([]() {
+  OptimizedModuleCache::Get()->Clear();
+});
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.model.cache_optimized_module", Bool);
 
 }  // namespace model
 }  // namespace raf
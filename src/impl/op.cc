@@ -8,6 +8,7 @@
  * \brief RAF operator interface underlying implementation
  */
 #include <tvm/runtime/device_api.h>
+#include <mutex>
 #include "dmlc/registry.h"
 #include "raf/executor.h"
 #include "raf/ir.h"
@@ -55,11 +56,43 @@ OpEnv::~OpEnv() {
   }
 }
 
-void OpEnv::RequestWorkspace(void** dest, const Device& dev, int64_t nbytes) {
+/*! \brief The workspace tables bound to the executions on this thread, innermost last. */
+static std::vector<void* const*>& BoundWorkspaces() {
+  static thread_local std::vector<void* const*> bound;
+  return bound;
+}
+
+int OpEnv::RequestWorkspace(const Device& dev, int64_t nbytes) {
   int index = impl->workspace.size();
-  impl->workspace.push_back({dest, dev, nbytes, nullptr});
-  if (impl->executor != nullptr) {
-    impl->executor->RequestWorkspace(impl.get(), index);
+  impl->workspace.push_back({dev, nbytes});
+  return index;
+}
+
+void* OpEnv::GetWorkspace(int index) {
+  if (index < 0) {
+    return nullptr;
+  }
+  const auto& bound = BoundWorkspaces();
+  CHECK(!bound.empty()) << "No workspace is bound to the execution on this thread";
+  return bound.back()[index];
+}
+
+WorkspaceBinding::WorkspaceBinding(std::vector<void*> workspace)
+    : workspace_(std::move(workspace)), bound_(true) {
+  BoundWorkspaces().push_back(workspace_.data());
+}
+
+WorkspaceBinding::WorkspaceBinding(WorkspaceBinding&& other)
+    : workspace_(std::move(other.workspace_)), bound_(other.bound_) {
+  // Moving the vector keeps its buffer, so the pointer on the stack stays valid.
+  other.bound_ = false;
+}
+
+WorkspaceBinding::~WorkspaceBinding() {
+  if (bound_) {
+    auto& bound = BoundWorkspaces();
+    CHECK(!bound.empty() && bound.back() == workspace_.data());
+    bound.pop_back();
   }
 }
 
@@ -261,7 +294,10 @@ Array<Value> GetListArgs(const Attrs& attrs) {
 }
 
 std::string GetUniqueName(std::string name) {
+  // OpEnvs are built by multiple threads in VirtualMachine::Precompile.
+  static std::mutex mu;
   static std::unordered_map<std::string, int> name_map;
+  std::lock_guard<std::mutex> lock(mu);
   for (size_t i = 0; i < name.length(); ++i) {
     if (name[i] == '.') name[i] = '_';
   }
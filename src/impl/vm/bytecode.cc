@@ -377,7 +377,7 @@ Instruction Instruction::AllocTensorReg(RegName storage, Index offset, RegName s
 
 Instruction Instruction::AllocStorage(RegName size, Index alignment, DLDataType dtype_hint,
                                       DevType device_type, Index device_id, Index dst,
-                                      bool alloc_async) {
+                                      bool alloc_async, Index arena_offset) {
   Instruction instr;
   instr.op = Opcode::AllocStorage;
   instr.dst = dst;
@@ -387,6 +387,7 @@ Instruction Instruction::AllocStorage(RegName size, Index alignment, DLDataType
   instr.alloc_storage.device_type = device_type;
   instr.alloc_storage.device_id = device_id;
   instr.alloc_storage.alloc_async = alloc_async;
+  instr.alloc_storage.arena_offset = arena_offset;
   return instr;
 }
 
@@ -700,6 +701,9 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
       if (instr.alloc_storage.alloc_async) {
         os << "(async)";
       }
+      if (instr.alloc_storage.arena_offset >= 0) {
+        os << " arena[" << instr.alloc_storage.arena_offset << "]";
+      }
       break;
     }
     case Opcode::Free: {
@@ -14,12 +14,21 @@
 #include <tvm/relay/transform.h>
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/attrs/memory.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
 #include "raf/op.h"
 #include "raf/ir.h"
 #include "raf/binding.h"
 #include "raf/type.h"
 #include "raf/pass.h"
 #include "raf/dist_config.h"
+#include "raf/dialect.h"
+#include "raf/cache.h"
 #include "./compiler.h"
 
 namespace tvm {
@@ -234,7 +243,17 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       this->VisitExpr(func->body);
     }
     instructions_.push_back(Instruction::Ret(last_register_));
-    return VMFunction(var->name_hint, params_, instructions_, registers_num_);
+    auto vm_func = VMFunction(var->name_hint, params_, instructions_, registers_num_);
+
+    // The static memory arena planned by MemoryPlan, if any.
+    auto arena_size = func->GetAttr<tvm::IntImm>(attr::kArenaSize);
+    if (arena_size.defined()) {
+      vm_func.arena_size = arena_size.value()->value;
+      auto arena_alignment = func->GetAttr<tvm::IntImm>(attr::kArenaAlignment);
+      CHECK(arena_alignment.defined()) << "The alignment of the static arena is missing";
+      vm_func.arena_alignment = arena_alignment.value()->value;
+    }
+    return vm_func;
   }
 
  protected:
@@ -456,7 +475,7 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                  })
           .Match("raf.op.vm.alloc_storage",
                  [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
-                   CHECK(args.size() == 5 || args.size() == 6);
+                   CHECK(args.size() >= 5 && args.size() <= 7);
                    // Compute the size of the allocation.
                    this->VisitExpr(args[0]);
                    auto size_register = last_register_;
@@ -495,8 +514,19 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                      alloc_async = async_val.as<BoolValueObj>()->value;
                    }
 
+                   // arena_offset, which is specified by the MemoryPlan pass when the storage
+                   // is planned into the static memory arena.
+                   Index arena_offset = -1;
+                   if (args.size() == 7) {
+                     CHECK(args[6]->IsInstance<ConstantNode>());
+                     auto offset_val = args[6].as<ConstantNode>()->value;
+                     CHECK(offset_val->IsInstance<IntValueObj>());
+                     arena_offset = offset_val.as<IntValueObj>()->value;
+                   }
+
                    Emit(Instruction::AllocStorage(size_register, alignment, dtype, device_type,
-                                                  device_id, NewRegister(), alloc_async));
+                                                  device_id, NewRegister(), alloc_async,
+                                                  arena_offset));
                  })
           .Match("raf.op.vm.free",
                  [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
@@ -777,6 +807,113 @@ void VMCompiler::SetParam(const std::string& name, Value data_in) {
   params_[name] = data_in;
 }
 
+/*!
+ * \brief The process-wide cache of compiled units, which evicts the least recently used unit
+ * when it holds more units than the capacity.
+ */
+class CompileCache {
+ public:
+  static CompileCache* Get() {
+    static CompileCache inst;
+    return &inst;
+  }
+
+  std::shared_ptr<const CompiledUnit> Lookup(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+  }
+
+  void Insert(const std::string& key, std::shared_ptr<const CompiledUnit> unit, size_t capacity) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      lru_.erase(it->second);
+    }
+    lru_.emplace_front(key, std::move(unit));
+    index_[key] = lru_.begin();
+    while (lru_.size() > capacity) {
+      index_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    lru_.clear();
+    index_.clear();
+    hits = 0;
+    misses = 0;
+  }
+
+  size_t Size() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return lru_.size();
+  }
+
+  /*! \brief The number of the units reused and compiled since the last clear. */
+  std::atomic<int64_t> hits{0};
+  std::atomic<int64_t> misses{0};
+
+ private:
+  using Entry = std::pair<std::string, std::shared_ptr<const CompiledUnit>>;
+  /*! \brief The units from the most to the least recently used. */
+  std::list<Entry> lru_;
+  /*! \brief The mapping from a key to its entry in lru_. */
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  std::mutex mu_;
+};
+
+/*!
+ * \brief Partition a module into units, one per function. The unit of a function also holds the
+ * functions it refers to transitively, which are needed to optimize it. Each unit lists its own
+ * function first and the others sorted by their names, and units are sorted by their functions.
+ */
+std::vector<std::vector<GlobalVar>> PartitionUnits(const IRModule& mod) {
+  std::map<std::string, GlobalVar> gvars;
+  for (const auto& it : mod->functions) {
+    if (it.second->IsInstance<FunctionNode>()) {
+      gvars[it.first->name_hint] = it.first;
+    }
+  }
+  std::unordered_map<std::string, std::vector<std::string>> callees;
+  for (const auto& it : gvars) {
+    auto& names = callees[it.first];
+    tvm::relay::PostOrderVisit(mod->Lookup(it.second), [&](const Expr& expr) {
+      if (const auto* gvar = expr.as<GlobalVarNode>()) {
+        if (gvars.count(gvar->name_hint)) {
+          names.push_back(gvar->name_hint);
+        }
+      }
+    });
+  }
+  std::vector<std::vector<GlobalVar>> units;
+  for (const auto& it : gvars) {
+    std::set<std::string> visited{it.first};
+    std::vector<std::string> stack{it.first};
+    while (!stack.empty()) {
+      std::string name = stack.back();
+      stack.pop_back();
+      for (const auto& callee : callees.at(name)) {
+        if (visited.insert(callee).second) {
+          stack.push_back(callee);
+        }
+      }
+    }
+    units.push_back({it.second});
+    for (const auto& name : visited) {
+      if (name != it.first) {
+        units.back().push_back(gvars.at(name));
+      }
+    }
+  }
+  return units;
+}
+
 void VMCompiler::Lower(IRModule mod, const DeviceMap& device_map) {
   CHECK_EQ(device_map.size(), 1U)
       << "Currently VM compiler doesn't support heterogeneous compilation";
@@ -792,49 +929,210 @@ void VMCompiler::Lower(IRModule mod, const DeviceMap& device_map) {
   exec_ = make_object<Executable>();
   device_map_ = device_map;
 
+  auto pass_ctx = pass::PassContext::Current();
+  int64_t capacity =
+      pass_ctx->GetConfig("raf.vm.compile_cache.capacity", Integer(0)).value()->value;
+  std::vector<std::shared_ptr<const CompiledUnit>> units;
+  if (capacity <= 0) {
+    units.push_back(CompileUnit(mod, ""));
+  } else {
+    // Each function is optimized and compiled separately, so the functions that are unchanged,
+    // along with their callees, can be reused from the cache.
+    std::string config_key = GetConfigKey();
+    for (const auto& gvars : PartitionUnits(mod)) {
+      HashKey key;
+      key << config_key;
+      Map<GlobalVar, BaseFunc> functions;
+      std::unordered_map<std::string, BaseFunc> funcs_by_name;
+      for (const auto& gvar : gvars) {
+        auto func = mod->Lookup(gvar);
+        functions.Set(gvar, func);
+        funcs_by_name[gvar->name_hint] = func;
+        key << gvar->name_hint << static_cast<uint64_t>(tvm::StructuralHash()(func));
+      }
+      std::string key_str(key.byte_vector.begin(), key.byte_vector.end());
+      auto unit = CompileCache::Get()->Lookup(key_str);
+      if (unit != nullptr &&
+          (unit->name != gvars[0]->name_hint || unit->source.size() != gvars.size())) {
+        unit = nullptr;
+      }
+      // Guard against hash collisions.
+      for (size_t i = 0; unit != nullptr && i < unit->source.size(); ++i) {
+        auto it = funcs_by_name.find(unit->source[i].first);
+        if (it == funcs_by_name.end() ||
+            !tvm::StructuralEqual()(unit->source[i].second, it->second)) {
+          unit = nullptr;
+        }
+      }
+      if (unit == nullptr) {
+        CompileCache::Get()->misses++;
+        unit = CompileUnit(IRModule(functions, mod->type_definitions), gvars[0]->name_hint);
+        CompileCache::Get()->Insert(key_str, unit, capacity);
+      } else {
+        CompileCache::Get()->hits++;
+        DLOG(INFO) << "Reuse the compiled unit of " << gvars[0]->name_hint;
+      }
+      units.push_back(unit);
+    }
+  }
+  Link(units);
+
+#if USE_RELAY_DEBUG
+  for (auto vm_func : exec_->functions) {
+    DLOG(INFO) << vm_func << "-------------";
+  }
+#endif  // USE_RELAY_DEBUG
+}
+
+std::shared_ptr<const CompiledUnit> VMCompiler::CompileUnit(const IRModule& mod,
+                                                            const std::string& name) {
+  auto unit = std::make_shared<CompiledUnit>();
+  unit->name = name;
+  for (const auto& it : mod->functions) {
+    if (it.second->IsInstance<FunctionNode>()) {
+      unit->source.emplace_back(it.first->name_hint, Downcast<Function>(it.second));
+    }
+  }
+  std::sort(unit->source.begin(), unit->source.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
   // Run the optimizations necessary to target the VM.
-  context_.module = OptimizeModule(mod, device_map_);
+  VMCompilerContext context;
+  context.module = OptimizeModule(mod, device_map_);
+  unit->module = context.module;
+
+  // Estimate the peak memory of each function after memory planning.
+  bool estimate_workspace = pass::PassContext::Current()
+                                ->GetConfig("raf.vm.peak_memory.include_workspace", Bool(false))
+                                .value();
+  Device device = (*device_map_.begin()).second;
+  auto peak_memory = pass::EstimatePeakMemory(context.module, device, estimate_workspace);
 
   // Populate the global map.
   //
   // This maps global variables to a global index
   // in the VMFunction table.
-  PopulateGlobalMap();
+  PopulateGlobalMap(&context);
 
   // Next we get ready by allocating space for
   // the global state.
-  exec_->functions.resize(context_.module->functions.size());
+  unit->functions.resize(context.module->functions.size());
+  unit->defines.resize(context.module->functions.size(), false);
 
-  for (auto named_func : context_.module->functions) {
+  for (auto named_func : context.module->functions) {
     auto gvar = named_func.first;
     if (auto* n = named_func.second.as<FunctionNode>()) {
       auto func = GetRef<Function>(n);
-      VMFunctionCompiler func_compiler(&context_, device_map_);
+      VMFunctionCompiler func_compiler(&context, device_map_);
       auto vm_func = func_compiler.Compile(gvar, func);
 
-      size_t func_index = context_.global_map.at(gvar);
-      CHECK(func_index < exec_->functions.size());
-      exec_->functions[func_index] = vm_func;
+      vm_func.peak_memory = peak_memory.at(gvar->name_hint);
+
+      size_t func_index = context.global_map.at(gvar);
+      CHECK(func_index < unit->functions.size());
+      unit->functions[func_index] = vm_func;
+      // The functions lifted from closures are not in the source, and are defined by any unit
+      // lifting them. The other callees are defined by their own units.
+      bool in_source = std::any_of(unit->source.begin(), unit->source.end(),
+                                   [&](const auto& src) { return src.first == gvar->name_hint; });
+      unit->defines[func_index] = name.empty() || gvar->name_hint == name || !in_source;
     }
   }
+  unit->constants = std::move(context.constants);
+  return unit;
+}
 
-#if USE_RELAY_DEBUG
-  for (auto vm_func : exec_->functions) {
-    DLOG(INFO) << vm_func << "-------------";
+void VMCompiler::Link(const std::vector<std::shared_ptr<const CompiledUnit>>& units) {
+  // Assign the function indices in the executable to the functions defined by the units. Functions
+  // lifted from identical closures have the same name in different units, so only the first one
+  // is kept.
+  std::unordered_map<std::string, Index> func_index;
+  std::unordered_map<std::string, Function> funcs;
+  std::vector<std::vector<bool>> emits(units.size());
+  for (size_t u = 0; u < units.size(); ++u) {
+    const auto& unit = units[u];
+    emits[u].resize(unit->functions.size(), false);
+    for (size_t i = 0; i < unit->functions.size(); ++i) {
+      if (!unit->defines[i]) {
+        continue;
+      }
+      const auto& name = unit->functions[i].name;
+      auto func = Downcast<Function>(unit->module->Lookup(name));
+      if (func_index.count(name)) {
+        CHECK(tvm::StructuralEqual()(funcs.at(name), func))
+            << "Function " << name << " is defined differently by multiple units";
+        continue;
+      }
+      Index index = func_index.size();
+      func_index[name] = index;
+      funcs[name] = func;
+      emits[u][i] = true;
+    }
   }
-#endif  // USE_RELAY_DEBUG
-
-  // populate constants
-  for (const Value& data : context_.constants) {
-    exec_->constants.push_back(data);
+  exec_->functions.resize(func_index.size());
+
+  for (size_t u = 0; u < units.size(); ++u) {
+    const auto& unit = units[u];
+    Index const_offset = exec_->constants.size();
+    exec_->constants.insert(exec_->constants.end(), unit->constants.begin(),
+                            unit->constants.end());
+    std::vector<Index> remap(unit->functions.size());
+    for (size_t i = 0; i < unit->functions.size(); ++i) {
+      const auto& name = unit->functions[i].name;
+      auto it = func_index.find(name);
+      CHECK(it != func_index.end()) << "Function " << name << " is not defined by any unit";
+      remap[i] = it->second;
+    }
+    for (size_t i = 0; i < unit->functions.size(); ++i) {
+      if (!emits[u][i]) {
+        continue;
+      }
+      VMFunction vm_func = unit->functions[i];
+      for (auto& instr : vm_func.instructions) {
+        if (instr.op == Opcode::LoadConst) {
+          instr.const_index += const_offset;
+        } else if (instr.op == Opcode::InvokeFunc) {
+          instr.invoke_func.func_index = remap[instr.invoke_func.func_index];
+        } else if (instr.op == Opcode::AllocClosure) {
+          instr.alloc_closure.func_index = remap[instr.alloc_closure.func_index];
+        }
+      }
+      exec_->functions[remap[i]] = std::move(vm_func);
+    }
   }
 
   // update global function map
-  for (auto gv : context_.global_map) {
-    exec_->global_map.insert({gv.first->name_hint, gv.second});
+  for (const auto& it : func_index) {
+    exec_->global_map.insert({it.first, it.second});
   }
 }
 
+std::string VMCompiler::GetConfigKey() const {
+  auto pass_ctx = pass::PassContext::Current();
+  Device device = (*device_map_.begin()).second;
+  HashKey key;
+  key << static_cast<tvm::Device>(device) << static_cast<int32_t>(pass_ctx->opt_level);
+  for (const auto& name : pass_ctx->required_pass) {
+    key << "+" << name.operator std::string();
+  }
+  for (const auto& name : pass_ctx->disabled_pass) {
+    key << "-" << name.operator std::string();
+  }
+  key << static_cast<uint64_t>(tvm::StructuralHash()(pass_ctx->config));
+  auto dcfg = DistConfig::Global();
+  key << dcfg->enable_data_parallel << static_cast<int32_t>(dcfg->zero_opt_level)
+      << dcfg->group_bucket_size;
+  for (const auto& dialect : Dialect::GetEnabledDialects(device.device_type())) {
+    key << dialect;
+  }
+  if (const auto* pref = DialectPreference::Current()) {
+    for (const auto& dialect : (*pref)->preferred_dialects) {
+      key << dialect.operator std::string();
+    }
+  }
+  return std::string(key.byte_vector.begin(), key.byte_vector.end());
+}
+
 IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device_map) {
   CHECK_EQ(device_map.size(), 1U)
       << "Currently VM compiler doesn't support heterogeneous compilation";
@@ -870,8 +1168,8 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
     pass_seqs.push_back(pass::EraseType());
 
     // optimization passes that transform BBNF into ANF
-    if (device_t == DevType::kCUDA()) {
-      if (DistConfig::Global()->enable_data_parallel) {
+    if (device_t == DevType::kCUDA() || device_t == DevType::kCPU()) {
+      if (device_t == DevType::kCUDA() && DistConfig::Global()->enable_data_parallel) {
         // The current design of EnforceSync assumes ops are executed on multiple CUDA streams:
         // all computation ops are executed on a computation stream, and all communication
         // collectives are executed on another communication stream. Memory copy ops added in
@@ -934,12 +1232,12 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
   return seq(mod);
 }
 
-void VMCompiler::PopulateGlobalMap() {
+void VMCompiler::PopulateGlobalMap(VMCompilerContext* context) {
   // First we populate global map.
   size_t global_index = 0;
-  for (auto named_func : context_.module->functions) {
+  for (auto named_func : context->module->functions) {
     auto gvar = named_func.first;
-    context_.global_map.insert({gvar, global_index++});
+    context->global_map.insert({gvar, global_index++});
   }
 }
 
@@ -991,6 +1289,21 @@ PackedFunc VMCompiler::GetFunction(const std::string& name, const ObjectPtr<Obje
 }
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.anf_only", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.peak_memory.include_workspace", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.compile_cache.capacity", Integer);
+
+RAF_REGISTER_GLOBAL("raf.vm.GetCompileCacheStats").set_body_typed([]() {
+  auto cache = CompileCache::Get();
+  Map<String, Integer> ret;
+  ret.Set("hits", Integer(cache->hits.load()));
+  ret.Set("misses", Integer(cache->misses.load()));
+  ret.Set("size", Integer(cache->Size()));
+  return ret;
+});
+
+RAF_REGISTER_GLOBAL("raf.vm.ClearCompileCache").set_body_typed([]() {
+  CompileCache::Get()->Clear();
+});
 
 RAF_REGISTER_GLOBAL("raf.vm.VMCompiler").set_body_typed(CreateVMCompiler);
 
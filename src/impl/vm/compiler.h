@@ -56,6 +56,27 @@ struct VMCompilerContext {
   std::vector<Value> constants;
 };
 
+/*!
+ * \brief The optimized and compiled functions of a unit, i.e., a function with all the functions it
+ * refers to. The unit only defines the function and the closures lifted from it, and the other
+ * functions are defined by their own units. The constant and function indices in the instructions
+ * are local to the unit, and are relocated when the units are linked into an executable.
+ */
+struct CompiledUnit {
+  /*! \brief The name of the function of the unit, or empty if the unit is the whole module. */
+  std::string name;
+  /*! \brief The functions before optimizations sorted by their names, to verify cache hits. */
+  std::vector<std::pair<std::string, Function>> source;
+  /*! \brief The optimized module. */
+  IRModule module;
+  /*! \brief The compiled functions indexed by their local function indices. */
+  std::vector<VMFunction> functions;
+  /*! \brief Whether the unit defines each function, indexed by the local function indices. */
+  std::vector<bool> defines;
+  /*! \brief The constants indexed by their local constant indices. */
+  std::vector<Value> constants;
+};
+
 class VMCompiler : public tvm::runtime::ModuleNode {
  public:
   virtual ~VMCompiler() {
@@ -76,7 +97,10 @@ class VMCompiler : public tvm::runtime::ModuleNode {
   void SetParam(const std::string& name, Value data_in);
 
   /*!
-   * \brief Lower the functions in a Module
+   * \brief Lower the functions in a Module. When the config "raf.vm.compile_cache.capacity" is
+   * positive, each function is compiled as a unit with its callees, and the compiled units are
+   * cached by the structural hash of their functions, the pass context, the device and the enabled
+   * dialects, so the unchanged functions are not optimized and compiled again.
    *
    * \param mod Relay Module
    * \param device_map Mapping from context to device mapping. If it has more than one entries,
@@ -90,13 +114,24 @@ class VMCompiler : public tvm::runtime::ModuleNode {
  protected:
   IRModule OptimizeModule(const IRModule& mod, const DeviceMap& device_map);
 
-  void PopulateGlobalMap();
+  void PopulateGlobalMap(VMCompilerContext* context);
+
+  /*!
+   * \brief Optimize and compile all functions of a module as a unit.
+   * \param mod The module of the unit.
+   * \param name The function of the unit, or empty to define all functions of the module.
+   */
+  std::shared_ptr<const CompiledUnit> CompileUnit(const IRModule& mod, const std::string& name);
+
+  /*! \brief Link the units into the executable, relocating their constants and functions. */
+  void Link(const std::vector<std::shared_ptr<const CompiledUnit>>& units);
+
+  /*! \brief Get the part of the cache key from the pass context, the device and the dialects. */
+  std::string GetConfigKey() const;
 
  protected:
   /*! \brief Device map. */
   DeviceMap device_map_;
-  /*! \brief Global shared meta data */
-  VMCompilerContext context_;
   /*! \brief Compiled executable. */
   ObjectPtr<Executable> exec_;
   /*! \brief parameters */
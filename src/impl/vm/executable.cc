@@ -9,18 +9,26 @@
  */
 
 #include <dmlc/memory_io.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <vector>
 
+#include "raf/memory_pool.h"
 #include "raf/serialization.h"
 #include "raf/vm/vm.h"
 #include "./serialize_util.h"
+#include "../../common/shape_utils.h"
 
 namespace raf {
 namespace executor {
@@ -28,16 +36,52 @@ namespace vm {
 
 using namespace raf::ir;
 using namespace raf::registry;
+using namespace raf::value;
+using common::shape_utils::BytesCompactTensor;
+using common::shape_utils::IsCompact;
 
 #define STREAM_CHECK(val, section)                                         \
   CHECK(val) << "Invalid VM file format in the " << section << " section." \
              << "\n";
 
+namespace {
+
+inline uint64_t RoundUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+/*! \brief The memory of a constant tensor that refers to a file mapped to memory. */
+class MappedMemory final : public memory_pool::Memory {
+ public:
+  MappedMemory(std::shared_ptr<void> mapping, const char* ptr) : mapping_(std::move(mapping)) {
+    data = const_cast<char*>(ptr);
+    device = Device(DevType::kCPU(), 0);
+  }
+
+ private:
+  /*! \brief The mapping, which is unmapped when all constants referring to it are freed. */
+  std::shared_ptr<void> mapping_;
+};
+
+}  // namespace
+
 // Helper to serialize a vm instruction.
 VMInstructionSerializer SerializeInstruction(const Instruction& instr);
 // Helper to deserialize a serialized vm instruction.
 Instruction DeserializeInstruction(const VMInstructionSerializer& instr);
 
+// Helper to deserialize the instructions of a vm function.
+std::vector<Instruction> LoadInstructions(dmlc::Stream* strm, size_t num_instructions) {
+  std::vector<Instruction> instructions;
+  instructions.reserve(num_instructions);
+  for (size_t i = 0; i < num_instructions; i++) {
+    VMInstructionSerializer instr;
+    STREAM_CHECK(instr.Load(strm), "code/instruction");
+    instructions.push_back(DeserializeInstruction(instr));
+  }
+  return instructions;
+}
+
 PackedFunc Executable::GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) {
   if (name == "get_lib") {
     return PackedFunc(
@@ -54,12 +98,26 @@ PackedFunc Executable::GetFunction(const std::string& name, const ObjectPtr<Obje
       std::string func_name = args[0];
       *rv = this->GetFunctionArity(func_name);
     });
+  } else if (name == "get_arena_size") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::string func_name = args[0];
+      *rv = this->GetArenaSize(func_name);
+    });
+  } else if (name == "get_peak_memory") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::string func_name = args[0];
+      *rv = this->GetPeakMemory(func_name);
+    });
   } else if (name == "get_function_param_name") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       std::string func_name = args[0];
       int index = args[1];
       *rv = this->GetFunctionParameterName(func_name, index);
     });
+  } else if (name == "get_num_loaded_functions") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = static_cast<int64_t>(this->GetNumLoadedFunctions());
+    });
   } else {
     LOG(FATAL) << "Unknown packed function: " << name;
     return PackedFunc(nullptr);
@@ -76,6 +134,24 @@ int Executable::GetFunctionArity(std::string func_name) const {
   return func.params.size();
 }
 
+int64_t Executable::GetArenaSize(std::string func_name) const {
+  auto it = global_map.find(func_name);
+  if (it == global_map.end()) {
+    LOG(ERROR) << "Cannot find function " << func_name << " in executable";
+    return -1;
+  }
+  return functions[it->second].arena_size;
+}
+
+int64_t Executable::GetPeakMemory(std::string func_name) const {
+  auto it = global_map.find(func_name);
+  if (it == global_map.end()) {
+    LOG(ERROR) << "Cannot find function " << func_name << " in executable";
+    return -1;
+  }
+  return functions[it->second].peak_memory;
+}
+
 std::string Executable::GetFunctionParameterName(std::string func_name, uint32_t index) const {
   auto it = global_map.find(func_name);
   if (it == global_map.end()) {
@@ -90,11 +166,50 @@ std::string Executable::GetFunctionParameterName(std::string func_name, uint32_t
   return func.params[index];
 }
 
+const VMFunction& Executable::GetVMFunction(Index func_index) const {
+  CHECK_LT(static_cast<size_t>(func_index), functions.size())
+      << "Invalid function index " << func_index;
+  if (function_once_ != nullptr) {
+    // The lazy deserialization does not change the observable state, so it is done in place.
+    std::call_once(function_once_[func_index], [this, func_index]() {
+      const_cast<Executable*>(this)->LoadFunction(func_index);
+    });
+  }
+  return functions[func_index];
+}
+
+size_t Executable::GetNumInstructions(Index func_index) const {
+  CHECK_LT(static_cast<size_t>(func_index), functions.size())
+      << "Invalid function index " << func_index;
+  if (function_once_ != nullptr) {
+    return num_instructions_[func_index];
+  }
+  return functions[func_index].instructions.size();
+}
+
+size_t Executable::GetNumLoadedFunctions() const {
+  if (function_once_ != nullptr) {
+    return num_loaded_functions_.load();
+  }
+  return functions.size();
+}
+
+const Value& Executable::GetConstant(Index const_index) const {
+  CHECK_LT(static_cast<size_t>(const_index), constants.size())
+      << "Invalid constant index " << const_index;
+  if (constant_once_ != nullptr) {
+    std::call_once(constant_once_[const_index], [this, const_index]() {
+      const_cast<Executable*>(this)->LoadConstant(const_index);
+    });
+  }
+  return constants[const_index];
+}
+
 std::string Executable::GetBytecode() const {
   std::ostringstream oss;
 
   for (size_t i = 0; i < functions.size(); ++i) {
-    const auto& func = functions[i];
+    const auto& func = GetVMFunction(i);
     // Print the header of the function format.
     oss << "VM Function[" << i << "]: " << func.name << "(";
     for (const auto& param : func.params) {
@@ -104,6 +219,9 @@ std::string Executable::GetBytecode() const {
     oss << ")" << std::endl;
     oss << "# reg file size = " << func.register_file_size << std::endl;
     oss << "# instruction count = " << func.instructions.size() << std::endl;
+    if (func.arena_size > 0) {
+      oss << "# static arena size = " << func.arena_size << std::endl;
+    }
 
     // Print the instructions of a `VMFunction`.
     // The part after ";" is the instruction in text format.
@@ -161,17 +279,46 @@ std::string Executable::Stats() const {
   if (!prim_ops.empty()) oss.seekp(-2, oss.cur);
   oss << "]" << std::endl;
 
+  // Get the static memory arena size of each function that has one.
+  oss << "  Static arenas (bytes): [";
+  bool has_arena = false;
+  for (const auto& func : functions) {
+    if (func.arena_size > 0) {
+      oss << "(\"" << func.name << "\", " << func.arena_size << "), ";
+      has_arena = true;
+    }
+  }
+  if (has_arena) oss.seekp(-2, oss.cur);
+  oss << "]" << std::endl;
+
+  // Get the estimated peak memory of each function, where -1 means unknown.
+  oss << "  Peak memory (bytes): [";
+  for (const auto& func : functions) {
+    oss << "(\"" << func.name << "\", " << func.peak_memory << "), ";
+  }
+  if (!functions.empty()) oss.seekp(-2, oss.cur);
+  oss << "]" << std::endl;
+
   return oss.str();
 }
 
 void SaveHeader(dmlc::Stream* strm) {
-  uint64_t header = kMetaVMBytecodeMagic;
+  uint64_t header = kMetaVMBytecodeMagicV2;
   strm->Write(header);
   std::string version = TVM_VERSION;
   strm->Write(version);
+  strm->Write(kMetaVMFormatVersion);
 }
 
 TVMByteArray Executable::Save() {
+  // Deserialize the rest of a loaded executable.
+  for (size_t i = 0; i < functions.size(); ++i) {
+    GetVMFunction(i);
+  }
+  for (size_t i = 0; i < constants.size(); ++i) {
+    GetConstant(i);
+  }
+
   // Initialize the stream object.
   code_.clear();
   dmlc::MemoryStringStream strm(&code_);
@@ -182,14 +329,25 @@ TVMByteArray Executable::Save() {
   // Global section.
   SaveGlobalSection(&strm);
 
-  // Constant section.
-  SaveConstantSection(&strm);
-
   // Primitive names.
   SavePrimitiveOpNames(&strm);
 
-  // Code section.
-  SaveCodeSection(&strm);
+  // The constant section and the code section are saved to the payload first, so that the
+  // section table in front of them records the location of each constant and function.
+  std::string payload;
+  dmlc::MemoryStringStream payload_strm(&payload);
+  std::vector<DataSectionTensor> tensors;
+  std::vector<Section> constant_sections;
+  SaveConstantSection(&payload_strm, &tensors, &constant_sections);
+  std::vector<Section> function_sections;
+  SaveCodeSection(&payload_strm, &function_sections);
+
+  // Section table, followed by the payload.
+  SaveSectionTable(&strm, constant_sections, function_sections, payload.size());
+  strm.Write(payload.data(), payload.size());
+
+  // Data section.
+  SaveDataSection(&strm, code_.size(), tensors);
 
   TVMByteArray arr;
   arr.data = code_.c_str();
@@ -212,10 +370,66 @@ void Executable::SaveGlobalSection(dmlc::Stream* strm) {
   strm->Write(glbs);
 }
 
-void Executable::SaveConstantSection(dmlc::Stream* strm) {
-  strm->Write(static_cast<uint64_t>(constants.size()));
-  for (const auto& value : this->constants) {
-    serialization::SerializeValue(strm, value);
+bool Executable::DataSectionTensor::Load(dmlc::Stream* strm) {
+  return strm->Read(&dtype) && strm->Read(&shape) && strm->Read(&offset) && strm->Read(&nbytes);
+}
+
+void Executable::DataSectionTensor::Save(dmlc::Stream* strm) const {
+  strm->Write(dtype);
+  strm->Write(shape);
+  strm->Write(offset);
+  strm->Write(nbytes);
+}
+
+void Executable::SaveConstantSection(dmlc::SeekStream* strm,
+                                     std::vector<DataSectionTensor>* tensors,
+                                     std::vector<Section>* sections) {
+  uint64_t offset = 0;
+  for (size_t i = 0; i < constants.size(); ++i) {
+    Section section;
+    section.offset = strm->Tell();
+    const auto* tv = constants[i].as<TensorValueObj>();
+    if (tv == nullptr || !IsCompact(*tv->tensor.operator->())) {
+      strm->Write(static_cast<uint8_t>(kInlineConstant));
+      serialization::SerializeValue(strm, constants[i]);
+      section.size = strm->Tell() - section.offset;
+      sections->push_back(section);
+      continue;
+    }
+    const DLTensor* dlt = tv->tensor.operator->();
+    DataSectionTensor tensor;
+    tensor.index = i;
+    tensor.dtype = dlt->dtype;
+    tensor.shape = common::shape_utils::GetShape<int64_t>(*dlt);
+    tensor.offset = RoundUp(offset, kMetaVMTensorAlignment);
+    tensor.nbytes = BytesCompactTensor(*dlt);
+    offset = tensor.offset + tensor.nbytes;
+    strm->Write(static_cast<uint8_t>(kDataSectionTensor));
+    tensor.Save(strm);
+    tensors->push_back(std::move(tensor));
+    section.size = strm->Tell() - section.offset;
+    sections->push_back(section);
+  }
+}
+
+void Executable::SaveDataSection(dmlc::Stream* strm, size_t pos,
+                                 const std::vector<DataSectionTensor>& tensors) {
+  std::vector<char> padding;
+  auto write_padding = [&](uint64_t nbytes) {
+    padding.resize(nbytes, 0);
+    strm->Write(padding.data(), nbytes);
+    pos += nbytes;
+  };
+  write_padding(RoundUp(pos, kMetaVMDataSectionAlignment) - pos);
+  const uint64_t start = pos;
+  for (const auto& tensor : tensors) {
+    write_padding(start + tensor.offset - pos);
+    auto src = Downcast<TensorValue>(constants[tensor.index])->tensor;
+    if (src->device.device_type != kDLCPU) {
+      src = tensor::Tensor(src.CopyTo(Device(DevType::kCPU(), 0)));
+    }
+    strm->Write(src->data, tensor.nbytes);
+    pos += tensor.nbytes;
   }
 }
 
@@ -328,6 +542,7 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       fields.push_back(instr.alloc_storage.device_id);
       fields.push_back(instr.dst);
       fields.push_back(instr.alloc_storage.alloc_async);
+      fields.push_back(instr.alloc_storage.arena_offset);
       break;
     }
     case Opcode::Free: {
@@ -448,49 +663,126 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
   return VMInstructionSerializer(static_cast<Index>(instr.op), fields);
 }
 
-void Executable::SaveCodeSection(dmlc::Stream* strm) {
-  // Save the number of functions.
-  strm->Write(static_cast<uint64_t>(this->functions.size()));
+void Executable::SaveCodeSection(dmlc::SeekStream* strm, std::vector<Section>* sections) {
   for (const auto& func : this->functions) {
-    // Save the function info.
-    VMFunctionSerializer func_format(func.name, func.register_file_size, func.instructions.size(),
-                                     func.params);
-    func_format.Save(strm);
-
-    // Serialize each instruction.
+    // Serialize each instruction. The function info is saved in the section table.
+    Section section;
+    section.offset = strm->Tell();
     for (const auto& instr : func.instructions) {
       const auto& serialized_instr = SerializeInstruction(instr);
       serialized_instr.Save(strm);
     }
+    section.size = strm->Tell() - section.offset;
+    sections->push_back(section);
   }
 }
 
-void LoadHeader(dmlc::Stream* strm) {
+void Executable::SaveSectionTable(dmlc::Stream* strm,
+                                  const std::vector<Section>& constant_sections,
+                                  const std::vector<Section>& function_sections,
+                                  uint64_t payload_size) {
+  strm->Write(static_cast<uint64_t>(constant_sections.size()));
+  for (const auto& section : constant_sections) {
+    strm->Write(section.offset);
+    strm->Write(section.size);
+  }
+  strm->Write(static_cast<uint64_t>(function_sections.size()));
+  for (size_t i = 0; i < function_sections.size(); ++i) {
+    const auto& func = functions[i];
+    VMFunctionSerializer func_format(func.name, func.register_file_size, func.instructions.size(),
+                                     func.params, func.arena_size, func.arena_alignment,
+                                     func.peak_memory);
+    func_format.Save(strm);
+    strm->Write(function_sections[i].offset);
+    strm->Write(function_sections[i].size);
+  }
+  strm->Write(payload_size);
+}
+
+/*! \brief Check the header and return the format version. */
+uint64_t LoadHeader(dmlc::Stream* strm) {
   // Check header.
   uint64_t header;
   STREAM_CHECK(strm->Read(&header), "header");
-  STREAM_CHECK(header == kMetaVMBytecodeMagic, "header");
+  STREAM_CHECK(header == kMetaVMBytecodeMagic || header == kMetaVMBytecodeMagicV2, "header");
 
   // Check version.
   std::string version;
   STREAM_CHECK(strm->Read(&version), "version");
   STREAM_CHECK(version == TVM_VERSION, "version");
+
+  if (header == kMetaVMBytecodeMagic) {
+    return 1;
+  }
+  uint64_t format_version;
+  STREAM_CHECK(strm->Read(&format_version), "version");
+  CHECK_LE(format_version, kMetaVMFormatVersion)
+      << "The VM file format version " << format_version << " is newer than the supported "
+      << kMetaVMFormatVersion;
+  return format_version;
+}
+
+tvm::runtime::Module Executable::Load(std::string code, const tvm::runtime::Module lib) {
+  // The string is moved to the owner without copying the bytes. The bytes may not be aligned,
+  // so the constant tensors do not refer to them in place.
+  auto source = std::make_shared<std::string>(std::move(code));
+  return Load(source->data(), source->size(), lib, source, false);
+}
+
+tvm::runtime::Module Executable::LoadFile(const std::string& path,
+                                          const tvm::runtime::Module lib) {
+  int fd = open(path.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Cannot open " << path << ": " << strerror(errno);
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "Cannot stat " << path << ": " << strerror(errno);
+  size_t size = static_cast<size_t>(st.st_size);
+  CHECK_GT(size, 0) << "The VM file " << path << " is empty";
+  // The mapping is private and copy-on-write, so that the constants are shared with the other
+  // processes until someone writes them.
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  CHECK(ptr != MAP_FAILED) << "Cannot map " << path << ": " << strerror(errno);
+  std::shared_ptr<void> mapping(ptr, [size](void* p) { munmap(p, size); });
+  return Load(static_cast<const char*>(ptr), size, lib, mapping, true);
 }
 
-tvm::runtime::Module Executable::Load(const std::string& code, const tvm::runtime::Module lib) {
+tvm::runtime::Module Executable::Load(const char* data, size_t size,
+                                      const tvm::runtime::Module lib,
+                                      std::shared_ptr<void> source, bool in_place) {
   auto exec = make_object<Executable>();
   exec->lib = lib;
-  exec->code_ = code;
-  dmlc::MemoryStringStream strm(&exec->code_);
+  dmlc::MemoryFixedSizeStream strm(const_cast<char*>(data), size);
 
   // Load header.
-  LoadHeader(&strm);
+  uint64_t format_version = LoadHeader(&strm);
 
   // Global section.
   exec->LoadGlobalSection(&strm);
 
+  if (format_version >= 3) {
+    // Primitive names that will be invoked by `InvokePacked` instructions.
+    exec->LoadPrimitiveOpNames(&strm);
+
+    // Section table. The constants and the instructions in the payload are deserialized on
+    // their first use.
+    uint64_t payload_size = exec->LoadSectionTable(&strm);
+    size_t payload_start = strm.Tell();
+    STREAM_CHECK(payload_start + payload_size <= size, "section table");
+    CHECK(source != nullptr) << "The bytes with a section table must be owned by the executable";
+    exec->source_ = std::move(source);
+    exec->source_in_place_ = in_place;
+    exec->payload_ = data + payload_start;
+    size_t start = RoundUp(payload_start + payload_size, kMetaVMDataSectionAlignment);
+    if (start <= size) {
+      exec->data_section_ = data + start;
+      exec->data_section_size_ = size - start;
+    }
+    return tvm::runtime::Module(exec);
+  }
+
   // Constant section.
-  exec->LoadConstantSection(&strm);
+  std::vector<DataSectionTensor> tensors;
+  exec->LoadConstantSection(&strm, format_version, &tensors);
 
   // Primitive names that will be invoked by `InvokePacked` instructions.
   exec->LoadPrimitiveOpNames(&strm);
@@ -498,6 +790,13 @@ tvm::runtime::Module Executable::Load(const std::string& code, const tvm::runtim
   // Code section.
   exec->LoadCodeSection(&strm);
 
+  // Data section.
+  if (!tensors.empty()) {
+    size_t start = RoundUp(strm.Tell(), kMetaVMDataSectionAlignment);
+    STREAM_CHECK(start <= size, "data");
+    exec->LoadDataSection(data + start, size - start, tensors, in_place ? source : nullptr);
+  }
+
   return tvm::runtime::Module(exec);
 }
 
@@ -509,18 +808,56 @@ void Executable::LoadGlobalSection(dmlc::Stream* strm) {
   }
 }
 
-void Executable::LoadConstantSection(dmlc::Stream* strm) {
+void Executable::LoadConstantSection(dmlc::Stream* strm, uint64_t format_version,
+                                     std::vector<DataSectionTensor>* tensors) {
   uint64_t sz;
   // Load the number of constants.
   STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "constant");
   size_t size = static_cast<size_t>(sz);
   // Load each of the constants.
   for (size_t i = 0; i < size; i++) {
-    Value value = serialization::DeserializeValue(strm);
-    constants.push_back(value);
+    uint8_t kind = kInlineConstant;
+    if (format_version >= 2) {
+      STREAM_CHECK(strm->Read(&kind), "constant");
+    }
+    if (kind == kInlineConstant) {
+      Value value = serialization::DeserializeValue(strm);
+      constants.push_back(value);
+      continue;
+    }
+    STREAM_CHECK(kind == kDataSectionTensor, "constant");
+    DataSectionTensor tensor;
+    tensor.index = i;
+    STREAM_CHECK(tensor.Load(strm), "constant");
+    constants.push_back(Value());
+    tensors->push_back(std::move(tensor));
   }
 }
 
+void Executable::LoadDataSection(const char* data, size_t size,
+                                 const std::vector<DataSectionTensor>& tensors,
+                                 std::shared_ptr<void> mapping) {
+  for (const auto& tensor : tensors) {
+    constants[tensor.index] = LoadDataSectionTensor(data, size, tensor, mapping);
+  }
+}
+
+Value Executable::LoadDataSectionTensor(const char* data, size_t size,
+                                        const DataSectionTensor& tensor,
+                                        const std::shared_ptr<void>& mapping) {
+  Device cpu(DevType::kCPU(), 0);
+  STREAM_CHECK(data != nullptr && tensor.offset + tensor.nbytes <= size, "data");
+  const char* ptr = data + tensor.offset;
+  std::shared_ptr<memory_pool::Memory> mem;
+  if (mapping != nullptr) {
+    mem = std::make_shared<MappedMemory>(mapping, ptr);
+  } else {
+    mem = memory_pool::Memory::Alloc(cpu, tensor.nbytes);
+    std::memcpy(mem->data, ptr, tensor.nbytes);
+  }
+  return TensorValue::Assemble(cpu, tensor.dtype, tensor.shape, {}, mem->data, mem);
+}
+
 void Executable::LoadPrimitiveOpNames(dmlc::Stream* strm) {
   std::vector<std::string> primitive_names;
   STREAM_CHECK(strm->Read(&primitive_names), "primitive name");
@@ -648,9 +985,11 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       Index device_id = instr.fields[6];
       RegName dst = instr.fields[7];
       bool alloc_async = instr.fields[8];
+      // The arena offset is absent in executables saved before static arenas were introduced.
+      Index arena_offset = instr.fields.size() > 9 ? instr.fields[9] : -1;
 
       return Instruction::AllocStorage(allocation_size, alignment, dtype, device_type, device_id,
-                                       dst, alloc_async);
+                                       dst, alloc_async, arena_offset);
     }
     case Opcode::Free: {
       DCHECK_EQ(instr.fields.size(), 1U);
@@ -780,17 +1119,14 @@ void Executable::LoadCodeSection(dmlc::Stream* strm) {
     STREAM_CHECK(loaded_func.Load(strm), "code/function");
 
     // Load the instructions.
-    std::vector<Instruction> instructions;
-    for (size_t j = 0; j < loaded_func.num_instructions; j++) {
-      VMInstructionSerializer instr;
-      std::vector<Index> instr_fields;
-      STREAM_CHECK(instr.Load(strm), "code/instruction");
-      instructions.push_back(DeserializeInstruction(instr));
-    }
+    std::vector<Instruction> instructions = LoadInstructions(strm, loaded_func.num_instructions);
 
     // Create the VM function.
     VMFunction vm_func = VMFunction(loaded_func.name, loaded_func.params, instructions,
                                     loaded_func.register_file_size);
+    vm_func.arena_size = loaded_func.arena_size;
+    vm_func.arena_alignment = loaded_func.arena_alignment;
+    vm_func.peak_memory = loaded_func.peak_memory;
     auto it = this->global_map.find(loaded_func.name);
     CHECK(it != this->global_map.end());
     CHECK_LE(it->second, this->global_map.size());
@@ -798,6 +1134,67 @@ void Executable::LoadCodeSection(dmlc::Stream* strm) {
   }
 }
 
+uint64_t Executable::LoadSectionTable(dmlc::Stream* strm) {
+  uint64_t num_constants;
+  STREAM_CHECK(strm->Read(&num_constants), "section table");
+  constant_sections_.resize(num_constants);
+  for (auto& section : constant_sections_) {
+    STREAM_CHECK(strm->Read(&section.offset) && strm->Read(&section.size), "section table");
+  }
+  constants.resize(num_constants);
+  constant_once_.reset(new std::once_flag[num_constants]);
+
+  uint64_t num_funcs;
+  STREAM_CHECK(strm->Read(&num_funcs), "section table");
+  function_sections_.resize(num_funcs);
+  num_instructions_.resize(num_funcs);
+  for (size_t i = 0; i < num_funcs; ++i) {
+    // The function info is loaded eagerly, so that the arity and the arena of the functions are
+    // known without deserializing their instructions.
+    VMFunctionSerializer loaded_func;
+    STREAM_CHECK(loaded_func.Load(strm), "section table/function");
+    STREAM_CHECK(strm->Read(&function_sections_[i].offset), "section table/function");
+    STREAM_CHECK(strm->Read(&function_sections_[i].size), "section table/function");
+    VMFunction vm_func = VMFunction(loaded_func.name, loaded_func.params, {},
+                                    loaded_func.register_file_size);
+    vm_func.arena_size = loaded_func.arena_size;
+    vm_func.arena_alignment = loaded_func.arena_alignment;
+    vm_func.peak_memory = loaded_func.peak_memory;
+    functions.push_back(std::move(vm_func));
+    num_instructions_[i] = loaded_func.num_instructions;
+  }
+  function_once_.reset(new std::once_flag[num_funcs]);
+
+  uint64_t payload_size;
+  STREAM_CHECK(strm->Read(&payload_size), "section table");
+  return payload_size;
+}
+
+void Executable::LoadConstant(Index const_index) {
+  const auto& section = constant_sections_[const_index];
+  dmlc::MemoryFixedSizeStream strm(const_cast<char*>(payload_ + section.offset), section.size);
+  uint8_t kind;
+  STREAM_CHECK(strm.Read(&kind), "constant");
+  if (kind == kInlineConstant) {
+    constants[const_index] = serialization::DeserializeValue(&strm);
+    return;
+  }
+  STREAM_CHECK(kind == kDataSectionTensor, "constant");
+  DataSectionTensor tensor;
+  tensor.index = const_index;
+  STREAM_CHECK(tensor.Load(&strm), "constant");
+  constants[const_index] =
+      LoadDataSectionTensor(data_section_, data_section_size_, tensor,
+                            source_in_place_ ? source_ : nullptr);
+}
+
+void Executable::LoadFunction(Index func_index) {
+  const auto& section = function_sections_[func_index];
+  dmlc::MemoryFixedSizeStream strm(const_cast<char*>(payload_ + section.offset), section.size);
+  functions[func_index].instructions = LoadInstructions(&strm, num_instructions_[func_index]);
+  num_loaded_functions_++;
+}
+
 RAF_REGISTER_GLOBAL("raf.vm.GetNumOfGlobals").set_body([](TVMArgs args, TVMRetValue* rv) {
   tvm::runtime::Module mod = args[0];
   const auto* exec = dynamic_cast<Executable*>(mod.operator->());
@@ -845,7 +1242,12 @@ RAF_REGISTER_GLOBAL("raf.vm.GetPrimitiveFields").set_body([](TVMArgs args, TVMRe
 
 RAF_REGISTER_GLOBAL("raf.vm.Load_Executable")
     .set_body_typed([](std::string code, tvm::runtime::Module lib) {
-      return Executable::Load(code, lib);
+      return Executable::Load(std::move(code), lib);
+    });
+
+RAF_REGISTER_GLOBAL("raf.vm.Load_ExecutableFile")
+    .set_body_typed([](std::string path, tvm::runtime::Module lib) {
+      return Executable::LoadFile(path, lib);
     });
 
 }  // namespace vm
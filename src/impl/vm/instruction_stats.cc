@@ -0,0 +1,278 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/instruction_stats.cc
+ * \brief The per-instruction latency statistics of the RAF virtual machine.
+ */
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include "./instruction_stats.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+namespace {
+
+const char* OpcodeName(Opcode op) {
+  switch (op) {
+    case Opcode::Move:
+      return "Move";
+    case Opcode::Ret:
+      return "Ret";
+    case Opcode::Fatal:
+      return "Fatal";
+    case Opcode::LoadConst:
+      return "LoadConst";
+    case Opcode::LoadConsti:
+      return "LoadConsti";
+    case Opcode::GetField:
+      return "GetField";
+    case Opcode::If:
+      return "If";
+    case Opcode::Goto:
+      return "Goto";
+    case Opcode::AllocStorage:
+      return "AllocStorage";
+    case Opcode::AllocTensor:
+      return "AllocTensor";
+    case Opcode::AllocTensorReg:
+      return "AllocTensorReg";
+    case Opcode::AllocTuple:
+      return "AllocTuple";
+    case Opcode::AllocClosure:
+      return "AllocClosure";
+    case Opcode::SetShape:
+      return "SetShape";
+    case Opcode::Free:
+      return "Free";
+    case Opcode::InvokeFunc:
+      return "InvokeFunc";
+    case Opcode::InvokeClosure:
+      return "InvokeClosure";
+    case Opcode::InvokePacked:
+      return "InvokePacked";
+    case Opcode::InvokeJit:
+      return "InvokeJit";
+    case Opcode::InferType:
+      return "InferType";
+    case Opcode::CudaSetStream:
+      return "CudaSetStream";
+    case Opcode::CudaAddEvent:
+      return "CudaAddEvent";
+    case Opcode::CudaWaitEvent:
+      return "CudaWaitEvent";
+    case Opcode::CudaStreamBarrier:
+      return "CudaStreamBarrier";
+  }
+  return "Unknown";
+}
+
+/*! \brief A snapshot of the counters of one or more instructions. */
+struct Summary {
+  uint64_t count = 0;
+  uint64_t total_ns = 0;
+  uint64_t min_ns = UINT64_MAX;
+  uint64_t max_ns = 0;
+  uint64_t alloc_bytes = 0;
+  uint64_t workspace_bytes = 0;
+  uint64_t inline_cache_hits = 0;
+  int num_instructions = 0;
+  std::vector<uint64_t> histogram = std::vector<uint64_t>(InstructionStats::kNumBuckets, 0);
+
+  void Add(const InstructionStats::Counter& counter) {
+    count += counter.count.load(std::memory_order_relaxed);
+    total_ns += counter.total_ns.load(std::memory_order_relaxed);
+    min_ns = std::min(min_ns, counter.min_ns.load(std::memory_order_relaxed));
+    max_ns = std::max(max_ns, counter.max_ns.load(std::memory_order_relaxed));
+    alloc_bytes += counter.alloc_bytes.load(std::memory_order_relaxed);
+    workspace_bytes += counter.workspace_bytes.load(std::memory_order_relaxed);
+    inline_cache_hits += counter.inline_cache_hits.load(std::memory_order_relaxed);
+    num_instructions++;
+    for (int i = 0; i < InstructionStats::kNumBuckets; ++i) {
+      histogram[i] += counter.histogram[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  /*! \brief Get the percentile in nanoseconds, clamped to the observed range. */
+  uint64_t Percentile(double p) const {
+    uint64_t total = 0;
+    for (auto n : histogram) {
+      total += n;
+    }
+    if (total == 0) {
+      return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * total + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < InstructionStats::kNumBuckets; ++i) {
+      seen += histogram[i];
+      if (seen >= rank) {
+        return std::min(max_ns, std::max(min_ns, InstructionStats::BucketValue(i)));
+      }
+    }
+    return max_ns;
+  }
+
+  void EmitJSON(std::ostream& os) const {
+    auto us = [](uint64_t ns) { return ns / 1e3; };
+    os << "\"count\": " << count << ", \"total_us\": " << us(total_ns)
+       << ", \"mean_us\": " << (count ? us(total_ns) / count : 0)
+       << ", \"min_us\": " << (count ? us(min_ns) : 0) << ", \"max_us\": " << us(max_ns)
+       << ", \"p50_us\": " << us(Percentile(0.5)) << ", \"p99_us\": " << us(Percentile(0.99))
+       << ", \"alloc_bytes\": " << alloc_bytes << ", \"workspace_bytes\": " << workspace_bytes
+       << ", \"inline_cache_hits\": " << inline_cache_hits;
+  }
+};
+
+/*! \brief Escape a string in JSON. */
+std::string Quote(const std::string& str) {
+  std::ostringstream os;
+  os << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+         << std::dec;
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+  return os.str();
+}
+
+}  // namespace
+
+InstructionStats::InstructionStats(const Executable* exec)
+    : exec_(exec), funcs_(new std::atomic<FunctionCounters*>[exec->functions.size()]) {
+  for (size_t i = 0; i < exec->functions.size(); ++i) {
+    funcs_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+InstructionStats::FunctionCounters* InstructionStats::AllocFunction(Index func_index) {
+  std::lock_guard<std::mutex> lock(mu_);
+  FunctionCounters* func = funcs_[func_index].load(std::memory_order_relaxed);
+  if (func == nullptr) {
+    owners_.emplace_back(new FunctionCounters(exec_->GetNumInstructions(func_index)));
+    func = owners_.back().get();
+    funcs_[func_index].store(func, std::memory_order_release);
+  }
+  return func;
+}
+
+void InstructionStats::SetOpName(Counter* counter, const std::string& op_name) {
+  if (counter->op_name.load(std::memory_order_acquire) != nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  const std::string* name = &*op_names_.insert(op_name).first;
+  const std::string* expected = nullptr;
+  counter->op_name.compare_exchange_strong(expected, name, std::memory_order_release);
+}
+
+uint64_t InstructionStats::BucketValue(int index) {
+  if (index < (1 << kSubBucketBits)) {
+    return index;
+  }
+  int exp = (index >> kSubBucketBits) + kSubBucketBits - 1;
+  uint64_t sub = index & ((1 << kSubBucketBits) - 1);
+  uint64_t width = 1ULL << (exp - kSubBucketBits);
+  return ((1ULL << kSubBucketBits) + sub) * width + width / 2;
+}
+
+void InstructionStats::Visit(const std::function<void(const VMFunction&, size_t, const std::string&,
+                                                     const Counter&)>& f) const {
+  for (size_t i = 0; i < exec_->functions.size(); ++i) {
+    const FunctionCounters* func = funcs_[i].load(std::memory_order_acquire);
+    if (func == nullptr) {
+      continue;
+    }
+    const auto& vm_func = exec_->GetVMFunction(i);
+    for (size_t pc = 0; pc < func->counters.size(); ++pc) {
+      const Counter& counter = func->counters[pc];
+      if (counter.count.load(std::memory_order_relaxed) == 0) {
+        continue;
+      }
+      const std::string* op_name = counter.op_name.load(std::memory_order_acquire);
+      f(vm_func, pc, op_name ? *op_name : OpcodeName(vm_func.instructions[pc].op), counter);
+    }
+  }
+}
+
+std::string InstructionStats::GetJSON() const {
+  std::ostringstream os;
+  std::map<std::string, Summary> ops;
+  os << "{\"instructions\": [";
+  bool first = true;
+  Visit([&](const VMFunction& func, size_t pc, const std::string& name, const Counter& counter) {
+    Summary summary;
+    summary.Add(counter);
+    ops[name].Add(counter);
+    os << (first ? "" : ", ") << "{\"function\": " << Quote(func.name) << ", \"pc\": " << pc
+       << ", \"name\": " << Quote(name) << ", ";
+    summary.EmitJSON(os);
+    os << "}";
+    first = false;
+  });
+  os << "], \"ops\": {";
+  first = true;
+  for (const auto& it : ops) {
+    os << (first ? "" : ", ") << Quote(it.first) << ": {";
+    it.second.EmitJSON(os);
+    os << ", \"num_instructions\": " << it.second.num_instructions << "}";
+    first = false;
+  }
+  os << "}}";
+  return os.str();
+}
+
+std::string InstructionStats::GetTable(int top) const {
+  std::map<std::string, Summary> ops;
+  Visit([&](const VMFunction& func, size_t pc, const std::string& name, const Counter& counter) {
+    ops[name].Add(counter);
+  });
+  std::vector<std::pair<std::string, const Summary*>> rows;
+  uint64_t total_ns = 0;
+  for (const auto& it : ops) {
+    rows.emplace_back(it.first, &it.second);
+    total_ns += it.second.total_ns;
+  }
+  std::sort(rows.begin(), rows.end(),
+            [](const auto& a, const auto& b) { return a.second->total_ns > b.second->total_ns; });
+  if (top > 0 && rows.size() > static_cast<size_t>(top)) {
+    rows.resize(top);
+  }
+
+  std::ostringstream os;
+  os << "Times are in microseconds." << std::endl;
+  os << std::left << std::setw(40) << "Name" << std::right << std::setw(10) << "Count"
+     << std::setw(12) << "Total" << std::setw(8) << "%" << std::setw(10) << "Mean"
+     << std::setw(10) << "Min" << std::setw(10) << "P50" << std::setw(10) << "P99"
+     << std::setw(10) << "Max" << std::setw(14) << "Alloc(B)" << std::setw(14) << "Workspace(B)"
+     << std::endl;
+  os << std::fixed << std::setprecision(1);
+  for (const auto& row : rows) {
+    const Summary& s = *row.second;
+    os << std::left << std::setw(40) << row.first << std::right << std::setw(10) << s.count
+       << std::setw(12) << s.total_ns / 1e3 << std::setw(8)
+       << (total_ns ? 100.0 * s.total_ns / total_ns : 0.0) << std::setw(10)
+       << (s.count ? s.total_ns / 1e3 / s.count : 0.0) << std::setw(10)
+       << (s.count ? s.min_ns / 1e3 : 0.0) << std::setw(10) << s.Percentile(0.5) / 1e3
+       << std::setw(10) << s.Percentile(0.99) / 1e3 << std::setw(10) << s.max_ns / 1e3
+       << std::setw(14) << s.alloc_bytes << std::setw(14) << s.workspace_bytes << std::endl;
+  }
+  return os.str();
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,148 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/instruction_stats.h
+ * \brief The per-instruction latency statistics of the RAF virtual machine.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "raf/vm/vm.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*!
+ * \brief The latency statistics of each instruction of the executable, which are aggregated by the
+ * op name (or the opcode of the instructions other than InvokeJit) on query. All counters are
+ * updated with relaxed atomics, so the statistics can be collected by concurrent runs.
+ *
+ * The latency of an instruction is the host time from its dispatch to the dispatch of the next
+ * instruction, so it only includes the launch of the kernels running asynchronously on devices.
+ * The latencies are kept in log-linear histograms, with 8 buckets per power of two, so the
+ * percentiles are accurate to 12.5%.
+ */
+class InstructionStats {
+ public:
+  /*! \brief The number of bits of the sub-buckets of a power of two. */
+  static constexpr int kSubBucketBits = 3;
+  /*! \brief The latencies of 2^kMaxExponent nanoseconds or more are put in the last bucket. */
+  static constexpr int kMaxExponent = 40;
+  /*! \brief The number of buckets of a histogram. */
+  static constexpr int kNumBuckets = (kMaxExponent - kSubBucketBits + 1) << kSubBucketBits;
+
+  /*! \brief The counters of an instruction. */
+  struct Counter {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> min_ns{UINT64_MAX};
+    std::atomic<uint64_t> max_ns{0};
+    /*! \brief The storage bytes of AllocStorage, either from the pool or the arena. */
+    std::atomic<uint64_t> alloc_bytes{0};
+    /*! \brief The workspace bytes requested by the ops of InvokeJit. */
+    std::atomic<uint64_t> workspace_bytes{0};
+    /*! \brief The number of InvokeJit invocations that reused the OpEnv of the inline cache. */
+    std::atomic<uint64_t> inline_cache_hits{0};
+    /*! \brief The op name of the first invocation of an InvokeJit, or nullptr. */
+    std::atomic<const std::string*> op_name{nullptr};
+    /*! \brief The latency histogram. */
+    std::atomic<uint32_t> histogram[kNumBuckets]{};
+
+    /*! \brief Record a latency in nanoseconds. */
+    inline void Record(uint64_t ns) {
+      count.fetch_add(1, std::memory_order_relaxed);
+      total_ns.fetch_add(ns, std::memory_order_relaxed);
+      uint64_t cur = min_ns.load(std::memory_order_relaxed);
+      while (ns < cur && !min_ns.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {
+      }
+      cur = max_ns.load(std::memory_order_relaxed);
+      while (ns > cur && !max_ns.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {
+      }
+      histogram[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+  };
+
+  explicit InstructionStats(const Executable* exec);
+
+  /*! \brief Get the counter of an instruction, which is allocated on its first use. */
+  inline Counter* Get(Index func_index, Index pc) {
+    FunctionCounters* func = funcs_[func_index].load(std::memory_order_acquire);
+    if (func == nullptr) {
+      func = AllocFunction(func_index);
+    }
+    return &func->counters[pc];
+  }
+
+  /*! \brief Set the op name of the counter of an InvokeJit, unless it has been set. */
+  void SetOpName(Counter* counter, const std::string& op_name);
+
+  /*!
+   * \brief Get the statistics in JSON, with the instructions that ran at least once and their
+   * aggregation by the op name.
+   */
+  std::string GetJSON() const;
+
+  /*!
+   * \brief Get the statistics aggregated by the op name as a table, sorted by the total time.
+   * \param top The maximal number of rows, or non-positive for all rows.
+   */
+  std::string GetTable(int top) const;
+
+  /*! \brief Get the histogram bucket of a latency. */
+  static inline int BucketIndex(uint64_t ns) {
+    if (ns < (1ULL << kSubBucketBits)) {
+      return static_cast<int>(ns);
+    }
+    int exp = 63 - __builtin_clzll(ns);
+    if (exp >= kMaxExponent) {
+      return kNumBuckets - 1;
+    }
+    int sub = static_cast<int>(ns >> (exp - kSubBucketBits)) & ((1 << kSubBucketBits) - 1);
+    return ((exp - kSubBucketBits + 1) << kSubBucketBits) + sub;
+  }
+
+  /*! \brief Get the middle latency of a histogram bucket. */
+  static uint64_t BucketValue(int index);
+
+ private:
+  /*! \brief The counters of the instructions of a function. */
+  struct FunctionCounters {
+    explicit FunctionCounters(size_t num_instructions) : counters(num_instructions) {
+    }
+    std::vector<Counter> counters;
+  };
+
+  /*! \brief Allocate the counters of a function. */
+  FunctionCounters* AllocFunction(Index func_index);
+
+  /*! \brief Visit the function, pc, name and counter of each instruction that has run. */
+  void Visit(const std::function<void(const VMFunction&, size_t, const std::string&,
+                                      const Counter&)>& f) const;
+
+  /*! \brief The executable. */
+  const Executable* exec_;
+  /*! \brief The counters of each function, or nullptr if none of its instructions has run. */
+  std::unique_ptr<std::atomic<FunctionCounters*>[]> funcs_;
+  /*! \brief The owners of the counters. */
+  std::vector<std::unique_ptr<FunctionCounters>> owners_;
+  /*! \brief The op names, whose addresses are stable. */
+  std::unordered_set<std::string> op_names_;
+  /*! \brief The mutex to allocate the counters and the op names. */
+  std::mutex mu_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
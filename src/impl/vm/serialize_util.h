@@ -24,6 +24,31 @@ namespace vm {
 
 /*! \brief The magic number for the serialized VM bytecode file  */
 constexpr uint64_t kMetaVMBytecodeMagic = 0xD225DE2F4214151D;
+/*!
+ * \brief The magic number for the versioned VM bytecode file, where the TVM version in the header
+ * is followed by the format version.
+ */
+constexpr uint64_t kMetaVMBytecodeMagicV2 = 0xD225DE2F4214151E;
+/*!
+ * \brief The current format version. Version 1 is the unversioned format with the constant tensors
+ * inlined in the constant section. Version 2 moves the data of the compact constant tensors to a
+ * page-aligned data section at the end of the file. Version 3 adds a section table in front of the
+ * constants and the functions, so that each of them can be deserialized on demand. Version 4 adds
+ * the estimated peak memory to the function info.
+ */
+constexpr uint64_t kMetaVMFormatVersion = 4;
+/*! \brief The alignment of the data section in the file, so that it can be mapped to memory. */
+constexpr uint64_t kMetaVMDataSectionAlignment = 4096;
+/*! \brief The alignment of each tensor in the data section. */
+constexpr uint64_t kMetaVMTensorAlignment = 64;
+
+/*! \brief How a constant is stored in the constant section since version 2. */
+enum MetaVMConstantKind : uint8_t {
+  /*! \brief The constant is serialized inline. */
+  kInlineConstant = 0,
+  /*! \brief The constant is a compact tensor with its data in the data section. */
+  kDataSectionTensor = 1,
+};
 
 template <typename T>
 static inline size_t VectorHash(size_t key, const std::vector<T>& values) {
@@ -43,15 +68,25 @@ struct VMFunctionSerializer {
   size_t num_instructions;
   /*! \brief The parameters of the VMFunction. */
   std::vector<std::string> params;
+  /*! \brief The size of the static memory arena of the VMFunction. */
+  int64_t arena_size = 0;
+  /*! \brief The alignment of the static memory arena of the VMFunction. */
+  int64_t arena_alignment = 0;
+  /*! \brief The estimated peak memory of the VMFunction, or -1 if unknown. */
+  int64_t peak_memory = -1;
 
   VMFunctionSerializer() = default;
 
   VMFunctionSerializer(const std::string& name, Index register_file_size, size_t num_instructions,
-                       const std::vector<std::string>& params)
+                       const std::vector<std::string>& params, int64_t arena_size = 0,
+                       int64_t arena_alignment = 0, int64_t peak_memory = -1)
       : name(name),
         register_file_size(register_file_size),
         num_instructions(num_instructions),
-        params(params) {
+        params(params),
+        arena_size(arena_size),
+        arena_alignment(arena_alignment),
+        peak_memory(peak_memory) {
   }
 
   /*!
@@ -62,12 +97,22 @@ struct VMFunctionSerializer {
   bool Load(dmlc::Stream* strm) {
     std::vector<std::string> func_info;
     if (!strm->Read(&func_info)) return false;
-    CHECK_EQ(func_info.size(), 3U) << "Failed to decode the vm function."
-                                   << "\n";
+    CHECK(func_info.size() == 3U || func_info.size() == 5U || func_info.size() == 6U)
+        << "Failed to decode the vm function."
+        << "\n";
     name = func_info[0];
     register_file_size = std::stoll(func_info[1]);
     // Get the number of instructions.
     num_instructions = static_cast<size_t>(std::stoll(func_info[2]));
+    // Get the static memory arena, which is absent in the old format.
+    if (func_info.size() >= 5U) {
+      arena_size = std::stoll(func_info[3]);
+      arena_alignment = std::stoll(func_info[4]);
+    }
+    // Get the estimated peak memory, which is absent before version 4.
+    if (func_info.size() == 6U) {
+      peak_memory = std::stoll(func_info[5]);
+    }
     return strm->Read(&params);
   }
 
@@ -80,6 +125,9 @@ struct VMFunctionSerializer {
     func_info.push_back(name);
     func_info.push_back(std::to_string(register_file_size));
     func_info.push_back(std::to_string(num_instructions));
+    func_info.push_back(std::to_string(arena_size));
+    func_info.push_back(std::to_string(arena_alignment));
+    func_info.push_back(std::to_string(peak_memory));
     strm->Write(func_info);
     strm->Write(params);
   }
@@ -12,13 +12,17 @@
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
 #include <tvm/runtime/device_api.h>
+#include <tvm/node/structural_hash.h>
 
 #include <algorithm>
 #include <chrono>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
 #include "raf/communicator.h"
@@ -38,6 +42,7 @@
 #include "../../requests.h"
 #include "../../op/ty/utils.h"
 #include "../../common/shape_utils.h"
+#include "./instruction_stats.h"
 
 #include "raf/device_api.h"
 #include "raf/registry.h"
@@ -63,7 +68,8 @@ using namespace raf::stream_pool;
 using namespace raf::distributed::communicator;
 
 namespace utils {
-inline std::shared_ptr<Event> GetEventById(const VMContext& ctx, Index device_id, Index event_id) {
+inline std::shared_ptr<Event> GetEventById(const VMContext& ctx, DevType device_type,
+                                           Index device_id, Index event_id) {
   if (device_id >= ctx->events.size()) {
     ctx->events.resize(device_id + 1);
   }
@@ -71,15 +77,15 @@ inline std::shared_ptr<Event> GetEventById(const VMContext& ctx, Index device_id
     ctx->events[device_id].resize(event_id + 1);
   }
   if (ctx->events[device_id][event_id] == nullptr) {
-    Device device(DevType::kCUDA(), static_cast<int>(device_id));
+    Device device(device_type, static_cast<int>(device_id));
     ctx->events[device_id][event_id] =
         EventPool::Get(device)->GetEvent(0x02 /*cudaEventDisableTiming*/);
   }
   return ctx->events[device_id][event_id];
 }
 
-inline std::shared_ptr<Stream> GetStreamById(const VMContext& ctx, Index device_id,
-                                             Index stream_id) {
+inline std::shared_ptr<Stream> GetStreamById(const VMContext& ctx, DevType device_type,
+                                             Index device_id, Index stream_id) {
   if (device_id >= ctx->streams.size()) {
     ctx->streams.resize(device_id + 1);
   }
@@ -87,10 +93,16 @@ inline std::shared_ptr<Stream> GetStreamById(const VMContext& ctx, Index device_
     ctx->streams[device_id].resize(stream_id + 1);
   }
   if (ctx->streams[device_id][stream_id] == nullptr) {
-    if (stream_id == 0) {
+    // CPU streams are only used by stream schedules, so the default stream is a worker stream as
+    // well to run concurrently with the others. Each context owns its CPU streams, so that the ops
+    // of concurrent runs do not queue up behind each other. The default stream of CUDA is the null
+    // stream.
+    Device device(device_type, static_cast<int>(device_id));
+    if (device_type == DevType::kCPU()) {
+      ctx->streams[device_id][stream_id] = Stream::Create(device);
+    } else if (stream_id == 0) {
       ctx->streams[device_id][stream_id] = std::make_shared<Stream>(nullptr);
     } else {
-      Device device(DevType::kCUDA(), static_cast<int>(device_id));
       ctx->streams[device_id][stream_id] =
           Stream::Get(device, kCudaCompute, static_cast<int>(stream_id));
     }
@@ -98,6 +110,61 @@ inline std::shared_ptr<Stream> GetStreamById(const VMContext& ctx, Index device_
   return ctx->streams[device_id][stream_id];
 }
 
+/*! \brief Block until the ops on the CPU streams of the context are done. */
+inline void WaitCPUStreams(const VMContext& ctx) {
+  for (const auto& device_streams : ctx->streams) {
+    for (const auto& stream : device_streams) {
+      if (stream != nullptr && stream->data() != nullptr) {
+        stream->Wait();
+      }
+    }
+  }
+  ctx->cpu_stream_producers.clear();
+}
+
+/*!
+ * \brief Block until the ops writing the tensors of a value on CPU streams are done, so that the
+ * VM can read the value on the host.
+ */
+inline void WaitCPUProducers(const VMContext& ctx, const Value& value) {
+  if (ctx->cpu_stream_producers.empty()) {
+    return;
+  }
+  if (const auto* tuple = value.as<TupleValueObj>()) {
+    for (const auto& field : tuple->fields) {
+      WaitCPUProducers(ctx, field);
+    }
+  } else if (value.as<TensorValueObj>()) {
+    DLTensor* tensor = Downcast<TensorValue>(value);
+    auto it = ctx->cpu_stream_producers.find(tensor->data);
+    if (it != ctx->cpu_stream_producers.end()) {
+      it->second->Wait();
+      ctx->cpu_stream_producers.erase(it);
+    }
+  }
+}
+
+/*!
+ * \brief Release a buffer after the ops already launched to the CPU streams of the context, because
+ * they may still read or write it. Every stream holds the buffer until its release task runs, so
+ * the buffer goes back to the pool once the last stream gets there.
+ */
+inline void ReleaseAfterCPUStreams(const VMContext& ctx, std::shared_ptr<Memory>* buffer) {
+  if (ctx->cpu_stream_producers.empty() || *buffer == nullptr) {
+    buffer->reset();
+    return;
+  }
+  auto holder = std::make_shared<std::shared_ptr<Memory>>(std::move(*buffer));
+  auto api = DeviceAPI::Get(DevType::kCPU());
+  for (const auto& device_streams : ctx->streams) {
+    for (const auto& stream : device_streams) {
+      if (stream != nullptr && stream->data() != nullptr) {
+        api->LaunchOnStream(stream->data(), [holder]() {});
+      }
+    }
+  }
+}
+
 const char* GetStreamName(Index stream_id) {
   static std::vector<std::string> names = {"Default Stream"};
   while (stream_id >= names.size()) {
@@ -139,6 +206,151 @@ void TensorRepr(std::ostringstream& os, const TensorValueObj* tensor) {
   }
   os << ">";
 }
+
+/*! \brief A fingerprint sink that appends the fingerprint to a vector. */
+struct FingerprintWriter {
+  std::vector<int64_t>* fingerprint;
+
+  inline bool Emit(int64_t v) {
+    fingerprint->push_back(v);
+    return true;
+  }
+};
+
+/*! \brief A fingerprint sink that compares the fingerprint against a recorded one. */
+struct FingerprintMatcher {
+  const std::vector<int64_t>& fingerprint;
+  size_t pos = 0;
+
+  inline bool Emit(int64_t v) {
+    return pos < fingerprint.size() && fingerprint[pos++] == v;
+  }
+
+  inline bool Done() const {
+    return pos == fingerprint.size();
+  }
+};
+
+template <typename TSink>
+inline bool FingerprintTensor(const TensorValueObj* tensor, TSink* sink) {
+  const DLTensor* t = tensor->tensor.operator->();
+  int64_t dtype = static_cast<int64_t>(t->dtype.code) |
+                  (static_cast<int64_t>(t->dtype.bits) << 8) |
+                  (static_cast<int64_t>(t->dtype.lanes) << 16);
+  if (!sink->Emit(dtype) || !sink->Emit(t->ndim)) {
+    return false;
+  }
+  for (int i = 0; i < t->ndim; ++i) {
+    if (!sink->Emit(t->shape[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ * \brief Emit the shape/dtype fingerprint of the registers accessed by an InvokeJit instruction.
+ * It covers the same information as the OpEnv cache key, but is built without string formatting.
+ * \return False if the sink rejects the fingerprint or a register cannot be fingerprinted.
+ */
+template <typename TSink>
+inline bool FingerprintInvokeJit(const VMContext& ctx, const Instruction& instr, TSink* sink) {
+  constexpr int64_t kConstTag = -1;
+  constexpr int64_t kTupleTag = -2;
+  constexpr int64_t kNonTensorTag = -3;
+  const VMFrame& frame = ctx->frames.back();
+  for (Index i = 0; i < instr.invoke_jit.arity; ++i) {
+    Index reg_idx = instr.invoke_jit.args[i];
+    if (frame.is_const[reg_idx]) {
+      if (!sink->Emit(kConstTag)) {
+        return false;
+      }
+      continue;
+    }
+    const Value& reg = frame.register_file[reg_idx];
+    if (auto tensor = reg.as<TensorValueObj>()) {
+      if (!FingerprintTensor(tensor, sink)) {
+        return false;
+      }
+    } else if (auto tup = reg.as<TupleValueObj>()) {
+      if (!sink->Emit(kTupleTag) || !sink->Emit(tup->fields.size())) {
+        return false;
+      }
+      for (const auto& field : tup->fields) {
+        auto t = field.as<TensorValueObj>();
+        if (t != nullptr ? !FingerprintTensor(t, sink) : !sink->Emit(kNonTensorTag)) {
+          return false;
+        }
+      }
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*! \brief Round up a workspace size so that the next workspace carved after it is aligned. */
+inline int64_t RoundUpWorkspace(int64_t nbytes) {
+  return (nbytes + kDefaultMemoryAlignment - 1) / kDefaultMemoryAlignment *
+         kDefaultMemoryAlignment;
+}
+
+/*!
+ * \brief Get a workspace buffer of at least the given size on the device. The buffer is owned
+ * by the calling thread and only grows, so concurrent contexts never share a workspace and
+ * repeated invocations do not go through the memory pool.
+ */
+inline void* GetThreadLocalWorkspace(const Device& dev, int64_t nbytes) {
+  thread_local std::unordered_map<int64_t, std::pair<std::shared_ptr<Memory>, int64_t>> buffers;
+  int64_t key = (static_cast<int64_t>(dev.device_type()) << 32) | dev.device_id();
+  auto& buf = buffers[key];
+  if (buf.first == nullptr || buf.second < nbytes) {
+    buf.first = memory_pool::Memory::Alloc(dev, nbytes);
+    buf.second = nbytes;
+  }
+  return buf.first->data;
+}
+
+/*!
+ * \brief A storage carved out of the static memory arena of a function. It holds a reference
+ * to the arena so that the arena outlives all tensors allocated from it.
+ */
+class ArenaMemory final : public Memory {
+ public:
+  ArenaMemory(std::shared_ptr<Memory> arena, int64_t offset) : arena_(std::move(arena)) {
+    data = static_cast<uint8_t*>(arena_->data) + offset;
+    device = arena_->device;
+  }
+
+ private:
+  /*! \brief The arena this storage belongs to. */
+  std::shared_ptr<Memory> arena_;
+};
+
+/*!
+ * \brief Thrown by the walk of Precompile when an instruction depends on the contents of a
+ * tensor that is not computed in the walk, e.g., a branch or a data-dependent shape. The walk
+ * stops there, and the rest of the function is built lazily when it runs.
+ */
+struct PrecompileStop {};
+
+/*! \brief Check whether the contents of a value are unknown in the walk of Precompile. */
+inline bool IsPrecompileUnknown(const VMContext& ctx, const Value& value) {
+  if (!value.defined()) {
+    return true;
+  }
+  if (ctx->precompile_unknown.count(value)) {
+    return true;
+  }
+  if (const auto* tuple = value.as<TupleValueObj>()) {
+    for (const auto& field : tuple->fields) {
+      if (IsPrecompileUnknown(ctx, field)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
 }  // namespace utils
 
 RAF_REGISTER_OBJECT_REFLECT(VMContextObj);
@@ -146,6 +358,7 @@ RAF_REGISTER_OBJECT_REFLECT(VMContextObj);
 VMContext VMContext::make(const Executable* exec) {
   auto ptr = make_object<VMContextObj>();
   ptr->exec = exec;
+  ptr->arenas.resize(exec->functions.size());
   return VMContext(ptr);
 }
 
@@ -205,7 +418,7 @@ inline bool VMContext::IsConst(Index reg) const {
 inline void VMContext::PushFrame(Index func_index, const std::vector<Value>& args,
                                  RegName ret_reg) {
   auto self = this->operator->();
-  const auto& func = self->exec->functions[func_index];
+  const auto& func = self->exec->GetVMFunction(func_index);
   CHECK_EQ(func.params.size(), args.size())
       << "Number of arguments mismatches: " << func.params.size() << " vs " << args.size();
   auto ret_pc = self->pc + 1;
@@ -222,12 +435,17 @@ inline void VMContext::PushFrame(Index func_index, const std::vector<Value>& arg
 inline Index VMContext::PopFrame() {
   auto self = this->operator->();
   CHECK_GT(self->frames.size(), 0);
-  const VMFrame& fr = self->frames.back();
+  VMFrame& fr = self->frames.back();
+  if (fr.arena != nullptr && self->arenas[self->func_index] == nullptr) {
+    // Keep the arena for the next invocation of the function.
+    self->arenas[self->func_index] = std::move(fr.arena);
+  }
+  RegName caller_return_register = fr.caller_return_register;
   self->func_index = fr.caller_func_index;
   self->pc = fr.caller_return_pc;
-  self->code = self->exec->functions[self->func_index].instructions.data();
+  self->code = self->exec->GetVMFunction(self->func_index).instructions.data();
   self->frames.pop_back();
-  return fr.caller_return_register;
+  return caller_return_register;
 }
 
 std::shared_ptr<OpEnvCache> VMFuncOpEnvCache::Get(Index pc) {
@@ -241,9 +459,26 @@ std::shared_ptr<OpEnvCache> VMFuncOpEnvCache::Get(Index pc) {
   return cache;
 }
 
+OpEnvCacheEntryPtr VMFuncOpEnvCache::GetInline(Index pc) const {
+  if (pc < 0 || pc >= inline_cache_.size()) {
+    return nullptr;
+  }
+  return std::atomic_load(&inline_cache_[pc]);
+}
+
+void VMFuncOpEnvCache::SetInline(Index pc, OpEnvCacheEntryPtr entry) {
+  if (pc < 0 || pc >= inline_cache_.size()) {
+    return;
+  }
+  std::atomic_store(&inline_cache_[pc], std::move(entry));
+}
+
 void VMFuncOpEnvCache::Clear() {
   std::lock_guard<std::mutex> lock(mu_);
   cache_map_.clear();
+  for (auto& entry : inline_cache_) {
+    std::atomic_store(&entry, OpEnvCacheEntryPtr(nullptr));
+  }
 }
 
 #ifdef RAF_USE_CUDA
@@ -297,6 +532,309 @@ class VirtualMachine::CudaGraphImpl {
 };
 #endif
 
+class CPUPlan {
+ public:
+  /*! \brief An OpEnv executed in the capturing run, with its resolved arguments. */
+  struct Step {
+    OpEnvPtr op_env;
+    std::vector<Value> inputs;
+    Value output;
+    std::string key;
+  };
+
+  /*! \brief A tensor of the steps whose data lies in an input or an output buffer. */
+  struct Binding {
+    DLTensor* tensor;
+    /*! \brief The index of the buffer in the inputs or the outputs. */
+    size_t index;
+    /*! \brief The offset in bytes of the data pointer of the tensor to the buffer. */
+    int64_t offset;
+  };
+
+  /*!
+   * \brief Get the signature of the inputs, i.e., their devices, dtypes and shapes.
+   * \return Whether the inputs can be fed to a plan, which requires compact tensors.
+   */
+  static bool GetSignature(const std::vector<Value>& inputs, std::vector<int64_t>* signature) {
+    for (const auto& input : inputs) {
+      const auto* tv = input.as<TensorValueObj>();
+      if (tv == nullptr) {
+        return false;
+      }
+      const DLTensor* dlt = tv->tensor.operator->();
+      if (!common::shape_utils::IsCompact(*dlt)) {
+        return false;
+      }
+      signature->push_back(static_cast<int64_t>(dlt->device.device_type));
+      signature->push_back(dlt->device.device_id);
+      signature->push_back((dlt->dtype.code << 16) | (dlt->dtype.bits << 8) | dlt->dtype.lanes);
+      signature->push_back(dlt->ndim);
+      signature->insert(signature->end(), dlt->shape, dlt->shape + dlt->ndim);
+    }
+    return true;
+  }
+
+  /*! \brief Record an executed OpEnv. */
+  void Record(const OpEnvPtr& op_env, const std::vector<Value>& inputs, const Value& output,
+              const std::string& key) {
+    steps_.push_back({op_env, inputs, output, key});
+    // Hold the memory of the tensors, which the Free instructions may release after the step.
+    for (const auto& input : inputs) {
+      HoldMemory(input);
+    }
+    HoldMemory(output);
+  }
+
+  /*! \brief Hold a buffer used by the steps, so that every replay reuses it. */
+  void Hold(std::shared_ptr<Memory> buffer) {
+    mems_.push_back(std::move(buffer));
+  }
+
+  /*!
+   * \brief Bind the tensors of the steps to the inputs and outputs of the capturing run.
+   * \param signature The signature of the inputs.
+   * \param inputs The inputs of the capturing run.
+   * \param ret The return value of the capturing run.
+   * \return Whether the plan can be replayed. It cannot if an output is not a compact tensor
+   * produced by the steps in its own buffer (e.g., an output aliasing an input, a constant or
+   * another output), or if a tensor of the steps straddles the boundary of a buffer.
+   */
+  bool Finalize(const std::vector<int64_t>& signature, const std::vector<Value>& inputs,
+                const Value& ret) {
+    signature_ = signature;
+    replayable_ = Resolve(inputs, ret);
+    if (!replayable_) {
+      // Only the signature is kept, so that the runs with it are interpreted without capturing.
+      steps_.clear();
+      mems_.clear();
+      input_bindings_.clear();
+      output_bindings_.clear();
+    }
+    return replayable_;
+  }
+
+  /*! \brief The signature of the inputs of the plan. */
+  const std::vector<int64_t>& signature() const {
+    return signature_;
+  }
+
+  /*! \brief Whether the plan can be replayed. */
+  bool replayable() const {
+    return replayable_;
+  }
+
+  /*! \brief The recorded steps. */
+  const std::vector<Step>& steps() const {
+    return steps_;
+  }
+
+  /*! \brief The size in bytes of each output buffer. */
+  const std::vector<int64_t>& output_nbytes() const {
+    return output_nbytes_;
+  }
+
+  /*! \brief Rebind the tensors of the steps to the given input and output buffers. */
+  void Bind(const std::vector<Value>& inputs, const std::vector<std::shared_ptr<Memory>>& outputs) {
+    for (const auto& binding : input_bindings_) {
+      void* data = Downcast<TensorValue>(inputs[binding.index])->tensor->data;
+      binding.tensor->data = static_cast<uint8_t*>(data) + binding.offset;
+    }
+    for (const auto& binding : output_bindings_) {
+      binding.tensor->data = static_cast<uint8_t*>(outputs[binding.index]->data) + binding.offset;
+    }
+  }
+
+  /*!
+   * \brief Make the return value in the given output buffers, in the same structure as the
+   * return value of the capturing run.
+   */
+  Value MakeReturn(const std::vector<std::shared_ptr<Memory>>& outputs) const {
+    return MapReturn([&](const TensorValue& tv, size_t index) -> Value {
+      const DLTensor* dlt = tv->tensor.operator->();
+      const auto& mem = outputs[index];
+      return TensorValue::Assemble(dlt->device, dlt->dtype,
+                                   common::shape_utils::GetShape<int64_t>(*dlt), {}, mem->data,
+                                   mem);
+    });
+  }
+
+  /*!
+   * \brief Make the return value of the capturing run with new tensors, so that the returned
+   * tensors are not rebound by the later replays.
+   */
+  Value ViewReturn() const {
+    return MapReturn([](const TensorValue& tv, size_t index) -> Value {
+      return tv.CreateView(common::shape_utils::GetShape<int64_t>(*tv->tensor.operator->()));
+    });
+  }
+
+ private:
+  /*! \brief The byte range [begin, end) of a tensor. */
+  using Range = std::pair<const uint8_t*, const uint8_t*>;
+
+  /*! \brief Resolve the output buffers and the bindings. See Finalize. */
+  bool Resolve(const std::vector<Value>& inputs, const Value& ret) {
+    ret_ = ret;
+    std::vector<const DLTensor*> outputs;
+    std::function<bool(const Value&)> collect_outputs = [&](const Value& value) {
+      if (const auto* tv = value.as<TensorValueObj>()) {
+        const DLTensor* dlt = tv->tensor.operator->();
+        if (!common::shape_utils::IsCompact(*dlt) || tv->mem == nullptr) {
+          return false;
+        }
+        outputs.push_back(dlt);
+        return true;
+      } else if (const auto* tuple = value.as<TupleValueObj>()) {
+        return std::all_of(tuple->fields.begin(), tuple->fields.end(), collect_outputs);
+      }
+      return false;
+    };
+    if (!collect_outputs(ret)) {
+      return false;
+    }
+    std::vector<Range> input_ranges, output_ranges;
+    for (const auto& input : inputs) {
+      input_ranges.push_back(GetRange(Downcast<TensorValue>(input)->tensor.operator->()));
+    }
+    for (const auto* output : outputs) {
+      auto range = GetRange(output);
+      for (const auto& other : input_ranges) {
+        if (Overlap(range, other)) {
+          return false;
+        }
+      }
+      for (const auto& other : output_ranges) {
+        if (Overlap(range, other)) {
+          return false;
+        }
+      }
+      output_ranges.push_back(range);
+      output_nbytes_.push_back(range.second - range.first);
+    }
+    // Each output buffer has to be written by a step, or it would be left uninitialized.
+    std::vector<bool> produced(outputs.size(), false);
+    std::unordered_set<DLTensor*> tensors;
+    for (const auto& step : steps_) {
+      std::unordered_set<DLTensor*> step_outputs;
+      CollectTensors(step.output, &step_outputs);
+      for (auto* dlt : step_outputs) {
+        for (size_t j = 0; j < outputs.size(); ++j) {
+          produced[j] = produced[j] || Overlap(GetRange(dlt), output_ranges[j]);
+        }
+      }
+      for (const auto& input : step.inputs) {
+        CollectTensors(input, &tensors);
+      }
+      tensors.insert(step_outputs.begin(), step_outputs.end());
+    }
+    if (!std::all_of(produced.begin(), produced.end(), [](bool p) { return p; })) {
+      return false;
+    }
+    // Returns 1 if the tensor is bound to one of the buffers, 0 if it is outside all of them,
+    // and -1 if it straddles the boundary of a buffer.
+    auto bind = [](DLTensor* dlt, const std::vector<Range>& ranges,
+                   std::vector<Binding>* bindings) {
+      auto range = GetRange(dlt);
+      for (size_t i = 0; i < ranges.size(); ++i) {
+        if (range.first >= ranges[i].first && range.second <= ranges[i].second &&
+            range.first < ranges[i].second) {
+          auto data = static_cast<const uint8_t*>(dlt->data);
+          bindings->push_back({dlt, i, data - ranges[i].first});
+          return 1;
+        }
+        if (Overlap(range, ranges[i])) {
+          return -1;
+        }
+      }
+      return 0;
+    };
+    for (auto* dlt : tensors) {
+      int bound = bind(dlt, input_ranges, &input_bindings_);
+      if (bound == 0) {
+        bound = bind(dlt, output_ranges, &output_bindings_);
+      }
+      if (bound < 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static Range GetRange(const DLTensor* dlt) {
+    auto begin = static_cast<const uint8_t*>(dlt->data) + dlt->byte_offset;
+    int64_t extent = 1;
+    int64_t stride = 1;
+    for (int i = dlt->ndim - 1; i >= 0; --i) {
+      if (dlt->shape[i] == 0) {
+        return {begin, begin};
+      }
+      int64_t dim_stride = dlt->strides != nullptr ? dlt->strides[i] : stride;
+      extent += (dlt->shape[i] - 1) * dim_stride;
+      stride *= dlt->shape[i];
+    }
+    int64_t elem_bytes = (dlt->dtype.bits * dlt->dtype.lanes + 7) / 8;
+    return {begin, begin + extent * elem_bytes};
+  }
+
+  Value MapReturn(const std::function<Value(const TensorValue&, size_t)>& fmap) const {
+    size_t index = 0;
+    std::function<Value(const Value&)> visit = [&](const Value& value) -> Value {
+      if (value.as<TensorValueObj>()) {
+        return fmap(Downcast<TensorValue>(value), index++);
+      }
+      Array<Value> fields;
+      for (const auto& field : Downcast<TupleValue>(value)->fields) {
+        fields.push_back(visit(field));
+      }
+      return TupleValue::make(fields);
+    };
+    return visit(ret_);
+  }
+
+  static bool Overlap(const Range& a, const Range& b) {
+    return a.first < b.second && b.first < a.second;
+  }
+
+  static void CollectTensors(const Value& value, std::unordered_set<DLTensor*>* tensors) {
+    if (const auto* tv = value.as<TensorValueObj>()) {
+      tensors->insert(const_cast<DLTensor*>(tv->tensor.operator->()));
+    } else if (const auto* tuple = value.as<TupleValueObj>()) {
+      for (const auto& field : tuple->fields) {
+        CollectTensors(field, tensors);
+      }
+    }
+  }
+
+  void HoldMemory(const Value& value) {
+    if (const auto* tv = value.as<TensorValueObj>()) {
+      if (tv->mem != nullptr) {
+        mems_.push_back(tv->mem);
+      }
+    } else if (const auto* tuple = value.as<TupleValueObj>()) {
+      for (const auto& field : tuple->fields) {
+        HoldMemory(field);
+      }
+    }
+  }
+
+  /*! \brief The signature of the inputs. */
+  std::vector<int64_t> signature_;
+  /*! \brief Whether the plan can be replayed. */
+  bool replayable_ = false;
+  /*! \brief The recorded steps. */
+  std::vector<Step> steps_;
+  /*! \brief The return value of the capturing run, as the template of the replayed ones. */
+  Value ret_;
+  /*! \brief The tensors bound to the inputs. */
+  std::vector<Binding> input_bindings_;
+  /*! \brief The tensors bound to the outputs. */
+  std::vector<Binding> output_bindings_;
+  /*! \brief The size in bytes of each output buffer. */
+  std::vector<int64_t> output_nbytes_;
+  /*! \brief The memory of the intermediate tensors, which is reused by every replay. */
+  std::vector<std::shared_ptr<Memory>> mems_;
+};
+
 PackedFunc VirtualMachine::GetFunction(const std::string& name,
                                        const ObjectPtr<Object>& sptr_to_self) {
   if (name == "run") {
@@ -331,6 +869,39 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       }
       *rv = PrepareVMContext(func_name, inputs);
     });
+  } else if (name == "precompile") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      VMContext ctx = args[0];
+      int num_threads = args[1];
+      *rv = Precompile(ctx, num_threads);
+    });
+  } else if (name == "enable_instruction_stats") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      bool enable = args[0];
+      EnableInstructionStats(enable);
+    });
+  } else if (name == "enable_inline_cache") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      bool enable = args[0];
+      EnableInlineCache(enable);
+    });
+  } else if (name == "get_instruction_stats") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      *rv = GetInstructionStats();
+    });
+  } else if (name == "get_instruction_stats_table") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      int top = args[0];
+      *rv = GetInstructionStatsTable(top);
+    });
+  } else if (name == "get_cpu_plan_stats") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::lock_guard<std::mutex> lock(cpu_plan_mu_);
+      Map<String, Integer> ret;
+      ret.Set("captures", Integer(num_cpu_plan_captures_));
+      ret.Set("replays", Integer(num_cpu_plan_replays_));
+      *rv = ret;
+    });
   } else {
     LOG(FATAL) << "Unknown packed function: " << name;
     return PackedFunc([sptr_to_self, name](registry::TVMArgs args, registry::TVMRetValue* rv) {});
@@ -340,8 +911,9 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
 void VirtualMachine::LoadExecutable(const Executable* exec) {
   CHECK(exec) << "The executable is not created yet.";
   exec_ = exec;
+  const_pool_ready_ = false;
   for (int i = 0; i < exec_->functions.size(); ++i) {
-    op_env_cache_.push_back(std::make_shared<VMFuncOpEnvCache>());
+    op_env_cache_.push_back(std::make_shared<VMFuncOpEnvCache>(exec_->GetNumInstructions(i)));
   }
 
   tvm::runtime::Module lib = exec_->lib;
@@ -359,6 +931,7 @@ void VirtualMachine::LoadExecutable(const Executable* exec) {
     CHECK(pf != nullptr) << "Cannot find function in module: " << packed_name;
     packed_funcs_[packed_index] = pf;
   }
+  cpu_plan_supported_.clear();
 }
 
 VMContext VirtualMachine::PrepareVMContext(const std::string& func_name,
@@ -366,7 +939,7 @@ VMContext VirtualMachine::PrepareVMContext(const std::string& func_name,
   auto gvit = exec_->global_map.find(func_name);
   CHECK(gvit != exec_->global_map.end()) << "Cannot find function " << func_name;
   auto func_index = gvit->second;
-  const auto& vm_func = exec_->functions[func_index];
+  const auto& vm_func = exec_->GetVMFunction(func_index);
   CHECK_EQ(inputs.size(), vm_func.params.size())
       << "The number of inputs doesn't match the number of parameters for function " << func_name;
 
@@ -413,6 +986,13 @@ VMContext VirtualMachine::PrepareVMContext(const std::string& func_name,
 }
 
 Value VirtualMachine::Run(VMContext ctx) {
+  InitConstPool();
+  if (enable_cpu_plan_ && !dryrun_) {
+    Value ret;
+    if (RunCPUPlan(ctx, &ret)) {
+      return ret;
+    }
+  }
   auto frun = [&]() {
     // ctx->pc will be reset to 0 in the PushFrame
     ctx.PushFrame(ctx->entry_func_index, ctx->inputs, -1);
@@ -442,9 +1022,127 @@ Value VirtualMachine::Run(VMContext ctx) {
     // reset the working stream to default stream.
     OpEnv::SetStreamForAllBackends(devices_[0], nullptr);
   }
+  if (!use_cuda_) {
+    // Ops on CPU streams are asynchronous to the VM, so wait for them before returning the results.
+    utils::WaitCPUStreams(ctx);
+  }
   return ctx->return_register;
 }
 
+bool VirtualMachine::RunCPUPlan(VMContext& ctx, Value* ret) {
+  std::unique_lock<std::mutex> lock(cpu_plan_mu_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    // The plans are in use by a concurrent run, so this run is interpreted.
+    return false;
+  }
+  if (!CPUPlanSupported(ctx->entry_func_index)) {
+    return false;
+  }
+  std::vector<int64_t> signature;
+  if (!CPUPlan::GetSignature(ctx->inputs, &signature)) {
+    return false;
+  }
+  auto& plan = cpu_plans_[ctx->entry_func_index];
+  if (plan != nullptr && plan->signature() == signature) {
+    if (!plan->replayable()) {
+      return false;
+    }
+    *ret = ReplayCPUPlan(ctx, plan.get());
+    num_cpu_plan_replays_++;
+    return true;
+  }
+
+  // Capture a new plan with private views of the inputs, because the plan rebinds the data of
+  // the input tensors in every replay.
+  DLOG(INFO) << "Capture the CPU plan of function " << ctx->entry_func_index;
+  auto new_plan = std::make_shared<CPUPlan>();
+  for (auto& input : ctx->inputs) {
+    auto tv = Downcast<TensorValue>(input);
+    input = tv.CreateView(common::shape_utils::GetShape<int64_t>(*tv->tensor.operator->()));
+  }
+  ctx->cpu_plan = new_plan.get();
+  try {
+    ctx.PushFrame(ctx->entry_func_index, ctx->inputs, -1);
+    RunLoop(ctx);
+  } catch (...) {
+    ctx->cpu_plan = nullptr;
+    throw;
+  }
+  ctx->cpu_plan = nullptr;
+  plan = new_plan;
+  num_cpu_plan_captures_++;
+  if (plan->Finalize(signature, ctx->inputs, ctx->return_register)) {
+    // Likewise, return new tensors because the plan rebinds the output tensors of the steps.
+    *ret = plan->ViewReturn();
+  } else {
+    DLOG(INFO) << "The CPU plan of function " << ctx->entry_func_index << " is not replayable";
+    *ret = ctx->return_register;
+  }
+  return true;
+}
+
+bool VirtualMachine::CPUPlanSupported(Index func_index) {
+  auto it = cpu_plan_supported_.find(func_index);
+  if (it != cpu_plan_supported_.end()) {
+    return it->second;
+  }
+  // A CPU plan replays a fixed sequence of OpEnvs, so it is only captured for the functions
+  // without control flow, dynamic shapes or multiple streams, including the functions they call.
+  bool supported = true;
+  std::vector<Index> stack{func_index};
+  std::unordered_set<Index> visited{func_index};
+  while (supported && !stack.empty()) {
+    const auto& func = exec_->GetVMFunction(stack.back());
+    stack.pop_back();
+    for (const auto& instr : func.instructions) {
+      Index callee = -1;
+      switch (instr.op) {
+        case Opcode::InvokeFunc:
+          callee = instr.invoke_func.func_index;
+          break;
+        case Opcode::AllocClosure:
+          callee = instr.alloc_closure.func_index;
+          break;
+        case Opcode::Move:
+        case Opcode::Ret:
+        case Opcode::LoadConst:
+        case Opcode::LoadConsti:
+        case Opcode::GetField:
+        case Opcode::Goto:
+        case Opcode::AllocStorage:
+        case Opcode::AllocTensor:
+        case Opcode::AllocTuple:
+        case Opcode::Free:
+        case Opcode::InvokeClosure:
+        case Opcode::InvokeJit:
+          break;
+        default:
+          supported = false;
+      }
+      if (callee >= 0 && visited.insert(callee).second) {
+        stack.push_back(callee);
+      }
+    }
+  }
+  cpu_plan_supported_[func_index] = supported;
+  return supported;
+}
+
+Value VirtualMachine::ReplayCPUPlan(const VMContext& ctx, CPUPlan* plan) {
+  std::vector<std::shared_ptr<Memory>> outputs;
+  for (int64_t nbytes : plan->output_nbytes()) {
+    outputs.push_back(memory_pool::Memory::Alloc(devices_[0], nbytes));
+  }
+  plan->Bind(ctx->inputs, outputs);
+  for (const auto& step : plan->steps()) {
+    std::vector<std::shared_ptr<Memory>> workspace;
+    auto binding = BindWorkspace(ctx, step.op_env, &workspace);
+    WITH_BASE_PROFILER(devices_[0], step.op_env->name(), "ComputationOperator", {step.key},
+                       { step.op_env->Execute(step.inputs, step.output); });
+  }
+  return plan->MakeReturn(outputs);
+}
+
 Array<FloatValue> VirtualMachine::Profile(VMContext ctx, int warmup, int number, int repeat) {
   Array<FloatValue> results;
   Device device = devices_[0];
@@ -454,13 +1152,18 @@ Array<FloatValue> VirtualMachine::Profile(VMContext ctx, int warmup, int number,
   for (int i = 0; i < warmup; ++i) {
     Run(ctx);
   }
+  // Run waits for the CPU streams of its own context, so only CUDA needs the device barrier.
   for (int i = 0; i < repeat; i++) {
-    api->WaitDevice(device);
+    if (use_cuda_) {
+      api->WaitDevice(device);
+    }
     auto beg = raf::profiler::ProfileStat::NowInMicrosec();
     for (int j = 0; j < number; ++j) {
       Run(ctx);
     }
-    api->WaitDevice(device);
+    if (use_cuda_) {
+      api->WaitDevice(device);
+    }
     auto end = raf::profiler::ProfileStat::NowInMicrosec();
     auto latency = static_cast<float>(static_cast<double>(end - beg) / number / 1000.0);
     results.push_back(FloatValue::make(DataType::Float(32), latency));
@@ -468,6 +1171,161 @@ Array<FloatValue> VirtualMachine::Profile(VMContext ctx, int warmup, int number,
   return results;
 }
 
+int VirtualMachine::Precompile(VMContext ctx, int num_threads) {
+  InitConstPool();
+  // Walk the function to collect the OpEnvs that miss the cache, without executing kernels.
+  std::vector<PrecompileTask> tasks;
+  ctx->precompile_tasks = &tasks;
+  ctx->precompile_unknown.clear();
+  try {
+    ctx.PushFrame(ctx->entry_func_index, ctx->inputs, -1);
+    RunLoop(ctx);
+  } catch (const utils::PrecompileStop&) {
+    // Keep the OpEnvs collected so far, whose inputs are all statically known.
+    while (!ctx->frames.empty()) {
+      ctx.PopFrame();
+    }
+  } catch (...) {
+    ctx->precompile_tasks = nullptr;
+    ctx->precompile_unknown.clear();
+    throw;
+  }
+  ctx->precompile_tasks = nullptr;
+  ctx->precompile_unknown.clear();
+
+  // An instruction may be visited multiple times with the same key. Besides, the instructions
+  // with the same callee and key share a kernel in the build cache, so only the first one of
+  // them is built in the first wave, and the others reuse the built kernel in the second wave.
+  std::vector<PrecompileTask> waves[2];
+  std::unordered_set<std::string> visited_instrs, visited_kernels;
+  for (auto& task : tasks) {
+    std::ostringstream instr_key;
+    instr_key << task.func_index << "@" << task.pc << "@" << task.key;
+    if (!visited_instrs.insert(instr_key.str()).second) {
+      continue;
+    }
+    std::ostringstream kernel_key;
+    if (const auto* op = task.call->callee.as<OpValueObj>()) {
+      kernel_key << op->op->name;
+    } else {
+      kernel_key << tvm::StructuralHash()(Downcast<ClosureValue>(task.call->callee)->func);
+    }
+    kernel_key << "@" << task.key;
+    int wave = visited_kernels.insert(kernel_key.str()).second ? 0 : 1;
+    waves[wave].push_back(std::move(task));
+  }
+
+  if (num_threads <= 0) {
+    num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  // Builds depend on the configs of the current PassContext, so the workers enter it as well.
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  int num_built = 0;
+  for (auto& wave : waves) {
+    std::vector<OpEnvPtr> op_envs(wave.size());
+    std::atomic<size_t> next{0};
+    std::mutex error_mu;
+    std::exception_ptr error;
+    auto worker = [&]() {
+      tvm::With<tvm::transform::PassContext> ctx_scope(pass_ctx);
+      for (size_t i = next++; i < wave.size(); i = next++) {
+        try {
+          op_envs[i] = BuildOpEnv(wave[i].call);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mu);
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+      }
+    };
+    std::vector<std::thread> workers;
+    int num_workers = std::min(num_threads, static_cast<int>(wave.size()));
+    for (int i = 1; i < num_workers; ++i) {
+      workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+      thread.join();
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    // The requests bind resources in the context, so they are initialized sequentially.
+    for (size_t i = 0; i < wave.size(); ++i) {
+      InitOpEnvRequests(ctx, op_envs[i]);
+      op_env_cache_[wave[i].func_index]->Get(wave[i].pc)->Set(wave[i].key, op_envs[i]);
+    }
+    num_built += wave.size();
+  }
+  return num_built;
+}
+
+void VirtualMachine::EnableInstructionStats(bool enable) {
+  CHECK(exec_) << "The executable is not loaded yet.";
+  std::atomic_store(&instr_stats_,
+                    enable ? std::make_shared<InstructionStats>(exec_) : nullptr);
+}
+
+void VirtualMachine::EnableInlineCache(bool enable) {
+  enable_inline_cache_.store(enable, std::memory_order_relaxed);
+}
+
+std::string VirtualMachine::GetInstructionStats() {
+  auto stats = std::atomic_load(&instr_stats_);
+  return stats != nullptr ? stats->GetJSON() : "";
+}
+
+std::string VirtualMachine::GetInstructionStatsTable(int top) {
+  auto stats = std::atomic_load(&instr_stats_);
+  return stats != nullptr ? stats->GetTable(top) : "";
+}
+
+void VirtualMachine::InitConstPool() {
+  if (const_pool_ready_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(const_pool_mu_);
+  if (const_pool_ready_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  CHECK(!devices_.empty()) << "Devices have not been initialized yet.";
+  const_pool_.assign(exec_->constants.size(), Value());
+  const_pool_once_.reset(new std::once_flag[exec_->constants.size()]);
+  const_pool_ready_.store(true, std::memory_order_release);
+}
+
+op::WorkspaceBinding VirtualMachine::BindWorkspace(const VMContext& ctx, const OpEnvPtr& op_env,
+                                                   std::vector<std::shared_ptr<Memory>>* memory) {
+  std::shared_ptr<Requests> requests = op_env->GetRequests();
+  if (requests->workspace.empty()) {
+    return op::WorkspaceBinding();
+  }
+  std::vector<void*> workspace;
+  if (!use_cuda_) {
+    // Kernels on CPU are executed synchronously, so the workspace of all requests is carved out
+    // of one buffer owned by the current thread.
+    int64_t total_nbytes = 0;
+    for (const auto& entry : requests->workspace) {
+      total_nbytes += utils::RoundUpWorkspace(entry.nbytes);
+    }
+    auto* data = static_cast<uint8_t*>(utils::GetThreadLocalWorkspace(devices_[0], total_nbytes));
+    for (const auto& entry : requests->workspace) {
+      workspace.push_back(data);
+      data += utils::RoundUpWorkspace(entry.nbytes);
+    }
+  } else {
+    // TODO(yaoyaoding): It seems that we can not release the workspace once we launched the
+    //   kernel. Because the kernel may be in the executing status at this point due to
+    //   asynchronous execution. This would cause problem for multi-stream execution.
+    for (const auto& entry : requests->workspace) {
+      memory->push_back(Alloc(ctx, entry.device, entry.nbytes));
+      workspace.push_back(memory->back()->data);
+    }
+  }
+  return op::WorkspaceBinding(std::move(workspace));
+}
+
 Device VirtualMachine::GetParamsDevice() const {
   CHECK(!devices_.empty()) << "Devices have not been initialized yet.";
 
@@ -484,6 +1342,7 @@ Device VirtualMachine::GetParamsDevice() const {
 
 void VirtualMachine::SetDevices(const std::vector<Device>& devices) {
   devices_ = devices;
+  const_pool_ready_ = false;
   host_device_ = Device(DevType::kCPU(), 0);
   use_cuda_ = false;
   for (const Device& dev : devices) {
@@ -493,6 +1352,8 @@ void VirtualMachine::SetDevices(const std::vector<Device>& devices) {
   }
   if (!use_cuda_) {
     enable_cuda_graph_ = false;
+  } else {
+    enable_cpu_plan_ = false;
   }
 }
 
@@ -505,7 +1366,8 @@ inline std::shared_ptr<Memory> VirtualMachine::Alloc(const VMContext& ctx, Devic
       // We can not use async memory allocation in cuda graph tracing mode
       return memory_pool::Memory::Alloc(dev, nbytes, alignment);
     } else {
-      auto stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id);
+      auto stream = utils::GetStreamById(ctx, DevType::kCUDA(), ctx->current_device_id,
+                                         ctx->current_stream_id);
       return memory_pool::Memory::AllocAsync(dev, nbytes, stream->data(), alignment);
     }
 #else
@@ -528,9 +1390,23 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
   ctx->current_device_id = 0;
   ctx->current_stream_id = 0;
   ctx->current_barrier_event_index = 0;
+  // The latency of an instruction is measured until the dispatch of the next instruction.
+  ctx->stats = std::atomic_load(&instr_stats_);
+  InstructionStats* stats = ctx->stats.get();
+  InstructionStats::Counter* last_counter = nullptr;
+  std::chrono::steady_clock::time_point last_time;
   while (true) {
   main_loop:
     auto const& instr = ctx->code[ctx->pc];
+    if (stats != nullptr) {
+      auto now = std::chrono::steady_clock::now();
+      if (last_counter != nullptr) {
+        last_counter->Record(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_time).count());
+      }
+      last_counter = stats->Get(ctx->func_index, ctx->pc);
+      last_time = now;
+    }
     switch (instr.op) {
       case Opcode::Move: {
         WITH_BASE_PROFILER_LEVEL(2, host_device_, "Move", "VMInstruction", {},
@@ -627,6 +1503,11 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
         WITH_BASE_PROFILER_LEVEL(2, host_device_, "Ret", "VMInstruction", {},
                                  { final_ret = HandleRet(ctx, instr); });
         if (final_ret) {
+          if (last_counter != nullptr) {
+            last_counter->Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - last_time)
+                                     .count());
+          }
           return;
         }
         goto main_loop;
@@ -662,19 +1543,14 @@ void VirtualMachine::HandleMove(VMContext& ctx, const Instruction& instr) {
 }
 
 void VirtualMachine::HandleLoadConst(VMContext& ctx, const Instruction& instr) {
-  auto constant_obj = exec_->constants[instr.const_index];
-  // We cache the allocated object in the constant pool. To measure, the
-  // first iteration will set the pool up. The other iterations will
-  // directly reuse the allocated objects.
-  if (const_pool_.size() <= static_cast<size_t>(instr.const_index)) {
-    const_pool_.resize(instr.const_index + 1);
-  }
-
-  if (!const_pool_[instr.const_index].defined()) {
+  // A constant is copied to the device on its first load, so that the constants of the functions
+  // never invoked are neither deserialized nor copied. Concurrent runs wait for the first copy.
+  Index const_index = instr.const_index;
+  std::call_once(const_pool_once_[const_index], [this, const_index]() {
     // TODO(@zhiics): device could be obtained from the device list.
-    const_pool_[instr.const_index] = CopyTo(constant_obj, devices_[0]);
-  }
-  ctx.WriteRegister(instr.dst, const_pool_[instr.const_index]);
+    const_pool_[const_index] = CopyTo(exec_->GetConstant(const_index), devices_[0]);
+  });
+  ctx.WriteRegister(instr.dst, const_pool_[const_index]);
   ctx->frames.back().is_const[instr.dst] = true;
   ctx->pc++;
 }
@@ -693,6 +1569,11 @@ void VirtualMachine::HandleGetField(VMContext& ctx, const Instruction& instr) {
 }
 
 void VirtualMachine::HandleIf(VMContext& ctx, const Instruction& instr) {
+  if (ctx->precompile_tasks != nullptr &&
+      utils::IsPrecompileUnknown(ctx, ctx.ReadRegister(instr.if_op.test))) {
+    throw utils::PrecompileStop();
+  }
+  utils::WaitCPUProducers(ctx, ctx.ReadRegister(instr.if_op.test));
   int32_t test_val = ctx.LoadTensorInt(instr.if_op.test);
   int32_t target_val = ctx.LoadScalarInt(instr.if_op.target);
 
@@ -715,8 +1596,45 @@ void VirtualMachine::HandleAllocStorage(VMContext& ctx, const Instruction& instr
              << " alloc_async=" << alloc_async;
 
   auto dev = Device(instr.alloc_storage.device_type, instr.alloc_storage.device_id);
-  auto buffer = Alloc(ctx, dev, size, alignment, alloc_async);
+  std::unique_ptr<memory_profiler::AllocationSiteScope> alloc_site;
+  if (memory_profiler::MemoryProfiler::Get()->IsRecordingEvents()) {
+    alloc_site = std::make_unique<memory_profiler::AllocationSiteScope>(
+        memory_profiler::AllocationSite{ctx->exec->functions[ctx->func_index].name, ctx->pc,
+                                        "AllocStorage"});
+  }
+  std::shared_ptr<Memory> buffer;
+  Index arena_offset = instr.alloc_storage.arena_offset;
+  if (arena_offset >= 0) {
+    // The storage is planned into the static memory arena of the current invocation. Each
+    // frame owns its arena, so recursive or re-entrant invocations do not overwrite each other.
+    const auto& func = ctx->exec->functions[ctx->func_index];
+    CHECK_LE(arena_offset + size, func.arena_size)
+        << "Storage at offset " << arena_offset << " with size " << size
+        << " exceeds the static arena of " << func.name;
+    auto& arena = ctx->frames.back().arena;
+    if (arena == nullptr) {
+      // Reuse the arena of a returned invocation if none of its storages is still alive, so no
+      // memory pool call is made here after the first invocation.
+      auto& cached = ctx->arenas[ctx->func_index];
+      if (cached != nullptr && cached.use_count() == 1) {
+        arena = std::move(cached);
+      } else {
+        arena = memory_pool::Memory::Alloc(dev, func.arena_size, func.arena_alignment);
+      }
+    }
+    buffer = std::make_shared<utils::ArenaMemory>(arena, arena_offset);
+  } else {
+    buffer = Alloc(ctx, dev, size, alignment, alloc_async);
+  }
+  if (ctx->stats != nullptr) {
+    ctx->stats->Get(ctx->func_index, ctx->pc)
+        ->alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+  }
   auto storage = StorageValue::make(buffer);
+  if (ctx->cpu_plan != nullptr) {
+    // The tensors that do not own their storage are not held by the steps.
+    ctx->cpu_plan->Hold(buffer);
+  }
   ctx.WriteRegister(instr.dst, storage);
   ctx->pc++;
 }
@@ -783,12 +1701,12 @@ void VirtualMachine::HandleFree(VMContext& ctx, const Instruction& instr) {
   auto reg_val = ctx.ReadRegister(reg);
   if (reg_val->IsInstance<StorageValueObj>()) {
     auto storage_val = Downcast<StorageValue>(reg_val);
-    storage_val->buffer.reset();
+    utils::ReleaseAfterCPUStreams(ctx, &storage_val->buffer);
   } else {
     CHECK(reg_val->IsInstance<TensorValueObj>())
         << "Expected StorageValue or TensorValue, but got " << reg_val->GetTypeKey();
     auto tensor_val = Downcast<TensorValue>(reg_val);
-    tensor_val->mem.reset();
+    utils::ReleaseAfterCPUStreams(ctx, &tensor_val->mem);
   }
   ctx->pc++;
 }
@@ -815,46 +1733,121 @@ void VirtualMachine::HandleInvokeClosure(VMContext& ctx, const Instruction& inst
 
 void VirtualMachine::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
   OpEnvPtr op_env;
-  std::vector<Value> inputs;
+  std::vector<Value>& inputs = ctx->jit_inputs;
   Value output;
-  std::string op_env_cache_key;
-
-  std::tie(op_env, inputs, output, op_env_cache_key) = PrepareOpEnv(ctx, instr);
+  OpEnvCacheEntryPtr cache_entry;
+
+  std::tie(op_env, output, cache_entry) = PrepareOpEnv(ctx, instr, &inputs);
+  if (ctx->precompile_tasks != nullptr) {
+    // Only collect the OpEnvs to build when walking the function in Precompile.
+    inputs.clear();
+    ctx->pc++;
+    return;
+  }
+  if (ctx->stats != nullptr) {
+    auto* counter = ctx->stats->Get(ctx->func_index, ctx->pc);
+    if (counter->op_name.load(std::memory_order_relaxed) == nullptr) {
+      ctx->stats->SetOpName(counter, op_env->name());
+    }
+    int64_t workspace_nbytes = 0;
+    for (const auto& entry : op_env->GetRequests()->workspace) {
+      workspace_nbytes += entry.nbytes;
+    }
+    counter->workspace_bytes.fetch_add(workspace_nbytes, std::memory_order_relaxed);
+  }
+  if (!use_cuda_ && !ctx->streams.empty() && !dryrun_) {
+    // The op is scheduled to a CPU stream, so it runs on the worker thread of the stream.
+    LaunchOnCPUStream(ctx, op_env, inputs, output, cache_entry->key);
+    // Do not hold the inputs, so that the Free instructions can release them.
+    inputs.clear();
+    ctx->pc++;
+    return;
+  }
+  std::unique_ptr<memory_profiler::AllocationSiteScope> alloc_site;
+  if (memory_profiler::MemoryProfiler::Get()->IsRecordingEvents()) {
+    // Attribute the workspace and the memory allocated by the op to the instruction.
+    alloc_site = std::make_unique<memory_profiler::AllocationSiteScope>(
+        memory_profiler::AllocationSite{ctx->exec->functions[ctx->func_index].name, ctx->pc,
+                                        op_env->name()});
+  }
+  std::vector<std::shared_ptr<Memory>> workspace;
+  auto binding = BindWorkspace(ctx, op_env, &workspace);
   if (!dryrun_) {  // Skip the execution in dryrun mode
 #ifdef RAF_USE_CUDA
     if (use_cuda_) {
       WITH_CUDA_PROFILER(
           devices_[0],
-          utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data(),
-          op_env->name(), utils::GetStreamName(ctx->current_stream_id), {op_env_cache_key},
+          utils::GetStreamById(ctx, DevType::kCUDA(), ctx->current_device_id,
+                               ctx->current_stream_id)
+              ->data(),
+          op_env->name(), utils::GetStreamName(ctx->current_stream_id), {cache_entry->key},
           { op_env->Execute(inputs, output); });
     } else
 #endif
     {  // cpu
-      WITH_BASE_PROFILER(devices_[0], op_env->name(), "ComputationOperator", {op_env_cache_key},
+      WITH_BASE_PROFILER(devices_[0], op_env->name(), "ComputationOperator", {cache_entry->key},
                          { op_env->Execute(inputs, output); });
+      if (ctx->cpu_plan != nullptr) {
+        ctx->cpu_plan->Record(op_env, inputs, output, cache_entry->key);
+      }
     }
   }
   PROFILE_MEMORY(devices_[0], op_env->name());
+  inputs.clear();
+  ctx->pc++;
+}
 
-  // Release workspace memory.
-  // TODO(yaoyaoding): It seems that we can not release the workspace once we launched the
-  //   kernel. Because the kernel may be in the executing status at this point due to
-  //   asynchronous execution. This would cause problem for multi-stream execution.
-  std::shared_ptr<Requests> requests = op_env->GetRequests();
-  for (size_t i = 0; i < requests->workspace.size(); ++i) {
-    Requests::WorkspaceRequest& entry = requests->workspace[i];
-    if (entry.nbytes > 0 && entry.memory != nullptr) {
-      *entry.dest = nullptr;
-      entry.memory.reset();
+void VirtualMachine::LaunchOnCPUStream(const VMContext& ctx, const OpEnvPtr& op_env,
+                                       const std::vector<Value>& inputs, const Value& output,
+                                       const std::string& key) {
+  // The task holds the memory of the tensors that own it. The storage of planned tensors is kept
+  // alive by the Free instructions, which release it only after the pending tasks.
+  std::vector<std::shared_ptr<Memory>> mems;
+  std::function<void(const Value&)> collect_mem = [&](const Value& value) {
+    if (const auto* tensor = value.as<TensorValueObj>()) {
+      mems.push_back(tensor->mem);
+    } else if (const auto* tuple = value.as<TupleValueObj>()) {
+      for (const auto& field : tuple->fields) {
+        collect_mem(field);
+      }
     }
+  };
+  for (const auto& input : inputs) {
+    collect_mem(input);
   }
-  ctx->pc++;
+  collect_mem(output);
+  auto stream = utils::GetStreamById(ctx, DevType::kCPU(), ctx->current_device_id,
+                                     ctx->current_stream_id);
+  std::function<void(const Value&)> record_producer = [&](const Value& value) {
+    if (const auto* tuple = value.as<TupleValueObj>()) {
+      for (const auto& field : tuple->fields) {
+        record_producer(field);
+      }
+    } else if (value.as<TensorValueObj>()) {
+      DLTensor* tensor = Downcast<TensorValue>(value);
+      ctx->cpu_stream_producers[tensor->data] = stream;
+    }
+  };
+  record_producer(output);
+  // The task does not hold the context, which owns the stream and joins its worker when destroyed.
+  auto task = [this, op_env, inputs, output, key, mems]() {
+    // The workspace is bound on the worker thread, which owns the thread-local workspace buffer.
+    // The CPU workspace does not come from the context.
+    std::vector<std::shared_ptr<Memory>> workspace;
+    auto binding = BindWorkspace(VMContext(), op_env, &workspace);
+    WITH_BASE_PROFILER(devices_[0], op_env->name(), "ComputationOperator", {key},
+                       { op_env->Execute(inputs, output); });
+  };
+  DeviceAPI::Get(DevType::kCPU())->LaunchOnStream(stream->data(), std::move(task));
 }
 
 void VirtualMachine::HandleSetShape(VMContext& ctx, const Instruction& instr) {
   auto data = Downcast<TensorValue>(ctx.ReadRegister(instr.set_shape.data));
   auto raw_shape = ctx.ReadRegister(instr.set_shape.shape);
+  if (ctx->precompile_tasks != nullptr && utils::IsPrecompileUnknown(ctx, raw_shape)) {
+    throw utils::PrecompileStop();
+  }
+  utils::WaitCPUProducers(ctx, raw_shape);
   std::vector<int64_t> shape;
   if (const auto tuple = raw_shape.as<TupleValueObj>()) {
     for (size_t i = 0; i < tuple->fields.size(); ++i) {
@@ -886,6 +1879,11 @@ void VirtualMachine::HandleInferType(VMContext& ctx, const Instruction& instr) {
   Array<Value> args;
   for (Index i = 0; i < instr.infer_type.num_args; i++) {
     args.push_back(ctx.ReadRegister(instr.infer_type.args[i]));
+    // The type inference of an op may read the contents of its arguments, e.g., a shape tensor.
+    if (ctx->precompile_tasks != nullptr && utils::IsPrecompileUnknown(ctx, args.back())) {
+      throw utils::PrecompileStop();
+    }
+    utils::WaitCPUProducers(ctx, args.back());
   }
   // infer type
   const Value& callee = ctx.ReadRegister(instr.infer_type.op_reg);
@@ -935,9 +1933,11 @@ void VirtualMachine::HandleInferType(VMContext& ctx, const Instruction& instr) {
 void VirtualMachine::HandleCudaSetStream(VMContext& ctx, const Instruction& instr) {
   Index device_id = instr.cuda_set_stream.device_id;
   Index stream_id = instr.cuda_set_stream.stream_id;
-  Device device(DevType::kCUDA(), static_cast<int>(device_id));
-  auto stream = utils::GetStreamById(ctx, device_id, stream_id);
-  OpEnv::SetStreamForAllBackends(device, stream->data());
+  Device device(devices_[0].device_type(), static_cast<int>(device_id));
+  auto stream = utils::GetStreamById(ctx, device.device_type(), device_id, stream_id);
+  if (use_cuda_) {
+    OpEnv::SetStreamForAllBackends(device, stream->data());
+  }
   ctx->current_device_id = device_id;
   ctx->current_stream_id = stream_id;
   ctx->pc++;
@@ -950,10 +1950,10 @@ void VirtualMachine::HandleCudaAddEvent(VMContext& ctx, const Instruction& instr
     stream_id = ctx->current_stream_id;
   }
   Index event_id = instr.cuda_event.event_id;
-  auto event = utils::GetEventById(ctx, device_id, event_id);
-  auto stream = utils::GetStreamById(ctx, device_id, stream_id);
-  auto api = DeviceAPI::Get(DevType::kCUDA());
-  Device device(DevType::kCUDA(), static_cast<int>(device_id));
+  DevType device_type = devices_[0].device_type();
+  auto event = utils::GetEventById(ctx, device_type, device_id, event_id);
+  auto stream = utils::GetStreamById(ctx, device_type, device_id, stream_id);
+  auto api = DeviceAPI::Get(device_type);
   api->EventRecordOnStream(event->data(), stream->data());
   ctx->pc++;
 }
@@ -965,21 +1965,29 @@ void VirtualMachine::HandleCudaWaitEvent(VMContext& ctx, const Instruction& inst
     stream_id = ctx->current_stream_id;
   }
   Index event_id = instr.cuda_event.event_id;
-  auto event = utils::GetEventById(ctx, device_id, event_id);
-  auto stream = utils::GetStreamById(ctx, device_id, stream_id);
-  auto api = DeviceAPI::Get(DevType::kCUDA());
+  DevType device_type = devices_[0].device_type();
+  auto event = utils::GetEventById(ctx, device_type, device_id, event_id);
+  auto stream = utils::GetStreamById(ctx, device_type, device_id, stream_id);
+  auto api = DeviceAPI::Get(device_type);
   api->StreamWaitEvent(stream->data(), event->data());
   ctx->pc++;
 }
 
 void VirtualMachine::HandleCudaStreamBarrier(VMContext& ctx, const Instruction& instr) {
+  if (!use_cuda_) {
+    // A barrier on the null stream would wait for the CPU streams of all contexts, so only wait
+    // for the streams of this context.
+    utils::WaitCPUStreams(ctx);
+    ctx->pc++;
+    return;
+  }
   if (ctx->current_barrier_event_index >= ctx->barrier_events.size()) {
-    Device device(DevType::kCUDA(), static_cast<int>(ctx->current_device_id));
+    Device device(devices_[0].device_type(), static_cast<int>(ctx->current_device_id));
     ctx->barrier_events.resize(ctx->current_barrier_event_index + 1);
     ctx->barrier_events[ctx->current_barrier_event_index] =
         EventPool::Get(device)->GetEvent(0x02 /*cudaEventDisableTiming*/);
   }
-  auto api = DeviceAPI::Get(DevType::kCUDA());
+  auto api = DeviceAPI::Get(devices_[0].device_type());
   /*
    * We implement the cuda stream barrier by recording an event on the default stream. See also
    * the cudaEventRecord API in
@@ -995,11 +2003,70 @@ void VirtualMachine::HandleCudaStreamBarrier(VMContext& ctx, const Instruction&
   ctx->pc++;
 }
 
-std::tuple<std::shared_ptr<OpEnv>, std::vector<Value>, Value, std::string>
-VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
+std::tuple<std::shared_ptr<OpEnv>, Value, OpEnvCacheEntryPtr> VirtualMachine::PrepareOpEnv(
+    const VMContext& ctx, const Instruction& instr, std::vector<Value>* inputs) {
+  inputs->clear();
   Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
-  Array<Value> args;
+
+  // extract the output
   Value output;
+  if (instr.invoke_jit.output_size == 1) {
+    output = ctx.ReadRegister(instr.invoke_jit.args[num_inputs]);
+  } else {
+    Array<Value> outs;
+    for (Index i = num_inputs; i < instr.invoke_jit.arity; i++) {
+      outs.push_back(ctx.ReadRegister(instr.invoke_jit.args[i]));
+    }
+    output = TupleValue::make(outs);
+  }
+  if (ctx->precompile_tasks != nullptr) {
+    // The kernel is not run in the walk of Precompile, so the outputs are not computed.
+    for (Index i = num_inputs; i < instr.invoke_jit.arity; i++) {
+      ctx->precompile_unknown.insert(ctx.ReadRegister(instr.invoke_jit.args[i]));
+    }
+    // Skip the instructions with uninitialized inputs instead of building from garbage.
+    for (Index i = 0; i < num_inputs; i++) {
+      if (!ctx.ReadRegister(instr.invoke_jit.args[i]).defined()) {
+        return std::make_tuple(OpEnvPtr(), std::move(output), OpEnvCacheEntryPtr());
+      }
+    }
+  }
+
+  // Fast path: the registers have the same shapes and dtypes as the last invocation of this
+  // instruction, so we reuse its OpEnv without building the cache key.
+  const auto& func_op_env_cache = op_env_cache_[ctx->func_index];
+  OpEnvCacheEntryPtr cache_entry = enable_inline_cache_.load(std::memory_order_relaxed)
+                                       ? func_op_env_cache->GetInline(ctx->pc)
+                                       : nullptr;
+  if (cache_entry != nullptr) {
+    utils::FingerprintMatcher matcher{cache_entry->fingerprint};
+    if (!utils::FingerprintInvokeJit(ctx, instr, &matcher) || !matcher.Done()) {
+      cache_entry = nullptr;
+    } else if (ctx->stats != nullptr) {
+      ctx->stats->Get(ctx->func_index, ctx->pc)
+          ->inline_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  if (cache_entry == nullptr) {
+    cache_entry = LookupOpEnv(ctx, instr, output);
+  }
+  OpEnvPtr op_env = cache_entry->op_env;
+  if (op_env == nullptr) {
+    // The OpEnv has been collected by Precompile and is not built yet.
+    return std::make_tuple(op_env, std::move(output), std::move(cache_entry));
+  }
+
+  for (int i : op_env->arg_indices) {
+    CHECK_GE(i, 0) << "Invalid input index: " << i;
+    inputs->push_back(ctx.ReadRegister(instr.invoke_jit.args[i]));
+  }
+  return std::make_tuple(op_env, std::move(output), std::move(cache_entry));
+}
+
+OpEnvCacheEntryPtr VirtualMachine::LookupOpEnv(const VMContext& ctx, const Instruction& instr,
+                                               const Value& output) {
+  Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
+  Array<Value> args;
 
   // extract the input args and prepare the hash key to query op env
   std::ostringstream os;
@@ -1029,37 +2096,38 @@ VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
     os << ",";
   }
 
-  // extract the output
+  // the output
   os << "|";
   if (instr.invoke_jit.output_size == 1) {
-    output = ctx.ReadRegister(instr.invoke_jit.args[num_inputs]);
     utils::TensorRepr(os, output.as<TensorValueObj>());
   } else {
     os << "(";
-    Array<Value> outs;
-    for (Index i = num_inputs; i < instr.invoke_jit.arity; i++) {
-      Value val = ctx.ReadRegister(instr.invoke_jit.args[i]);
-      outs.push_back(val);
+    for (const auto& val : Downcast<TupleValue>(output)->fields) {
       utils::TensorRepr(os, val.as<TensorValueObj>());
       os << ",";
     }
     os << ")";
-    output = TupleValue::make(outs);
   }
-  std::string op_env_cache_key = os.str();
+  auto cache_entry = std::make_shared<OpEnvCacheEntry>();
+  cache_entry->key = os.str();
 
   // check the OpEnv cache
-  std::shared_ptr<OpEnv> op_env;
   auto op_env_cache = op_env_cache_[ctx->func_index]->Get(ctx->pc);
-  if (auto p = op_env_cache->Get(op_env_cache_key)) {
+  auto p = op_env_cache->Get(cache_entry->key);
+  std::unique_lock<std::mutex> build_lock;
+  if (p == nullptr) {
+    // Concurrent contexts that miss the same key wait for a single OpEnv to be built.
+    build_lock = std::unique_lock<std::mutex>(op_env_build_mu_);
+    p = op_env_cache->Get(cache_entry->key);
+  }
+  if (p != nullptr) {
     // Cache hit. Reuse the OpEnv from the cache.
-    op_env = *p;
+    cache_entry->op_env = *p;
   } else {
     // Create a new OpEnv.
     auto call_values = CallValues::make();
     Value callee = ctx.ReadRegister(instr.invoke_jit.op_reg);
     const auto* op = callee.as<OpValueObj>();
-    const auto* closure = callee.as<ClosureValueObj>();
     call_values->callee = callee;
     if (op) {
       call_values->args = GetOpAttr<FRAFSchema>(op->op, "FRAFSchema")(args);
@@ -1068,51 +2136,60 @@ VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
     }
     call_values->device = devices_[0];
     call_values->out = output;
-    op_env = Dispatch(call_values);
-    CHECK(op_env != nullptr) << "ValueError: Cannot dispatch "
-                             << (op ? op->op->name : PrettyPrint(closure->func)) << " @"
-                             << call_values->device.c_str();
-    std::shared_ptr<Requests> requests = op_env->GetRequests();
-    // prepare distributed requests
-    for (size_t i = 0; i < requests->distributed.size(); i++) {
-      Requests::DistributedRequest& entry = requests->distributed[i];
-      *entry.dest = (void*)(Communicator::Get(entry.name, entry.rank_list).as<CommunicatorObj>());
-    }
-#ifdef RAF_USE_CUDA
-    // prepare cuda stream requests
-    for (size_t i = 0; i < requests->stream.size(); i++) {
-      Requests::StreamRequest& entry = requests->stream[i];
-      // currently ignores the stream_idx field in requests, all requests with the same tag_idx will
-      // get the same cuda stream in vm
-      std::shared_ptr<Stream> stream =
-          utils::GetStreamById(ctx, entry.device.device_id(), entry.tag_idx);
-      *entry.dest = stream->data();
-      entry.stream = stream;
+    if (ctx->precompile_tasks != nullptr) {
+      // Leave the OpEnv to be built in parallel by Precompile.
+      ctx->precompile_tasks->push_back({ctx->func_index, ctx->pc, cache_entry->key, call_values});
+      return cache_entry;
     }
-#endif
+    auto op_env = BuildOpEnv(call_values);
+    InitOpEnvRequests(ctx, op_env);
     // add to cache
-    op_env_cache->Set(op_env_cache_key, op_env);
+    op_env_cache->Set(cache_entry->key, op_env);
+    cache_entry->op_env = op_env;
   }
 
-  std::shared_ptr<Requests> requests = op_env->GetRequests();
-  for (size_t i = 0; i < requests->workspace.size(); i++) {
-    Requests::WorkspaceRequest& entry = requests->workspace[i];
-    auto buf = Alloc(ctx, entry.device, entry.nbytes);
-    entry.memory = buf;
-    *entry.dest = buf->data;
+  // Remember this entry in the inline cache if all registers can be fingerprinted.
+  utils::FingerprintWriter writer{&cache_entry->fingerprint};
+  if (utils::FingerprintInvokeJit(ctx, instr, &writer)) {
+    op_env_cache_[ctx->func_index]->SetInline(ctx->pc, cache_entry);
   }
+  return cache_entry;
+}
 
-  std::vector<Value> inputs;
-  for (int i : op_env->arg_indices) {
-    CHECK_GE(i, 0) << "Invalid input index: " << i;
-    inputs.push_back(args[i]);
+OpEnvPtr VirtualMachine::BuildOpEnv(const CallValues& call) {
+  auto op_env = Dispatch(call);
+  const auto* op = call->callee.as<OpValueObj>();
+  const auto* closure = call->callee.as<ClosureValueObj>();
+  CHECK(op_env != nullptr) << "ValueError: Cannot dispatch "
+                           << (op ? op->op->name : PrettyPrint(closure->func)) << " @"
+                           << call->device.c_str();
+  return op_env;
+}
+
+void VirtualMachine::InitOpEnvRequests(const VMContext& ctx, const OpEnvPtr& op_env) {
+  std::shared_ptr<Requests> requests = op_env->GetRequests();
+  // prepare distributed requests
+  for (size_t i = 0; i < requests->distributed.size(); i++) {
+    Requests::DistributedRequest& entry = requests->distributed[i];
+    *entry.dest = (void*)(Communicator::Get(entry.name, entry.rank_list).as<CommunicatorObj>());
   }
-  return std::make_tuple(op_env, std::move(inputs), std::move(output), op_env_cache_key);
+#ifdef RAF_USE_CUDA
+  // prepare cuda stream requests
+  for (size_t i = 0; i < requests->stream.size(); i++) {
+    Requests::StreamRequest& entry = requests->stream[i];
+    // currently ignores the stream_idx field in requests, all requests with the same tag_idx will
+    // get the same cuda stream in vm
+    std::shared_ptr<Stream> stream =
+        utils::GetStreamById(ctx, DevType::kCUDA(), entry.device.device_id(), entry.tag_idx);
+    *entry.dest = stream->data();
+    entry.stream = stream;
+  }
+#endif
 }
 
 tvm::runtime::Module CreateVirtualMachine(const Executable* exec, bool enable_cuda_graph,
-                                          bool dryrun) {
-  auto vm = make_object<VirtualMachine>(enable_cuda_graph, dryrun);
+                                          bool dryrun, bool enable_cpu_plan) {
+  auto vm = make_object<VirtualMachine>(enable_cuda_graph, dryrun, enable_cpu_plan);
   vm->LoadExecutable(exec);
   return tvm::runtime::Module(vm);
 }
@@ -1121,9 +2198,10 @@ RAF_REGISTER_GLOBAL("raf.vm.VirtualMachine").set_body([](tvm::TVMArgs args, tvm:
   tvm::runtime::Module mod = args[0];
   bool enable_cuda_graph = args[1];
   bool dryrun = args[2];
+  bool enable_cpu_plan = args.size() > 3 ? args[3] : false;
   const auto* exec = dynamic_cast<Executable*>(mod.operator->());
   CHECK(exec) << "The virtual machine executable has not been defined yet.";
-  *rv = CreateVirtualMachine(exec, enable_cuda_graph, dryrun);
+  *rv = CreateVirtualMachine(exec, enable_cuda_graph, dryrun, enable_cpu_plan);
 });
 
 }  // namespace vm
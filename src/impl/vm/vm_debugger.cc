@@ -85,10 +85,18 @@ void VMDebugger::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
   OpEnvPtr op_env;
   std::vector<Value> inputs;
   Value output;
-  std::string op_env_cache_key;
+  OpEnvCacheEntryPtr cache_entry;
 
-  std::tie(op_env, inputs, output, op_env_cache_key) = PrepareOpEnv(ctx, instr);
-  op_env->Execute(inputs, output);
+  std::tie(op_env, output, cache_entry) = PrepareOpEnv(ctx, instr, &inputs);
+  if (ctx->precompile_tasks != nullptr) {
+    ctx->pc++;
+    return;
+  }
+  {
+    std::vector<std::shared_ptr<Memory>> workspace;
+    auto binding = BindWorkspace(ctx, op_env, &workspace);
+    op_env->Execute(inputs, output);
+  }
   ctx->pc++;
 
   if (op_invokes_.find(op_env.get()) == op_invokes_.end()) {
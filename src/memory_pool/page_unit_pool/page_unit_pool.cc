@@ -8,6 +8,7 @@
  * \brief A memory pool that use page as memory unit
  */
 #include <atomic>
+#include <mutex>
 #include <tvm/relay/transform.h>
 #include "raf/device_api.h"
 #include "raf/memory_pool.h"
@@ -113,6 +114,8 @@ class PageUnitPool : public MemoryPool {
   }
 
   std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    // The pool may be shared by multiple VM contexts running concurrently.
+    std::lock_guard<std::recursive_mutex> lock(mu_);
     nbytes = GetAllocBytes(nbytes);
     CHECK_GE(nbytes, 0);
 
@@ -180,6 +183,7 @@ class PageUnitPool : public MemoryPool {
   }
 
   std::pair<float, float> GetPoolSize() override {
+    std::lock_guard<std::recursive_mutex> lock(mu_);
     // First query the device API and use its numbers if available.
     auto ret = api->GetPoolSize();
     float used_total = BytesToMegaBytes(ret.first);
@@ -227,6 +231,8 @@ class PageUnitPool : public MemoryPool {
   std::shared_ptr<DeviceAPI> api;
   /*! \brief The pool that hold the references to NonOwnedMemory. */
   std::unordered_map<int64_t, std::list<std::shared_ptr<Memory>>> _pool;
+  /*! \brief The mutex to protect the pool. Recursive since Alloc may query the pool size. */
+  std::recursive_mutex mu_;
 };
 
 RAF_REGISTER_GLOBAL("raf.memory_pool._make.page_unit_pool").set_body_typed([](const Device& dev) {
@@ -0,0 +1,469 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/size_class_pool/size_class_pool.cc
+ * \brief A memory pool with bucketed size classes and best-fit allocation of large blocks
+ */
+#include <array>
+#include <map>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+namespace size_class_pool {
+
+using device_api::DeviceAPI;
+
+/*! \brief The minimal block size and the alignment of every block in the pool. */
+constexpr int64_t kBlockBytes = 512;
+/*! \brief Requests up to this size are served by the size classes. */
+constexpr int64_t kSmallLimitBytes = 1 << 20;
+/*! \brief The number of size classes. See GetSizeClass for the layout. */
+constexpr int kNumSizeClasses = 40;
+/*! \brief Large requests are rounded up to a multiple of this size. */
+constexpr int64_t kLargeGranularityBytes = 4096;
+/*! \brief New segments are allocated from the device in multiples of this size. */
+constexpr int64_t kSegmentBytes = 2 << 20;
+
+/*!
+ * \brief Get the size class of a small request.
+ *
+ * Requests up to 4KB are rounded up to a multiple of 512 bytes (8 classes). Larger requests
+ * have 4 classes per power of two, e.g., (4KB, 8KB] is split into 5KB, 6KB, 7KB and 8KB. This
+ * bounds the internal fragmentation of a small allocation to 25%.
+ *
+ * \param nbytes The requested size, which must be in (0, kSmallLimitBytes].
+ * \param class_bytes The rounded size of the class.
+ * \return The index of the class.
+ */
+inline int GetSizeClass(int64_t nbytes, int64_t* class_bytes) {
+  if (nbytes <= 4096) {
+    int64_t n = (nbytes + kBlockBytes - 1) / kBlockBytes;
+    *class_bytes = n * kBlockBytes;
+    return static_cast<int>(n - 1);
+  }
+  int p = 63 - __builtin_clzll(static_cast<uint64_t>(nbytes - 1));
+  int64_t step = int64_t(1) << (p - 2);
+  int64_t n = (nbytes + step - 1) / step;
+  *class_bytes = n * step;
+  return 8 + (p - 12) * 4 + static_cast<int>(n - 5);
+}
+
+/*!
+ * \brief A contiguous range of memory inside a segment allocated from the device. The blocks of
+ * a segment form a doubly linked list in address order so that free neighbours can be merged.
+ */
+struct Block {
+  /*! \brief The start address of the block. */
+  char* ptr = nullptr;
+  /*! \brief The size of the block in bytes. */
+  int64_t size = 0;
+  /*! \brief The size class that caches this block, or -1 for a large block. */
+  int size_class = -1;
+  /*! \brief Whether the block is handed out to a user or cached by a size class. */
+  bool allocated = false;
+  /*! \brief The previous block in the same segment. */
+  Block* prev = nullptr;
+  /*! \brief The next block in the same segment. */
+  Block* next = nullptr;
+  /*! \brief The next block in the free list of the size class. */
+  Block* next_free = nullptr;
+};
+
+/*!
+ * \brief The shared allocator state. It is owned by the pool and by every memory chunk handed out
+ * by the pool, so that chunks can still be returned after the pool is removed.
+ */
+class Arena {
+ public:
+  Arena(std::shared_ptr<DeviceAPI> api, int64_t pool_limit)
+      : api_(std::move(api)), max_pool_size_(pool_limit) {
+    free_lists_.fill(nullptr);
+  }
+
+  ~Arena() {
+    for (auto& kv : segments_) {
+      Block* block = kv.second;
+      while (block != nullptr) {
+        Block* next = block->next;
+        delete block;
+        block = next;
+      }
+      api_->FreeMemory(kv.first);
+    }
+  }
+
+  /*! \brief Allocate a block that holds at least nbytes. */
+  Block* Alloc(int64_t nbytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    Block* block = nullptr;
+    if (nbytes <= kSmallLimitBytes) {
+      int64_t class_bytes;
+      int size_class = GetSizeClass(nbytes, &class_bytes);
+      block = free_lists_[size_class];
+      if (block != nullptr) {
+        // O(1) hit in the free list of the size class.
+        free_lists_[size_class] = block->next_free;
+        block->next_free = nullptr;
+      } else {
+        block = AllocLarge(class_bytes);
+        block->size_class = size_class;
+      }
+    } else {
+      block = AllocLarge(RoundUp(nbytes, kLargeGranularityBytes));
+    }
+    used_bytes_ += block->size;
+    return block;
+  }
+
+  /*! \brief Return a block to the pool. */
+  void Free(Block* block) {
+    std::lock_guard<std::mutex> lock(mu_);
+    used_bytes_ -= block->size;
+    if (block->size_class >= 0) {
+      // Small blocks stay in their size class, so the next request of the class is O(1).
+      block->next_free = free_lists_[block->size_class];
+      free_lists_[block->size_class] = block;
+    } else {
+      FreeLarge(block);
+    }
+  }
+
+  /*! \brief Get the (used, total) bytes of the pool. */
+  std::pair<int64_t, int64_t> GetSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {used_bytes_, pool_bytes_};
+  }
+
+  /*!
+   * \brief Release the blocks cached by the size classes and return the segments that are
+   * entirely free to the device.
+   * \return The freed memory in bytes.
+   */
+  int64_t FreeUnusedSegments() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return FreeUnusedSegmentsLocked();
+  }
+
+  static inline int64_t RoundUp(int64_t nbytes, int64_t unit) {
+    return (nbytes + unit - 1) / unit * unit;
+  }
+
+ private:
+  /*! \brief Best-fit allocation of a block with exactly nbytes from the segments. */
+  Block* AllocLarge(int64_t nbytes) {
+    auto it = free_blocks_.lower_bound({nbytes, nullptr});
+    if (it == free_blocks_.end()) {
+      NewSegment(nbytes);
+      it = free_blocks_.lower_bound({nbytes, nullptr});
+      CHECK(it != free_blocks_.end());
+    }
+    Block* block = it->second;
+    free_blocks_.erase(it);
+    if (block->size - nbytes >= kBlockBytes) {
+      // Split the block and put the remaining part back.
+      Block* remain = new Block();
+      remain->ptr = block->ptr + nbytes;
+      remain->size = block->size - nbytes;
+      remain->prev = block;
+      remain->next = block->next;
+      if (block->next != nullptr) {
+        block->next->prev = remain;
+      }
+      block->next = remain;
+      block->size = nbytes;
+      free_blocks_.insert({remain->size, remain});
+    }
+    block->allocated = true;
+    return block;
+  }
+
+  /*! \brief Mark a large block as free and coalesce it with its free neighbours. */
+  void FreeLarge(Block* block) {
+    block->allocated = false;
+    block->size_class = -1;
+    if (block->prev != nullptr && !block->prev->allocated) {
+      Block* prev = block->prev;
+      free_blocks_.erase({prev->size, prev});
+      prev->size += block->size;
+      prev->next = block->next;
+      if (block->next != nullptr) {
+        block->next->prev = prev;
+      }
+      delete block;
+      block = prev;
+    }
+    if (block->next != nullptr && !block->next->allocated) {
+      Block* next = block->next;
+      free_blocks_.erase({next->size, next});
+      block->size += next->size;
+      block->next = next->next;
+      if (next->next != nullptr) {
+        next->next->prev = block;
+      }
+      delete next;
+    }
+    free_blocks_.insert({block->size, block});
+  }
+
+  /*! \brief Allocate a new segment from the device that can hold at least nbytes. */
+  void NewSegment(int64_t nbytes) {
+    int64_t seg_bytes = RoundUp(nbytes, kSegmentBytes);
+    auto within_limit = [&]() {
+      return max_pool_size_ == 0 || pool_bytes_ + seg_bytes <= max_pool_size_;
+    };
+    void* data = nullptr;
+    if (within_limit()) {
+      data = AllocDeviceMemory(seg_bytes);
+    }
+    if (data == nullptr) {
+      // Out of memory or exceed the user-specified limitation, free unused segments and retry.
+      int64_t free_nbytes = FreeUnusedSegmentsLocked();
+      DLOG(WARNING) << "Failed to allocate " << seg_bytes / 1048576.0 << " MBs. Ran GC and got "
+                    << free_nbytes / 1048576.0 << " more MBs";
+      if (within_limit()) {
+        data = AllocDeviceMemory(seg_bytes);
+      }
+    }
+    if (data == nullptr) {
+      LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << seg_bytes / 1048576.0
+                 << " MBs; Already allocated " << pool_bytes_ / 1048576.0 << " MBs and used "
+                 << used_bytes_ / 1048576.0 << " MBs; The pool limit is "
+                 << max_pool_size_ / 1048576.0 << " MBs (0 means no limit)";
+      throw;
+    }
+    Block* block = new Block();
+    block->ptr = static_cast<char*>(data);
+    block->size = seg_bytes;
+    segments_.emplace(data, block);
+    free_blocks_.insert({block->size, block});
+    pool_bytes_ += seg_bytes;
+  }
+
+  int64_t FreeUnusedSegmentsLocked() {
+    for (int i = 0; i < kNumSizeClasses; ++i) {
+      Block* block = free_lists_[i];
+      while (block != nullptr) {
+        Block* next = block->next_free;
+        block->next_free = nullptr;
+        FreeLarge(block);
+        block = next;
+      }
+      free_lists_[i] = nullptr;
+    }
+    int64_t total_free = 0;
+    for (auto it = segments_.begin(); it != segments_.end();) {
+      Block* block = it->second;
+      if (!block->allocated && block->next == nullptr) {
+        free_blocks_.erase({block->size, block});
+        total_free += block->size;
+        pool_bytes_ -= block->size;
+        api_->FreeMemory(it->first);
+        delete block;
+        it = segments_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return total_free;
+  }
+
+  inline void* AllocDeviceMemory(int64_t nbytes) {
+    try {
+      return api_->AllocMemory(nbytes, kLargeGranularityBytes);
+    } catch (const dmlc::Error& e) {
+      return nullptr;
+    }
+  }
+
+  /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
+  std::shared_ptr<DeviceAPI> api_;
+  /*! \brief The maximum allowed size (bytes) in the pool. 0 means no limit. */
+  int64_t max_pool_size_ = 0;
+  /*! \brief The bytes of all segments. */
+  int64_t pool_bytes_ = 0;
+  /*! \brief The bytes of blocks handed out to users. */
+  int64_t used_bytes_ = 0;
+  /*! \brief The intrusive free lists of the size classes. */
+  std::array<Block*, kNumSizeClasses> free_lists_;
+  /*! \brief The free large blocks ordered by (size, address) for best-fit lookup. */
+  std::set<std::pair<int64_t, Block*>> free_blocks_;
+  /*! \brief Map from the segment address to its first block. */
+  std::map<void*, Block*> segments_;
+  /*! \brief The thread-safe lock. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A memory chunk served by a block of the pool. The block goes back to the pool when the
+ * chunk is released.
+ */
+class PooledMemory final : public Memory {
+ public:
+  explicit PooledMemory(void* data, const Device& dev, Block* block, std::shared_ptr<Arena> arena)
+      : block(block), arena(std::move(arena)) {
+    this->data = data;
+    this->device = dev;
+  }
+
+  ~PooledMemory() {
+    arena->Free(block);
+  }
+
+ public:
+  /*! \brief The block that holds the memory. */
+  Block* block;
+  /*! \brief The arena that owns the block. */
+  std::shared_ptr<Arena> arena;
+};
+
+/*!
+ * \brief A wrapper which holds a chunk of memory that is not managed by the pool.
+ */
+class NonOwnedMemory final : public Memory {
+ public:
+  explicit NonOwnedMemory(void* data, const Device& dev, std::shared_ptr<DeviceAPI> api) {
+    this->data = data;
+    this->device = dev;
+    this->api = std::move(api);
+  }
+
+  ~NonOwnedMemory() {
+    if (data != nullptr) {
+      api->FreeMemory(data);
+    }
+  }
+
+ public:
+  std::shared_ptr<DeviceAPI> api;
+};
+
+/*!
+ * \brief A Memory Pool that serves requests from large segments allocated from the device.
+ *
+ * Small requests (up to 1MB) are rounded up to one of the size classes (see GetSizeClass). Each
+ * size class keeps an intrusive free list of released blocks, so allocating and releasing a small
+ * chunk is O(1) in the steady state.
+ *
+ * Large requests are rounded up to 4KB and served by the best-fit free block, which is split when
+ * it is larger than needed. Released large blocks are coalesced with their free neighbours, so
+ * models with many distinct tensor sizes do not fragment the pool. When the pool runs out of
+ * memory, the cached small blocks are released and fully free segments are returned to the device.
+ *
+ * \sa SizeClassPool
+ */
+class SizeClassPool : public MemoryPool {
+ public:
+  explicit SizeClassPool(Device dev, int64_t pool_limit = 0) {
+    this->device = dev;
+    this->api = DeviceAPI::Get(dev.device_type());
+    if (dev.device_type() == DevType::kCUDA()) {
+      this->api->SetDevice(dev.device_id());
+    }
+    this->arena = std::make_shared<Arena>(api, pool_limit);
+  }
+
+  std::string GetName() {
+    return "size_class_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    return GetBlockBytes(nbytes, kDefaultMemoryAlignment);
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    CHECK_GE(nbytes, 0);
+    if (nbytes == 0) {
+      return std::make_shared<NonOwnedMemory>(nullptr, device, api);
+    }
+    if (alignment > kLargeGranularityBytes) {
+      // Such alignments are rare, so we do not pool them.
+      return std::make_shared<NonOwnedMemory>(api->AllocMemory(nbytes, alignment), device, api);
+    }
+    Block* block = arena->Alloc(GetPaddedBytes(nbytes, alignment));
+    uintptr_t addr = reinterpret_cast<uintptr_t>(block->ptr);
+    addr = (addr + alignment - 1) / alignment * alignment;
+    return std::make_shared<PooledMemory>(reinterpret_cast<void*>(addr), device, block, arena);
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    LOG(FATAL) << "Please use NoPool to use AllocAsync.";
+    throw;
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    // First query the device API and use its numbers if available.
+    auto ret = api->GetPoolSize();
+    if (ret.first == 0 && ret.second == 0) {
+      ret = arena->GetSize();
+    }
+    return std::make_pair(BytesToMegaBytes(ret.first), BytesToMegaBytes(ret.second));
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    int64_t max_pool_limit = 0;
+    if (const char* val = getenv("RAF_MEMORY_POOL_SIZE_LIMIT")) {
+      max_pool_limit = atol(val);
+    }
+    return new SizeClassPool(dev, max_pool_limit);
+  }
+
+ protected:
+  Device device;
+  /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
+  std::shared_ptr<DeviceAPI> api;
+  /*! \brief The allocator state shared with the allocated memory chunks. */
+  std::shared_ptr<Arena> arena;
+
+ private:
+  /*! \brief Blocks are aligned to kBlockBytes. Pad the request to align the data pointer further. */
+  static int64_t GetPaddedBytes(int64_t nbytes, int64_t alignment) {
+    return nbytes + (alignment > kBlockBytes ? alignment - kBlockBytes : 0);
+  }
+
+  /*! \brief Get the bytes of the block that Alloc reserves for a request. */
+  static int64_t GetBlockBytes(int64_t nbytes, int64_t alignment) {
+    if (nbytes <= 0) {
+      return 0;
+    }
+    if (alignment > kLargeGranularityBytes) {
+      return nbytes;
+    }
+    nbytes = GetPaddedBytes(nbytes, alignment);
+    if (nbytes <= kSmallLimitBytes) {
+      int64_t class_bytes;
+      GetSizeClass(nbytes, &class_bytes);
+      return class_bytes;
+    }
+    return Arena::RoundUp(nbytes, kLargeGranularityBytes);
+  }
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.size_class_pool").set_body_typed([](const Device& dev) {
+  return SizeClassPool::make(dev);
+});
+
+}  // namespace size_class_pool
+}  // namespace memory_pool
+}  // namespace raf
@@ -10,6 +10,7 @@
 #include "raf/op.h"
 #include "raf/tensor.h"
 #include "../schema/ufunc.h"
+#include "../schema/nn.h"
 
 namespace raf {
 namespace op {
@@ -128,6 +129,48 @@ RAF_OP_DECLARE("raf.op.dense", [](const CallValues& call) {
   }
 });
 
+template <int ndim>
+void QuantizedGemmDecl(const CallValues& call) {
+  const auto* args = call->args.as<schema::QuantizedGemmArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* a = args->x1;
+  const DLTensor* b = args->x2;
+  // a is of shape [k1, n1, m1] or [n1, m1]
+  // b is of shape [k2, n2, m2] or [n2, m2]
+  CHECK_EQ(a->ndim, ndim);
+  CHECK_EQ(b->ndim, ndim);
+  int batch_dims = ndim - 2;
+  int64_t n1 = a->shape[batch_dims];
+  int64_t m1 = a->shape[batch_dims + 1];
+  int64_t n2 = b->shape[batch_dims];
+  int64_t m2 = b->shape[batch_dims + 1];
+  if (args->transpose_a) {
+    std::swap(n1, m1);
+  }
+  if (args->transpose_b) {
+    std::swap(n2, m2);
+  }
+  CHECK_EQ(m1, n2);
+  CHECK(a->dtype.code == kDLInt && a->dtype.bits == 8 && b->dtype.code == kDLInt &&
+        b->dtype.bits == 8)
+      << "Only int8 inputs are supported!";
+  std::vector<int64_t> oshape{n1, m2};
+  if (batch_dims) {
+    int64_t k1 = a->shape[0];
+    int64_t k2 = b->shape[0];
+    CHECK(k1 == k2 || k1 == 1 || k2 == 1)
+        << "Incompatible broadcast batch size " << k1 << " and " << k2;
+    oshape.insert(oshape.begin(), std::max(k1, k2));
+  }
+  call->out = TensorValue::Assemble(/*dev=*/a->device,
+                                    /*dtype=*/DType(DTypeCode::kInt(), 32),
+                                    /*shape=*/oshape);
+  call->device = a->device;
+}
+
+RAF_OP_DECLARE("raf.op.quantized_matmul", QuantizedGemmDecl<2>);
+RAF_OP_DECLARE("raf.op.quantized_batch_matmul", QuantizedGemmDecl<3>);
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
@@ -95,6 +95,26 @@ void Conv2D(const CallValues& call) {
 
 RAF_OP_DECLARE("raf.op.conv2d", Conv2D);
 
+void QuantizedConv2D(const CallValues& call) {
+  const auto* args = call->args.as<ConvArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* w = args->w;
+  CHECK(x->dtype.code == kDLInt && x->dtype.bits == 8 && w->dtype.code == kDLInt &&
+        w->dtype.bits == 8)
+      << "Only int8 inputs are supported!";
+  Conv2D(call);
+  // The products are accumulated in int32.
+  TensorValue out = Downcast<TensorValue>(call->out);
+  const DLTensor* y = out;
+  std::vector<int64_t> oshape(y->shape, y->shape + y->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/DType(DTypeCode::kInt(), 32),
+                                    /*shape=*/oshape);
+}
+
+RAF_OP_DECLARE("raf.op.quantized_conv2d", QuantizedConv2D);
+
 void Conv2dTrans(const CallValues& call) {
   // N.B.: NCHW + IOHW
   const auto* args = call->args.as<ConvTransArgs>();
@@ -912,6 +912,97 @@ RAF_OP_DECLARE("raf.op.group_cast", [](const CallValues& call) {
   call->out = TupleValue::make(ir::Array<Value>(ret.begin(), ret.end()));
 });
 
+RAF_OP_DECLARE("raf.op.quantize_blockwise", [](const CallValues& call) {
+  const auto* args = call->args.as<QuantizeBlockwiseArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CHECK_GT(args->block_size, 0);
+  int64_t size = 1;
+  for (int i = 0; i < x->ndim; ++i) {
+    size *= x->shape[i];
+  }
+  int64_t n_blocks = (size + args->block_size - 1) / args->block_size;
+  TensorValue data = TensorValue::Assemble(/*dev=*/x->device,
+                                           /*dtype=*/DType(DTypeCode::kInt(), 8),
+                                           /*shape=*/{n_blocks, args->block_size});
+  TensorValue scale = TensorValue::Assemble(/*dev=*/x->device,
+                                            /*dtype=*/DType(DTypeCode::kFloat(), 32),
+                                            /*shape=*/{n_blocks});
+  call->out = TupleValue::make(ir::Array<Value>({data, scale}));
+  call->device = x->device;
+});
+
+RAF_OP_DECLARE("raf.op.dequantize_blockwise", [](const CallValues& call) {
+  const auto* args = call->args.as<DequantizeBlockwiseArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* data = args->data;
+  const DLTensor* scale = args->scale;
+  CHECK_EQ(data->ndim, 2);
+  CHECK_EQ(scale->ndim, 1);
+  CHECK_EQ(data->shape[0], scale->shape[0]);
+  int64_t size = 1;
+  for (auto dim : args->shape) {
+    size *= dim;
+  }
+  CHECK_LE(size, data->shape[0] * data->shape[1]);
+  call->out = TensorValue::Assemble(/*dev=*/data->device,
+                                    /*dtype=*/String2DLDataType(args->dtype),
+                                    /*shape=*/args->shape);
+  call->device = data->device;
+});
+
+/*! \brief Check the scale is a scalar or a vector along the given axis of x. */
+void CheckQuantizeScale(const DLTensor* x, const DLTensor* scale, int axis) {
+  int64_t size = 1;
+  for (int i = 0; i < scale->ndim; ++i) {
+    size *= scale->shape[i];
+  }
+  if (size == 1) {
+    return;
+  }
+  CHECK_EQ(scale->ndim, 1) << "The per-channel scale must be 1-D";
+  axis = axis < 0 ? axis + x->ndim : axis;
+  CHECK(axis >= 0 && axis < x->ndim) << "Invalid axis " << axis << " for " << x->ndim << "-D input";
+  CHECK_EQ(scale->shape[0], x->shape[axis]) << "The scale size mismatches the channels";
+}
+
+RAF_OP_DECLARE("raf.op.quantize", [](const CallValues& call) {
+  const auto* args = call->args.as<QuantizeArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CheckQuantizeScale(x, args->scale, args->axis);
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/String2DLDataType(args->dtype),
+                                    /*shape=*/shape);
+  call->device = x->device;
+});
+
+RAF_OP_DECLARE("raf.op.dequantize", [](const CallValues& call) {
+  const auto* args = call->args.as<DequantizeArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CheckQuantizeScale(x, args->scale, args->axis);
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/String2DLDataType(args->dtype),
+                                    /*shape=*/shape);
+  call->device = x->device;
+});
+
+RAF_OP_DECLARE("raf.op.requantize", [](const CallValues& call) {
+  const auto* args = call->args.as<RequantizeArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CheckQuantizeScale(x, args->in_scale, args->axis);
+  CheckQuantizeScale(x, args->out_scale, args->axis);
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/String2DLDataType(args->dtype),
+                                    /*shape=*/shape);
+  call->device = x->device;
+});
+
 RAF_OP_DECLARE("raf.op.gather", [](const CallValues& call) {
   const auto* args = call->args.as<GatherArgs>();
   CHECK(args != nullptr);
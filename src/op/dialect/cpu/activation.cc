@@ -0,0 +1,80 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/activation.cc
+ * \brief Elementwise activation CPU backend
+ */
+#include "raf/op.h"
+#include "../../schema/ufunc.h"
+#include "../../../common/shape_utils.h"
+#include "./cpu_utils.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+using namespace raf::value;
+using common::shape_utils::GetNumel;
+
+template <UnaryKind kind>
+class UnaryImpl : public raf::op::OpEnv {
+ public:
+  explicit UnaryImpl(const CallValues& cv, const std::string& op_name) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto op = ir::Op::Get("raf.op." + op_name);
+    this->arg_indices = {
+        fschema_index[op]("x"),
+    };
+    env_name_ = TruncateName(GetUniqueName("raf.op.cpu." + op_name));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::UnaryArgs>();
+    Execute(std::vector<Value>{args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    const float* x_data = static_cast<const float*>(x->data);
+    float* out_data = static_cast<float*>(out->data);
+    const Kernels* kernels = GetKernels();
+    ParallelFor(0, GetNumel(*x), 32768, [&](int64_t begin, int64_t end) {
+      kernels->unary(kind, x_data + begin, out_data + begin, end - begin);
+    });
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  static OpEnv* make(const CallValues& cv, const std::string& op_name) {
+    auto args = cv->args.as<op::schema::UnaryArgs>();
+    CHECK(args != nullptr);
+    if (!IsFloat32(args->x)) {
+      return nullptr;
+    }
+    return new UnaryImpl<kind>(cv, op_name);
+  }
+
+ private:
+  std::string env_name_;
+};
+
+#define RAF_CPU_UNARY(OP, KIND)                                                         \
+  RAF_REGISTER_DIALECT_OP(cpu, OP, 15);                                                 \
+  RAF_OP_ENV_MAKER("raf.op.cpu." #OP,                                                   \
+                   [](const CallValues& cv) { return UnaryImpl<KIND>::make(cv, #OP); })
+
+RAF_CPU_UNARY(relu, UnaryKind::kRelu);
+RAF_CPU_UNARY(gelu, UnaryKind::kGelu);
+RAF_CPU_UNARY(tanh, UnaryKind::kTanh);
+RAF_CPU_UNARY(sigmoid, UnaryKind::kSigmoid);
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
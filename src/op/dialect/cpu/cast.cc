@@ -0,0 +1,84 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/cast.cc
+ * \brief Cast between float32 and bfloat16 CPU backend
+ */
+#include "raf/op.h"
+#include "../../schema/transform.h"
+#include "../../../common/shape_utils.h"
+#include "./cpu_utils.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+using namespace raf::value;
+using common::shape_utils::GetNumel;
+
+class CastImpl : public raf::op::OpEnv {
+ public:
+  explicit CastImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.cast");
+    this->arg_indices = {
+        fschema_index[op]("data"),
+    };
+    env_name_ = TruncateName(GetUniqueName("raf.op.cpu.cast"));
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::CastArgs>();
+    Execute(std::vector<Value>{args->data}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    const Kernels* kernels = GetKernels();
+    if (IsFloat32(x)) {
+      const float* x_data = static_cast<const float*>(x->data);
+      uint16_t* out_data = static_cast<uint16_t*>(out->data);
+      ParallelFor(0, GetNumel(*x), 32768, [&](int64_t begin, int64_t end) {
+        kernels->cast_f32_to_bf16(x_data + begin, out_data + begin, end - begin);
+      });
+    } else {
+      const uint16_t* x_data = static_cast<const uint16_t*>(x->data);
+      float* out_data = static_cast<float*>(out->data);
+      ParallelFor(0, GetNumel(*x), 32768, [&](int64_t begin, int64_t end) {
+        kernels->cast_bf16_to_f32(x_data + begin, out_data + begin, end - begin);
+      });
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::CastArgs>();
+    CHECK(args != nullptr);
+    DLTensor* x = args->data;
+    DLDataType dtype = ir::String2DLDataType(args->dtype);
+    bool to_bf16 = IsFloat32(x) && dtype.code == kDLBfloat && dtype.bits == 16;
+    bool from_bf16 = IsBFloat16(x) && dtype.code == kDLFloat && dtype.bits == 32;
+    if (dtype.lanes != 1 || (!to_bf16 && !from_bf16)) {
+      return nullptr;
+    }
+    return new CastImpl(cv);
+  }
+
+ private:
+  std::string env_name_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, cast, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.cast", CastImpl::make);
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
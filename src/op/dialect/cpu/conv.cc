@@ -0,0 +1,134 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/conv.cc
+ * \brief quantized_conv2d CPU backend
+ */
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "../../schema/nn.h"
+#include "./cpu_utils.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+using namespace raf::value;
+
+/*!
+ * \brief The int8 2-D convolution of NCHW inputs and OIHW weights with int32 outputs. Each image
+ * and group is lowered to im2col and a GEMM of the weights [O / groups, K] and the columns [K, P],
+ * where K = C / groups * KH * KW and P = OH * OW, which writes the NCHW output directly.
+ */
+class QuantizedConv2DImpl : public raf::op::OpEnv {
+ public:
+  explicit QuantizedConv2DImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.quantized_conv2d");
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("w"),
+    };
+    auto args = cv->args.as<op::schema::ConvArgs>();
+    std::vector<int64_t> stride = Pad<2>(args->stride);
+    std::vector<int64_t> dilation = Pad<2>(args->dilation);
+    const std::vector<int64_t>& padding = args->padding;
+    stride_h_ = stride[0];
+    stride_w_ = stride[1];
+    dilation_h_ = dilation[0];
+    dilation_w_ = dilation[1];
+    // The leading paddings, which are the first two of [top, left, bottom, right].
+    pad_top_ = padding[0];
+    pad_left_ = padding.size() > 1 ? padding[1] : padding[0];
+    groups_ = args->groups;
+    env_name_ = TruncateName(GetUniqueName("raf.op.cpu.quantized_conv2d"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::ConvArgs>();
+    Execute(std::vector<Value>{args->x, args->w}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* w = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    const int64_t batch = x->shape[0], channels = x->shape[1], height = x->shape[2],
+                  width = x->shape[3];
+    const int64_t out_channels = w->shape[0], kernel_h = w->shape[2], kernel_w = w->shape[3];
+    const int64_t out_h = out->shape[2], out_w = out->shape[3];
+    const int64_t group_channels = channels / groups_;
+    const int64_t group_out_channels = out_channels / groups_;
+    const int64_t k = group_channels * kernel_h * kernel_w;
+    const int64_t p = out_h * out_w;
+    const int8_t* x_data = static_cast<const int8_t*>(x->data);
+    const int8_t* w_data = static_cast<const int8_t*>(w->data);
+    int32_t* out_data = static_cast<int32_t*>(out->data);
+
+    std::vector<int8_t> cols(k * p);
+    for (int64_t n = 0; n < batch; ++n) {
+      for (int64_t g = 0; g < groups_; ++g) {
+        const int8_t* image = x_data + (n * channels + g * group_channels) * height * width;
+        // Each row of the columns is a (channel, kernel_y, kernel_x) of the receptive fields.
+        ParallelFor(0, k, std::max<int64_t>(1, 32768 / p), [&](int64_t begin, int64_t end) {
+          for (int64_t row = begin; row < end; ++row) {
+            int64_t c = row / (kernel_h * kernel_w);
+            int64_t ky = row / kernel_w % kernel_h;
+            int64_t kx = row % kernel_w;
+            const int8_t* plane = image + c * height * width;
+            int8_t* dst = cols.data() + row * p;
+            for (int64_t oy = 0; oy < out_h; ++oy) {
+              int64_t iy = oy * stride_h_ - pad_top_ + ky * dilation_h_;
+              if (iy < 0 || iy >= height) {
+                std::memset(dst + oy * out_w, 0, out_w);
+                continue;
+              }
+              for (int64_t ox = 0; ox < out_w; ++ox) {
+                int64_t ix = ox * stride_w_ - pad_left_ + kx * dilation_w_;
+                dst[oy * out_w + ox] = ix >= 0 && ix < width ? plane[iy * width + ix] : 0;
+              }
+            }
+          }
+        });
+        GemmS8(1, group_out_channels, p, k, w_data + g * group_out_channels * k, 0, false,
+               cols.data(), 0, false,
+               out_data + (n * out_channels + g * group_out_channels) * p);
+      }
+    }
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::ConvArgs>();
+    CHECK(args != nullptr);
+    if (!IsInt(args->x, 8) || !IsInt(args->w, 8) || args->layout != "NCHW" ||
+        args->kernel_layout != "OIHW" || args->out_layout != "NCHW") {
+      return nullptr;
+    }
+    return new QuantizedConv2DImpl(cv);
+  }
+
+ private:
+  std::string env_name_;
+  int64_t stride_h_, stride_w_;
+  int64_t dilation_h_, dilation_w_;
+  int64_t pad_top_, pad_left_;
+  int64_t groups_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, quantized_conv2d, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.quantized_conv2d", QuantizedConv2DImpl::make);
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
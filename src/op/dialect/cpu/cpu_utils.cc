@@ -0,0 +1,435 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/cpu_utils.cc
+ * \brief Helper functions for the CPU dialect
+ */
+#include <tvm/runtime/c_backend_api.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "raf/device_api.h"
+#include "raf/op.h"
+#include "raf/registry.h"
+#include "./cpu_utils.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+namespace {
+
+ISA DetectISA() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+  __builtin_cpu_init();
+  bool avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+  if (avx512 && __builtin_cpu_supports("avx512vnni") && GetAVX512VNNIKernels() != nullptr) {
+    return ISA::kAVX512VNNI;
+  }
+  if (avx512 && GetAVX512Kernels() != nullptr) {
+    return ISA::kAVX512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+      GetAVX2Kernels() != nullptr) {
+    return ISA::kAVX2;
+  }
+#endif
+  return ISA::kScalar;
+}
+
+/*! \brief The K blocking of GEMM, so that a packed strip of B stays in L1. */
+constexpr int64_t kGemmKC = 256;
+/*! \brief The M blocking of GEMM (rounded down to the micro-kernel rows), to fit A in L2. */
+constexpr int64_t kGemmMC = 144;
+/*! \brief The N blocking of GEMM, to fit the packed panel of B in L3. */
+constexpr int64_t kGemmNC = 1024;
+
+/*! \brief Convert an element of the GEMM operands to float32. */
+inline float ToFloat(float x) {
+  return x;
+}
+inline float ToFloat(uint16_t x) {
+  return BF16ToFloat(x);
+}
+
+/*! \brief Convert a contiguous row of the GEMM operands to float32. */
+inline void RowToFloat(const Kernels* kernels, const float* x, float* y, int64_t n) {
+  std::memcpy(y, x, n * sizeof(float));
+}
+inline void RowToFloat(const Kernels* kernels, const uint16_t* x, float* y, int64_t n) {
+  kernels->cast_bf16_to_f32(x, y, n);
+}
+
+/*!
+ * \brief Pack A[i0:i0+mc, k0:k0+kc] into float32 strips of mr rows, zero-padding the last strip.
+ */
+template <typename T>
+void PackA(const T* a, int64_t lda, bool transpose, int64_t i0, int64_t k0, int64_t mc,
+           int64_t kc, int64_t mr, float* buf) {
+  for (int64_t s = 0; s < mc; s += mr) {
+    int64_t rows = std::min(mr, mc - s);
+    for (int64_t p = 0; p < kc; ++p, buf += mr) {
+      for (int64_t r = 0; r < rows; ++r) {
+        int64_t i = i0 + s + r;
+        buf[r] = ToFloat(transpose ? a[(k0 + p) * lda + i] : a[i * lda + k0 + p]);
+      }
+      std::fill(buf + rows, buf + mr, 0.0f);
+    }
+  }
+}
+
+/*!
+ * \brief Pack B[k0:k0+kc, j0:j0+nc] into float32 strips of nr columns, zero-padding the last
+ * strip.
+ */
+template <typename T>
+void PackB(const Kernels* kernels, const T* b, int64_t ldb, bool transpose, int64_t k0,
+           int64_t j0, int64_t kc, int64_t nc, int64_t nr, float* buf) {
+  for (int64_t s = 0; s < nc; s += nr) {
+    int64_t cols = std::min(nr, nc - s);
+    for (int64_t p = 0; p < kc; ++p, buf += nr) {
+      if (transpose) {
+        for (int64_t c = 0; c < cols; ++c) {
+          buf[c] = ToFloat(b[(j0 + s + c) * ldb + k0 + p]);
+        }
+      } else {
+        RowToFloat(kernels, b + (k0 + p) * ldb + j0 + s, buf, cols);
+      }
+      std::fill(buf + cols, buf + nr, 0.0f);
+    }
+  }
+}
+
+/*!
+ * \brief Compute C[m0:m1, n0:n1] of a single GEMM with the packed micro-kernel. c points to
+ * C[m0, n0], which is always float32, so the operands of any dtype are accumulated in float32.
+ */
+template <typename T>
+void GemmBlock(const Kernels* kernels, int64_t k, const T* a, int64_t lda, bool transpose_a,
+               const T* b, int64_t ldb, bool transpose_b, float* c, int64_t ldc, int64_t m0,
+               int64_t m1, int64_t n0, int64_t n1, int64_t mc) {
+  thread_local std::vector<float> a_buf, b_buf;
+  const int64_t mr = kernels->gemm_mr;
+  const int64_t nr = kernels->gemm_nr;
+  for (int64_t jc = n0; jc < n1; jc += kGemmNC) {
+    int64_t nc = std::min(kGemmNC, n1 - jc);
+    for (int64_t pc = 0; pc < k; pc += kGemmKC) {
+      int64_t kc = std::min(kGemmKC, k - pc);
+      b_buf.resize((nc + nr - 1) / nr * nr * kc);
+      PackB(kernels, b, ldb, transpose_b, pc, jc, kc, nc, nr, b_buf.data());
+      for (int64_t ic = m0; ic < m1; ic += mc) {
+        int64_t mcur = std::min(mc, m1 - ic);
+        a_buf.resize((mcur + mr - 1) / mr * mr * kc);
+        PackA(a, lda, transpose_a, ic, pc, mcur, kc, mr, a_buf.data());
+        for (int64_t jr = 0; jr < nc; jr += nr) {
+          for (int64_t ir = 0; ir < mcur; ir += mr) {
+            kernels->gemm(kc, a_buf.data() + ir * kc, b_buf.data() + jr * kc,
+                          c + (ic - m0 + ir) * ldc + jc - n0 + jr, ldc, std::min(mr, mcur - ir),
+                          std::min(nr, nc - jr), pc > 0);
+          }
+        }
+      }
+    }
+  }
+}
+
+/*! \brief Compute the tile C[m0:m1, n0:n1] of a float32 GEMM in place. */
+void GemmTile(const Kernels* kernels, int64_t k, const float* a, int64_t lda, bool transpose_a,
+              const float* b, int64_t ldb, bool transpose_b, float* c, int64_t ldc, int64_t m0,
+              int64_t m1, int64_t n0, int64_t n1, int64_t mc) {
+  GemmBlock(kernels, k, a, lda, transpose_a, b, ldb, transpose_b, c + m0 * ldc + n0, ldc, m0, m1,
+            n0, n1, mc);
+}
+
+/*!
+ * \brief Compute the tile C[m0:m1, n0:n1] of a bfloat16 GEMM. The tile is accumulated in a float32
+ * buffer and rounded to bfloat16 only once at the end.
+ */
+void GemmTile(const Kernels* kernels, int64_t k, const uint16_t* a, int64_t lda, bool transpose_a,
+              const uint16_t* b, int64_t ldb, bool transpose_b, uint16_t* c, int64_t ldc,
+              int64_t m0, int64_t m1, int64_t n0, int64_t n1, int64_t mc) {
+  thread_local std::vector<float> c_buf;
+  c_buf.resize((m1 - m0) * (n1 - n0));
+  GemmBlock(kernels, k, a, lda, transpose_a, b, ldb, transpose_b, c_buf.data(), n1 - n0, m0, m1,
+            n0, n1, mc);
+  for (int64_t i = m0; i < m1; ++i) {
+    kernels->cast_f32_to_bf16(c_buf.data() + (i - m0) * (n1 - n0), c + i * ldc + n0, n1 - n0);
+  }
+}
+
+/*!
+ * \brief Interleave n elements of two rows into int16 pairs. row1 is null for the zero padding of
+ * an odd reduction size.
+ */
+inline void InterleavePairs(const int8_t* row0, const int8_t* row1, int64_t n, int16_t* buf) {
+  if (row1 == nullptr) {
+    for (int64_t i = 0; i < n; ++i) {
+      buf[2 * i] = row0[i];
+      buf[2 * i + 1] = 0;
+    }
+    return;
+  }
+  for (int64_t i = 0; i < n; ++i) {
+    buf[2 * i] = row0[i];
+    buf[2 * i + 1] = row1[i];
+  }
+}
+
+/*!
+ * \brief Pack X[r0:r0+rc, k0:k0+kc] of int8 into strips of rs rows, where X[r, p] is
+ * x[r * ld + p], or x[p * ld + r] if transpose. Each strip holds the reduction axis in pairs of
+ * int16. The last strip and the last odd pair are zero-padded. A is packed as X, and B as the
+ * transpose of X.
+ */
+void PackS8(const int8_t* x, int64_t ld, bool transpose, int64_t r0, int64_t k0, int64_t rc,
+            int64_t kc, int64_t rs, int16_t* buf) {
+  const int64_t kp = (kc + 1) / 2;
+  for (int64_t s = 0; s < rc; s += rs, buf += 2 * rs * kp) {
+    int64_t rows = std::min(rs, rc - s);
+    if (transpose) {
+      // The rows of a strip are contiguous in memory, so interleave two rows of x at a time.
+      for (int64_t p = 0; p < kp; ++p) {
+        const int8_t* row0 = x + (k0 + 2 * p) * ld + r0 + s;
+        const int8_t* row1 = 2 * p + 1 < kc ? row0 + ld : nullptr;
+        InterleavePairs(row0, row1, rows, buf + 2 * rs * p);
+        std::fill(buf + 2 * rs * p + 2 * rows, buf + 2 * rs * (p + 1), 0);
+      }
+    } else {
+      // The reduction axis is contiguous, so copy each row to its slots of the pairs.
+      for (int64_t r = 0; r < rows; ++r) {
+        const int8_t* row = x + (r0 + s + r) * ld + k0;
+        int16_t* dst = buf + 2 * r;
+        for (int64_t p = 0; p < kc / 2; ++p) {
+          dst[2 * rs * p] = row[2 * p];
+          dst[2 * rs * p + 1] = row[2 * p + 1];
+        }
+        if (kc % 2) {
+          dst[2 * rs * (kp - 1)] = row[kc - 1];
+          dst[2 * rs * (kp - 1) + 1] = 0;
+        }
+      }
+      for (int64_t p = 0; p < kp; ++p) {
+        std::fill(buf + 2 * rs * p + 2 * rows, buf + 2 * rs * (p + 1), 0);
+      }
+    }
+  }
+}
+
+/*! \brief Compute the tile C[m0:m1, n0:n1] of an int8 GEMM in place, accumulating in int32. */
+void GemmTile(const Kernels* kernels, int64_t k, const int8_t* a, int64_t lda, bool transpose_a,
+              const int8_t* b, int64_t ldb, bool transpose_b, int32_t* c, int64_t ldc, int64_t m0,
+              int64_t m1, int64_t n0, int64_t n1, int64_t mc) {
+  thread_local std::vector<int16_t> a_buf, b_buf;
+  const int64_t mr = kernels->gemm_s8_mr;
+  const int64_t nr = kernels->gemm_s8_nr;
+  for (int64_t jc = n0; jc < n1; jc += kGemmNC) {
+    int64_t nc = std::min(kGemmNC, n1 - jc);
+    // kGemmKC is even, so only the last block may have an odd reduction size.
+    for (int64_t pc = 0; pc < k; pc += kGemmKC) {
+      int64_t kc = std::min(kGemmKC, k - pc);
+      int64_t kp = (kc + 1) / 2;
+      b_buf.resize((nc + nr - 1) / nr * nr * 2 * kp);
+      PackS8(b, ldb, !transpose_b, jc, pc, nc, kc, nr, b_buf.data());
+      for (int64_t ic = m0; ic < m1; ic += mc) {
+        int64_t mcur = std::min(mc, m1 - ic);
+        a_buf.resize((mcur + mr - 1) / mr * mr * 2 * kp);
+        PackS8(a, lda, transpose_a, ic, pc, mcur, kc, mr, a_buf.data());
+        for (int64_t jr = 0; jr < nc; jr += nr) {
+          for (int64_t ir = 0; ir < mcur; ir += mr) {
+            kernels->gemm_s8(kp, a_buf.data() + ir * 2 * kp, b_buf.data() + jr * 2 * kp,
+                             c + (ic + ir) * ldc + jc + jr, ldc, std::min(mr, mcur - ir),
+                             std::min(nr, nc - jr), pc > 0);
+          }
+        }
+      }
+    }
+  }
+}
+
+/*! \brief The shape of the micro-kernel tiles for the GEMM operands of type T. */
+template <typename T>
+struct GemmTraits {
+  static int64_t MR(const Kernels* kernels) {
+    return kernels->gemm_mr;
+  }
+  static int64_t NR(const Kernels* kernels) {
+    return kernels->gemm_nr;
+  }
+};
+
+template <>
+struct GemmTraits<int8_t> {
+  static int64_t MR(const Kernels* kernels) {
+    return kernels->gemm_s8_mr;
+  }
+  static int64_t NR(const Kernels* kernels) {
+    return kernels->gemm_s8_nr;
+  }
+};
+
+/*!
+ * \brief Batched GEMM of float32, bfloat16 or int8 operands, whose output is of type TC. See Gemm
+ * for the parameters.
+ */
+template <typename T, typename TC>
+void GemmImpl(int64_t batch, int64_t m, int64_t n, int64_t k, const T* a, int64_t batch_stride_a,
+              bool transpose_a, const T* b, int64_t batch_stride_b, bool transpose_b, TC* c) {
+  if (k == 0) {
+    // The tiles only write C from the accumulators of the K loop, so an empty reduction has to
+    // be filled here. The zero bit pattern is also 0 in bfloat16.
+    std::fill(c, c + batch * m * n, TC(0));
+    return;
+  }
+  const Kernels* kernels = GetKernels();
+  const int64_t mr = GemmTraits<T>::MR(kernels);
+  const int64_t nr = GemmTraits<T>::NR(kernels);
+  const int64_t lda = transpose_a ? m : k;
+  const int64_t ldb = transpose_b ? k : n;
+  // Partition C of each batch into a grid of tiles, with at least one tile per thread. Every tile
+  // packs its own operands so the tiles run independently. Rows are split first, because tiles
+  // with the same rows pack the same A and tiles with the same columns pack the same B, and B is
+  // usually the larger one.
+  const int64_t mc = std::max(mr, kGemmMC / mr * mr);
+  const int64_t num_threads = device_api::CPUThreadPoolSize();
+  const int64_t tiles_per_batch = std::max<int64_t>(1, (num_threads + batch - 1) / batch);
+  int64_t tm = std::min(tiles_per_batch, (m + mr - 1) / mr);
+  int64_t tn = std::min((tiles_per_batch + tm - 1) / tm, (n + nr - 1) / nr);
+  const int64_t mb = ((m + tm - 1) / tm + mr - 1) / mr * mr;
+  const int64_t nb = ((n + tn - 1) / tn + nr - 1) / nr * nr;
+  tm = (m + mb - 1) / mb;
+  tn = (n + nb - 1) / nb;
+  ParallelFor(0, batch * tm * tn, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t task = begin; task < end; ++task) {
+      int64_t bi = task / (tm * tn);
+      int64_t ti = task % (tm * tn) / tn;
+      int64_t tj = task % tn;
+      GemmTile(kernels, k, a + bi * batch_stride_a, lda, transpose_a, b + bi * batch_stride_b,
+               ldb, transpose_b, c + bi * m * n, n, ti * mb, std::min(m, (ti + 1) * mb), tj * nb,
+               std::min(n, (tj + 1) * nb), mc);
+    }
+  });
+}
+
+/*! \brief The closure of ParallelFor passed to the TVM thread pool. */
+struct ParallelClosure {
+  const std::function<void(int64_t, int64_t)>* f;
+  int64_t begin;
+  int64_t end;
+};
+
+int ParallelLambda(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+  auto* closure = static_cast<ParallelClosure*>(cdata);
+  int64_t chunk = (closure->end - closure->begin + penv->num_task - 1) / penv->num_task;
+  int64_t begin = closure->begin + task_id * chunk;
+  int64_t end = std::min(closure->end, begin + chunk);
+  if (begin < end) {
+    (*closure->f)(begin, end);
+  }
+  return 0;
+}
+
+}  // namespace
+
+ISA GetISA() {
+  static const ISA isa = []() {
+    ISA isa = DetectISA();
+    if (const char* val = getenv("RAF_CPU_ISA")) {
+      ISA requested = isa;
+      if (std::strcmp(val, "scalar") == 0) {
+        requested = ISA::kScalar;
+      } else if (std::strcmp(val, "avx2") == 0) {
+        requested = ISA::kAVX2;
+      } else if (std::strcmp(val, "avx512") == 0) {
+        requested = ISA::kAVX512;
+      } else if (std::strcmp(val, "avx512_vnni") == 0) {
+        requested = ISA::kAVX512VNNI;
+      } else {
+        LOG(FATAL) << "Unknown RAF_CPU_ISA " << val
+                   << ", expected scalar, avx2, avx512 or avx512_vnni";
+      }
+      if (requested > isa) {
+        LOG(WARNING) << "RAF_CPU_ISA=" << val << " is not supported, use " << ISAName(isa);
+      } else {
+        isa = requested;
+      }
+    }
+    return isa;
+  }();
+  return isa;
+}
+
+const char* ISAName(ISA isa) {
+  switch (isa) {
+    case ISA::kScalar:
+      return "scalar";
+    case ISA::kAVX2:
+      return "avx2";
+    case ISA::kAVX512:
+      return "avx512";
+    case ISA::kAVX512VNNI:
+      return "avx512_vnni";
+  }
+  return "unknown";
+}
+
+const Kernels* GetKernels() {
+  static const Kernels* kernels = []() {
+    switch (GetISA()) {
+      case ISA::kAVX512VNNI:
+        return GetAVX512VNNIKernels();
+      case ISA::kAVX512:
+        return GetAVX512Kernels();
+      case ISA::kAVX2:
+        return GetAVX2Kernels();
+      default:
+        return GetScalarKernels();
+    }
+  }();
+  return kernels;
+}
+
+void ParallelFor(int64_t begin, int64_t end, int64_t grain,
+                 const std::function<void(int64_t, int64_t)>& f) {
+  if (end <= begin) {
+    return;
+  }
+  int64_t num_tasks = std::min<int64_t>(device_api::CPUThreadPoolSize(),
+                                        (end - begin + grain - 1) / std::max<int64_t>(grain, 1));
+  if (num_tasks <= 1) {
+    f(begin, end);
+    return;
+  }
+  ParallelClosure closure{&f, begin, end};
+  TVMBackendParallelLaunch(ParallelLambda, &closure, static_cast<int>(num_tasks));
+}
+
+void Gemm(int64_t batch, int64_t m, int64_t n, int64_t k, const float* a, int64_t batch_stride_a,
+          bool transpose_a, const float* b, int64_t batch_stride_b, bool transpose_b, float* c) {
+  GemmImpl(batch, m, n, k, a, batch_stride_a, transpose_a, b, batch_stride_b, transpose_b, c);
+}
+
+void GemmBF16(int64_t batch, int64_t m, int64_t n, int64_t k, const uint16_t* a,
+              int64_t batch_stride_a, bool transpose_a, const uint16_t* b, int64_t batch_stride_b,
+              bool transpose_b, uint16_t* c) {
+  GemmImpl(batch, m, n, k, a, batch_stride_a, transpose_a, b, batch_stride_b, transpose_b, c);
+}
+
+void GemmS8(int64_t batch, int64_t m, int64_t n, int64_t k, const int8_t* a,
+            int64_t batch_stride_a, bool transpose_a, const int8_t* b, int64_t batch_stride_b,
+            bool transpose_b, int32_t* c) {
+  GemmImpl(batch, m, n, k, a, batch_stride_a, transpose_a, b, batch_stride_b, transpose_b, c);
+}
+
+RAF_REGISTER_DIALECT("cpu").set_enable(DevType::kCPU());
+
+RAF_REGISTER_GLOBAL("raf.backend.cpu.GetISA").set_body_typed([]() {
+  return std::string(ISAName(GetISA()));
+});
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,92 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/cpu_utils.h
+ * \brief Helper functions for the CPU dialect
+ */
+#pragma once
+#include <dlpack/dlpack.h>
+#include <functional>
+#include "./kernels/kernels.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+/*!
+ * \brief Get the best ISA supported by both the running CPU and the build. It can be lowered
+ * (but not raised) by the environment variable RAF_CPU_ISA, one of "scalar", "avx2", "avx512" and
+ * "avx512_vnni".
+ */
+ISA GetISA();
+
+/*! \brief Get the name of an ISA. */
+const char* ISAName(ISA isa);
+
+/*! \brief Get the kernels of the ISA returned by GetISA. */
+const Kernels* GetKernels();
+
+/*!
+ * \brief Run f over [begin, end) in chunks of at least grain elements on the TVM thread pool.
+ * \param begin The first index.
+ * \param end The index past the last one.
+ * \param grain The minimal number of indices of a chunk.
+ * \param f The function to process the indices in [chunk_begin, chunk_end).
+ */
+void ParallelFor(int64_t begin, int64_t end, int64_t grain,
+                 const std::function<void(int64_t, int64_t)>& f);
+
+/*!
+ * \brief Batched row-major float32 GEMM, computing C[i] = op(A[i]) * op(B[i]) for each batch.
+ * \param batch The batch size.
+ * \param m The rows of op(A) and C.
+ * \param n The columns of op(B) and C.
+ * \param k The columns of op(A) and the rows of op(B).
+ * \param a The A tensor, of shape [m, k], or [k, m] if transpose_a.
+ * \param batch_stride_a The elements between two batches of A, or 0 to broadcast it.
+ * \param transpose_a Whether op(A) is the transpose of A.
+ * \param b The B tensor, of shape [k, n], or [n, k] if transpose_b.
+ * \param batch_stride_b The elements between two batches of B, or 0 to broadcast it.
+ * \param transpose_b Whether op(B) is the transpose of B.
+ * \param c The output tensor of shape [batch, m, n], which is filled with 0 if k is 0.
+ */
+void Gemm(int64_t batch, int64_t m, int64_t n, int64_t k, const float* a, int64_t batch_stride_a,
+          bool transpose_a, const float* b, int64_t batch_stride_b, bool transpose_b, float* c);
+
+/*!
+ * \brief Batched row-major bfloat16 GEMM with float32 accumulation. The bfloat16 values are stored
+ * as uint16_t. See Gemm for the parameters.
+ */
+void GemmBF16(int64_t batch, int64_t m, int64_t n, int64_t k, const uint16_t* a,
+              int64_t batch_stride_a, bool transpose_a, const uint16_t* b, int64_t batch_stride_b,
+              bool transpose_b, uint16_t* c);
+
+/*!
+ * \brief Batched row-major int8 GEMM with int32 accumulation, which is exact as long as k is below
+ * 2^17. See Gemm for the parameters.
+ */
+void GemmS8(int64_t batch, int64_t m, int64_t n, int64_t k, const int8_t* a,
+            int64_t batch_stride_a, bool transpose_a, const int8_t* b, int64_t batch_stride_b,
+            bool transpose_b, int32_t* c);
+
+/*! \brief Whether the tensor is a float32 tensor, which is the compute dtype of the kernels. */
+inline bool IsFloat32(const DLTensor* tensor) {
+  return tensor->dtype.code == kDLFloat && tensor->dtype.bits == 32 && tensor->dtype.lanes == 1;
+}
+
+/*! \brief Whether the tensor is a bfloat16 tensor. */
+inline bool IsBFloat16(const DLTensor* tensor) {
+  return tensor->dtype.code == kDLBfloat && tensor->dtype.bits == 16 && tensor->dtype.lanes == 1;
+}
+
+/*! \brief Whether the tensor is a tensor of the given integer dtype. */
+inline bool IsInt(const DLTensor* tensor, int bits) {
+  return tensor->dtype.code == kDLInt && tensor->dtype.bits == bits && tensor->dtype.lanes == 1;
+}
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,101 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/embedding.cc
+ * \brief embedding CPU backend
+ */
+#include <cstring>
+#include "raf/op.h"
+#include "../../schema/nn.h"
+#include "./cpu_utils.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+using namespace raf::value;
+
+template <typename IndexType>
+void EmbeddingRows(const char* weight, const IndexType* indices, char* out, int64_t begin,
+                   int64_t end, int64_t num_rows, int64_t row_bytes) {
+  for (int64_t i = begin; i < end; ++i) {
+    // Out-of-range indices are clipped, as topi.take does by default.
+    int64_t row = std::min<int64_t>(std::max<int64_t>(indices[i], 0), num_rows - 1);
+    std::memcpy(out + i * row_bytes, weight + row * row_bytes, row_bytes);
+  }
+}
+
+class EmbeddingImpl : public raf::op::OpEnv {
+ public:
+  explicit EmbeddingImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.embedding");
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("indices"),
+    };
+    env_name_ = TruncateName(GetUniqueName("raf.op.cpu.embedding"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::EmbeddingArgs>();
+    Execute(std::vector<Value>{args->x, args->indices}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    int64_t row_bytes = (x->dtype.bits * x->dtype.lanes + 7) / 8;
+    for (int i = 1; i < x->ndim; ++i) {
+      row_bytes *= x->shape[i];
+    }
+    int64_t num_indices = 1;
+    for (int i = 0; i < indices->ndim; ++i) {
+      num_indices *= indices->shape[i];
+    }
+    const char* weight = static_cast<const char*>(x->data);
+    char* out_data = static_cast<char*>(out->data);
+    int64_t num_rows = x->shape[0];
+    int64_t grain = std::max<int64_t>(1, 65536 / std::max<int64_t>(row_bytes, 1));
+    ParallelFor(0, num_indices, grain, [&](int64_t begin, int64_t end) {
+      if (indices->dtype.bits == 64) {
+        EmbeddingRows(weight, static_cast<const int64_t*>(indices->data), out_data, begin, end,
+                      num_rows, row_bytes);
+      } else {
+        EmbeddingRows(weight, static_cast<const int32_t*>(indices->data), out_data, begin, end,
+                      num_rows, row_bytes);
+      }
+    });
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::EmbeddingArgs>();
+    CHECK(args != nullptr);
+    DLTensor* x = args->x;
+    DLTensor* indices = args->indices;
+    if (x->ndim == 0 || x->shape[0] == 0 || indices->dtype.code != kDLInt ||
+        (indices->dtype.bits != 32 && indices->dtype.bits != 64)) {
+      return nullptr;
+    }
+    return new EmbeddingImpl(cv);
+  }
+
+ private:
+  std::string env_name_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, embedding, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.embedding", EmbeddingImpl::make);
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,178 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/kernels/avx2.cc
+ * \brief The AVX2 kernels. This file is compiled with -mavx2 -mfma on x86-64.
+ */
+#include "./kernels.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define RAF_CPU_KERNEL_NAMESPACE avx2
+#include "./kernel_impl.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+namespace avx2 {
+
+struct AVX2Vec {
+  using Reg = __m256;
+  static constexpr int kWidth = 8;
+
+  static Reg Zero() {
+    return _mm256_setzero_ps();
+  }
+  static Reg Set1(float x) {
+    return _mm256_set1_ps(x);
+  }
+  static Reg Load(const float* p) {
+    return _mm256_loadu_ps(p);
+  }
+  static void Store(float* p, Reg x) {
+    _mm256_storeu_ps(p, x);
+  }
+  static Reg LoadBF16(const uint16_t* p) {
+    __m256i bits = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(bits, 16));
+  }
+  static void StoreBF16(uint16_t* p, Reg x) {
+    // Round to nearest even, and keep NaNs quiet instead of rounding them to infinities.
+    __m256i bits = _mm256_castps_si256(x);
+    __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+    bits = _mm256_add_epi32(bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7FFF)));
+    __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+    bits = _mm256_blendv_epi8(bits, _mm256_set1_epi32(0x7FC00000), nan);
+    bits = _mm256_srli_epi32(bits, 16);
+    // packus works within 128-bit lanes, so move the two packed halves to the lower lane.
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(bits, bits), 0xD8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(packed));
+  }
+  static Reg LoadS8(const int8_t* p) {
+    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes));
+  }
+  static Reg LoadS32(const int32_t* p) {
+    return _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+  }
+  static void StoreS8(int8_t* p, Reg x) {
+    __m256i ints = _mm256_cvttps_epi32(x);
+    __m128i lo = _mm256_castsi256_si128(ints);
+    __m128i words = _mm_packs_epi32(lo, _mm256_extracti128_si256(ints, 1));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi16(words, words));
+  }
+  static Reg Add(Reg a, Reg b) {
+    return _mm256_add_ps(a, b);
+  }
+  static Reg Sub(Reg a, Reg b) {
+    return _mm256_sub_ps(a, b);
+  }
+  static Reg Mul(Reg a, Reg b) {
+    return _mm256_mul_ps(a, b);
+  }
+  static Reg Div(Reg a, Reg b) {
+    return _mm256_div_ps(a, b);
+  }
+  static Reg FMA(Reg a, Reg b, Reg c) {
+    return _mm256_fmadd_ps(a, b, c);
+  }
+  static Reg Max(Reg a, Reg b) {
+    return _mm256_max_ps(a, b);
+  }
+  static Reg Min(Reg a, Reg b) {
+    return _mm256_min_ps(a, b);
+  }
+  static Reg Abs(Reg x) {
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+  }
+  static Reg CopySign(Reg mag, Reg sign) {
+    Reg mask = _mm256_set1_ps(-0.0f);
+    return _mm256_or_ps(_mm256_andnot_ps(mask, mag), _mm256_and_ps(mask, sign));
+  }
+  static Reg Floor(Reg x) {
+    return _mm256_floor_ps(x);
+  }
+  static Reg Round(Reg x) {
+    return _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+  static Reg Pow2n(Reg n) {
+    __m256i bits = _mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(127));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(bits, 23));
+  }
+  static float ReduceSum(Reg x) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+  }
+  static float ReduceMax(Reg x) {
+    __m128 s = _mm_max_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    s = _mm_max_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_max_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+  }
+};
+
+struct AVX2IntVec {
+  using Reg = __m256i;
+  static constexpr int kWidth = 8;
+
+  static Reg Zero() {
+    return _mm256_setzero_si256();
+  }
+  static Reg Set1(const int16_t* p) {
+    int32_t pair;
+    std::memcpy(&pair, p, sizeof(pair));
+    return _mm256_set1_epi32(pair);
+  }
+  static Reg Load(const int16_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  static Reg Dot(Reg acc, Reg a, Reg b) {
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(a, b));
+  }
+  static Reg Add(Reg a, Reg b) {
+    return _mm256_add_epi32(a, b);
+  }
+  static Reg LoadAcc(const int32_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  static void StoreAcc(int32_t* p, Reg x) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+  }
+};
+
+}  // namespace avx2
+
+const Kernels* GetAVX2Kernels() {
+  static const Kernels kernels = []() {
+    // 6x16 tiles keep 12 accumulators in the 16 ymm registers.
+    Kernels kernels = avx2::MakeKernels<avx2::AVX2Vec, 6, 16>(ISA::kAVX2);
+    avx2::SetGemmS8<avx2::AVX2IntVec, 6, 16>(&kernels);
+    return kernels;
+  }();
+  return &kernels;
+}
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
+
+#else
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+const Kernels* GetAVX2Kernels() {
+  return nullptr;
+}
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
+
+#endif
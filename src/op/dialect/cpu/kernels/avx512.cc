@@ -0,0 +1,185 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/kernels/avx512.cc
+ * \brief The AVX-512 kernels. This file is compiled with -mavx512f -mavx512bw -mavx2 -mfma on
+ * x86-64.
+ */
+#include "./kernels.h"
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#include <immintrin.h>
+#define RAF_CPU_KERNEL_NAMESPACE avx512
+#include "./kernel_impl.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+namespace avx512 {
+
+struct AVX512Vec {
+  using Reg = __m512;
+  static constexpr int kWidth = 16;
+
+  static Reg Zero() {
+    return _mm512_setzero_ps();
+  }
+  static Reg Set1(float x) {
+    return _mm512_set1_ps(x);
+  }
+  static Reg Load(const float* p) {
+    return _mm512_loadu_ps(p);
+  }
+  static void Store(float* p, Reg x) {
+    _mm512_storeu_ps(p, x);
+  }
+  static Reg LoadBF16(const uint16_t* p) {
+    __m512i bits = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(bits, 16));
+  }
+  static void StoreBF16(uint16_t* p, Reg x) {
+    // Round to nearest even, and keep NaNs quiet instead of rounding them to infinities.
+    // vcvtneps2bf16 does the same but needs AVX512-BF16, which is not in the baseline AVX-512.
+    __m512i bits = _mm512_castps_si512(x);
+    __m512i lsb = _mm512_and_si512(_mm512_srli_epi32(bits, 16), _mm512_set1_epi32(1));
+    bits = _mm512_add_epi32(bits, _mm512_add_epi32(lsb, _mm512_set1_epi32(0x7FFF)));
+    __mmask16 nan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+    bits = _mm512_mask_blend_epi32(nan, bits, _mm512_set1_epi32(0x7FC00000));
+    __m256i packed = _mm512_cvtepi32_epi16(_mm512_srli_epi32(bits, 16));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), packed);
+  }
+  static Reg LoadS8(const int8_t* p) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(bytes));
+  }
+  static Reg LoadS32(const int32_t* p) {
+    return _mm512_cvtepi32_ps(_mm512_loadu_si512(p));
+  }
+  static void StoreS8(int8_t* p, Reg x) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_cvtsepi32_epi8(_mm512_cvttps_epi32(x)));
+  }
+  static Reg Add(Reg a, Reg b) {
+    return _mm512_add_ps(a, b);
+  }
+  static Reg Sub(Reg a, Reg b) {
+    return _mm512_sub_ps(a, b);
+  }
+  static Reg Mul(Reg a, Reg b) {
+    return _mm512_mul_ps(a, b);
+  }
+  static Reg Div(Reg a, Reg b) {
+    return _mm512_div_ps(a, b);
+  }
+  static Reg FMA(Reg a, Reg b, Reg c) {
+    return _mm512_fmadd_ps(a, b, c);
+  }
+  static Reg Max(Reg a, Reg b) {
+    return _mm512_max_ps(a, b);
+  }
+  static Reg Min(Reg a, Reg b) {
+    return _mm512_min_ps(a, b);
+  }
+  static Reg Abs(Reg x) {
+    return _mm512_abs_ps(x);
+  }
+  static Reg CopySign(Reg mag, Reg sign) {
+    // Bitwise float ops need AVX512DQ, so go through the integer domain.
+    __m512i mask = _mm512_set1_epi32(0x80000000);
+    __m512i bits = _mm512_or_si512(_mm512_andnot_si512(mask, _mm512_castps_si512(mag)),
+                                   _mm512_and_si512(mask, _mm512_castps_si512(sign)));
+    return _mm512_castsi512_ps(bits);
+  }
+  static Reg Floor(Reg x) {
+    return _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  }
+  static Reg Round(Reg x) {
+    return _mm512_roundscale_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+  static Reg Pow2n(Reg n) {
+    __m512i bits = _mm512_add_epi32(_mm512_cvttps_epi32(n), _mm512_set1_epi32(127));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(bits, 23));
+  }
+  // The reductions run once per row, so spilling the lanes is cheap enough.
+  static float ReduceSum(Reg x) {
+    alignas(64) float lanes[kWidth];
+    _mm512_store_ps(lanes, x);
+    float ret = lanes[0];
+    for (int i = 1; i < kWidth; ++i) {
+      ret += lanes[i];
+    }
+    return ret;
+  }
+  static float ReduceMax(Reg x) {
+    alignas(64) float lanes[kWidth];
+    _mm512_store_ps(lanes, x);
+    float ret = lanes[0];
+    for (int i = 1; i < kWidth; ++i) {
+      ret = std::max(ret, lanes[i]);
+    }
+    return ret;
+  }
+};
+
+struct AVX512IntVec {
+  using Reg = __m512i;
+  static constexpr int kWidth = 16;
+
+  static Reg Zero() {
+    return _mm512_setzero_si512();
+  }
+  static Reg Set1(const int16_t* p) {
+    int32_t pair;
+    std::memcpy(&pair, p, sizeof(pair));
+    return _mm512_set1_epi32(pair);
+  }
+  static Reg Load(const int16_t* p) {
+    return _mm512_loadu_si512(p);
+  }
+  static Reg Dot(Reg acc, Reg a, Reg b) {
+    return _mm512_add_epi32(acc, _mm512_madd_epi16(a, b));
+  }
+  static Reg Add(Reg a, Reg b) {
+    return _mm512_add_epi32(a, b);
+  }
+  static Reg LoadAcc(const int32_t* p) {
+    return _mm512_loadu_si512(p);
+  }
+  static void StoreAcc(int32_t* p, Reg x) {
+    _mm512_storeu_si512(p, x);
+  }
+};
+
+}  // namespace avx512
+
+const Kernels* GetAVX512Kernels() {
+  static const Kernels kernels = []() {
+    // 12x32 tiles keep 24 accumulators in the 32 zmm registers.
+    Kernels kernels = avx512::MakeKernels<avx512::AVX512Vec, 12, 32>(ISA::kAVX512);
+    avx512::SetGemmS8<avx512::AVX512IntVec, 12, 32>(&kernels);
+    return kernels;
+  }();
+  return &kernels;
+}
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
+
+#else
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+const Kernels* GetAVX512Kernels() {
+  return nullptr;
+}
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
+
+#endif
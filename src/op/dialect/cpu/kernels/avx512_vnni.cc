@@ -0,0 +1,91 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/kernels/avx512_vnni.cc
+ * \brief The AVX-512 kernels with the VNNI int8 GEMM. This file is compiled with -mavx512f
+ * -mavx512bw -mavx512vnni -mavx2 -mfma on x86-64. Only the int8 GEMM differs from avx512.cc.
+ */
+#include "./kernels.h"
+
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VNNI__)
+#include <immintrin.h>
+#define RAF_CPU_KERNEL_NAMESPACE avx512_vnni
+#include "./kernel_impl.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+namespace avx512_vnni {
+
+struct AVX512VNNIIntVec {
+  using Reg = __m512i;
+  static constexpr int kWidth = 16;
+
+  static Reg Zero() {
+    return _mm512_setzero_si512();
+  }
+  static Reg Set1(const int16_t* p) {
+    int32_t pair;
+    std::memcpy(&pair, p, sizeof(pair));
+    return _mm512_set1_epi32(pair);
+  }
+  static Reg Load(const int16_t* p) {
+    return _mm512_loadu_si512(p);
+  }
+  static Reg Dot(Reg acc, Reg a, Reg b) {
+    // vpdpwssd fuses the pairwise multiplies of vpmaddwd with the accumulation. It is written in
+    // assembly because GCC copies the accumulator before and after _mm512_dpwssd_epi32, which
+    // spills the accumulators of the micro-kernel and halves its throughput.
+    asm("vpdpwssd %2, %1, %0" : "+v"(acc) : "v"(a), "v"(b));
+    return acc;
+  }
+  static Reg Add(Reg a, Reg b) {
+    return _mm512_add_epi32(a, b);
+  }
+  static Reg LoadAcc(const int32_t* p) {
+    return _mm512_loadu_si512(p);
+  }
+  static void StoreAcc(int32_t* p, Reg x) {
+    _mm512_storeu_si512(p, x);
+  }
+};
+
+}  // namespace avx512_vnni
+
+const Kernels* GetAVX512VNNIKernels() {
+  const Kernels* avx512 = GetAVX512Kernels();
+  if (avx512 == nullptr) {
+    return nullptr;
+  }
+  static const Kernels kernels = [avx512]() {
+    Kernels kernels = *avx512;
+    kernels.isa = ISA::kAVX512VNNI;
+    // 12x32 tiles keep 24 accumulators in the 32 zmm registers.
+    avx512_vnni::SetGemmS8<avx512_vnni::AVX512VNNIIntVec, 12, 32>(&kernels);
+    return kernels;
+  }();
+  return &kernels;
+}
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
+
+#else
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+const Kernels* GetAVX512VNNIKernels() {
+  return nullptr;
+}
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
+
+#endif
@@ -0,0 +1,549 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/kernels/kernel_impl.h
+ * \brief The kernels written once against a vector abstraction. Each ISA translation unit defines
+ * RAF_CPU_KERNEL_NAMESPACE and a vector type, includes this file and instantiates the kernels, so
+ * the instantiations of different ISAs never get merged by the linker.
+ *
+ * A vector type provides the register type Reg, its width kWidth and the following static
+ * functions: Zero, Set1, Load, Store, LoadBF16, StoreBF16, LoadS8, LoadS32, StoreS8, Add, Sub, Mul,
+ * Div, FMA, Max, Min, Abs, CopySign, Floor, Round, Pow2n, ReduceSum and ReduceMax.
+ *
+ * An integer vector type for the int8 GEMM provides the register type Reg of kWidth int32 lanes,
+ * and the following static functions: Zero, Set1 and Load of int16 pairs, Dot, Add, LoadAcc and
+ * StoreAcc.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "./kernels.h"
+
+#ifndef RAF_CPU_KERNEL_NAMESPACE
+#error "RAF_CPU_KERNEL_NAMESPACE must be defined before including kernel_impl.h"
+#endif
+
+#if defined(__clang__)
+#define RAF_CPU_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define RAF_CPU_UNROLL _Pragma("GCC unroll 32")
+#else
+#define RAF_CPU_UNROLL
+#endif
+
+namespace raf {
+namespace op {
+namespace cpu {
+namespace RAF_CPU_KERNEL_NAMESPACE {
+
+/*! \brief The vector type of a single lane, used for the tails of the vectorized loops. */
+struct ScalarVec {
+  using Reg = float;
+  static constexpr int kWidth = 1;
+
+  static Reg Zero() {
+    return 0.0f;
+  }
+  static Reg Set1(float x) {
+    return x;
+  }
+  static Reg Load(const float* p) {
+    return *p;
+  }
+  static void Store(float* p, Reg x) {
+    *p = x;
+  }
+  static Reg LoadBF16(const uint16_t* p) {
+    return BF16ToFloat(*p);
+  }
+  static void StoreBF16(uint16_t* p, Reg x) {
+    *p = FloatToBF16(x);
+  }
+  static Reg LoadS8(const int8_t* p) {
+    return static_cast<float>(*p);
+  }
+  static Reg LoadS32(const int32_t* p) {
+    return static_cast<float>(*p);
+  }
+  static void StoreS8(int8_t* p, Reg x) {
+    *p = static_cast<int8_t>(x);
+  }
+  static Reg Add(Reg a, Reg b) {
+    return a + b;
+  }
+  static Reg Sub(Reg a, Reg b) {
+    return a - b;
+  }
+  static Reg Mul(Reg a, Reg b) {
+    return a * b;
+  }
+  static Reg Div(Reg a, Reg b) {
+    return a / b;
+  }
+  static Reg FMA(Reg a, Reg b, Reg c) {
+    return a * b + c;
+  }
+  static Reg Max(Reg a, Reg b) {
+    return a > b ? a : b;
+  }
+  static Reg Min(Reg a, Reg b) {
+    return a < b ? a : b;
+  }
+  static Reg Abs(Reg x) {
+    return std::fabs(x);
+  }
+  static Reg CopySign(Reg mag, Reg sign) {
+    return std::copysign(mag, sign);
+  }
+  static Reg Floor(Reg x) {
+    return std::floor(x);
+  }
+  static Reg Round(Reg x) {
+    return std::nearbyint(x);
+  }
+  static Reg Pow2n(Reg n) {
+    int32_t bits = (static_cast<int32_t>(n) + 127) << 23;
+    float ret;
+    std::memcpy(&ret, &bits, sizeof(ret));
+    return ret;
+  }
+  static float ReduceSum(Reg x) {
+    return x;
+  }
+  static float ReduceMax(Reg x) {
+    return x;
+  }
+};
+
+/*! \brief The integer vector type of a single int32 lane, holding a pair of int16. */
+struct ScalarIntVec {
+  using Reg = int32_t;
+  static constexpr int kWidth = 1;
+
+  static Reg Zero() {
+    return 0;
+  }
+  static Reg Set1(const int16_t* p) {
+    Reg ret;
+    std::memcpy(&ret, p, sizeof(ret));
+    return ret;
+  }
+  static Reg Load(const int16_t* p) {
+    return Set1(p);
+  }
+  /*! \brief Multiply the int16 pairs of a and b, and add the two products to acc. */
+  static Reg Dot(Reg acc, Reg a, Reg b) {
+    int16_t x[2], y[2];
+    std::memcpy(x, &a, sizeof(x));
+    std::memcpy(y, &b, sizeof(y));
+    return acc + x[0] * y[0] + x[1] * y[1];
+  }
+  static Reg Add(Reg a, Reg b) {
+    return a + b;
+  }
+  static Reg LoadAcc(const int32_t* p) {
+    return *p;
+  }
+  static void StoreAcc(int32_t* p, Reg x) {
+    *p = x;
+  }
+};
+
+/*!
+ * \brief The exponential function, with the range reduction and the polynomial of Cephes. The
+ * input is clamped so that the result stays a normal float.
+ */
+template <typename V>
+inline typename V::Reg Exp(typename V::Reg x) {
+  using Reg = typename V::Reg;
+  x = V::Min(V::Max(x, V::Set1(-87.3f)), V::Set1(88.0f));
+  // exp(x) = 2^n * exp(r), where n = floor(x / ln(2) + 0.5) and r = x - n * ln(2)
+  Reg n = V::Floor(V::FMA(x, V::Set1(1.44269504088896341f), V::Set1(0.5f)));
+  x = V::Sub(x, V::Mul(n, V::Set1(0.693359375f)));
+  x = V::Sub(x, V::Mul(n, V::Set1(-2.12194440e-4f)));
+  Reg y = V::Set1(1.9875691500e-4f);
+  y = V::FMA(y, x, V::Set1(1.3981999507e-3f));
+  y = V::FMA(y, x, V::Set1(8.3334519073e-3f));
+  y = V::FMA(y, x, V::Set1(4.1665795894e-2f));
+  y = V::FMA(y, x, V::Set1(1.6666665459e-1f));
+  y = V::FMA(y, x, V::Set1(5.0000001201e-1f));
+  y = V::FMA(y, V::Mul(x, x), V::Add(x, V::Set1(1.0f)));
+  return V::Mul(y, V::Pow2n(n));
+}
+
+/*! \brief The error function (Abramowitz and Stegun 7.1.26, absolute error below 1.5e-7). */
+template <typename V>
+inline typename V::Reg Erf(typename V::Reg x) {
+  using Reg = typename V::Reg;
+  Reg ax = V::Abs(x);
+  Reg t = V::Div(V::Set1(1.0f), V::FMA(ax, V::Set1(0.3275911f), V::Set1(1.0f)));
+  Reg p = V::Set1(1.061405429f);
+  p = V::FMA(p, t, V::Set1(-1.453152027f));
+  p = V::FMA(p, t, V::Set1(1.421413741f));
+  p = V::FMA(p, t, V::Set1(-0.284496736f));
+  p = V::FMA(p, t, V::Set1(0.254829592f));
+  p = V::Mul(p, t);
+  Reg e = Exp<V>(V::Sub(V::Zero(), V::Mul(ax, ax)));
+  return V::CopySign(V::Sub(V::Set1(1.0f), V::Mul(p, e)), x);
+}
+
+struct ReluOp {
+  template <typename V>
+  static typename V::Reg Apply(typename V::Reg x) {
+    return V::Max(x, V::Zero());
+  }
+};
+
+struct GeluOp {
+  template <typename V>
+  static typename V::Reg Apply(typename V::Reg x) {
+    // gelu(x) = x * 0.5 * (1 + erf(x / sqrt(2)))
+    auto cdf = V::FMA(Erf<V>(V::Mul(x, V::Set1(0.70710678118654752f))), V::Set1(0.5f),
+                      V::Set1(0.5f));
+    return V::Mul(x, cdf);
+  }
+};
+
+struct TanhOp {
+  template <typename V>
+  static typename V::Reg Apply(typename V::Reg x) {
+    // tanh(|x|) = 1 - 2 / (exp(2|x|) + 1), which does not overflow for large |x|
+    auto e = Exp<V>(V::Mul(V::Abs(x), V::Set1(2.0f)));
+    auto t = V::Sub(V::Set1(1.0f), V::Div(V::Set1(2.0f), V::Add(e, V::Set1(1.0f))));
+    return V::CopySign(t, x);
+  }
+};
+
+struct SigmoidOp {
+  template <typename V>
+  static typename V::Reg Apply(typename V::Reg x) {
+    auto e = Exp<V>(V::Sub(V::Zero(), x));
+    return V::Div(V::Set1(1.0f), V::Add(e, V::Set1(1.0f)));
+  }
+};
+
+template <typename V, typename Op>
+void MapUnary(const float* x, float* y, int64_t n) {
+  int64_t i = 0;
+  for (; i + V::kWidth <= n; i += V::kWidth) {
+    V::Store(y + i, Op::template Apply<V>(V::Load(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = Op::template Apply<ScalarVec>(x[i]);
+  }
+}
+
+template <typename V>
+void Unary(UnaryKind kind, const float* x, float* y, int64_t n) {
+  switch (kind) {
+    case UnaryKind::kRelu:
+      return MapUnary<V, ReluOp>(x, y, n);
+    case UnaryKind::kGelu:
+      return MapUnary<V, GeluOp>(x, y, n);
+    case UnaryKind::kTanh:
+      return MapUnary<V, TanhOp>(x, y, n);
+    case UnaryKind::kSigmoid:
+      return MapUnary<V, SigmoidOp>(x, y, n);
+  }
+}
+
+template <typename V>
+float RowSum(const float* x, int64_t n) {
+  auto acc = V::Zero();
+  int64_t i = 0;
+  for (; i + V::kWidth <= n; i += V::kWidth) {
+    acc = V::Add(acc, V::Load(x + i));
+  }
+  float sum = V::ReduceSum(acc);
+  for (; i < n; ++i) {
+    sum += x[i];
+  }
+  return sum;
+}
+
+template <typename V>
+void Softmax(const float* x, float* y, int64_t rows, int64_t n) {
+  for (int64_t r = 0; r < rows; ++r, x += n, y += n) {
+    auto vmax = V::Set1(-std::numeric_limits<float>::infinity());
+    int64_t i = 0;
+    for (; i + V::kWidth <= n; i += V::kWidth) {
+      vmax = V::Max(vmax, V::Load(x + i));
+    }
+    float max = V::ReduceMax(vmax);
+    for (; i < n; ++i) {
+      max = std::max(max, x[i]);
+    }
+    auto vsum = V::Zero();
+    auto vshift = V::Set1(max);
+    for (i = 0; i + V::kWidth <= n; i += V::kWidth) {
+      auto e = Exp<V>(V::Sub(V::Load(x + i), vshift));
+      V::Store(y + i, e);
+      vsum = V::Add(vsum, e);
+    }
+    float sum = V::ReduceSum(vsum);
+    for (; i < n; ++i) {
+      y[i] = Exp<ScalarVec>(x[i] - max);
+      sum += y[i];
+    }
+    auto vscale = V::Set1(1.0f / sum);
+    for (i = 0; i + V::kWidth <= n; i += V::kWidth) {
+      V::Store(y + i, V::Mul(V::Load(y + i), vscale));
+    }
+    for (; i < n; ++i) {
+      y[i] *= 1.0f / sum;
+    }
+  }
+}
+
+template <typename V>
+void LayerNorm(const float* x, const float* scale, const float* bias, float* y, int64_t rows,
+               int64_t n, float eps) {
+  for (int64_t r = 0; r < rows; ++r, x += n, y += n) {
+    float mean = RowSum<V>(x, n) / n;
+    auto vmean = V::Set1(mean);
+    auto vvar = V::Zero();
+    int64_t i = 0;
+    for (; i + V::kWidth <= n; i += V::kWidth) {
+      auto d = V::Sub(V::Load(x + i), vmean);
+      vvar = V::FMA(d, d, vvar);
+    }
+    float var = V::ReduceSum(vvar);
+    for (; i < n; ++i) {
+      var += (x[i] - mean) * (x[i] - mean);
+    }
+    float rstd = 1.0f / std::sqrt(var / n + eps);
+    auto vrstd = V::Set1(rstd);
+    for (i = 0; i + V::kWidth <= n; i += V::kWidth) {
+      auto v = V::Mul(V::Sub(V::Load(x + i), vmean), vrstd);
+      if (scale != nullptr) {
+        v = V::FMA(v, V::Load(scale + i), V::Load(bias + i));
+      }
+      V::Store(y + i, v);
+    }
+    for (; i < n; ++i) {
+      y[i] = (x[i] - mean) * rstd;
+      if (scale != nullptr) {
+        y[i] = y[i] * scale[i] + bias[i];
+      }
+    }
+  }
+}
+
+template <typename V>
+void CastToBF16(const float* x, uint16_t* y, int64_t n) {
+  int64_t i = 0;
+  for (; i + V::kWidth <= n; i += V::kWidth) {
+    V::StoreBF16(y + i, V::Load(x + i));
+  }
+  for (; i < n; ++i) {
+    y[i] = FloatToBF16(x[i]);
+  }
+}
+
+template <typename V>
+void CastFromBF16(const uint16_t* x, float* y, int64_t n) {
+  int64_t i = 0;
+  for (; i + V::kWidth <= n; i += V::kWidth) {
+    V::Store(y + i, V::LoadBF16(x + i));
+  }
+  for (; i < n; ++i) {
+    y[i] = BF16ToFloat(x[i]);
+  }
+}
+
+/*! \brief Load elements of any supported dtype to float32. */
+template <typename V>
+inline typename V::Reg LoadAsFloat(const float* p) {
+  return V::Load(p);
+}
+template <typename V>
+inline typename V::Reg LoadAsFloat(const int8_t* p) {
+  return V::LoadS8(p);
+}
+template <typename V>
+inline typename V::Reg LoadAsFloat(const int32_t* p) {
+  return V::LoadS32(p);
+}
+
+/*! \brief Store float32 elements, rounding to nearest even and saturating for int8. */
+template <typename V>
+inline void StoreFromFloat(float* p, typename V::Reg x) {
+  V::Store(p, x);
+}
+template <typename V>
+inline void StoreFromFloat(int8_t* p, typename V::Reg x) {
+  x = V::Min(V::Max(x, V::Set1(-127.0f)), V::Set1(127.0f));
+  V::StoreS8(p, V::Round(x));
+}
+
+/*!
+ * \brief Scale n elements as y = x / scale if Divide, otherwise y = x * scale, in float32. scale
+ * has n elements if per_element, otherwise a single one. Quantization divides by the scale
+ * instead of multiplying by its reciprocal, to round the same as the TVM kernels.
+ */
+template <typename V, typename TIn, typename TOut, bool Divide>
+void Rescale(const TIn* x, const float* scale, bool per_element, TOut* y, int64_t n) {
+  auto vscale = V::Set1(scale[0]);
+  int64_t i = 0;
+  for (; i + V::kWidth <= n; i += V::kWidth) {
+    auto s = per_element ? V::Load(scale + i) : vscale;
+    auto v = LoadAsFloat<V>(x + i);
+    StoreFromFloat<V>(y + i, Divide ? V::Div(v, s) : V::Mul(v, s));
+  }
+  for (; i < n; ++i) {
+    float s = per_element ? scale[i] : scale[0];
+    float v = LoadAsFloat<ScalarVec>(x + i);
+    StoreFromFloat<ScalarVec>(y + i, Divide ? v / s : v * s);
+  }
+}
+
+template <typename V, int MR, int NR>
+void Gemm(int64_t kc, const float* a, const float* b, float* c, int64_t ldc, int64_t mr,
+          int64_t nr, bool accumulate) {
+  using Reg = typename V::Reg;
+  constexpr int NV = NR / V::kWidth;
+  static_assert(NR % V::kWidth == 0, "NR must be a multiple of the vector width");
+  // The accumulators are fully unrolled to stay in registers.
+  Reg acc[MR][NV];
+  RAF_CPU_UNROLL
+  for (int i = 0; i < MR; ++i) {
+    RAF_CPU_UNROLL
+    for (int j = 0; j < NV; ++j) {
+      acc[i][j] = V::Zero();
+    }
+  }
+  for (int64_t k = 0; k < kc; ++k, a += MR, b += NR) {
+    Reg bv[NV];
+    RAF_CPU_UNROLL
+    for (int j = 0; j < NV; ++j) {
+      bv[j] = V::Load(b + j * V::kWidth);
+    }
+    RAF_CPU_UNROLL
+    for (int i = 0; i < MR; ++i) {
+      Reg av = V::Set1(a[i]);
+      RAF_CPU_UNROLL
+      for (int j = 0; j < NV; ++j) {
+        acc[i][j] = V::FMA(av, bv[j], acc[i][j]);
+      }
+    }
+  }
+  if (mr == MR && nr == NR) {
+    RAF_CPU_UNROLL
+    for (int i = 0; i < MR; ++i) {
+      RAF_CPU_UNROLL
+      for (int j = 0; j < NV; ++j) {
+        float* p = c + i * ldc + j * V::kWidth;
+        V::Store(p, accumulate ? V::Add(V::Load(p), acc[i][j]) : acc[i][j]);
+      }
+    }
+    return;
+  }
+  // Edge tiles go through a local buffer to avoid writing out of bounds.
+  float tile[MR * NR];
+  for (int i = 0; i < MR; ++i) {
+    for (int j = 0; j < NV; ++j) {
+      V::Store(tile + i * NR + j * V::kWidth, acc[i][j]);
+    }
+  }
+  for (int64_t i = 0; i < mr; ++i) {
+    for (int64_t j = 0; j < nr; ++j) {
+      c[i * ldc + j] = accumulate ? c[i * ldc + j] + tile[i * NR + j] : tile[i * NR + j];
+    }
+  }
+}
+
+template <typename IV, int MR, int NR>
+void GemmS8(int64_t kp, const int16_t* a, const int16_t* b, int32_t* c, int64_t ldc, int64_t mr,
+            int64_t nr, bool accumulate) {
+  using Reg = typename IV::Reg;
+  constexpr int NV = NR / IV::kWidth;
+  static_assert(NR % IV::kWidth == 0, "NR must be a multiple of the vector width");
+  Reg acc[MR][NV];
+  RAF_CPU_UNROLL
+  for (int i = 0; i < MR; ++i) {
+    RAF_CPU_UNROLL
+    for (int j = 0; j < NV; ++j) {
+      acc[i][j] = IV::Zero();
+    }
+  }
+  for (int64_t p = 0; p < kp; ++p, a += 2 * MR, b += 2 * NR) {
+    Reg bv[NV];
+    RAF_CPU_UNROLL
+    for (int j = 0; j < NV; ++j) {
+      bv[j] = IV::Load(b + 2 * j * IV::kWidth);
+    }
+    RAF_CPU_UNROLL
+    for (int i = 0; i < MR; ++i) {
+      Reg av = IV::Set1(a + 2 * i);
+      RAF_CPU_UNROLL
+      for (int j = 0; j < NV; ++j) {
+        acc[i][j] = IV::Dot(acc[i][j], av, bv[j]);
+      }
+    }
+  }
+  if (mr == MR && nr == NR) {
+    RAF_CPU_UNROLL
+    for (int i = 0; i < MR; ++i) {
+      RAF_CPU_UNROLL
+      for (int j = 0; j < NV; ++j) {
+        int32_t* p = c + i * ldc + j * IV::kWidth;
+        IV::StoreAcc(p, accumulate ? IV::Add(IV::LoadAcc(p), acc[i][j]) : acc[i][j]);
+      }
+    }
+    return;
+  }
+  int32_t tile[MR * NR];
+  for (int i = 0; i < MR; ++i) {
+    for (int j = 0; j < NV; ++j) {
+      IV::StoreAcc(tile + i * NR + j * IV::kWidth, acc[i][j]);
+    }
+  }
+  for (int64_t i = 0; i < mr; ++i) {
+    for (int64_t j = 0; j < nr; ++j) {
+      c[i * ldc + j] = accumulate ? c[i * ldc + j] + tile[i * NR + j] : tile[i * NR + j];
+    }
+  }
+}
+
+/*! \brief Set the int8 GEMM of an integer vector type in the kernel table. */
+template <typename IV, int MR, int NR>
+void SetGemmS8(Kernels* kernels) {
+  kernels->gemm_s8_mr = MR;
+  kernels->gemm_s8_nr = NR;
+  kernels->gemm_s8 = GemmS8<IV, MR, NR>;
+}
+
+/*!
+ * \brief Make the kernel table of a vector type. The int8 GEMM is left to SetGemmS8, because it
+ * may need other instructions than the float32 kernels.
+ */
+template <typename V, int MR, int NR>
+Kernels MakeKernels(ISA isa) {
+  Kernels kernels;
+  kernels.isa = isa;
+  kernels.gemm_mr = MR;
+  kernels.gemm_nr = NR;
+  kernels.gemm = Gemm<V, MR, NR>;
+  kernels.softmax = Softmax<V>;
+  kernels.layer_norm = LayerNorm<V>;
+  kernels.unary = Unary<V>;
+  kernels.cast_f32_to_bf16 = CastToBF16<V>;
+  kernels.cast_bf16_to_f32 = CastFromBF16<V>;
+  kernels.quantize_f32 = Rescale<V, float, int8_t, true>;
+  kernels.requantize_s32 = Rescale<V, int32_t, int8_t, false>;
+  kernels.dequantize_s8 = Rescale<V, int8_t, float, false>;
+  kernels.dequantize_s32 = Rescale<V, int32_t, float, false>;
+  return kernels;
+}
+
+}  // namespace RAF_CPU_KERNEL_NAMESPACE
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
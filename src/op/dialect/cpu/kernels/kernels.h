@@ -0,0 +1,138 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/kernels/kernels.h
+ * \brief The ISA-specific CPU kernels. Each ISA is compiled in its own translation unit with the
+ * matching compiler flags, and the kernels are selected at runtime by the detected ISA.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+/*! \brief The instruction sets with dedicated kernels, in ascending order of capability. */
+enum class ISA : int {
+  kScalar = 0,
+  kAVX2 = 1,
+  kAVX512 = 2,
+  kAVX512VNNI = 3,
+};
+
+/*! \brief The elementwise activations. */
+enum class UnaryKind : int {
+  kRelu = 0,
+  kGelu = 1,
+  kTanh = 2,
+  kSigmoid = 3,
+};
+
+/*! \brief Convert a bfloat16, stored as its upper 16 bits of float32, to float32. */
+inline float BF16ToFloat(uint16_t x) {
+  uint32_t bits = static_cast<uint32_t>(x) << 16;
+  float ret;
+  std::memcpy(&ret, &bits, sizeof(ret));
+  return ret;
+}
+
+/*! \brief Convert a float32 to bfloat16, rounding to nearest even and keeping NaNs quiet. */
+inline uint16_t FloatToBF16(float x) {
+  uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+    return 0x7FC0;
+  }
+  bits += 0x7FFFu + ((bits >> 16) & 1u);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+/*!
+ * \brief The kernel table of an ISA. All kernels except the int8 GEMM compute in float32 and work
+ * on a given range of rows or elements, so that the caller can partition the work over threads.
+ */
+struct Kernels {
+  /*! \brief The ISA of the kernels. */
+  ISA isa;
+  /*! \brief The number of rows of the GEMM micro-kernel. */
+  int gemm_mr;
+  /*! \brief The number of columns of the GEMM micro-kernel. */
+  int gemm_nr;
+  /*!
+   * \brief The GEMM micro-kernel, computing C[mr, nr] (+)= A[mr, kc] * B[kc, nr].
+   * \param kc The reduction size.
+   * \param a The packed A strip, kc columns of gemm_mr elements.
+   * \param b The packed B strip, kc rows of gemm_nr elements.
+   * \param c The output tile.
+   * \param ldc The row stride of C.
+   * \param mr The valid rows of the tile, which is at most gemm_mr.
+   * \param nr The valid columns of the tile, which is at most gemm_nr.
+   * \param accumulate Whether to accumulate to C instead of overwriting it.
+   */
+  void (*gemm)(int64_t kc, const float* a, const float* b, float* c, int64_t ldc, int64_t mr,
+               int64_t nr, bool accumulate);
+  /*! \brief Softmax over each of the rows of length n. */
+  void (*softmax)(const float* x, float* y, int64_t rows, int64_t n);
+  /*! \brief Layer normalization over each of the rows of length n. scale and bias may be null. */
+  void (*layer_norm)(const float* x, const float* scale, const float* bias, float* y, int64_t rows,
+                     int64_t n, float eps);
+  /*! \brief Apply an activation to n elements. */
+  void (*unary)(UnaryKind kind, const float* x, float* y, int64_t n);
+  /*! \brief Convert n float32 elements to bfloat16 (see FloatToBF16). */
+  void (*cast_f32_to_bf16)(const float* x, uint16_t* y, int64_t n);
+  /*! \brief Convert n bfloat16 elements to float32. */
+  void (*cast_bf16_to_f32)(const uint16_t* x, float* y, int64_t n);
+  /*! \brief The number of rows of the int8 GEMM micro-kernel. */
+  int gemm_s8_mr;
+  /*! \brief The number of columns of the int8 GEMM micro-kernel. */
+  int gemm_s8_nr;
+  /*!
+   * \brief The int8 GEMM micro-kernel, computing C[mr, nr] (+)= A[mr, 2 * kp] * B[2 * kp, nr] in
+   * int32. The int8 operands are sign-extended to int16 and packed in pairs along the reduction
+   * axis, so that a 32-bit lane multiplies and adds a pair at once without overflow.
+   * \param kp The number of reduction pairs.
+   * \param a The packed A strip, kp pairs of gemm_s8_mr rows.
+   * \param b The packed B strip, kp pairs of gemm_s8_nr columns.
+   * \param c The output tile.
+   * \param ldc The row stride of C.
+   * \param mr The valid rows of the tile, which is at most gemm_s8_mr.
+   * \param nr The valid columns of the tile, which is at most gemm_s8_nr.
+   * \param accumulate Whether to accumulate to C instead of overwriting it.
+   */
+  void (*gemm_s8)(int64_t kp, const int16_t* a, const int16_t* b, int32_t* c, int64_t ldc,
+                  int64_t mr, int64_t nr, bool accumulate);
+  /*!
+   * \brief Quantize n float32 elements to int8 as y = clamp(round(x / scale), -127, 127), where
+   * round is to nearest even. scale has n elements if per_element, otherwise a single one.
+   */
+  void (*quantize_f32)(const float* x, const float* scale, bool per_element, int8_t* y, int64_t n);
+  /*! \brief Requantize n int32 elements to int8 as clamp(round(x * scale), -127, 127). */
+  void (*requantize_s32)(const int32_t* x, const float* scale, bool per_element, int8_t* y,
+                         int64_t n);
+  /*! \brief Dequantize n int8 elements to float32 as x * scale. */
+  void (*dequantize_s8)(const int8_t* x, const float* scale, bool per_element, float* y, int64_t n);
+  /*! \brief Dequantize n int32 elements to float32 as x * scale. */
+  void (*dequantize_s32)(const int32_t* x, const float* scale, bool per_element, float* y,
+                         int64_t n);
+};
+
+/*! \brief The portable kernels, which are always available. */
+const Kernels* GetScalarKernels();
+
+/*! \brief The AVX2 and FMA kernels, or nullptr if they are not compiled in. */
+const Kernels* GetAVX2Kernels();
+
+/*! \brief The AVX-512 (F and BW) kernels, or nullptr if they are not compiled in. */
+const Kernels* GetAVX512Kernels();
+
+/*! \brief The AVX-512 kernels with the VNNI int8 GEMM, or nullptr if they are not compiled in. */
+const Kernels* GetAVX512VNNIKernels();
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
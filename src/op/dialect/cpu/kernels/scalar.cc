@@ -0,0 +1,28 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/kernels/scalar.cc
+ * \brief The portable kernels, compiled with the baseline flags.
+ */
+#define RAF_CPU_KERNEL_NAMESPACE scalar
+#include "./kernel_impl.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+const Kernels* GetScalarKernels() {
+  static const Kernels kernels = []() {
+    Kernels kernels = scalar::MakeKernels<scalar::ScalarVec, 4, 8>(ISA::kScalar);
+    scalar::SetGemmS8<scalar::ScalarIntVec, 4, 8>(&kernels);
+    return kernels;
+  }();
+  return &kernels;
+}
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
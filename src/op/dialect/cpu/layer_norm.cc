@@ -0,0 +1,105 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/layer_norm.cc
+ * \brief layer_norm CPU backend
+ */
+#include "raf/op.h"
+#include "../../schema/nn.h"
+#include "./cpu_utils.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+using namespace raf::value;
+
+class LayerNormImpl : public raf::op::OpEnv {
+ public:
+  explicit LayerNormImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.layer_norm");
+    auto args = cv->args.as<op::schema::LayerNormArgs>();
+    this->arg_indices = {
+        fschema_index[op]("x"),
+    };
+    if (args->scale.defined()) {
+      this->arg_indices.push_back(fschema_index[op]("scale"));
+      this->arg_indices.push_back(fschema_index[op]("bias"));
+    }
+    eps_ = args->eps;
+    env_name_ = TruncateName(GetUniqueName("raf.op.cpu.layer_norm"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::LayerNormArgs>();
+    std::vector<Value> inputs{args->x};
+    if (args->scale.defined()) {
+      inputs.push_back(args->scale.value());
+      inputs.push_back(args->bias.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    const float* scale = nullptr;
+    const float* bias = nullptr;
+    if (inputs.size() == 3) {
+      DLTensor* scale_tensor = ir::Downcast<TensorValue>(inputs[1]);
+      DLTensor* bias_tensor = ir::Downcast<TensorValue>(inputs[2]);
+      scale = static_cast<const float*>(scale_tensor->data);
+      bias = static_cast<const float*>(bias_tensor->data);
+    }
+    int64_t n = x->shape[x->ndim - 1];
+    int64_t rows = 1;
+    for (int i = 0; i < x->ndim - 1; ++i) {
+      rows *= x->shape[i];
+    }
+    const float* x_data = static_cast<const float*>(x->data);
+    float* out_data = static_cast<float*>(out->data);
+    const Kernels* kernels = GetKernels();
+    float eps = eps_;
+    ParallelFor(0, rows, std::max<int64_t>(1, 16384 / n), [&](int64_t begin, int64_t end) {
+      kernels->layer_norm(x_data + begin * n, scale, bias, out_data + begin * n, end - begin, n,
+                          eps);
+    });
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::LayerNormArgs>();
+    CHECK(args != nullptr);
+    DLTensor* x = args->x;
+    // The kernel normalizes the innermost axis, with both or neither of scale and bias.
+    int axis = (args->axis + x->ndim) % x->ndim;
+    if (!IsFloat32(x) || axis != x->ndim - 1 || x->shape[axis] == 0 ||
+        args->scale.defined() != args->bias.defined()) {
+      return nullptr;
+    }
+    if (args->scale.defined() && (!IsFloat32(args->scale.value()) ||
+                                  !IsFloat32(args->bias.value()))) {
+      return nullptr;
+    }
+    return new LayerNormImpl(cv);
+  }
+
+ private:
+  double eps_;
+  std::string env_name_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, layer_norm, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.layer_norm", LayerNormImpl::make);
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,235 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/matmul.cc
+ * \brief matmul, batch_matmul, dense and their int8 variants CPU backend
+ */
+#include "raf/op.h"
+#include "../../schema/ufunc.h"
+#include "../../schema/nn.h"
+#include "./cpu_utils.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+using namespace raf::value;
+
+static auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+
+/*! \brief Whether both operands are float32, or both are bfloat16. */
+static bool IsGemmSupported(const DLTensor* x1, const DLTensor* x2) {
+  return (IsFloat32(x1) && IsFloat32(x2)) || (IsBFloat16(x1) && IsBFloat16(x2));
+}
+
+/*! \brief Dispatch the batched GEMM by the dtype of the operands. See Gemm for the parameters. */
+static void DispatchGemm(int64_t batch, int64_t m, int64_t n, int64_t k, const DLTensor* a,
+                         int64_t batch_stride_a, bool transpose_a, const DLTensor* b,
+                         int64_t batch_stride_b, bool transpose_b, DLTensor* c) {
+  if (IsBFloat16(a)) {
+    GemmBF16(batch, m, n, k, static_cast<const uint16_t*>(a->data), batch_stride_a, transpose_a,
+             static_cast<const uint16_t*>(b->data), batch_stride_b, transpose_b,
+             static_cast<uint16_t*>(c->data));
+  } else {
+    Gemm(batch, m, n, k, static_cast<const float*>(a->data), batch_stride_a, transpose_a,
+         static_cast<const float*>(b->data), batch_stride_b, transpose_b,
+         static_cast<float*>(c->data));
+  }
+}
+
+static std::string GemmOpName(const std::string& base, bool transpose_a, bool transpose_b) {
+  std::string op_name = "raf.op.cpu." + base;
+  if (transpose_a || transpose_b) {
+    op_name += "_";
+    op_name += (transpose_a) ? "t" : "n";
+    op_name += (transpose_b) ? "t" : "n";
+  }
+  return op_name;
+}
+
+template <bool transpose_a, bool transpose_b>
+class MatmulImpl : public raf::op::OpEnv {
+ public:
+  explicit MatmulImpl(const CallValues& cv) {
+    static auto op = ir::Op::Get("raf.op.matmul");
+    this->arg_indices = {
+        fschema_index[op]("x1"),
+        fschema_index[op]("x2"),
+    };
+    env_name_ = TruncateName(GetUniqueName(GemmOpName("matmul", transpose_a, transpose_b)));
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::BinaryArgs>();
+    Execute(std::vector<Value>{args->x1, args->x2}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x1 = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* x2 = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    int64_t k = x1->shape[transpose_a ? 0 : 1];
+    DispatchGemm(1, out->shape[0], out->shape[1], k, x1, 0, transpose_a, x2, 0, transpose_b, out);
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::BinaryArgs>();
+    CHECK(args != nullptr);
+    if (!IsGemmSupported(args->x1, args->x2)) {
+      return nullptr;
+    }
+    return new MatmulImpl<transpose_a, transpose_b>(cv);
+  }
+
+ private:
+  std::string env_name_;
+};
+
+using MatmulNN = MatmulImpl<false, false>;
+using MatmulNT = MatmulImpl<false, true>;
+using MatmulTN = MatmulImpl<true, false>;
+using MatmulTT = MatmulImpl<true, true>;
+
+RAF_REGISTER_DIALECT_OP(cpu, matmul, 15);
+RAF_REGISTER_DIALECT_OP(cpu, matmul_nt, 15);
+RAF_REGISTER_DIALECT_OP(cpu, matmul_tn, 15);
+RAF_REGISTER_DIALECT_OP(cpu, matmul_tt, 15);
+RAF_REGISTER_DIALECT_OP(cpu, dense, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.matmul", MatmulNN::make);
+RAF_OP_ENV_MAKER("raf.op.cpu.matmul_nt", MatmulNT::make);
+RAF_OP_ENV_MAKER("raf.op.cpu.matmul_tn", MatmulTN::make);
+RAF_OP_ENV_MAKER("raf.op.cpu.matmul_tt", MatmulTT::make);
+RAF_OP_ENV_MAKER("raf.op.cpu.dense", MatmulNT::make);
+
+template <bool transpose_a, bool transpose_b>
+class BatchMatmulImpl : public raf::op::OpEnv {
+ public:
+  explicit BatchMatmulImpl(const CallValues& cv) {
+    static auto op = ir::Op::Get("raf.op.batch_matmul");
+    this->arg_indices = {
+        fschema_index[op]("x1"),
+        fschema_index[op]("x2"),
+    };
+    env_name_ = TruncateName(GetUniqueName(GemmOpName("batch_matmul", transpose_a, transpose_b)));
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::BinaryArgs>();
+    Execute(std::vector<Value>{args->x1, args->x2}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x1 = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* x2 = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    // A batch of size 1 is broadcast to the other operand.
+    int64_t stride_a = x1->shape[0] == 1 ? 0 : x1->shape[1] * x1->shape[2];
+    int64_t stride_b = x2->shape[0] == 1 ? 0 : x2->shape[1] * x2->shape[2];
+    int64_t k = x1->shape[transpose_a ? 1 : 2];
+    DispatchGemm(out->shape[0], out->shape[1], out->shape[2], k, x1, stride_a, transpose_a, x2,
+                 stride_b, transpose_b, out);
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::BinaryArgs>();
+    CHECK(args != nullptr);
+    if (!IsGemmSupported(args->x1, args->x2)) {
+      return nullptr;
+    }
+    return new BatchMatmulImpl<transpose_a, transpose_b>(cv);
+  }
+
+ private:
+  std::string env_name_;
+};
+
+using BatchMatmulNN = BatchMatmulImpl<false, false>;
+using BatchMatmulNT = BatchMatmulImpl<false, true>;
+using BatchMatmulTN = BatchMatmulImpl<true, false>;
+using BatchMatmulTT = BatchMatmulImpl<true, true>;
+
+RAF_REGISTER_DIALECT_OP(cpu, batch_matmul, 15);
+RAF_REGISTER_DIALECT_OP(cpu, batch_matmul_nt, 15);
+RAF_REGISTER_DIALECT_OP(cpu, batch_matmul_tn, 15);
+RAF_REGISTER_DIALECT_OP(cpu, batch_matmul_tt, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.batch_matmul", BatchMatmulNN::make);
+RAF_OP_ENV_MAKER("raf.op.cpu.batch_matmul_nt", BatchMatmulNT::make);
+RAF_OP_ENV_MAKER("raf.op.cpu.batch_matmul_tn", BatchMatmulTN::make);
+RAF_OP_ENV_MAKER("raf.op.cpu.batch_matmul_tt", BatchMatmulTT::make);
+
+/*! \brief The int8 GEMM with int32 outputs, of 2-D operands, or 3-D operands if batched. */
+template <bool batched>
+class QuantizedGemmImpl : public raf::op::OpEnv {
+ public:
+  explicit QuantizedGemmImpl(const CallValues& cv) {
+    static auto op =
+        ir::Op::Get(batched ? "raf.op.quantized_batch_matmul" : "raf.op.quantized_matmul");
+    this->arg_indices = {
+        fschema_index[op]("x1"),
+        fschema_index[op]("x2"),
+    };
+    auto args = cv->args.as<op::schema::QuantizedGemmArgs>();
+    transpose_a_ = args->transpose_a;
+    transpose_b_ = args->transpose_b;
+    std::string base = batched ? "quantized_batch_matmul" : "quantized_matmul";
+    env_name_ = TruncateName(GetUniqueName(GemmOpName(base, transpose_a_, transpose_b_)));
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::QuantizedGemmArgs>();
+    Execute(std::vector<Value>{args->x1, args->x2}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x1 = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* x2 = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    constexpr int b = batched ? 1 : 0;
+    int64_t batch = batched ? out->shape[0] : 1;
+    // A batch of size 1 is broadcast to the other operand.
+    int64_t stride_a = batched && x1->shape[0] == 1 ? 0 : x1->shape[b] * x1->shape[b + 1];
+    int64_t stride_b = batched && x2->shape[0] == 1 ? 0 : x2->shape[b] * x2->shape[b + 1];
+    int64_t k = x1->shape[transpose_a_ ? b : b + 1];
+    GemmS8(batch, out->shape[b], out->shape[b + 1], k, static_cast<const int8_t*>(x1->data),
+           stride_a, transpose_a_, static_cast<const int8_t*>(x2->data), stride_b, transpose_b_,
+           static_cast<int32_t*>(out->data));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::QuantizedGemmArgs>();
+    CHECK(args != nullptr);
+    if (!IsInt(args->x1, 8) || !IsInt(args->x2, 8)) {
+      return nullptr;
+    }
+    return new QuantizedGemmImpl<batched>(cv);
+  }
+
+ private:
+  std::string env_name_;
+  bool transpose_a_;
+  bool transpose_b_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, quantized_matmul, 15);
+RAF_REGISTER_DIALECT_OP(cpu, quantized_batch_matmul, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.quantized_matmul", QuantizedGemmImpl<false>::make);
+RAF_OP_ENV_MAKER("raf.op.cpu.quantized_batch_matmul", QuantizedGemmImpl<true>::make);
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
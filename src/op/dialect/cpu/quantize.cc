@@ -0,0 +1,222 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/quantize.cc
+ * \brief quantize, dequantize and requantize CPU backend
+ */
+#include <algorithm>
+#include <vector>
+#include "raf/op.h"
+#include "../../schema/transform.h"
+#include "../../../common/shape_utils.h"
+#include "./cpu_utils.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+using namespace raf::value;
+using common::shape_utils::GetNumel;
+
+static auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+
+/*!
+ * \brief Scale x to y with a kernel of the kernel table. The scale has a single element for the
+ * whole tensor, or one element per channel along the axis.
+ */
+template <typename TIn, typename TOut>
+void ApplyScale(void (*kernel)(const TIn*, const float*, bool, TOut*, int64_t), const DLTensor* x,
+                const float* scale, int64_t scale_size, int axis, DLTensor* y) {
+  const TIn* x_data = static_cast<const TIn*>(x->data);
+  TOut* y_data = static_cast<TOut*>(y->data);
+  int64_t size = GetNumel(*x);
+  if (scale_size == 1) {
+    ParallelFor(0, size, 32768, [&](int64_t begin, int64_t end) {
+      kernel(x_data + begin, scale, false, y_data + begin, end - begin);
+    });
+    return;
+  }
+  axis = axis < 0 ? axis + x->ndim : axis;
+  int64_t inner = 1;
+  for (int i = axis + 1; i < x->ndim; ++i) {
+    inner *= x->shape[i];
+  }
+  if (inner == 1) {
+    // The channels are contiguous, so each row scales elementwise.
+    int64_t rows = size / scale_size;
+    ParallelFor(0, rows, std::max<int64_t>(1, 32768 / scale_size), [&](int64_t begin, int64_t end) {
+      for (int64_t r = begin; r < end; ++r) {
+        kernel(x_data + r * scale_size, scale, true, y_data + r * scale_size, scale_size);
+      }
+    });
+    return;
+  }
+  // Otherwise, each block of inner elements shares the scale of its channel.
+  int64_t blocks = size / inner;
+  ParallelFor(0, blocks, std::max<int64_t>(1, 32768 / inner), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      kernel(x_data + i * inner, scale + i % scale_size, false, y_data + i * inner, inner);
+    }
+  });
+}
+
+class QuantizeImpl : public raf::op::OpEnv {
+ public:
+  explicit QuantizeImpl(const CallValues& cv) {
+    static auto op = ir::Op::Get("raf.op.quantize");
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("scale"),
+    };
+    axis_ = cv->args.as<op::schema::QuantizeArgs>()->axis;
+    env_name_ = TruncateName(GetUniqueName("raf.op.cpu.quantize"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::QuantizeArgs>();
+    Execute(std::vector<Value>{args->x, args->scale}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* scale = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    ApplyScale(GetKernels()->quantize_f32, x, static_cast<const float*>(scale->data),
+               GetNumel(*scale), axis_, out);
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::QuantizeArgs>();
+    CHECK(args != nullptr);
+    if (!IsFloat32(args->x) || !IsFloat32(args->scale) || args->dtype != "int8") {
+      return nullptr;
+    }
+    return new QuantizeImpl(cv);
+  }
+
+ private:
+  std::string env_name_;
+  int axis_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, quantize, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.quantize", QuantizeImpl::make);
+
+class DequantizeImpl : public raf::op::OpEnv {
+ public:
+  explicit DequantizeImpl(const CallValues& cv) {
+    static auto op = ir::Op::Get("raf.op.dequantize");
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("scale"),
+    };
+    axis_ = cv->args.as<op::schema::DequantizeArgs>()->axis;
+    env_name_ = TruncateName(GetUniqueName("raf.op.cpu.dequantize"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::DequantizeArgs>();
+    Execute(std::vector<Value>{args->x, args->scale}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* scale = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    const float* scale_data = static_cast<const float*>(scale->data);
+    if (IsInt(x, 8)) {
+      ApplyScale(GetKernels()->dequantize_s8, x, scale_data, GetNumel(*scale), axis_, out);
+    } else {
+      ApplyScale(GetKernels()->dequantize_s32, x, scale_data, GetNumel(*scale), axis_, out);
+    }
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::DequantizeArgs>();
+    CHECK(args != nullptr);
+    if (!(IsInt(args->x, 8) || IsInt(args->x, 32)) || !IsFloat32(args->scale) ||
+        args->dtype != "float32") {
+      return nullptr;
+    }
+    return new DequantizeImpl(cv);
+  }
+
+ private:
+  std::string env_name_;
+  int axis_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, dequantize, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.dequantize", DequantizeImpl::make);
+
+class RequantizeImpl : public raf::op::OpEnv {
+ public:
+  explicit RequantizeImpl(const CallValues& cv) {
+    static auto op = ir::Op::Get("raf.op.requantize");
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("in_scale"),
+        fschema_index[op]("out_scale"),
+    };
+    axis_ = cv->args.as<op::schema::RequantizeArgs>()->axis;
+    env_name_ = TruncateName(GetUniqueName("raf.op.cpu.requantize"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::RequantizeArgs>();
+    Execute(std::vector<Value>{args->x, args->in_scale, args->out_scale}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* in_scale = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out_scale = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    // Fold the two scales into one multiplier per channel, the same way as the TVM kernel.
+    int64_t in_size = GetNumel(*in_scale);
+    int64_t out_size = GetNumel(*out_scale);
+    const float* in_data = static_cast<const float*>(in_scale->data);
+    const float* out_data = static_cast<const float*>(out_scale->data);
+    std::vector<float> multiplier(std::max(in_size, out_size));
+    for (size_t i = 0; i < multiplier.size(); ++i) {
+      multiplier[i] = in_data[in_size == 1 ? 0 : i] / out_data[out_size == 1 ? 0 : i];
+    }
+    ApplyScale(GetKernels()->requantize_s32, x, multiplier.data(), multiplier.size(), axis_, out);
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::RequantizeArgs>();
+    CHECK(args != nullptr);
+    if (!IsInt(args->x, 32) || !IsFloat32(args->in_scale) || !IsFloat32(args->out_scale) ||
+        args->dtype != "int8") {
+      return nullptr;
+    }
+    return new RequantizeImpl(cv);
+  }
+
+ private:
+  std::string env_name_;
+  int axis_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, requantize, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.requantize", RequantizeImpl::make);
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
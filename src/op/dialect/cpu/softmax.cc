@@ -0,0 +1,87 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cpu/softmax.cc
+ * \brief softmax CPU backend
+ */
+#include "raf/op.h"
+#include "../../schema/nn.h"
+#include "./cpu_utils.h"
+
+namespace raf {
+namespace op {
+namespace cpu {
+
+using namespace raf::value;
+
+class SoftmaxImpl : public raf::op::OpEnv {
+ public:
+  explicit SoftmaxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.softmax");
+    this->arg_indices = {
+        fschema_index[op]("x"),
+    };
+    auto args = cv->args.as<op::schema::SoftmaxArgs>();
+    DLTensor* x = args->x;
+    axis_ = (args->axis + x->ndim) % x->ndim;
+    env_name_ = TruncateName(GetUniqueName("raf.op.cpu.softmax"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::SoftmaxArgs>();
+    Execute(std::vector<Value>{args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    int64_t n = x->shape[axis_];
+    int64_t rows = 1;
+    for (int i = 0; i < axis_; ++i) {
+      rows *= x->shape[i];
+    }
+    const float* x_data = static_cast<const float*>(x->data);
+    float* out_data = static_cast<float*>(out->data);
+    const Kernels* kernels = GetKernels();
+    ParallelFor(0, rows, std::max<int64_t>(1, 16384 / n), [&](int64_t begin, int64_t end) {
+      kernels->softmax(x_data + begin * n, out_data + begin * n, end - begin, n);
+    });
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::SoftmaxArgs>();
+    CHECK(args != nullptr);
+    DLTensor* x = args->x;
+    // Only the softmax over the innermost axis has contiguous rows.
+    int axis = (args->axis + x->ndim) % x->ndim;
+    for (int i = axis + 1; i < x->ndim; ++i) {
+      if (x->shape[i] != 1) {
+        return nullptr;
+      }
+    }
+    if (!IsFloat32(x) || x->shape[axis] == 0) {
+      return nullptr;
+    }
+    return new SoftmaxImpl(cv);
+  }
+
+ private:
+  int axis_;
+  std::string env_name_;
+};
+
+RAF_REGISTER_DIALECT_OP(cpu, softmax, 15);
+RAF_OP_ENV_MAKER("raf.op.cpu.softmax", SoftmaxImpl::make);
+
+}  // namespace cpu
+}  // namespace op
+}  // namespace raf
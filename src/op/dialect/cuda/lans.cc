@@ -65,9 +65,9 @@ class LansImpl : public raf::op::OpEnv {
     }
     max_chunks_per_tensor_ = -1;
     if (datatype.bits == 32) {
-      RequestWorkspace(&q_tensor_buf_, cv->device, FLOAT_BYTES * tensor_elements);
+      q_tensor_buf_idx_ = RequestWorkspace(cv->device, FLOAT_BYTES * tensor_elements);
     } else {
-      RequestWorkspace(&q_tensor_buf_, cv->device, HALF_BYTES * tensor_elements);
+      q_tensor_buf_idx_ = RequestWorkspace(cv->device, HALF_BYTES * tensor_elements);
     }
     for (int t = 0; t < param_group_n_; t++) {
       int max_chunks_this_tensor = (numels_[t] + CHUNK_SIZE - 1) / CHUNK_SIZE;
@@ -75,11 +75,12 @@ class LansImpl : public raf::op::OpEnv {
         max_chunks_per_tensor_ = max_chunks_this_tensor;
       }
     }
-    RequestWorkspace(&output_per_tensor_, cv->device, 4 * param_group_n_ * max_chunks_per_tensor_);
-    RequestWorkspace(&grad_norm_tensor_, cv->device, 4 * param_group_n_);
-    RequestWorkspace(&param_norm_tensor_, cv->device, 4 * param_group_n_);
-    RequestWorkspace(&update_m_norm_, cv->device, 4 * param_group_n_);
-    RequestWorkspace(&q_norm_tensor_, cv->device, 4 * param_group_n_);
+    output_per_tensor_idx_ =
+        RequestWorkspace(cv->device, 4 * param_group_n_ * max_chunks_per_tensor_);
+    grad_norm_tensor_idx_ = RequestWorkspace(cv->device, 4 * param_group_n_);
+    param_norm_tensor_idx_ = RequestWorkspace(cv->device, 4 * param_group_n_);
+    update_m_norm_idx_ = RequestWorkspace(cv->device, 4 * param_group_n_);
+    q_norm_tensor_idx_ = RequestWorkspace(cv->device, 4 * param_group_n_);
 
     static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
     compute_stream_ = cuda_device_api->GetStream();
@@ -116,14 +117,15 @@ class LansImpl : public raf::op::OpEnv {
       beta3 = 1 - beta1_;
     }
 
+    float* q_tensor_buf = static_cast<float*>(GetWorkspace(q_tensor_buf_idx_));
     std::vector<float*> tlist;
     for (int i = 0; i < param_group_n_; ++i) {
       DLTensor* tensor = ir::Downcast<TensorValue>(tuple->fields[i]);
       tlist.push_back(static_cast<float*>(tensor->data));
     }
-    tlist.push_back(static_cast<float*>(q_tensor_buf_));
+    tlist.push_back(q_tensor_buf);
     for (int i = 1; i < numels_.size(); ++i) {
-      tlist.push_back(static_cast<float*>(q_tensor_buf_) + numels_[i - 1]);
+      tlist.push_back(q_tensor_buf + numels_[i - 1]);
     }
     for (int i = param_group_n_; i < tuple->fields.size(); ++i) {
       DLTensor* tensor = ir::Downcast<TensorValue>(tuple->fields[i]);
@@ -132,10 +134,11 @@ class LansImpl : public raf::op::OpEnv {
     multi_tensor_lans_cuda<float>(
         CHUNK_SIZE, tlist, learning_rate_, beta1_, beta2_, eps_, bias_correction_, bias_correction1,
         bias_correction2, beta3, weight_decay_, grad_averaging_, mode_, normalize_grad_, numels_,
-        compute_stream_, static_cast<float*>(output_per_tensor_),
-        static_cast<float*>(grad_norm_tensor_), static_cast<float*>(param_norm_tensor_),
-        static_cast<float*>(update_m_norm_), static_cast<float*>(q_norm_tensor_),
-        max_chunks_per_tensor_);
+        compute_stream_, static_cast<float*>(GetWorkspace(output_per_tensor_idx_)),
+        static_cast<float*>(GetWorkspace(grad_norm_tensor_idx_)),
+        static_cast<float*>(GetWorkspace(param_norm_tensor_idx_)),
+        static_cast<float*>(GetWorkspace(update_m_norm_idx_)),
+        static_cast<float*>(GetWorkspace(q_norm_tensor_idx_)), max_chunks_per_tensor_);
   }
 
   std::string name() const override {
@@ -158,13 +161,13 @@ class LansImpl : public raf::op::OpEnv {
   bool normalize_grad_;
   std::vector<int> numels_;
   int param_group_n_;
-  void* output_per_tensor_;
-  void* grad_norm_tensor_;
-  void* param_norm_tensor_;
-  void* update_m_norm_;
-  void* q_norm_tensor_;
+  int output_per_tensor_idx_;
+  int grad_norm_tensor_idx_;
+  int param_norm_tensor_idx_;
+  int update_m_norm_idx_;
+  int q_norm_tensor_idx_;
   int max_chunks_per_tensor_;
-  void* q_tensor_buf_;
+  int q_tensor_buf_idx_;
   void* compute_stream_;
   DLDevice cpu_ctx_;
 };
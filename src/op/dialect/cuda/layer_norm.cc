@@ -180,8 +180,8 @@ class LayerNormTrainDxImpl : public raf::op::OpEnv {
     }
     if (scale) {
       const int part_size = 16;
-      RequestWorkspace(&part_grad_gamma_, x->device, 4 * part_size * n2_);
-      RequestWorkspace(&part_grad_beta_, x->device, 4 * part_size * n2_);
+      part_grad_gamma_idx_ = RequestWorkspace(x->device, 4 * part_size * n2_);
+      part_grad_beta_idx_ = RequestWorkspace(x->device, 4 * part_size * n2_);
     }
 
     cudaDeviceProp deviceProp;
@@ -217,6 +217,9 @@ class LayerNormTrainDxImpl : public raf::op::OpEnv {
     DLTensor* db = ir::Downcast<TensorValue>(out_tuple->fields[2]);
     CHECK(x->dtype.code == kDLFloat);
     CHECK((x->dtype.bits == 32) || (x->dtype.bits == 16));
+    // The workspace of the execution, which is null if no scale is given.
+    float* part_grad_gamma = static_cast<float*>(GetWorkspace(part_grad_gamma_idx_));
+    float* part_grad_beta = static_cast<float*>(GetWorkspace(part_grad_beta_idx_));
 
     switch (x->dtype.bits) {
       case 16: {
@@ -224,9 +227,7 @@ class LayerNormTrainDxImpl : public raf::op::OpEnv {
             static_cast<Half*>(dy->data), mean_p, invvar_p, static_cast<Half*>(x->data), n1_, n2_,
             static_cast<Half*>(scale->data), eps_, static_cast<Half*>(dx->data),
             static_cast<Half*>(dw->data), static_cast<Half*>(db->data),
-            part_grad_gamma_ != NULL ? static_cast<float*>(part_grad_gamma_) : NULL,
-            part_grad_beta_ != NULL ? static_cast<float*>(part_grad_beta_) : NULL, compute_stream_,
-            maxGridY_);
+            part_grad_gamma, part_grad_beta, compute_stream_, maxGridY_);
         break;
       }
       case 32: {
@@ -234,9 +235,7 @@ class LayerNormTrainDxImpl : public raf::op::OpEnv {
             static_cast<float*>(dy->data), mean_p, invvar_p, static_cast<float*>(x->data), n1_, n2_,
             static_cast<float*>(scale->data), eps_, static_cast<float*>(dx->data),
             static_cast<float*>(dw->data), static_cast<float*>(db->data),
-            part_grad_gamma_ != NULL ? static_cast<float*>(part_grad_gamma_) : NULL,
-            part_grad_beta_ != NULL ? static_cast<float*>(part_grad_beta_) : NULL, compute_stream_,
-            maxGridY_);
+            part_grad_gamma, part_grad_beta, compute_stream_, maxGridY_);
 
         break;
       }
@@ -259,8 +258,8 @@ class LayerNormTrainDxImpl : public raf::op::OpEnv {
   int axis_;
   double eps_;
   int n1_, n2_;
-  void* part_grad_gamma_ = nullptr;
-  void* part_grad_beta_ = nullptr;
+  int part_grad_gamma_idx_ = -1;
+  int part_grad_beta_idx_ = -1;
   uint64_t maxGridY_;
   void* compute_stream_;
 };
@@ -278,7 +278,7 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
   cudnnConvolutionDescriptor_t convDesc;
   cudnnConvolutionFwdAlgoPerf_t algo;
   size_t workSpaceSizeInBytes;
-  void* workSpace;
+  int workSpaceIdx;
 
   explicit Conv2DImplementedByCUDNNConvolutionForward(const CallValues& cv) {
     auto op = Op::Get("raf.op.conv2d");
@@ -320,7 +320,7 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
     CUDNN_CALL(cudnnGetConvolutionForwardWorkspaceSize(CUDNNThreadEntry::ThreadLocal()->handle,
                                                        xDesc, wDesc, convDesc, yDesc, algo.algo,
                                                        &workSpaceSizeInBytes));
-    RequestWorkspace(&workSpace, cv->device, workSpaceSizeInBytes);
+    workSpaceIdx = RequestWorkspace(cv->device, workSpaceSizeInBytes);
     cudnnSetConvolutionMathType(convDesc, algo.mathType);
   }
 
@@ -346,6 +346,7 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
     DLTensor* out = cv->out;
     (void)out;
 
+    void* workSpace = GetWorkspace(workSpaceIdx);
     CUDNN_CALL(cudnnConvolutionForward(
         CUDNNThreadEntry::ThreadLocal()->handle, CUDNNDType(out->dtype).const_addr<1>(), xDesc,
         x->data, wDesc, w->data, convDesc, algo.algo, workSpace, workSpaceSizeInBytes,
@@ -357,6 +358,7 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
     DLTensor* x = Downcast<TensorValue>(inputs[0]);
     DLTensor* w = Downcast<TensorValue>(inputs[1]);
     DLTensor* out = Downcast<TensorValue>(output);
+    void* workSpace = GetWorkspace(workSpaceIdx);
     CUDNN_CALL(cudnnConvolutionForward(
         CUDNNThreadEntry::ThreadLocal()->handle, CUDNNDType(out->dtype).const_addr<1>(), xDesc,
         x->data, wDesc, w->data, convDesc, algo.algo, workSpace, workSpaceSizeInBytes,
@@ -378,7 +380,7 @@ class Conv2DDwImplementedByCUDNNConvolutionBackwardFilter : public raf::op::OpEn
   cudnnConvolutionDescriptor_t convDesc;
   cudnnConvolutionBwdFilterAlgoPerf_t algo;
   size_t workSpaceSizeInBytes;
-  void* workSpace;
+  int workSpaceIdx;
 
   explicit Conv2DDwImplementedByCUDNNConvolutionBackwardFilter(const CallValues& cv) {
     auto op = Op::Get("raf.op.conv2d_dw");
@@ -424,7 +426,7 @@ class Conv2DDwImplementedByCUDNNConvolutionBackwardFilter : public raf::op::OpEn
     CUDNN_CALL(cudnnGetConvolutionBackwardFilterWorkspaceSize(
         CUDNNThreadEntry::ThreadLocal()->handle, xDesc, dyDesc, convDesc, dwDesc, algo.algo,
         &workSpaceSizeInBytes));
-    RequestWorkspace(&workSpace, cv->device, workSpaceSizeInBytes);
+    workSpaceIdx = RequestWorkspace(cv->device, workSpaceSizeInBytes);
     cudnnSetConvolutionMathType(convDesc, algo.mathType);
   }
 
@@ -445,6 +447,7 @@ class Conv2DDwImplementedByCUDNNConvolutionBackwardFilter : public raf::op::OpEn
     DLTensor* x_or_w = args->x_or_w;
     DLTensor* out = cv->out;
     DLTensor* dy = args->dy;
+    void* workSpace = GetWorkspace(workSpaceIdx);
     CUDNN_CALL(cudnnConvolutionBackwardFilter(
         CUDNNThreadEntry::ThreadLocal()->handle, CUDNNDType(out->dtype).const_addr<1>(), xDesc,
         x_or_w->data, dyDesc, dy->data, convDesc, algo.algo, workSpace, workSpaceSizeInBytes,
@@ -456,6 +459,7 @@ class Conv2DDwImplementedByCUDNNConvolutionBackwardFilter : public raf::op::OpEn
     DLTensor* x_or_w = Downcast<TensorValue>(inputs[0]);
     DLTensor* out = Downcast<TensorValue>(output);
     DLTensor* dy = Downcast<TensorValue>(inputs[1]);
+    void* workSpace = GetWorkspace(workSpaceIdx);
     CUDNN_CALL(cudnnConvolutionBackwardFilter(
         CUDNNThreadEntry::ThreadLocal()->handle, CUDNNDType(out->dtype).const_addr<1>(), xDesc,
         x_or_w->data, dyDesc, dy->data, convDesc, algo.algo, workSpace, workSpaceSizeInBytes,
@@ -478,7 +482,7 @@ class Conv2DDxImplementedByCUDNNConvolutionBackwardData : public raf::op::OpEnv
   cudnnConvolutionDescriptor_t convDesc;
   cudnnConvolutionBwdDataAlgoPerf_t algo;
   size_t workSpaceSizeInBytes;
-  void* workSpace;
+  int workSpaceIdx;
 
   explicit Conv2DDxImplementedByCUDNNConvolutionBackwardData(const CallValues& cv) {
     auto op = Op::Get("raf.op.conv2d_dx");
@@ -519,7 +523,7 @@ class Conv2DDxImplementedByCUDNNConvolutionBackwardData : public raf::op::OpEnv
     CUDNN_CALL(cudnnGetConvolutionBackwardDataWorkspaceSize(CUDNNThreadEntry::ThreadLocal()->handle,
                                                             wDesc, dyDesc, convDesc, dxDesc,
                                                             algo.algo, &workSpaceSizeInBytes));
-    RequestWorkspace(&workSpace, cv->device, workSpaceSizeInBytes);
+    workSpaceIdx = RequestWorkspace(cv->device, workSpaceSizeInBytes);
     cudnnSetConvolutionMathType(convDesc, algo.mathType);
   }
 
@@ -540,6 +544,7 @@ class Conv2DDxImplementedByCUDNNConvolutionBackwardData : public raf::op::OpEnv
     DLTensor* out = cv->out;
     DLTensor* x_or_w = args->x_or_w;
     DLTensor* dy = args->dy;
+    void* workSpace = GetWorkspace(workSpaceIdx);
     CUDNN_CALL(cudnnConvolutionBackwardData(
         CUDNNThreadEntry::ThreadLocal()->handle, CUDNNDType(out->dtype).const_addr<1>(), wDesc,
         x_or_w->data, dyDesc, dy->data, convDesc, algo.algo, workSpace, workSpaceSizeInBytes,
@@ -551,6 +556,7 @@ class Conv2DDxImplementedByCUDNNConvolutionBackwardData : public raf::op::OpEnv
     DLTensor* out = Downcast<TensorValue>(output);
     DLTensor* x_or_w = Downcast<TensorValue>(inputs[0]);
     DLTensor* dy = Downcast<TensorValue>(inputs[1]);
+    void* workSpace = GetWorkspace(workSpaceIdx);
     CUDNN_CALL(cudnnConvolutionBackwardData(
         CUDNNThreadEntry::ThreadLocal()->handle, CUDNNDType(out->dtype).const_addr<1>(), wDesc,
         x_or_w->data, dyDesc, dy->data, convDesc, algo.algo, workSpace, workSpaceSizeInBytes,
@@ -38,7 +38,7 @@ class NCCLOpEnv : public raf::op::OpEnv {
 };
 
 class NCCLAllReduce : public NCCLOpEnv {
-  void* fused_data;
+  int fused_data_idx = -1;
   size_t total_size = 0;
   std::vector<size_t> tuple_sizes;
   DType dtype;
@@ -80,7 +80,7 @@ class NCCLAllReduce : public NCCLOpEnv {
       dtype = x->dtype;
     }
     if (tv.size() > 1) {
-      RequestWorkspace(&fused_data, cv->device, total_size);
+      fused_data_idx = RequestWorkspace(cv->device, total_size);
     }
   }
 
@@ -117,6 +117,7 @@ class NCCLAllReduce : public NCCLOpEnv {
                               nccl_comm, (cudaStream_t)stream));
 
     } else {
+      void* fused_data = GetWorkspace(fused_data_idx);
       size_t offset = 0;
       for (int i = 0; i < tv->fields.size(); ++i) {
         DLTensor* x = tv->fields[i];
@@ -251,7 +252,7 @@ RAF_REGISTER_DIALECT_OP(nccl, _group_allgather, 10);
 RAF_OP_ENV_MAKER("raf.op.nccl._group_allgather", NCCLGroupAllGather::make);
 
 class NCCLReduceScatter : public NCCLOpEnv {
-  void* in_buffer;
+  int in_buffer_idx = -1;
   size_t size_in_bytes;
   size_t size;
   ncclRedOp_t compute;
@@ -284,7 +285,7 @@ class NCCLReduceScatter : public NCCLOpEnv {
     const DLTensor* out = cv->out;
     size_in_bytes = BytesCompactTensor(*out);
     size = size_in_bytes / (out->dtype.bits / 8);
-    RequestWorkspace(&in_buffer, cv->device, size_in_bytes * GetGlobalCommunicator()->size);
+    in_buffer_idx = RequestWorkspace(cv->device, size_in_bytes * GetGlobalCommunicator()->size);
   }
 
  public:
@@ -314,6 +315,7 @@ class NCCLReduceScatter : public NCCLOpEnv {
       NCCL_CALL(ncclReduceScatter(x->data, out->data, size, dtype, compute, nccl_comm,
                                   (cudaStream_t)stream));
     } else {
+      void* in_buffer = GetWorkspace(in_buffer_idx);
       for (int i = 0; i < tv->fields.size(); ++i) {
         DLTensor* x = tv->fields[i];
         void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(in_buffer) + size_in_bytes * i;
@@ -416,7 +418,7 @@ RAF_REGISTER_DIALECT_OP(nccl, _group_reduce_scatter, 10);
 RAF_OP_ENV_MAKER("raf.op.nccl._group_reduce_scatter", NCCLGroupReduceScatter::make);
 
 class NCCLBroadcast : public NCCLOpEnv {
-  void* fused_data;
+  int fused_data_idx = -1;
   size_t total_size = 0;
   std::vector<size_t> tuple_sizes;
   DType dtype;
@@ -439,7 +441,7 @@ class NCCLBroadcast : public NCCLOpEnv {
       dtype = x->dtype;
     }
     if (tv.size() == 1) return;
-    RequestWorkspace(&fused_data, cv->device, total_size);
+    fused_data_idx = RequestWorkspace(cv->device, total_size);
   }
 
  public:
@@ -470,6 +472,7 @@ class NCCLBroadcast : public NCCLOpEnv {
       return;
     }
 
+    void* fused_data = GetWorkspace(fused_data_idx);
     size_t offset = 0;
     for (int i = 0; i < tv->fields.size(); ++i) {
       DLTensor* x = tv->fields[i];
@@ -602,7 +605,7 @@ class NCCLReduce : public NCCLOpEnv {
   DType dtype;
   size_t total_size = 0;
   std::vector<size_t> tuple_sizes;
-  void* fused_data;
+  int fused_data_idx = -1;
 
   explicit NCCLReduce(const CallValues& cv) : NCCLOpEnv(cv) {
     auto op = ir::Op::Get("raf.op._reduce");
@@ -639,7 +642,7 @@ class NCCLReduce : public NCCLOpEnv {
       dtype = x->dtype;
     }
     if (tv.size() >= 1) {
-      RequestWorkspace(&fused_data, cv->device, total_size);
+      fused_data_idx = RequestWorkspace(cv->device, total_size);
     }
   }
 
@@ -670,6 +673,7 @@ class NCCLReduce : public NCCLOpEnv {
       NCCL_CALL(ncclReduce(x->data, out->data, total_size / dtype_size, dtype, compute, root,
                            nccl_comm, (cudaStream_t)stream));
     } else {
+      void* fused_data = GetWorkspace(fused_data_idx);
       size_t offset = 0;
       for (int i = 0; i < input_x->fields.size(); ++i) {
         DLTensor* x = input_x->fields[i];
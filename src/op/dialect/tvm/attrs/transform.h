@@ -73,6 +73,15 @@ struct SwapAxisAttrs : public tvm::AttrsNode<SwapAxisAttrs> {
   }
 };
 
+/*! \brief Attributes for quantize, dequantize and requantize operators */
+struct QuantizeAttrs : public tvm::AttrsNode<QuantizeAttrs> {
+  int axis;
+  TVM_DECLARE_ATTRS(QuantizeAttrs, "attrs.QuantizeAttrs") {
+    TVM_ATTR_FIELD(axis).set_default(-1).describe(
+        "The channel axis of per-channel scales. Ignored by per-tensor scales.");
+  }
+};
+
 }  // namespace tvm_dialect
 }  // namespace op
 }  // namespace raf
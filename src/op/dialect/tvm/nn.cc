@@ -56,6 +56,36 @@ RAF_TVM(batch_matmul_tn, BatchMatmulTN, BinaryArgs, BinarySchema2Args, BinarySch
 RAF_TVM(batch_matmul_tt, BatchMatmulTT, BinaryArgs, BinarySchema2Args, BinarySchemaArgNames,
         (BinarySchema2BatchMatmulAttrs<true, true>), GenericHasher, kOutEWiseFusable);
 
+std::vector<Value> QuantizedGemmSchema2Args(const QuantizedGemmArgs* args) {
+  return {args->x1, args->x2};
+}
+
+std::vector<std::string> QuantizedGemmSchemaArgNames(const op::CallValues& call) {
+  return {"x1", "x2"};
+}
+
+Attrs QuantizedGemmSchema2Attrs(const QuantizedGemmArgs* args) {
+  auto attrs = make_object<tvm::relay::BatchMatmulAttrs>();
+  attrs->out_dtype = DataType::Int(32);
+  attrs->transpose_a = args->transpose_a;
+  attrs->transpose_b = args->transpose_b;
+  return Attrs(attrs);
+}
+
+HashKey QuantizedGemmHasher(const std::vector<Type>& param_types, const Type& y_type,
+                            const QuantizedGemmArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->transpose_a;
+  key << args->transpose_b;
+  return key;
+}
+
+// The int8 GEMMs are opaque so that the CPU dialect picks them up instead of a fused TVM kernel.
+RAF_TVM(quantized_matmul, QuantizedMatmul, QuantizedGemmArgs, QuantizedGemmSchema2Args,
+        QuantizedGemmSchemaArgNames, QuantizedGemmSchema2Attrs, QuantizedGemmHasher, kOpaque);
+RAF_TVM(quantized_batch_matmul, QuantizedBatchMatmul, QuantizedGemmArgs, QuantizedGemmSchema2Args,
+        QuantizedGemmSchemaArgNames, QuantizedGemmSchema2Attrs, QuantizedGemmHasher, kOpaque);
+
 std::vector<Value> ConvSchema2Args(const ConvArgs* args) {
   return {args->x, args->w};
 }
@@ -64,7 +94,7 @@ std::vector<std::string> ConvSchemaArgNames(const op::CallValues& call) {
   return {"x", "w"};
 }
 
-Attrs ConvSchema2Attrs(const ConvArgs* args) {
+ObjectPtr<Conv2DAttrs> MakeConv2DAttrs(const ConvArgs* args) {
   std::vector<int64_t> stride = Pad<2>(args->stride);
   std::vector<int64_t> padding = args->padding.size() > 1 ? args->padding : Pad<2>(args->padding);
   std::vector<int64_t> dilation = Pad<2>(args->dilation);
@@ -84,8 +114,11 @@ Attrs ConvSchema2Attrs(const ConvArgs* args) {
   attrs->data_layout = args->layout;
   attrs->kernel_layout = args->kernel_layout;
   attrs->out_layout = args->out_layout;
+  return attrs;
+}
 
-  return Attrs(attrs);
+Attrs ConvSchema2Attrs(const ConvArgs* args) {
+  return Attrs(MakeConv2DAttrs(args));
 }
 
 HashKey Conv2dHasher(const std::vector<Type>& param_types, const Type& y_type,
@@ -101,6 +134,15 @@ HashKey Conv2dHasher(const std::vector<Type>& param_types, const Type& y_type,
 RAF_TVM(conv2d, Conv2d, ConvArgs, ConvSchema2Args, ConvSchemaArgNames, ConvSchema2Attrs,
         Conv2dHasher, kOutEWiseFusable);
 
+Attrs QuantizedConvSchema2Attrs(const ConvArgs* args) {
+  auto attrs = MakeConv2DAttrs(args);
+  attrs->out_dtype = DataType::Int(32);
+  return Attrs(attrs);
+}
+
+RAF_TVM(quantized_conv2d, QuantizedConv2d, ConvArgs, ConvSchema2Args, ConvSchemaArgNames,
+        QuantizedConvSchema2Attrs, Conv2dHasher, kOpaque);
+
 std::vector<Value> ConvTransSchema2Args(const ConvTransArgs* args) {
   return {args->x, args->w};
 }
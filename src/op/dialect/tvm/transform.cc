@@ -672,6 +672,77 @@ HashKey GroupCastHasher(const std::vector<Type>& param_types, const Type& y_type
 RAF_TVM(group_cast, GroupCast, GroupCastArgs, GroupCastSchema2Args, GroupCastSchemaArgNames,
         GroupCastSchema2Attrs, GroupCastHasher, kElemWise);
 
+std::vector<Value> QuantizeBlockwiseSchema2Args(const QuantizeBlockwiseArgs* args) {
+  return {args->x};
+}
+
+std::vector<std::string> QuantizeBlockwiseSchemaArgNames(const op::CallValues& call) {
+  return {"x"};
+}
+
+// The block size, output shape and dtype are all in the output type, which is hashed.
+RAF_TVM(quantize_blockwise, QuantizeBlockwise, QuantizeBlockwiseArgs, QuantizeBlockwiseSchema2Args,
+        QuantizeBlockwiseSchemaArgNames, GenericAttrs, GenericHasher, kOpaque);
+
+std::vector<Value> DequantizeBlockwiseSchema2Args(const DequantizeBlockwiseArgs* args) {
+  return {args->data, args->scale};
+}
+
+std::vector<std::string> DequantizeBlockwiseSchemaArgNames(const op::CallValues& call) {
+  return {"data", "scale"};
+}
+
+RAF_TVM(dequantize_blockwise, DequantizeBlockwise, DequantizeBlockwiseArgs,
+        DequantizeBlockwiseSchema2Args, DequantizeBlockwiseSchemaArgNames, GenericAttrs,
+        GenericHasher, kInjective);
+
+template <typename T>
+Attrs QuantizeSchema2Attrs(const T* args) {
+  auto attrs = make_object<QuantizeAttrs>();
+  attrs->axis = args->axis;
+  return Attrs(attrs);
+}
+
+template <typename T>
+HashKey QuantizeHasher(const std::vector<Type>& param_types, const Type& y_type, const T* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->axis;
+  return key;
+}
+
+std::vector<Value> QuantizeSchema2Args(const QuantizeArgs* args) {
+  return {args->x, args->scale};
+}
+
+std::vector<std::string> QuantizeSchemaArgNames(const op::CallValues& call) {
+  return {"x", "scale"};
+}
+
+RAF_TVM(quantize, Quantize, QuantizeArgs, QuantizeSchema2Args, QuantizeSchemaArgNames,
+        QuantizeSchema2Attrs<QuantizeArgs>, QuantizeHasher<QuantizeArgs>, kBroadcast);
+
+std::vector<Value> DequantizeSchema2Args(const DequantizeArgs* args) {
+  return {args->x, args->scale};
+}
+
+std::vector<std::string> DequantizeSchemaArgNames(const op::CallValues& call) {
+  return {"x", "scale"};
+}
+
+RAF_TVM(dequantize, Dequantize, DequantizeArgs, DequantizeSchema2Args, DequantizeSchemaArgNames,
+        QuantizeSchema2Attrs<DequantizeArgs>, QuantizeHasher<DequantizeArgs>, kBroadcast);
+
+std::vector<Value> RequantizeSchema2Args(const RequantizeArgs* args) {
+  return {args->x, args->in_scale, args->out_scale};
+}
+
+std::vector<std::string> RequantizeSchemaArgNames(const op::CallValues& call) {
+  return {"x", "in_scale", "out_scale"};
+}
+
+RAF_TVM(requantize, Requantize, RequantizeArgs, RequantizeSchema2Args, RequantizeSchemaArgNames,
+        QuantizeSchema2Attrs<RequantizeArgs>, QuantizeHasher<RequantizeArgs>, kBroadcast);
+
 std::vector<Value> GatherSchema2Args(const GatherArgs* args) {
   return {args->data, args->indices};
 }
@@ -25,6 +25,7 @@ RAF_REGISTER_OBJECT_REFLECT(DimAttrs);
 RAF_REGISTER_OBJECT_REFLECT(FullAttrs);
 RAF_REGISTER_OBJECT_REFLECT(StridedSliceDxAttrs);
 RAF_REGISTER_OBJECT_REFLECT(SwapAxisAttrs);
+RAF_REGISTER_OBJECT_REFLECT(QuantizeAttrs);
 
 // nn attrs
 RAF_REGISTER_OBJECT_REFLECT(Conv2dDxwAttrs);
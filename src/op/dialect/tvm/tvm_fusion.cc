@@ -7,8 +7,10 @@
  * \file ./src/op/dialect/tvm/tvm_fusion.cc
  * \brief Implementation of tvm dispatch for fused functions
  */
+#include <mutex>
 #include "raf/value.h"
 #include "raf/registry.h"
+#include "raf/executor.h"
 #include "raf/op.h"
 #include "raf/ir.h"
 #include "raf/ir_ext.h"
@@ -257,8 +259,102 @@ HashKey HashFusedFunc(const Function& func) {
   return key;
 }
 
-OpEnv* FusedFuncBuild(const op::CallValues& call) {
+/*!
+ * \brief Run a fused function op by op with the interpreter, so that each op is executed by its
+ * own TVM kernel. It is the fallback while the fused function is being built in the background.
+ */
+class FusedFuncFallback {
+ public:
+  FusedFuncFallback(const CallValues& call, const std::vector<int>& arg_indices)
+      : callee_(call->callee),
+        args_(GetListArgs(call->args)),
+        arg_indices_(arg_indices),
+        device_(call->device) {
+  }
+
+  void operator()(const std::vector<Value>& inputs, Value output) const {
+    CHECK_EQ(inputs.size(), arg_indices_.size());
+    Array<Value> args = args_;
+    for (size_t i = 0; i < arg_indices_.size(); ++i) {
+      args.Set(arg_indices_[i], inputs[i]);
+    }
+    auto call = CallValues::make();
+    call->callee = callee_;
+    call->args = MakeListArgs(args);
+    call->device = device_;
+    CopyTo(executor::interpreter::InvokeClosure(call), output);
+  }
+
+ private:
+  /*! \brief The closure of the fused function. */
+  Value callee_;
+  /*! \brief The arguments when the OpEnv is built, which provide the non-tensor arguments. */
+  Array<Value> args_;
+  /*! \brief The indices of the arguments that are passed at runtime. */
+  std::vector<int> arg_indices_;
+  /*! \brief The device to run on. */
+  Device device_;
+};
+
+TVMModuleCacheEntry BuildFusedFunc(const Function& func, const tvm::Target& target) {
   tvm::relay::tec::TECompiler te_compiler;
+  auto cached_key = tvm::relay::tec::CCacheKey(func, target);
+  auto cached_func = te_compiler->Lower(cached_key, [](String name) { return name; });
+  auto mod = tvm::build(cached_func->funcs, cached_key->target, Target(nullptr));
+  return TVMModuleCacheEntry(mod, cached_func->prim_fn_var->name_hint);
+}
+
+/*!
+ * \brief Build a fused function on the background compile thread pool. Builds of the same
+ * function are deduplicated, so OpEnvs that miss the same key share one build. A finished build,
+ * either successful or failed, is evicted from the pending builds.
+ */
+std::shared_ptr<AsyncBuildState> BuildFusedFuncAsync(const Function& func,
+                                                     const tvm::Target& target,
+                                                     const std::vector<uint8_t>& key,
+                                                     MetaPersistCache<TVMModuleCacheEntry>* cache,
+                                                     const std::string& name) {
+  // Never destroyed, as they are accessed by the background builds running at the process exit.
+  static auto* mu = new std::mutex();
+  static auto* pending = new std::unordered_map<std::string, std::shared_ptr<AsyncBuildState>>();
+  std::string key_str(key.begin(), key.end());
+  std::lock_guard<std::mutex> lock(*mu);
+  auto it = pending->find(key_str);
+  if (it != pending->end()) {
+    return it->second;
+  }
+  auto state = std::make_shared<AsyncBuildState>();
+  (*pending)[key_str] = state;
+  // The build depends on the configs of the current PassContext, e.g., whether to use
+  // auto-scheduler, so it is built under the same PassContext in the worker thread.
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  state->build = [=]() {
+    tvm::With<tvm::transform::PassContext> ctx_scope(pass_ctx);
+    auto entry = BuildFusedFunc(func, target);
+    // The cache may have been destroyed if the process is exiting.
+    if (!AsyncBuildStopped()) {
+      cache->Set(key_str, entry);
+    }
+    return entry.GetFunction();
+  };
+  AsyncBuild([=]() {
+    try {
+      state->f = state->build();
+      state->ready.store(true, std::memory_order_release);
+    } catch (const dmlc::Error& e) {
+      // The OpEnvs sharing this state build it synchronously on their next invocation.
+      LOG(WARNING) << "Failed to build a fused op " << name
+                   << " in the background. Build it synchronously instead: " << e.what();
+      state->failed.store(true, std::memory_order_release);
+    }
+    // Evict the state, so that a new OpEnv of the same function starts another build.
+    std::lock_guard<std::mutex> lock(*mu);
+    pending->erase(key_str);
+  });
+  return state;
+}
+
+OpEnv* FusedFuncBuild(const op::CallValues& call) {
   auto env = std::make_unique<TVMOpEnv>();
   Device dev = call->device;
 
@@ -279,28 +375,30 @@ OpEnv* FusedFuncBuild(const op::CallValues& call) {
   RAF2TVM raf_to_tvm(call, dev.device_type());
   Function func = Downcast<Function>(raf_to_tvm());
   env->env_name = TruncateName(GetUniqueName(raf_to_tvm.func_name));
+  env->arg_indices = raf_to_tvm.arg_indices;
 
   auto key = HashFusedFunc(Downcast<ClosureValue>(call->callee)->func);
+  key << target->str();
   TVMModuleCacheEntry entry;
   if (const auto* compiled = cache->Get(key.byte_vector)) {
     entry = *compiled;
+    env->f = entry.GetFunction();
+  } else if (!AllowJitFailure() && AsyncBuildEnabled()) {
+    // Do not block the first invocation on the build. Run the fallback until it is ready.
+    env->async_build = BuildFusedFuncAsync(func, target, key.byte_vector, cache, env->env_name);
+    env->fallback = FusedFuncFallback(call, env->arg_indices);
   } else {
-    te_compiler->Clear();
     try {
-      auto cached_key = tvm::relay::tec::CCacheKey(func, target);
-      auto cached_func = te_compiler->Lower(cached_key, [](String name) { return name; });
-      auto mod = tvm::build(cached_func->funcs, cached_key->target, Target(nullptr));
-      entry = TVMModuleCacheEntry(mod, cached_func->prim_fn_var->name_hint);
+      entry = BuildFusedFunc(func, target);
       cache->Set(key.byte_vector, entry);
     } catch (const dmlc::Error& e) {
       if (!AllowJitFailure()) {
         LOG(FATAL) << "Failed to build a fused op " << env->env_name << ": " << e.what();
       }
     }
+    env->f = entry.GetFunction();
   }
 
-  env->f = entry.GetFunction();
-  env->arg_indices = raf_to_tvm.arg_indices;
   Array<Value> args = GetListArgs(call->args);
   for (const int& i : env->arg_indices) {
     GetDLTensor(args[i], &env->inputs);
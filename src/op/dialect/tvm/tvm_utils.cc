@@ -7,6 +7,12 @@
  * \file ./src/op/dialect/tvm/tvm_utils.cc
  * \brief Implementation of utility methods for TVM dialect.
  */
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <queue>
+#include <thread>
 #include "raf/value.h"
 #include "raf/registry.h"
 #include "./tvm_utils.h"
@@ -85,12 +91,22 @@ void SetArgs(std::vector<DLTensor>* i, std::vector<DLTensor>* o, std::vector<TVM
 }
 
 void TVMOpEnv::Execute(const op::CallValues& call) {
+  if (async_build != nullptr && !async_build->Ready()) {
+    Array<Value> args = GetListArgs(call->args);
+    std::vector<Value> fallback_inputs;
+    for (int i : arg_indices) {
+      fallback_inputs.push_back(args[i]);
+    }
+    fallback(fallback_inputs, call->out);
+    return;
+  }
+  const registry::PackedFunc& func = async_build != nullptr ? async_build->f : f;
   std::vector<TVMValue> values;
   std::vector<int> codes;
   SetArgs(&inputs, &outputs, &values, &codes);
   TVMArgs targs(values.data(), codes.data(), values.size());
   TVMRetValue rv;
-  f.CallPacked(targs, &rv);
+  func.CallPacked(targs, &rv);
   if (call->out->IsInstance<TensorValueObj>()) {
     DLTensor* dlt = Downcast<value::TensorValue>(call->out);
     dlt->data = outputs[0].data;
@@ -107,15 +123,16 @@ void TVMOpEnv::Execute(const op::CallValues& call) {
 }
 
 void TVMOpEnv::Execute(const std::vector<Value>& inputs, Value output) {
-  this->inputs.clear();
-  this->outputs.clear();
+  // Use local tensors instead of the members, as the OpEnv may be executed by
+  // multiple VM contexts concurrently.
+  std::vector<DLTensor> in_tensors, out_tensors;
   for (auto val : inputs) {
-    GetDLTensor(val, &this->inputs);
+    GetDLTensor(val, &in_tensors);
   }
-  GetDLTensor(output, &this->outputs);
+  GetDLTensor(output, &out_tensors);
   std::vector<TVMValue> values;
   std::vector<int> codes;
-  SetArgs(&this->inputs, &this->outputs, &values, &codes);
+  SetArgs(&in_tensors, &out_tensors, &values, &codes);
   TVMArgs targs(values.data(), codes.data(), values.size());
   TVMRetValue rv;
 
@@ -125,9 +142,124 @@ void TVMOpEnv::Execute(const std::vector<Value>& inputs, Value output) {
     return;
   }
 
+  if (async_build != nullptr) {
+    // Swap in the built function once the background build is ready.
+    if (!async_build->Ready()) {
+      fallback(inputs, output);
+      return;
+    }
+    async_build->f.CallPacked(targs, &rv);
+    return;
+  }
   f.CallPacked(targs, &rv);
 }
 
+bool AsyncBuildState::Ready() {
+  if (ready.load(std::memory_order_acquire)) {
+    return true;
+  }
+  if (!failed.load(std::memory_order_acquire)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mu);
+  if (!ready.load(std::memory_order_relaxed)) {
+    f = build();
+    ready.store(true, std::memory_order_release);
+  }
+  return true;
+}
+
+/*!
+ * \brief A fixed-size thread pool that builds TVM modules in the background. The pool is never
+ * destroyed and its workers are detached, so a running build does not block the process exit.
+ */
+class AsyncBuildPool {
+ public:
+  explicit AsyncBuildPool(int num_threads) {
+    for (int i = 0; i < num_threads; ++i) {
+      std::thread([this]() { WorkerLoop(); }).detach();
+    }
+  }
+
+  void Enqueue(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (stop_) {
+        return;
+      }
+      tasks_.push(std::move(task));
+    }
+    cv_.notify_one();
+  }
+
+  /*! \brief Drop the pending tasks and let the idle workers exit. */
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      stop_ = true;
+      std::queue<std::function<void()>>().swap(tasks_);
+    }
+    cv_.notify_all();
+  }
+
+  bool stopped() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return stop_;
+  }
+
+  static AsyncBuildPool* Get() {
+    static AsyncBuildPool* pool = []() {
+      auto* pool = new AsyncBuildPool(GetNumThreads());
+      // Stop the pool before the static objects used by the builds, e.g., the caches, are
+      // destroyed.
+      std::atexit([]() { Get()->Stop(); });
+      return pool;
+    }();
+    return pool;
+  }
+
+ private:
+  static int GetNumThreads() {
+    if (const char* val = getenv("RAF_TVM_ASYNC_BUILD_THREADS")) {
+      return std::max(1, atoi(val));
+    }
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+  }
+
+  void WorkerLoop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+        if (stop_) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+      task();
+    }
+  }
+
+  /*! \brief The pending build tasks. */
+  std::queue<std::function<void()>> tasks_;
+  /*! \brief The mutex to protect the task queue. */
+  std::mutex mu_;
+  /*! \brief The condition variable to wake up the workers. */
+  std::condition_variable cv_;
+  /*! \brief Whether the process is exiting. */
+  bool stop_ = false;
+};
+
+void AsyncBuild(std::function<void()> task) {
+  AsyncBuildPool::Get()->Enqueue(std::move(task));
+}
+
+bool AsyncBuildStopped() {
+  return AsyncBuildPool::Get()->stopped();
+}
+
 PackedMetricMap DumpTVMCacheMetric(const std::string& cache_name) {
   static std::unordered_map<std::string, MetaCacheMetric*> name_to_cache = {
       {"tvm_cpu", &CacheBuildCpu},
@@ -152,6 +284,7 @@ RAF_REGISTER_GLOBAL("raf.cache.DumpTVMCacheMetric").set_body_typed(DumpTVMCacheM
 
 RAF_REGISTER_DIALECT("tvm").set_enable(DevType::kCPU()).set_enable(DevType::kCUDA());
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.allow_jit_failure", tvm::Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.async_build", tvm::Bool);
 
 }  // namespace tvm_dialect
 }  // namespace op
@@ -8,8 +8,11 @@
  * \brief Utility methods for TVM dialect.
  */
 #pragma once
+#include <atomic>
+#include <functional>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <dmlc/filesystem.h>
 #include <tvm/node/serialization.h>
 #include "dlpack/dlpack.h"
@@ -40,12 +43,50 @@ ir::Function LowerOp(const ir::Op& op, const ir::Attrs& attrs,
 float CalcFuncGFLOPS(const op::CallValues& call, const Array<Type>& param_types,
                      const Type& ret_type, const Device& device);
 
+/*! \brief The state of a TVM module that is being built in the background. */
+struct AsyncBuildState {
+  /*! \brief Whether the build has finished successfully. */
+  std::atomic<bool> ready{false};
+  /*! \brief Whether the background build has failed. */
+  std::atomic<bool> failed{false};
+  /*! \brief The built function. It is valid only after ready is set. */
+  registry::PackedFunc f{nullptr};
+  /*! \brief Build the function, which runs in the background, and again synchronously if the
+   * background build has failed. */
+  std::function<registry::PackedFunc()> build;
+  /*! \brief The mutex of the synchronous build. */
+  std::mutex mu;
+
+  /*!
+   * \brief Return whether the built function is ready. If the background build has failed, the
+   * function is built synchronously, which reports the error if it fails again.
+   */
+  bool Ready();
+};
+
+/*!
+ * \brief Run a build task on the background compile thread pool. The number of threads is
+ * controlled by the environment variable RAF_TVM_ASYNC_BUILD_THREADS. The pending tasks are
+ * dropped when the process exits.
+ */
+void AsyncBuild(std::function<void()> task);
+
+/*! \brief Return whether the process is exiting, so the background builds should not publish
+ * their results. */
+bool AsyncBuildStopped();
+
 class TVMOpEnv : public op::OpEnv {
  public:
+  using FFallback = std::function<void(const std::vector<Value>& inputs, Value output)>;
+
   std::string env_name;
   std::vector<DLTensor> inputs;
   std::vector<DLTensor> outputs;
   registry::PackedFunc f{nullptr};
+  /*! \brief The pending background build. If set, it replaces f once it is ready. */
+  std::shared_ptr<AsyncBuildState> async_build;
+  /*! \brief The kernel to run while the background build is pending. */
+  FFallback fallback;
 
   TVMOpEnv() = default;
   virtual ~TVMOpEnv() = default;
@@ -179,6 +220,16 @@ inline bool AllowJitFailure() {
       .value();
 }
 
+/*!
+ * \brief Return whether to build fused TVM ops in the background and run a fallback kernel
+ * until the build is ready.
+ */
+inline bool AsyncBuildEnabled() {
+  return tvm::relay::transform::PassContext::Current()
+      ->GetConfig<tvm::Bool>("raf.tvm.async_build", tvm::Bool(false))
+      .value();
+}
+
 /*!
  * \brief Modify the configs of the current PassContext to enable auto-scheduler for TVM ops.
  */
@@ -205,7 +256,8 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
   template <typename RType>                                                                        \
   inline RType FUNC##CacheCompile(TVMOpEnv* env, const op::CallValues call,                        \
                                   MetaPersistCache<RType>* cache,                                  \
-                                  std::function<RType(const ir::Function&)> f_post_lower) {        \
+                                  std::function<RType(const ir::Function&)> f_post_lower,          \
+                                  const tvm::Target& target) {                                     \
     raf::op::tvm_dialect::ForceEnableAutoScheduler();                                              \
     static const auto op = Op::Get(RAF_DIALECT_OP_NAME(tvm, OP));                                  \
     const auto* schema = call->args.as<SCHEMA>();                                                  \
@@ -228,6 +280,10 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
     RType ret;                                                                                     \
     HashKey key;                                                                                   \
     key << #OP << HASH(param_types, ret_type, schema);                                             \
+    /* The compiled module depends on the target, while the lowered function does not */           \
+    if (target.defined()) {                                                                        \
+      key << target->str();                                                                        \
+    }                                                                                              \
     if (const auto* compiled = cache->Get(key.byte_vector)) {                                      \
       ret = *compiled;                                                                             \
     } else {                                                                                       \
@@ -269,7 +325,7 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
           return TVMModuleCacheEntry(mod, cached_func->prim_fn_var->name_hint);                    \
         });                                                                                        \
     try {                                                                                          \
-      auto module_cache_entry = FUNC##CacheCompile(env, call, cache, f_post_lower);                \
+      auto module_cache_entry = FUNC##CacheCompile(env, call, cache, f_post_lower, target);        \
       env->f = module_cache_entry.GetFunction();                                                   \
     } catch (const dmlc::Error& e) {                                                               \
       /* Invalid implementation. Return nullptr to let dispatcher select the next one */           \
@@ -306,7 +362,7 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
     MetaPersistCache<RelayFuncCacheEntry>* cache;                                                  \
     cache = &CacheLoweredFunc;                                                                     \
     auto env = std::make_unique<TVMOpEnv>();                                                       \
-    return FUNC##CacheCompile(env.get(), call, cache, identity).GetFunction();                     \
+    return FUNC##CacheCompile(env.get(), call, cache, identity, Target(nullptr)).GetFunction();    \
   }                                                                                                \
   RAF_REGISTER_DIALECT_OP(tvm, OP, PLEVEL)                                                         \
       .set_attr<::raf::op::TOpPattern>("TOpPattern", OP_PATTERN)                                   \
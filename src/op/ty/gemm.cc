@@ -10,6 +10,7 @@
 #include <tvm/relay/type.h>
 #include "raf/type.h"
 #include "../schema/ufunc.h"
+#include "../schema/nn.h"
 #include "./utils.h"
 
 namespace raf {
@@ -18,6 +19,7 @@ namespace op {
 using namespace raf::ir;
 using namespace raf::value;
 using schema::BinaryArgs;
+using schema::QuantizedGemmArgs;
 
 template <bool transpose_a, bool transpose_b>
 Type MatmulInfer(const CallValues& value) {
@@ -71,6 +73,40 @@ Type BatchMatmulInfer(const CallValues& value) {
   return TensorType(oshape, x->dtype);
 }
 
+template <int ndim>
+Type QuantizedGemmInfer(const CallValues& value) {
+  const auto* args = value->args.as<QuantizedGemmArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x1));
+  TensorType y = Downcast<TensorType>(GetType(args->x2));
+  CHECK(x->shape.size() == ndim && y->shape.size() == ndim);
+  CHECK(x->dtype == DataType::Int(8) && y->dtype == DataType::Int(8))
+      << "QuantizedGemm: expects int8 inputs, but got " << x->dtype << " and " << y->dtype;
+  int batch_dims = ndim - 2;
+  PrimExpr n1 = x->shape[batch_dims];
+  PrimExpr m1 = x->shape[batch_dims + 1];
+  PrimExpr n2 = y->shape[batch_dims];
+  PrimExpr m2 = y->shape[batch_dims + 1];
+  if (args->transpose_a) {
+    std::swap(n1, m1);
+  }
+  if (args->transpose_b) {
+    std::swap(n2, m2);
+  }
+  CHECK(TypeCheckCompare(m1, n2, std::equal_to<int>()))
+      << "QuantizedGemm: shapes of x and y is inconsistent, "
+      << " x shape=" << x->shape << ", y shape=" << y->shape;
+  Array<tvm::PrimExpr> oshape = {n1, m2};
+  if (batch_dims) {
+    int64_t k1_v = x->shape[0].as<IntImmNode>()->value;
+    int64_t k2_v = y->shape[0].as<IntImmNode>()->value;
+    CHECK(k1_v == k2_v || k1_v == 1 || k2_v == 1)
+        << "Incompatible broadcast type " << x << " and " << y;
+    oshape.insert(oshape.begin(), k1_v > k2_v ? x->shape[0] : y->shape[0]);
+  }
+  return TensorType(oshape, DataType::Int(32));
+}
+
 RAF_OP_TYPE("raf.op.matmul", "Matmul", (MatmulInfer<false, false>));
 RAF_OP_TYPE("raf.op.matmul_nt", "MatmulNT", (MatmulInfer<false, true>));
 RAF_OP_TYPE("raf.op.matmul_tn", "MatmulTN", (MatmulInfer<true, false>));
@@ -80,6 +116,8 @@ RAF_OP_TYPE("raf.op.batch_matmul", "BatchMatmulNN", (BatchMatmulInfer<false, fal
 RAF_OP_TYPE("raf.op.batch_matmul_nt", "BatchMatmulNT", (BatchMatmulInfer<false, true>));
 RAF_OP_TYPE("raf.op.batch_matmul_tn", "BatchMatmulTN", (BatchMatmulInfer<true, false>));
 RAF_OP_TYPE("raf.op.batch_matmul_tt", "BatchMatmulTT", (BatchMatmulInfer<true, true>));
+RAF_OP_TYPE("raf.op.quantized_matmul", "QuantizedMatmul", QuantizedGemmInfer<2>);
+RAF_OP_TYPE("raf.op.quantized_batch_matmul", "QuantizedBatchMatmul", QuantizedGemmInfer<3>);
 
 }  // namespace op
 }  // namespace raf
@@ -81,6 +81,19 @@ Type Conv2DInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.conv2d", "Conv2d", Conv2DInfer);
 
+Type QuantizedConv2DInfer(const CallValues& value) {
+  const auto* args = value->args.as<ConvArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType w = Downcast<TensorType>(GetType(args->w));
+  CHECK(x->dtype == DataType::Int(8) && w->dtype == DataType::Int(8))
+      << "QuantizedConv2d: expects int8 inputs, but got " << x->dtype << " and " << w->dtype;
+  TensorType y = Downcast<TensorType>(Conv2DInfer(value));
+  return TensorType(y->shape, DataType::Int(32));
+}
+
+RAF_OP_TYPE("raf.op.quantized_conv2d", "QuantizedConv2d", QuantizedConv2DInfer);
+
 Type Conv2DTransInfer(const CallValues& value) {
   const auto* args = value->args.as<ConvTransArgs>();
   CHECK(args != nullptr);
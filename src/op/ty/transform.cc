@@ -493,6 +493,48 @@ Type GroupCastInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.group_cast", "GroupCast", GroupCastInfer);
 
+Type QuantizeBlockwiseInfer(const CallValues& value) {
+  const auto* args = value->args.as<QuantizeBlockwiseArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  CHECK_GT(args->block_size, 0);
+  PrimExpr size = Integer(1);
+  for (const auto& dim : x->shape) {
+    size *= dim;
+  }
+  PrimExpr block_size = Integer(args->block_size);
+  PrimExpr n_blocks = tvm::indexdiv(size + block_size - 1, block_size);
+  TensorType data = TensorType({n_blocks, block_size}, DataType::Int(8));
+  TensorType scale = TensorType({n_blocks}, DataType::Float(32));
+  return TupleType({data, scale});
+}
+
+RAF_OP_TYPE("raf.op.quantize_blockwise", "QuantizeBlockwise", QuantizeBlockwiseInfer);
+
+Type DequantizeBlockwiseInfer(const CallValues& value) {
+  const auto* args = value->args.as<DequantizeBlockwiseArgs>();
+  CHECK(args != nullptr);
+  Array<PrimExpr> shape;
+  for (auto dim : args->shape) {
+    shape.push_back(Integer(dim));
+  }
+  return TensorType(shape, DataType(ir::String2DLDataType(args->dtype)));
+}
+
+RAF_OP_TYPE("raf.op.dequantize_blockwise", "DequantizeBlockwise", DequantizeBlockwiseInfer);
+
+template <typename T>
+Type QuantizeInfer(const CallValues& value) {
+  const auto* args = value->args.as<T>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  return TensorType(x->shape, DataType(ir::String2DLDataType(args->dtype)));
+}
+
+RAF_OP_TYPE("raf.op.quantize", "Quantize", QuantizeInfer<QuantizeArgs>);
+RAF_OP_TYPE("raf.op.dequantize", "Dequantize", QuantizeInfer<DequantizeArgs>);
+RAF_OP_TYPE("raf.op.requantize", "Requantize", QuantizeInfer<RequantizeArgs>);
+
 Type ExpandDimsInfer(const CallValues& value) {
   const auto* args = value->args.as<ExpandDimsArgs>();
   CHECK(args);
@@ -628,7 +628,10 @@ TVM_REGISTER_PASS_CONFIG_OPTION("raf.amp.out_dtype", String);
 Pass AutoCast() {
   PassContext pass_ctx = PassContext::Current();
   String amp_dtype = pass_ctx->GetConfig("raf.amp.dtype", String("float16")).value();
-  String out_dtype = pass_ctx->GetConfig("raf.amp.out_dtype", String("float16")).value();
+  CHECK(amp_dtype == "float16" || amp_dtype == "bfloat16")
+      << "Unsupported AMP dtype " << amp_dtype << ". Candidates are float16 and bfloat16";
+  // The model outputs follow the AMP dtype unless specified.
+  String out_dtype = pass_ctx->GetConfig("raf.amp.out_dtype", amp_dtype).value();
   DLOG(INFO) << "AMP dtype: " << amp_dtype << ", output dtype: " << out_dtype;
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
@@ -0,0 +1,275 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file compress_activation.cc
+ * \brief Store the activations saved for backward in compressed form.
+ */
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "raf/op_utils.h"
+#include "./common.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace compress_activation {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+template <typename T>
+using VarMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+using VarSet = std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual>;
+
+/*!
+ * \brief Compress the activations produced by the forward graph and used by the backward closure
+ * generated by AutoDiff. Each activation is compressed right after its last use in the forward
+ * graph and decompressed right before its first use in the closure, so the full-precision tensor
+ * is no longer alive in between, and liveness-based passes (e.g., memory planning and
+ * rematerialization) naturally account for the savings. For example, with float16:
+ *
+ *   let %a = relu(%x);
+ *   let %b = matmul(%a, %w);
+ *   let %closure = fn (%dy) {
+ *     let %da = matmul_nt(%dy, %w);
+ *     let %dx = relu_dx(%a, %da);
+ *     ...
+ *   };
+ *
+ * becomes
+ *
+ *   let %a = relu(%x);
+ *   let %b = matmul(%a, %w);
+ *   let %a_c = cast(%a, "float16");
+ *   let %closure = fn (%dy) {
+ *     let %da = matmul_nt(%dy, %w);
+ *     let %a_d = cast(%a_c, "float32");
+ *     let %dx = relu_dx(%a_d, %da);
+ *     ...
+ *   };
+ *
+ * With int8, the activation is quantized in blocks with a float32 scale per block.
+ */
+class ActivationCompressor {
+ public:
+  ActivationCompressor(const std::string& dtype, int block_size, int64_t min_bytes)
+      : dtype_(dtype), block_size_(block_size), min_bytes_(min_bytes) {
+  }
+
+  Function Run(const Function& func) {
+    auto ell = ExplicitLetList::make(func->body);
+    int n = ell->vars.size();
+
+    // Find the backward closure, which is the last closure in the let list.
+    int closure_idx = -1;
+    for (int i = 0; i < n; ++i) {
+      if (ell->exprs[i].as<FunctionNode>()) {
+        closure_idx = i;
+      }
+    }
+    if (closure_idx == -1) {
+      return func;
+    }
+    auto closure = Downcast<Function>(ell->exprs[closure_idx]);
+
+    // Find the last use of each forward var in the forward graph.
+    VarMap<int> def_line, last_use;
+    for (int i = 0; i < closure_idx; ++i) {
+      def_line[ell->vars[i]] = last_use[ell->vars[i]] = i;
+      for (const auto& var : FreeVars(ell->exprs[i])) {
+        last_use[var] = i;
+      }
+    }
+    // Vars used after the closure (e.g., the forward output) are alive until the end anyway.
+    VarSet used_after;
+    for (int i = closure_idx + 1; i < n; ++i) {
+      for (const auto& var : FreeVars(ell->exprs[i])) {
+        used_after.insert(var);
+      }
+    }
+    used_after.insert(ell->ret);
+
+    // Pick the activations and compress each of them after its last use in the forward graph.
+    std::unordered_map<int, std::vector<Var>> compress_at;
+    VarMap<Var> compressed;
+    int64_t orig_bytes = 0, compressed_bytes = 0;
+    for (const auto& var : FreeVars(closure)) {
+      if (def_line.count(var) == 0 || used_after.count(var) || !IsCompressible(var)) {
+        continue;
+      }
+      auto ttype = var->checked_type().as<TensorTypeNode>();
+      compress_at[last_use[var]].push_back(var);
+      orig_bytes += common::shape_utils::BytesCompactTensor(ttype);
+      compressed_bytes += CompressedBytes(ttype);
+    }
+    if (compress_at.empty()) {
+      return func;
+    }
+
+    ExplicitLetList fwd;
+    for (int i = 0; i < closure_idx; ++i) {
+      fwd.Push(ell->vars[i], ell->exprs[i]);
+      auto it = compress_at.find(i);
+      if (it == compress_at.end()) {
+        continue;
+      }
+      for (const auto& var : it->second) {
+        auto compressed_var = MakeVar(var->name_hint() + "_c", {});
+        fwd.Push(compressed_var, Compress(var));
+        compressed[var] = compressed_var;
+      }
+    }
+    fwd.Push(ell->vars[closure_idx], DecompressInClosure(closure, compressed));
+    for (int i = closure_idx + 1; i < n; ++i) {
+      fwd.Push(ell->vars[i], ell->exprs[i]);
+    }
+    fwd.ret = ell->ret;
+
+    LOG(INFO) << "Compressed " << compressed.size() << " activations to " << dtype_ << " from "
+              << orig_bytes / 1048576.0 << " MBs to " << compressed_bytes / 1048576.0 << " MBs";
+    return Function(func->params, fwd.AsExpr(), func->ret_type, func->type_params, func->attrs);
+  }
+
+ private:
+  /*! \brief Whether the var is a large enough floating point tensor with a static shape. */
+  bool IsCompressible(const Var& var) {
+    const auto* extended_var = static_cast<const ExtendedVarNode*>(var.operator->());
+    if (extended_var->may_share.defined() || !var->checked_type_.defined()) {
+      return false;
+    }
+    auto ttype = var->checked_type().as<TensorTypeNode>();
+    if (ttype == nullptr || !ttype->dtype.is_float() || ttype->dtype.bits() <= 16) {
+      return false;
+    }
+    // BytesCompactTensor returns 0 for dynamic shapes.
+    return common::shape_utils::BytesCompactTensor(ttype) >= std::max<int64_t>(min_bytes_, 1);
+  }
+
+  /*! \brief The size of the compressed tensor in bytes. */
+  int64_t CompressedBytes(const TensorTypeNode* ttype) {
+    int64_t size = common::shape_utils::BytesCompactTensor(ttype) / (ttype->dtype.bits() / 8);
+    if (dtype_ == "int8") {
+      int64_t n_blocks = (size + block_size_ - 1) / block_size_;
+      return n_blocks * block_size_ + n_blocks * 4;
+    }
+    return size * 2;
+  }
+
+  /*! \brief Make the expression compressing the var. */
+  Expr Compress(const Var& var) {
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    static const Op& quantize_op = Op::Get("raf.op.quantize_blockwise");
+    if (dtype_ == "int8") {
+      return Call(quantize_op, {var, MakeConstant(ScalarValue::make(block_size_))});
+    }
+    return Call(cast_op, {var, MakeConstant(StringValue::make(dtype_))});
+  }
+
+  /*! \brief Decompress the activations right before their first uses in the closure. */
+  Function DecompressInClosure(const Function& closure, const VarMap<Var>& compressed) {
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    static const Op& dequantize_op = Op::Get("raf.op.dequantize_blockwise");
+
+    auto ell = ExplicitLetList::make(closure->body);
+    int n = ell->vars.size();
+    CHECK_GT(n, 0) << "The backward closure is expected to be in ANF";
+
+    // Find the first use of each activation. The closure output counts as a use at the end.
+    std::unordered_map<int, std::vector<Var>> decompress_at;
+    VarSet found;
+    for (int i = 0; i <= n; ++i) {
+      Array<Var> used_vars = i < n ? FreeVars(ell->exprs[i]) : Array<Var>({ell->ret});
+      for (const auto& var : used_vars) {
+        if (compressed.count(var) && !found.count(var)) {
+          found.insert(var);
+          decompress_at[i].push_back(var);
+        }
+      }
+    }
+
+    ExplicitLetList new_ell;
+    Map<Var, Expr> vmap;
+    for (int i = 0; i <= n; ++i) {
+      auto it = decompress_at.find(i);
+      if (it != decompress_at.end()) {
+        for (const auto& var : it->second) {
+          auto ttype = var->checked_type().as<TensorTypeNode>();
+          auto orig_dtype = MakeConstant(StringValue::make(DLDataType2String(ttype->dtype)));
+          auto compressed_var = compressed.at(var);
+          Expr value;
+          if (dtype_ == "int8") {
+            auto data = MakeVar(var->name_hint() + "_q", {});
+            auto scale = MakeVar(var->name_hint() + "_s", {});
+            new_ell.Push(data, TupleGetItem(compressed_var, 0));
+            new_ell.Push(scale, TupleGetItem(compressed_var, 1));
+            auto shape = MakeConstant(op::ArrayToIntTuple(ttype->shape));
+            value = Call(dequantize_op, {data, scale, shape, orig_dtype});
+          } else {
+            value = Call(cast_op, {compressed_var, orig_dtype});
+          }
+          auto decompressed_var = MakeVar(var->name_hint() + "_d", {});
+          new_ell.Push(decompressed_var, value);
+          vmap.Set(var, decompressed_var);
+        }
+      }
+      if (i < n) {
+        new_ell.Push(ell->vars[i], Substitute(ell->exprs[i], vmap));
+      }
+    }
+    new_ell.ret = vmap.count(ell->ret) ? Downcast<Var>(vmap[ell->ret]) : ell->ret;
+    return Function(closure->params, new_ell.AsExpr(), closure->ret_type, closure->type_params,
+                    closure->attrs);
+  }
+
+  /*! \brief The compressed dtype, which is float16, bfloat16 or int8. */
+  std::string dtype_;
+  /*! \brief The number of elements sharing a scale in int8 compression. */
+  int block_size_;
+  /*! \brief The minimal size of an activation in bytes to be compressed. */
+  int64_t min_bytes_;
+};
+
+}  // namespace compress_activation
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.compress_activation.dtype", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.compress_activation.block_size", Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.compress_activation.min_bytes", Integer);
+
+Pass CompressActivation() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    std::string dtype = pc->GetConfig("raf.compress_activation.dtype", String("none")).value();
+    if (dtype == "none") {
+      return f;
+    }
+    CHECK(dtype == "float16" || dtype == "bfloat16" || dtype == "int8")
+        << "Unsupported activation compression dtype " << dtype
+        << ". Candidates are none, float16, bfloat16 and int8";
+    int block_size =
+        pc->GetConfig("raf.compress_activation.block_size", Integer(static_cast<int>(256)))
+            .value()
+            ->value;
+    CHECK_GT(block_size, 0) << "raf.compress_activation.block_size must be positive";
+    int64_t min_bytes =
+        pc->GetConfig("raf.compress_activation.min_bytes", Integer(static_cast<int>(1 << 20)))
+            .value()
+            ->value;
+    return compress_activation::ActivationCompressor(dtype, block_size, min_bytes).Run(f);
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "CompressActivationHelper", {});
+  PassInfo pass_info(1, "CompressActivation", {});
+  return RAFSequential({InferType(), func_pass}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.CompressActivation").set_body_typed(CompressActivation);
+
+}  // namespace pass
+}  // namespace raf
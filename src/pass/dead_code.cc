@@ -224,7 +224,7 @@ Pass DeadCodeElimination() {
                                                                              PassContext pc) {
     return Downcast<Function>(DeadCodeElimination(f));
   };
-  return CreateRAFFunctionPass(pass_func, 1, "DeadCodeElimination", {});
+  return CreateRAFFunctionPass(pass_func, 1, "DeadCodeElimination", {}, true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.DeadCodeElimination").set_body_typed([]() {
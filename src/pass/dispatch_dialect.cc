@@ -67,7 +67,7 @@ Pass DispatchDialect() {
                                                                              PassContext pc) {
     return Downcast<Function>(dispatch_dialect::Dispatch(f));
   };
-  return CreateRAFFunctionPass(pass_func, 1, "DispatchDialect", {});
+  return CreateRAFFunctionPass(pass_func, 1, "DispatchDialect", {}, true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.DispatchDialect").set_body_typed(DispatchDialect);
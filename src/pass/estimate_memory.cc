@@ -7,7 +7,11 @@
  * \file estimate_memory.cc
  * \brief Estimate the memory footprint. Note that this can only be used after ManifestAlloc pass.
  */
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include "raf/device.h"
+#include "raf/memory_pool.h"
 #include "raf/op.h"
 #include "raf/op_profiler.h"
 #include "raf/pass.h"
@@ -124,8 +128,226 @@ class MemoryTracer : public ExprVisitor {
   float curr_memoey_mbs_ = 0;
 };
 
+/*!
+ * \brief Estimate the peak bytes that a function allocates from the memory pool when it runs in
+ * the VM, in the program order after ManifestAlloc and MemoryPlan. The sizes of the storages and
+ * the static arena are rounded by the memory pool of their devices. The static arenas are held
+ * by the VM context once they are allocated, and so are they here.
+ *
+ * The workspace of ops is only accounted when include_workspace is set, since it requires
+ * building the ops. On CPU the workspace is a per-thread buffer that only grows, so the maximal
+ * workspace is held since the op that requests it; on other devices the workspace of an op is
+ * released after the op.
+ */
+class PeakMemoryEstimator {
+ public:
+  PeakMemoryEstimator(const IRModule& mod, const Device& device, bool include_workspace)
+      : mod_(mod), device_(device), include_workspace_(include_workspace) {
+  }
+
+  /*! \brief The peak bytes of a function, and the bytes it holds after returning. */
+  struct Result {
+    int64_t peak = 0;
+    int64_t retained = 0;
+  };
+
+  /*! \brief Estimate the function, or return nullptr if its peak depends on dynamic shapes. */
+  const Result* Estimate(const GlobalVar& gvar) {
+    auto it = results_.find(gvar);
+    if (it != results_.end()) {
+      return it->second.get();
+    }
+    // Recursive calls are not accounted.
+    results_[gvar] = std::make_unique<Result>();
+    auto func = mod_->Lookup(gvar).as<FunctionNode>();
+    if (func == nullptr) {
+      return results_[gvar].get();
+    }
+    State state;
+    auto arena_size = func->GetAttr<tvm::IntImm>(attr::kArenaSize);
+    state.arena_size = arena_size.defined() ? arena_size.value()->value : 0;
+    if (!Walk(func->body, &state)) {
+      results_[gvar] = nullptr;
+      return nullptr;
+    }
+    auto result = std::make_unique<Result>();
+    result->peak = state.peak;
+    result->retained = state.retained;
+    results_[gvar] = std::move(result);
+    return results_[gvar].get();
+  }
+
+ private:
+  /*! \brief The memory state during walking a function. */
+  struct State {
+    /*! \brief The bytes of the live storages. */
+    int64_t live = 0;
+    /*! \brief The bytes held until the function returns, e.g., the static arenas. */
+    int64_t retained = 0;
+    /*! \brief The per-thread workspace held on CPU. */
+    int64_t cpu_workspace = 0;
+    int64_t peak = 0;
+    /*! \brief The bytes of the storage vars. */
+    std::unordered_map<const VarNode*, int64_t> storages;
+    /*! \brief The size of the static arena, and whether it has been allocated. */
+    int64_t arena_size = 0;
+    bool arena_allocated = false;
+    /*! \brief The callees whose static arenas are held. */
+    std::unordered_set<const GlobalVarNode*> callees;
+
+    inline void Update(int64_t extra = 0) {
+      peak = std::max(peak, live + retained + cpu_workspace + extra);
+    }
+  };
+
+  /*! \brief Walk the let chain of an expression. Return false if the peak is unknown. */
+  bool Walk(const Expr& body, State* state) {
+    Expr expr = body;
+    while (const auto* let = expr.as<LetNode>()) {
+      let_map_[let->var.get()] = let->value;
+      if (!Visit(let->var, let->value, state)) {
+        return false;
+      }
+      expr = let->body;
+    }
+    return Visit(Var(), expr, state);
+  }
+
+  bool Visit(const Var& var, const Expr& value, State* state) {
+    static const Op& alloc_storage_op = Op::Get("raf.op.vm.alloc_storage");
+    static const Op& free_op = Op::Get("raf.op.vm.free");
+    static const Op& invoke_op = Op::Get("raf.op.vm.invoke_op");
+
+    if (const auto* if_node = value.as<IfNode>()) {
+      // Take the branch with the higher peak, and conservatively keep both of their storages.
+      State then_state = *state;
+      State else_state = *state;
+      if (!Walk(if_node->true_branch, &then_state) || !Walk(if_node->false_branch, &else_state)) {
+        return false;
+      }
+      state->peak = std::max(then_state.peak, else_state.peak);
+      state->live = std::max(then_state.live, else_state.live);
+      state->retained = std::max(then_state.retained, else_state.retained);
+      state->cpu_workspace = std::max(then_state.cpu_workspace, else_state.cpu_workspace);
+      return true;
+    }
+    const auto* call = value.as<CallNode>();
+    if (call == nullptr) {
+      return true;
+    }
+    if (const auto* gvar = call->op.as<GlobalVarNode>()) {
+      const Result* callee = Estimate(GetRef<GlobalVar>(gvar));
+      if (callee == nullptr) {
+        return false;
+      }
+      if (state->callees.insert(gvar).second) {
+        state->Update(callee->peak);
+        state->retained += callee->retained;
+      } else {
+        // The static arena of the callee is reused by the later calls.
+        state->Update(callee->peak - callee->retained);
+      }
+      return true;
+    }
+    if (call->op.same_as(alloc_storage_op)) {
+      const auto* size = call->args[0].as<ConstantNode>();
+      if (size == nullptr) {
+        // The size is computed at runtime from dynamic shapes.
+        return false;
+      }
+      Device dev(static_cast<DLDeviceType>(GetInt(call->args[2])), GetInt(call->args[3]));
+      if (call->args.size() == 7U) {
+        // The storage is in the static arena, which is allocated at the first such storage.
+        if (!state->arena_allocated) {
+          state->arena_allocated = true;
+          state->retained += memory_pool::Memory::GetAllocBytes(dev, state->arena_size);
+        }
+      } else {
+        int64_t nbytes = memory_pool::Memory::GetAllocBytes(dev, GetInt(call->args[0]));
+        state->live += nbytes;
+        state->storages[var.get()] = nbytes;
+      }
+      state->Update();
+    } else if (call->op.same_as(free_op)) {
+      auto it = state->storages.find(call->args[0].as<VarNode>());
+      if (it != state->storages.end()) {
+        state->live -= it->second;
+        state->storages.erase(it);
+      }
+    } else if (call->op.same_as(invoke_op) && include_workspace_) {
+      int64_t workspace = GetWorkspace(call);
+      if (device_.device_type() == DevType::kCPU()) {
+        state->cpu_workspace = std::max(state->cpu_workspace, workspace);
+        state->Update();
+      } else {
+        state->Update(workspace);
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Get the rounded workspace bytes of an invoked op by building it. */
+  int64_t GetWorkspace(const CallNode* invoke) {
+    auto callee_op = Resolve(invoke->args[0]);
+    const auto* args = Resolve(invoke->args[1]).as<TupleNode>();
+    if (!callee_op->IsInstance<OpNode>() && !callee_op->IsInstance<FunctionNode>()) {
+      // The op is resolved at runtime, e.g., by vm.infer_type.
+      return 0;
+    }
+    CHECK(args != nullptr);
+    Array<Expr> arg_exprs;
+    for (const auto& arg : args->fields) {
+      arg_exprs.push_back(arg);
+    }
+    auto callee = pass::InferType(Call(callee_op, arg_exprs));
+    auto* profiler = op_profiler::OpProfiler::Get(device_);
+    // Only build the op to get its workspace requests, without measuring the latency.
+    int64_t workspace = profiler->ProfileOp(callee, 0, 0, 0).second;
+    return workspace > 0 ? memory_pool::Memory::GetAllocBytes(device_, workspace) : 0;
+  }
+
+  Expr Resolve(const Expr& expr) {
+    if (const auto* var = expr.as<VarNode>()) {
+      auto it = let_map_.find(var);
+      if (it != let_map_.end()) {
+        return it->second;
+      }
+    }
+    return expr;
+  }
+
+  static int64_t GetInt(const Expr& expr) {
+    const auto* constant = expr.as<ConstantNode>();
+    CHECK(constant != nullptr);
+    return constant->value.as<IntValueObj>()->value;
+  }
+
+  /*! \brief The module after ManifestAlloc and MemoryPlan. */
+  IRModule mod_;
+  /*! \brief The device to build the ops. */
+  Device device_;
+  /*! \brief Whether to build the ops to account their workspace. */
+  bool include_workspace_;
+  /*! \brief The values of the let-bound vars. */
+  std::unordered_map<const VarNode*, Expr> let_map_;
+  /*! \brief The estimated functions, and nullptr for the functions with unknown peaks. */
+  std::unordered_map<GlobalVar, std::unique_ptr<Result>, ObjectPtrHash, ObjectPtrEqual> results_;
+};
+
 }  // namespace estimate_memory
 
+std::unordered_map<std::string, int64_t> EstimatePeakMemory(const IRModule& mod,
+                                                            const Device& device,
+                                                            bool include_workspace) {
+  estimate_memory::PeakMemoryEstimator estimator(mod, device, include_workspace);
+  std::unordered_map<std::string, int64_t> ret;
+  for (const auto& kv : mod->functions) {
+    const auto* result = estimator.Estimate(kv.first);
+    ret[kv.first->name_hint] = result != nullptr ? result->peak : -1;
+  }
+  return ret;
+}
+
 estimate_memory::MemoryTrace EstimateMemory(const IRModule& mod, const Device& device,
                                             bool include_params) {
   auto entry = mod->GetGlobalVar("main");
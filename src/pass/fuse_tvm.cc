@@ -664,7 +664,7 @@ Pass FuseTVM() {
     return Downcast<Function>(fuse_tvm::FuseMutator().Transform(f));
   };
 
-  Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "FuseTVM", {});
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "FuseTVM", {}, true);
   PassInfo pass_info(2, "FuseTVM", {});
   return RAFSequential({InferType(), func_pass}, pass_info);
 }
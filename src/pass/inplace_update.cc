@@ -512,7 +512,7 @@ Pass InplaceUpdate() {
     auto func = Function(f->params, body, f->ret_type, f->type_params, f->attrs);
     return inplace_update::InplaceSimplifer().Run(func);
   };
-  return CreateRAFFunctionPass(pass_func, 1, "InplaceUpdate", {"InferType"});
+  return CreateRAFFunctionPass(pass_func, 1, "InplaceUpdate", {"InferType"}, true);
 }
 
 Pass ValidateInplaceUpdate(bool enforce_inplace_update) {
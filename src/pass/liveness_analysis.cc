@@ -8,6 +8,7 @@
  * \brief A pass for analyzing tensor liveness.
  */
 #include "liveness_analysis.h"
+#include <algorithm>
 #include <vector>
 #include "raf/op.h"
 #include "raf/ir.h"
@@ -24,11 +25,11 @@ using PackedLiveInMap = Map<Var, Array<Var>>;
 
 namespace liveness_analysis {
 
-MapVSet LivenessAnalyzer::Run() {
+void LivenessAnalyzer::Run() {
   Expr body;
   FormCheck(func_->body);
   if (failure_) {
-    return live_;
+    return;
   }
 
   for (const auto& var : func_->params) {
@@ -54,10 +55,31 @@ MapVSet LivenessAnalyzer::Run() {
   // forward analysis
   Forward(func_->body);
 
+  // number the lines
+  NumberLines(func_->body, 0);
+
   // backward analysis
-  Var dummy = CreateNull();
-  live_[dummy] = {};
-  Backward(func_->body, dummy);
+  live_out_ = CreateNull();
+  track_temps_ = true;
+  dummy_output_ = Backward(func_->body, lines_.size());
+  ReleaseTemps();
+  track_temps_ = false;
+  Expr ret = func_->body;
+  while (const auto* let = ret.as<LetNode>()) {
+    ret = let->body;
+  }
+  if (ret.as<VarNode>()) {
+    output_tensors_ = GetVSet(Downcast<Var>(ret));
+  }
+
+  // live intervals
+  live_begins_.resize(lines_.size());
+  for (auto& kv : intervals_) {
+    kv.second.Normalize();
+    for (const auto& range : kv.second.ranges) {
+      live_begins_[range.first].push_back(kv.first);
+    }
+  }
 
   // init find
   for (const auto& kv : vset_) {
@@ -68,15 +90,6 @@ MapVSet LivenessAnalyzer::Run() {
     }
   }
 
-  // init inv
-  for (const auto& kv : live_) {
-    const Var& k = kv.first;
-    const VSet& vs = kv.second;
-    for (const auto& v : vs) {
-      inv_live_[v].insert(k);
-    }
-  }
-
   // mandatory memory sharing
   CHECK_EQ(var_out_.size(), var_in_.size());
   int m = var_out_.size();
@@ -99,8 +112,6 @@ MapVSet LivenessAnalyzer::Run() {
       Unite(fin, fout);
     }
   }
-
-  return live_;
 }
 
 void LivenessAnalyzer::FormChecker::VisitExpr_(const CallNode* node) {
@@ -252,13 +263,11 @@ Var LivenessAnalyzer::ForwardAnalyzer::Run() {
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const VarNode* node) {
   auto vars = analyzer_->GetTensorVars(GetRef<Var>(node));
   CHECK_EQ(vars.size(), 1U);
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(vars[0])];
+  SetLive(vars[0]);
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const FunctionNode* node) {
-  Function f = GetRef<Function>(node);
-  Array<Var> free_vars = FreeVars(f);
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(let_var_)];
+  SetLive(let_var_);
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const CallNode* node) {
@@ -281,9 +290,7 @@ void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const CallNode* node) {
         LOG(FATAL) << "NotImplementedError: unsupported args: " << arg->GetTypeKey();
       }
     }
-    Var d1 = analyzer_->Merge(vargs);
-    Var d2 = MergeLive(d1, let_var_);
-    analyzer_->live_[let_var_] = analyzer_->vset_[d2];
+    SetLive(analyzer_->Merge(vargs), let_var_);
   }
 }
 
@@ -296,68 +303,72 @@ void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const TupleNode* node) {
       var_fields.push_back(Downcast<Var>(field));
     }
   }
-  Var d1 = analyzer_->Merge(var_fields);
-  Var d2 = MergeLive(d1, let_var_);
-  analyzer_->live_[let_var_] = analyzer_->vset_[d2];
+  SetLive(analyzer_->Merge(var_fields), let_var_);
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const TupleGetItemNode* node) {
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(let_var_)];
+  SetLive(let_var_);
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const IfNode* node) {
   Var free_true = analyzer_->Merge(FreeVars(node->true_branch));
   Var free_false = analyzer_->Merge(FreeVars(node->false_branch));
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(
-      analyzer_->Merge({free_true, free_false, Downcast<Var>(node->cond)}), let_var_)];
-  VisitBranch(node->true_branch, let_var_);
-  VisitBranch(node->false_branch, let_var_);
+  SetLive(analyzer_->Merge({free_true, free_false, Downcast<Var>(node->cond)}), let_var_);
+  // The live tensor vars are the live-out of this line now. The ones that are not defined by
+  // this line are the live-out of both branches, which are analyzed before this line.
+  analyzer_->Backward(node->true_branch, analyzer_->false_branch_pos_.at(let_var_));
+  analyzer_->Backward(node->false_branch, next_pos_);
 }
 
-void LivenessAnalyzer::BackwardAnalyzer::VisitBranch(const Expr& branch, const Var& def) {
-  Var total_next = analyzer_->CreateTensorVar("if");
-  // get total live-out variables of true_branch
-  analyzer_->vset_[total_next] = analyzer_->live_[next_var_];
-  // remove the tensors defined at this line
-  Var branch_next = analyzer_->Remove(total_next, def);
-  analyzer_->live_[branch_next] = analyzer_->vset_[branch_next];
-  analyzer_->Backward(branch, branch_next);
-}
-
-void LivenessAnalyzer::BackwardAnalyzer::Run(Var next_var) {
+Var LivenessAnalyzer::BackwardAnalyzer::Run(int end) {
   const auto& vars = ell_->vars;
   const auto& exprs = ell_->exprs;
   CHECK_EQ(vars.size(), exprs.size());
   int n = exprs.size();
+  Var dummy_output = analyzer_->CreateNull();
+  if (n == 0) {
+    return dummy_output;
+  }
 
-  // Backward analysis
-  next_var_ = next_var;
-  analyzer_->dummy_output_ = analyzer_->CreateNull();
-  analyzer_->live_[analyzer_->dummy_output_] = analyzer_->vset_[MergeLive(ell_->ret)];
+  // Backward analysis. The returned tensor vars are live at the last line and its branches.
+  analyzer_->Transfer(analyzer_->GetVSet(ell_->ret), {}, end - 1, end, &opened_);
   for (int i = n - 1; i >= 0; --i) {
     let_var_ = vars[i];
-    next_var_ = i == n - 1 ? analyzer_->dummy_output_ : vars[i + 1];
+    next_var_ = i == n - 1 ? dummy_output : vars[i + 1];
+    next_pos_ = i == n - 1 ? end : analyzer_->line_pos_.at(next_var_);
+    uses_.clear();
+    def_ = Var();
 
     // We need to handle these nodes here, because all these nodes with
     // the same value may point to the same reference, so only the first one will be visited.
     if (exprs[i].as<OpNode>() || exprs[i].as<ConstantNode>() || exprs[i].as<FunctionNode>()) {
       auto dummy_vars = analyzer_->GetTensorVars(next_var_);
-      Var d1 = analyzer_->Merge(dummy_vars);
-      Var d2 = MergeLive(d1, next_var_);
-      analyzer_->live_[let_var_] = analyzer_->vset_[d2];
-    } else {
-      CHECK_GT(analyzer_->live_.count(next_var_), 0);
+      SetLive(analyzer_->Merge(dummy_vars), next_var_);
     }
     ExprVisitor::VisitExpr(exprs[i]);
+    analyzer_->Transfer(uses_, analyzer_->GetVSet(def_), analyzer_->line_pos_.at(let_var_),
+                        next_pos_, &opened_);
+    analyzer_->ReleaseTemps();
   }
+
+  // The tensor vars that are still live are live in at the first line.
+  int begin = analyzer_->line_pos_.at(vars[0]);
+  for (const auto& var : opened_) {
+    auto it = analyzer_->live_end_.find(var);
+    if (it != analyzer_->live_end_.end()) {
+      analyzer_->AddLiveRange(var, begin, it->second);
+      analyzer_->live_end_.erase(it);
+    }
+  }
+  return dummy_output;
 }
 
 Var LivenessAnalyzer::Forward(const Expr& e) {
   return ForwardAnalyzer(e, this).Run();
 }
 
-void LivenessAnalyzer::Backward(const Expr& e, const Var& next_var) {
-  BackwardAnalyzer(e, this).Run(next_var);
+Var LivenessAnalyzer::Backward(const Expr& e, int end) {
+  return BackwardAnalyzer(e, this).Run(end);
 }
 
 void LivenessAnalyzer::FormCheck(const Expr& e) {
@@ -368,6 +379,98 @@ Var LivenessAnalyzer::CreateTensorVar(const Type& type) {
   return VarCreator(this).Run(type);
 }
 
+int LivenessAnalyzer::NumberLines(const Expr& e, int pos) {
+  auto ell = ExplicitLetList::make(e);
+  for (size_t i = 0; i < ell->vars.size(); ++i) {
+    line_pos_[ell->vars[i]] = pos++;
+    lines_.push_back(ell->vars[i]);
+    if (const auto* if_node = ell->exprs[i].as<IfNode>()) {
+      pos = NumberLines(if_node->true_branch, pos);
+      false_branch_pos_[ell->vars[i]] = pos;
+      pos = NumberLines(if_node->false_branch, pos);
+    }
+  }
+  return pos;
+}
+
+void LivenessAnalyzer::Transfer(const VSet& uses, const VSet& defs, int pos, int next_pos,
+                                std::vector<Var>* opened) {
+  for (const auto& var : defs) {
+    auto it = live_end_.find(var);
+    if (it != live_end_.end() && uses.count(var) == 0) {
+      AddLiveRange(var, next_pos, it->second);
+      live_end_.erase(it);
+    }
+  }
+  for (const auto& var : uses) {
+    if (live_end_.emplace(var, pos).second) {
+      opened->push_back(var);
+    }
+  }
+}
+
+MapVSet LivenessAnalyzer::GetLiveInSets() const {
+  MapVSet ret;
+  if (live_out_.defined()) {
+    ret[live_out_] = {};
+  }
+  for (const auto& line : lines_) {
+    ret[line] = {};
+  }
+  for (const auto& kv : intervals_) {
+    for (const auto& range : kv.second.ranges) {
+      for (int pos = range.first; pos <= range.second; ++pos) {
+        ret[lines_[pos]].insert(kv.first);
+      }
+    }
+  }
+  if (dummy_output_.defined()) {
+    ret[dummy_output_] = output_tensors_;
+  }
+  return ret;
+}
+
+bool LiveInterval::Intersect(const LiveInterval& other) const {
+  if (!Overlap(other)) {
+    return false;
+  }
+  size_t i = 0, j = 0;
+  while (i < ranges.size() && j < other.ranges.size()) {
+    if (ranges[i].second < other.ranges[j].first) {
+      ++i;
+    } else if (other.ranges[j].second < ranges[i].first) {
+      ++j;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+void LiveInterval::Merge(const LiveInterval& other) {
+  ranges.insert(ranges.end(), other.ranges.begin(), other.ranges.end());
+  Normalize();
+}
+
+void LiveInterval::Normalize() {
+  std::sort(ranges.begin(), ranges.end());
+  std::vector<std::pair<int, int>> merged;
+  for (const auto& range : ranges) {
+    if (!merged.empty() && range.first <= merged.back().second + 1) {
+      merged.back().second = std::max(merged.back().second, range.second);
+    } else {
+      merged.push_back(range);
+    }
+  }
+  ranges = std::move(merged);
+  num_lines = 0;
+  for (const auto& range : ranges) {
+    num_lines += range.second - range.first + 1;
+  }
+  begin = ranges.empty() ? -1 : ranges.front().first;
+  end = ranges.empty() ? -1 : ranges.back().second;
+}
+
 /*!
  * \brief Calculate the byte compact size of the given type. If the type is a tuple,
  * then the size of each tensor in the tuple will be returned. Note that size 0 means
@@ -428,31 +531,33 @@ std::vector<int64_t> CalcBytesCompactSizes(const Type& type) {
 */
 
 /*! \brief Dump liveness analysis result statistics. */
-void DumpLivenessStat(const MapVSet& live_in) {
+void DumpLivenessStat(const LivenessAnalyzer& analyzer) {
   std::stringstream ss;
   ss << "Liveness Analysis Result Statistics: " << std::endl;
 
-  // Peak tensor number.
-  int peak_tensor_num = 0;
-
-  // Each tensor (var) to the length of its live.
-  StdMap<int> var_to_live_length;
-  for (auto it : live_in) {
-    peak_tensor_num = (it.second.size() > peak_tensor_num) ? it.second.size() : peak_tensor_num;
-    for (auto var : it.second) {
-      var_to_live_length[var]++;
+  // Peak tensor number, counted by the live runs that begin and end at each line.
+  std::vector<int> delta(analyzer.GetNumLines() + 1, 0);
+  for (const auto& it : analyzer.GetLiveIntervals()) {
+    for (const auto& range : it.second.ranges) {
+      delta[range.first]++;
+      delta[range.second + 1]--;
     }
   }
+  int peak_tensor_num = 0, curr_tensor_num = 0;
+  for (int d : delta) {
+    curr_tensor_num += d;
+    peak_tensor_num = std::max(peak_tensor_num, curr_tensor_num);
+  }
   ss << "Peak number of live tensors: " << peak_tensor_num << std::endl;
 
   // Each appeared live length to nmuber of tensors.
   float avg_length = 0;
   std::unordered_map<int, int> live_length_to_freq;
-  for (auto it : var_to_live_length) {
-    live_length_to_freq[it.second] += 1;
-    avg_length += it.second;
+  for (const auto& it : analyzer.GetLiveIntervals()) {
+    live_length_to_freq[it.second.num_lines] += 1;
+    avg_length += it.second.num_lines;
   }
-  avg_length /= var_to_live_length.size();
+  avg_length /= analyzer.GetLiveIntervals().size();
   ss << "Average life length: " << avg_length << std::endl;
   ss << "Detail live length to frequency: " << std::endl;
   for (auto it : live_length_to_freq) {
@@ -467,7 +572,8 @@ liveness_analysis::MapVSet LivenessAnalysis(const IRModule& mod) {
   auto entry = mod->GetGlobalVar("main");
   auto func = Downcast<Function>(mod->Lookup(entry));
   auto la = liveness_analysis::LivenessAnalyzer(func);
-  return la.Run();
+  la.Run();
+  return la.GetLiveInSets();
 }
 
 // Put the live in set to an Array as std::unordered_set is not in the object system.
@@ -484,7 +590,25 @@ PackedLiveInMap LivenessAnalysisPacked(const IRModule& mod) {
   return ret;
 }
 
+// Get the live interval [begin, end] of each tensor var, and the position of each line.
+Array<ObjectRef> LiveIntervalsPacked(const IRModule& mod) {
+  auto entry = mod->GetGlobalVar("main");
+  auto func = Downcast<Function>(mod->Lookup(entry));
+  auto la = liveness_analysis::LivenessAnalyzer(func);
+  la.Run();
+  Map<Var, Array<Integer>> intervals;
+  for (const auto& it : la.GetLiveIntervals()) {
+    intervals.Set(it.first, {Integer(it.second.begin), Integer(it.second.end)});
+  }
+  Map<Var, Integer> positions;
+  for (int pos = 0; pos < la.GetNumLines(); ++pos) {
+    positions.Set(la.GetLine(pos), Integer(pos));
+  }
+  return {intervals, positions};
+}
+
 RAF_REGISTER_GLOBAL("raf.pass_.LivenessAnalysis").set_body_typed(LivenessAnalysisPacked);
+RAF_REGISTER_GLOBAL("raf.pass_.LiveIntervals").set_body_typed(LiveIntervalsPacked);
 
 }  // namespace pass
 }  // namespace raf
@@ -8,6 +8,8 @@
  * \brief A pass for analyzing tensor liveness.
  */
 #pragma once
+#include <algorithm>
+#include <utility>
 #include <vector>
 #include "raf/op.h"
 #include "raf/op_utils.h"
@@ -43,7 +45,8 @@ namespace liveness_analysis {
  *
  * Our algorithm works as follows:
  * 1. obtain the set of tensor var contained by each original var, in ForwardAnalyzer
- * 2. obtain the set of live tensor vars at each line, in BackwardAnalyzer.
+ * 2. number the let bindings in program order (the lines of if branches follow the if line).
+ * 3. obtain the lines where each tensor var is live, in BackwardAnalyzer.
  *    Following liveness analysis for registers described in [1], live(l, t) denotes
  *    tensor var t has been defined at line l, and its value will be used at or after
  *    line l. We have rules:
@@ -51,6 +54,12 @@ namespace liveness_analysis {
  *    - live(l + 1, x) && !define(l, x) => live(l, x)
  *    where use(l, x) denotes that the computation of line l uses the value of x,
  *    and define(l, x) denotes that line l defines the value of x. x is a tensor var.
+ *    The live tensor vars are updated in place while walking the lines backward, so that
+ *    only the tensor vars used or defined by a line are touched. A tensor var that becomes
+ *    live at line l starts a live run ending at l, and the run is closed when the tensor
+ *    var is defined. The runs of each tensor var form its live interval, so that the
+ *    memory planner and the rematerializer query liveness by position instead of
+ *    scanning or copying live-in sets.
  *
  * References:
  * [1] https://www.cs.cmu.edu/~rjsimmon/15411-f15/lec/04-liveness.pdf
@@ -67,28 +76,139 @@ using MapVar = StdMap<Var>;
 using MapVSet = StdMap<VSet>;
 using MapFunction = StdMap<Function>;
 
+/*!
+ * \brief The live interval of a tensor var, i.e., the first and the last positions of the lines
+ * where it is live. The lines are numbered in program order.
+ */
+struct LiveInterval {
+  /*! \brief The first line, or -1 if the tensor is not live at any line. */
+  int begin = -1;
+  /*! \brief The last line, or -1 if the tensor is not live at any line. */
+  int end = -1;
+  /*! \brief The number of lines where the tensor is live. */
+  int num_lines = 0;
+  /*! \brief The runs [first, last] of consecutive lines where the tensor is live, in program
+   * order. There is more than one run only if the tensor is live in some branches of an if. */
+  std::vector<std::pair<int, int>> ranges;
+
+  /*! \brief Whether the tensor is live at all lines of the interval, which always holds in
+   * straight-line code but not when the tensor is only used by one branch of an if. */
+  bool IsContiguous() const {
+    return ranges.size() <= 1;
+  }
+
+  /*! \brief Whether the tensor is live at the line of the given position. */
+  bool Contains(int pos) const {
+    if (pos < begin || pos > end) {
+      return false;
+    }
+    if (IsContiguous()) {
+      return true;
+    }
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), pos,
+                               [](int p, const std::pair<int, int>& r) { return p < r.first; });
+    return (--it)->second >= pos;
+  }
+
+  /*! \brief Whether the two intervals overlap. */
+  bool Overlap(const LiveInterval& other) const {
+    return num_lines > 0 && other.num_lines > 0 && begin <= other.end && other.begin <= end;
+  }
+
+  /*! \brief Whether the two tensors are live at a common line. */
+  bool Intersect(const LiveInterval& other) const;
+
+  /*! \brief Add the lines where the other tensor is live to this interval. */
+  void Merge(const LiveInterval& other);
+
+  /*! \brief Sort and coalesce the runs, and update begin, end and num_lines accordingly. */
+  void Normalize();
+};
+
 class LivenessAnalyzer {
  public:
   LivenessAnalyzer(const Function& func) : func_(func) {
   }
 
-  MapVSet Run();
+  void Run();
 
   bool IsSuccess() {
     return !failure_;
   }
 
-  /*! \brief Get live in tensors of the given line (var). */
-  VSet GetLiveVars(const Var& x) {
-    if (live_.count(x) == 0) {
-      return VSet();
+  /*! \brief Check whether the tensor var is live in at the given line (var). */
+  bool IsLiveAt(const Var& tensor_var, const Var& x) const {
+    auto pos = line_pos_.find(x);
+    if (pos == line_pos_.end()) {
+      return false;
+    }
+    auto it = intervals_.find(tensor_var);
+    return it != intervals_.end() && it->second.Contains(pos->second);
+  }
+
+  /*!
+   * \brief Get the tensor vars that are live in at the given line (var) and whose live runs
+   * begin after the line at prev_pos. When walking a straight-line let list in order, these are
+   * the tensors that become live since the previously visited line.
+   */
+  std::vector<Var> GetLiveVarsSince(int prev_pos, const Var& x) const {
+    std::vector<Var> ret;
+    int pos = GetLinePosition(x);
+    for (int p = std::max(prev_pos + 1, 0); p <= pos; ++p) {
+      for (const auto& var : live_begins_[p]) {
+        if (intervals_.at(var).Contains(pos)) {
+          ret.push_back(var);
+        }
+      }
     }
-    return live_.at(x);
+    return ret;
+  }
+
+  /*! \brief Get the position of the line (var) in program order, or -1 if it is not a line. */
+  int GetLinePosition(const Var& x) const {
+    auto it = line_pos_.find(x);
+    return it == line_pos_.end() ? -1 : it->second;
+  }
+
+  /*! \brief Get the number of lines, including the lines in if branches. */
+  int GetNumLines() const {
+    return lines_.size();
+  }
+
+  /*! \brief Get the line (var) at the given position. */
+  const Var& GetLine(int pos) const {
+    return lines_.at(pos);
+  }
+
+  /*! \brief Get the live interval of the tensor var. */
+  const LiveInterval& GetLiveInterval(const Var& tensor_var) const {
+    static const LiveInterval empty;
+    auto it = intervals_.find(tensor_var);
+    return it == intervals_.end() ? empty : it->second;
+  }
+
+  /*!
+   * \brief Check whether the live intervals of two tensor vars overlap in constant time. It is
+   * conservative: tensors only live in different branches of an if may be reported to overlap.
+   */
+  bool MayOverlap(const Var& x, const Var& y) const {
+    return GetLiveInterval(x).Overlap(GetLiveInterval(y));
+  }
+
+  /*! \brief Get the live intervals of all tensor vars that are live at some line. */
+  const StdMap<LiveInterval>& GetLiveIntervals() const {
+    return intervals_;
   }
 
+  /*!
+   * \brief Materialize the live-in tensor vars of each line from the live intervals. It takes
+   * time and memory in the total size of the sets, so it is only meant for tests and debugging.
+   */
+  MapVSet GetLiveInSets() const;
+
   /*! \brief Get the dummy tensor variables of the final outputs. */
   VSet GetOutputTensorVars() {
-    return GetLiveVars(dummy_output_);
+    return output_tensors_;
   }
 
   /*! \brief Get the dummy tensor variables created by CreateTensor. */
@@ -109,9 +229,9 @@ class LivenessAnalyzer {
     return ret;
   }
 
-  /*! \brief Check if the variable is alive given the live dummy var set. */
-  bool IsAlive(const Var& var, const VSet& live_vars) {
-    if (live_vars.count(var)) {
+  /*! \brief Check if the variable is alive at the given line (var). */
+  bool IsAlive(const Var& var, const Var& x) {
+    if (IsLiveAt(var, x)) {
       return true;
     }
     // deal with the live dummy vars.
@@ -119,7 +239,7 @@ class LivenessAnalyzer {
       if (v == var) {
         continue;
       }
-      if (live_vars.count(v) || IsAlive(v, live_vars)) {
+      if (IsAlive(v, x)) {
         return true;
       }
     }
@@ -142,24 +262,18 @@ class LivenessAnalyzer {
     Var fx = Find(x);
     Var fy = Find(y);
     union_find_forest_[fx] = fy;
-    CHECK_GT(inv_live_.count(fx), 0);
-    CHECK_GT(inv_live_.count(fy), 0);
-    inv_live_[fy].insert(inv_live_.at(fx).begin(), inv_live_.at(fx).end());
+    if (fx != fy) {
+      LiveInterval merged = GetUnionInterval(fy);
+      merged.Merge(GetUnionInterval(fx));
+      union_intervals_[fy] = std::move(merged);
+      union_intervals_.erase(fx);
+    }
     return fy;
   }
 
-  /*! \brief check if inv_live_[x] and inv_live_[y] intersects or not */
+  /*! \brief check if the trees rooted at x and y are live at a common line or not */
   bool Intersect(const Var& x, const Var& y) {
-    CHECK_GT(inv_live_.count(x), 0);
-    CHECK_GT(inv_live_.count(y), 0);
-    const VSet& sx = inv_live_.at(x);
-    const VSet& sy = inv_live_.at(y);
-    for (const auto& v : sx) {
-      if (sy.find(v) != sy.end()) {
-        return true;
-      }
-    }
-    return false;
+    return GetUnionInterval(x).Intersect(GetUnionInterval(y));
   }
 
   /*! \brief Debug output: vset[x] */
@@ -192,9 +306,17 @@ class LivenessAnalyzer {
     return os.str();
   }
 
-  /*! \brief Debug output: live_ */
-  std::string DebugDumpLiveIn() {
-    return DebugDump(live_);
+  /*! \brief Debug output: intervals_ */
+  std::string DebugDumpLiveIntervals() {
+    std::ostringstream os;
+    for (const auto& kv : intervals_) {
+      os << kv.first << ":";
+      for (const auto& range : kv.second.ranges) {
+        os << " [" << range.first << ", " << range.second << "]";
+      }
+      os << "\n";
+    }
+    return os.str();
   }
 
   /*! \brief Debug output: vset_ */
@@ -243,6 +365,23 @@ class LivenessAnalyzer {
     return ret;
   }
 
+  /*! \brief Create a temporary variable, which is released by ReleaseTemps in backward analysis. */
+  Var CreateTemp(const std::string& name) {
+    Var var = CreateTensorVar(name);
+    if (track_temps_) {
+      temps_.push_back(var);
+    }
+    return var;
+  }
+
+  /*! \brief Release the sets of the temporary variables of the line that has been analyzed. */
+  void ReleaseTemps() {
+    for (const auto& var : temps_) {
+      vset_.erase(var);
+    }
+    temps_.clear();
+  }
+
   /*! \brief Remove vset_[v2] from vset_[v1] */
   Var Remove(Var v1, Var v2) {
     bool v1_legel = (v1.defined() && vset_.find(v1) != vset_.end());
@@ -256,7 +395,7 @@ class LivenessAnalyzer {
     }
     const VSet& vset1 = vset_.at(v1);
     const VSet& vset2 = vset_.at(v2);
-    Var rs = CreateTensorVar("rs");
+    Var rs = CreateTemp("rs");
     vset_[rs] = Remove(vset1, vset2);
     return rs;
   }
@@ -272,7 +411,7 @@ class LivenessAnalyzer {
     }
     const VSet& vset1 = vset_.at(v1);
     const VSet& vset2 = vset_.at(v2);
-    Var ms = CreateTensorVar("ms");
+    Var ms = CreateTemp("ms");
     vset_[ms] = Merge(vset1, vset2);
     return ms;
   }
@@ -336,13 +475,15 @@ class LivenessAnalyzer {
   Var Forward(const Expr& e);
 
   /*!
-   * \brief invoke BackwardAnalyzer for func:
-   *        populate live_ for each line in e
+   * \brief invoke BackwardAnalyzer for e:
+   *        add the lines of e where each tensor var is live to its live interval
    * \param e the expression to be analyzed
-   * \param next_var live_[next_var] is the live-out variables of e
-   * \note vset_ should be available already
+   * \param end the position next to the last line of e, including the lines of its branches
+   * \return the dummy var of the value of e
+   * \note vset_ and line_pos_ should be available already, and live_end_ holds the
+   *       live-out tensor vars of e
    */
-  void Backward(const Expr& e, const Var& next_var);
+  Var Backward(const Expr& e, int end);
 
   /*! \brief Check if e contains closure invoke */
   void FormCheck(const Expr& e);
@@ -350,6 +491,42 @@ class LivenessAnalyzer {
   /*! \brief Create a variable of specified type */
   Var CreateTensorVar(const Type& type);
 
+  /*! \brief Number the lines of e in program order, starting from pos. */
+  int NumberLines(const Expr& e, int pos);
+
+  /*! \brief Get vset_[x], or an empty set if x is not in vset_. */
+  const VSet& GetVSet(const Var& x) const {
+    static const VSet empty;
+    auto it = vset_.find(x);
+    return it == vset_.end() ? empty : it->second;
+  }
+
+  /*!
+   * \brief Update live_end_ from the live-out to the live-in tensor vars of the line at pos,
+   *        following live(l, x) <= use(l, x) || (live(l + 1, x) && !define(l, x)).
+   * \param uses the tensor vars used by the line
+   * \param defs the tensor vars defined by the line
+   * \param pos the position of the line
+   * \param next_pos the position next to the line and its branches, where the live runs of
+   *        the tensor vars defined by the line begin
+   * \param opened the tensor vars that become live at this line are appended to it
+   */
+  void Transfer(const VSet& uses, const VSet& defs, int pos, int next_pos,
+                std::vector<Var>* opened);
+
+  /*! \brief Add the run [first, last] of lines to the live interval of the tensor var. */
+  void AddLiveRange(const Var& var, int first, int last) {
+    if (first <= last) {
+      intervals_[var].ranges.emplace_back(first, last);
+    }
+  }
+
+  /*! \brief Get the live interval of the tensors that share memory with the root x. */
+  const LiveInterval& GetUnionInterval(const Var& x) const {
+    auto it = union_intervals_.find(x);
+    return it == union_intervals_.end() ? GetLiveInterval(x) : it->second;
+  }
+
  private:
   /*! \brief the function to be analyzed */
   const Function& func_;
@@ -359,19 +536,39 @@ class LivenessAnalyzer {
   MapVSet vset_;
   /*! \brief maps a variable with TupleType to its constituent (fake) variables */
   Map<Var, Array<Var>> vtuple_;
-  /*! \brief the live-in variables at a specific line */
-  MapVSet live_;
+  /*! \brief The dummy var of the live-out of the function, which is empty */
+  Var live_out_;
   /*! \brief The dummy value of the final output */
   Var dummy_output_;
+  /*! \brief The dummy tensor vars of the final output */
+  VSet output_tensors_;
   /*! \brief count the occurences of a var name, to avoid name collision */
   std::unordered_map<std::string, int> label_;
   /*! \brief mandatory memory sharing between a pair of vars */
   Array<Var> var_out_, var_in_;
   /*! \brief vars that share memory with one another are merged in the union find forest */
   std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> union_find_forest_;
-  /*! \brief the lines where a variable is live.
-             Initially it's the inversion of live_: inv_live_[x] = {y | x \in live_[y]} */
-  MapVSet inv_live_;
+  /*! \brief the merged live intervals of the roots in the union find forest that have been
+             united with other trees */
+  StdMap<LiveInterval> union_intervals_;
+  /*! \brief the position of each line (let var) in program order */
+  StdMap<int> line_pos_;
+  /*! \brief the line (let var) at each position */
+  std::vector<Var> lines_;
+  /*! \brief the position where the false branch of each if line begins */
+  StdMap<int> false_branch_pos_;
+  /*! \brief the live interval of each tensor var */
+  StdMap<LiveInterval> intervals_;
+  /*! \brief the tensor vars whose live runs begin at each position */
+  std::vector<std::vector<Var>> live_begins_;
+  /*! \brief the tensor vars that are live out of the line being analyzed in backward analysis,
+             and the last position of their current live runs */
+  StdMap<int> live_end_;
+  /*! \brief whether the temporary variables are tracked, which is only true in backward
+             analysis, as forward analysis keeps the temporary tuples in vtuple_ */
+  bool track_temps_{false};
+  /*! \brief the temporary variables created since the last release */
+  std::vector<Var> temps_;
 };
 
 class LivenessAnalyzer::FormChecker : public ExprVisitor {
@@ -460,23 +657,14 @@ class LivenessAnalyzer::BackwardAnalyzer : public ExprVisitor {
   void VisitExpr_(const TupleNode* node) override;
   void VisitExpr_(const TupleGetItemNode* node) override;
   void VisitExpr_(const IfNode* node) override;
-  void VisitBranch(const Expr& branch, const Var& def);
-  void Run(Var next_var);
+  Var Run(int end);
 
  private:
-  /*! \brief returns live_[next_var_] - vset_[def] + vset_[cur]
-             it's an instantiation of the following rule:
-             live(l + 1, x) && !define(l, x) => live(l, x) */
-  Var MergeLive(const Var& cur, const Var& def = Var()) {
-    Var next_line_var = analyzer_->CreateTensorVar("ml");
-    CHECK(analyzer_->live_.find(next_var_) != analyzer_->live_.end());
-    analyzer_->vset_[next_line_var] = analyzer_->live_.at(next_var_);
-    Var remain = next_line_var;
-    if (def.defined()) {
-      remain = analyzer_->Remove(remain, def);
-    }
-    Var ret = analyzer_->Merge(remain, cur);
-    return ret;
+  /*! \brief set the tensor vars used and defined by the current line to vset_[use] and
+             vset_[def], which are applied by Transfer once the line is visited */
+  void SetLive(const Var& use, const Var& def = Var()) {
+    uses_ = analyzer_->GetVSet(use);
+    def_ = def;
   }
 
  private:
@@ -488,6 +676,14 @@ class LivenessAnalyzer::BackwardAnalyzer : public ExprVisitor {
   Var let_var_;
   /*! \brief the variable next to let_var_ */
   Var next_var_;
+  /*! \brief the position next to let_var_ and its branches */
+  int next_pos_;
+  /*! \brief the tensor vars used by let_var_ */
+  VSet uses_;
+  /*! \brief the variable whose tensor vars are defined by let_var_ */
+  Var def_;
+  /*! \brief the tensor vars that become live in this let list */
+  std::vector<Var> opened_;
   /*! \brief the analyzer it belongs to */
   LivenessAnalyzer* analyzer_;
 };
@@ -499,7 +695,7 @@ class LivenessAnalyzer::BackwardAnalyzer : public ExprVisitor {
 std::vector<int64_t> CalcBytesCompactSizes(const Type& type);
 
 /*! \brief Dump liveness analysis result statistics. */
-void DumpLivenessStat(const MapVSet& live_in);
+void DumpLivenessStat(const LivenessAnalyzer& analyzer);
 
 }  // namespace liveness_analysis
 }  // namespace pass
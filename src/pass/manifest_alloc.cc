@@ -358,7 +358,7 @@ Pass ManifestAlloc() {
                                                                              PassContext pc) {
     return Downcast<ir::Function>(manifest_alloc::ManifestAllocMutator()(f));
   };
-  return CreateRAFFunctionPass(pass_func, 0, "ManifestAlloc", {});
+  return CreateRAFFunctionPass(pass_func, 0, "ManifestAlloc", {}, true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.ManifestAlloc").set_body_typed(ManifestAlloc);
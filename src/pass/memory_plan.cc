@@ -8,7 +8,11 @@
  * \brief Optimized allocated memory in the IR.
  */
 #include <algorithm>
+#include <map>
+#include <numeric>
 #include <random>
+#include <set>
+#include <utility>
 #include <vector>
 
 #include "raf/op.h"
@@ -54,6 +58,13 @@ struct TensorGroup {
 
   /*! \brief The alignment of this group. */
   int64_t alignment;
+
+  /*! \brief The last line where a member is live, or -1 if no member is live at any line. */
+  int live_end = -1;
+
+  /*! \brief Whether a member is only live in some branches of an if, so the group may be
+   * free at a line before live_end. */
+  bool has_gaps = false;
 };
 
 /*! \brief A list of tensor groups with manipulation utilities. */
@@ -91,49 +102,51 @@ class TensorGroups {
 
   /*! \brief Find the group ID that the target var belongs to, or -1 if not found. */
   int FindGroupIdByMember(const Var& let_var) {
-    const Var target_var = GetTensorVar(let_var);
-    for (size_t j = 0; j < groups.size(); ++j) {
-      if (groups[j].members.find(target_var) != groups[j].members.end()) {
-        return j;
-      }
-    }
-    return -1;
+    auto it = member_group_.find(GetTensorVar(let_var));
+    return it == member_group_.end() ? -1 : it->second;
   }
 
   /*! \brief Find the group ID that the target storage var belongs to, or -1 if not found. */
   int FindGroupIdByStorageVar(const Var& storage_var) {
-    for (size_t j = 0; j < groups.size(); ++j) {
-      if (groups[j].storage == storage_var) {
-        return j;
-      }
-    }
-    return -1;
+    auto it = storage_group_.find(storage_var);
+    return it == storage_group_.end() ? -1 : it->second;
   }
 
   /*! \brief Find valid tensor groups of the given tensor and its alignment. */
   std::vector<int> FindValidGroups(const Var& let_var, const int64_t alignment) {
-    // Live in vars.
-    auto live_in_vars = analyzer_->GetLiveVars(let_var);
-
-    // Find valid tensor groups.
+    // This group is invalid for this tensor to join if:
+    // 1. Its size is dynamic,
+    // 2. Its alignment is not the same as the current tensor, or
+    // 3. One of its members is live in at this line.
+    // The groups are indexed by the last line where their members are live, so only the
+    // groups whose members are all dead before this line are visited, plus the groups with
+    // members live in some branches of an if, which are checked member by member.
+    int pos = analyzer_->GetLinePosition(let_var);
+    auto is_candidate = [&](int group_id) {
+      return groups[group_id].size != -1 && groups[group_id].alignment == alignment;
+    };
     std::vector<int> candidates;
-    for (size_t i = 0; i < groups.size(); ++i) {
+    for (auto it = group_ends_.begin(); it != group_ends_.end() && it->first < pos; ++it) {
+      if (is_candidate(it->second)) {
+        candidates.push_back(it->second);
+      }
+    }
+    for (int group_id : gapped_groups_) {
+      if (!is_candidate(group_id)) {
+        continue;
+      }
       bool valid = true;
-      for (const auto& member : groups[i].members) {
-        if (groups[i].size == -1 || live_in_vars.count(member.first) > 0 ||
-            groups[i].alignment != alignment) {
-          // This group is invalid for this tensor to join if:
-          // 1. Its size is dynamic,
-          // 2. One of its members appears at the live-in set, or
-          // 3. Its alignment is not the same as the current tensor.
+      for (const auto& member : groups[group_id].members) {
+        if (groups[group_id].live_end >= pos && analyzer_->IsLiveAt(member.first, let_var)) {
           valid = false;
           break;
         }
       }
       if (valid) {
-        candidates.push_back(i);
+        candidates.push_back(group_id);
       }
     }
+    std::sort(candidates.begin(), candidates.end());
     return candidates;
   }
 
@@ -141,13 +154,18 @@ class TensorGroups {
   void JoinGroup(size_t group_id, const Var& let_var, int64_t size = 0) {
     const Var target_var = GetTensorVar(let_var);
     groups[group_id].members[target_var] = std::make_pair(let_var, size);
+    member_group_[target_var] = group_id;
     groups[group_id].size = (groups[group_id].size > size) ? groups[group_id].size : size;
+    UpdateLiveEnd(group_id);
   }
 
   /*! \brief Create a new group and return its ID. */
   int CreateGroup(const Var& storage_var, int64_t alignment) {
     groups.emplace_back(TensorGroup(storage_var, alignment));
-    return groups.size() - 1;
+    int group_id = groups.size() - 1;
+    storage_group_.emplace(storage_var, group_id);
+    group_ends_.emplace(groups[group_id].live_end, group_id);
+    return group_id;
   }
 
   /*! \brief Remove the tensor from the group, update the storage size, and return the size of
@@ -169,6 +187,8 @@ class TensorGroups {
       groups[group_id].size = max_size;
     }
     groups[group_id].members.erase(target_var);
+    member_group_.erase(target_var);
+    UpdateLiveEnd(group_id);
     return storage_nbytes;
   }
 
@@ -200,6 +220,33 @@ class TensorGroups {
   liveness_analysis::LivenessAnalyzer* analyzer_;
   /*! \brief Dummy vars that output tensors map to. */
   VSet dummy_out_vars_;
+  /*! \brief The group ID of each dummy tensor var in a group. */
+  StdMap<int> member_group_;
+  /*! \brief The first group ID of each storage var. */
+  StdMap<int> storage_group_;
+  /*! \brief The groups ordered by their live ends. */
+  std::set<std::pair<int, int>> group_ends_;
+  /*! \brief The groups that have members only live in some branches of an if. */
+  std::set<int> gapped_groups_;
+
+  /*! \brief Recompute the live end of the group after its members change. */
+  void UpdateLiveEnd(size_t group_id) {
+    auto& group = groups[group_id];
+    group_ends_.erase({group.live_end, group_id});
+    group.live_end = -1;
+    group.has_gaps = false;
+    for (const auto& member : group.members) {
+      const auto& interval = analyzer_->GetLiveInterval(member.first);
+      group.live_end = std::max(group.live_end, interval.end);
+      group.has_gaps |= !interval.IsContiguous();
+    }
+    if (group.has_gaps) {
+      gapped_groups_.insert(group_id);
+    } else {
+      gapped_groups_.erase(group_id);
+      group_ends_.emplace(group.live_end, group_id);
+    }
+  }
 };
 
 /*! \brief A mutator to perform the following tasks:
@@ -241,28 +288,18 @@ class MemoryPlanner : public ExprMutator {
     do {
       curr_let_ = node->var;
 
-      // Free allocated tensors that will not be used anymore.
-      auto live_in_vars = analyzer_->GetLiveVars(curr_let_);
-      auto it = live_tensors_.begin();
-      while (it != live_tensors_.end()) {
-        const Var target_var = tensor_groups_.GetTensorVar(*it);
-        if (live_in_vars.find(target_var) == live_in_vars.end()) {
-          auto group_id = tensor_groups_.FindGroupIdByMember(*it);
-          // If a tensor does not belong to any group, meaning that we its storage is not
-          // allocated by us (i.e., parameters), so simply remove it from the live set.
-          if (group_id != -1) {
-            // Remove the freed tensor from the tensor group when its life is eneded.
-            // Note that we do not need to insert vm.free for tensors as only the storage
-            // should hold the memory pointer.
-            tensor_groups_.RemoveFromGroup(group_id, *it);
-
-            // Free allocated storages that will not be used anymore.
-            auto group = tensor_groups_.groups[group_id];
-            if (group.members.size() == 0) {
-              scope->Push(MakeFreeMemory(group.storage));
-            }
-          }
-          it = live_tensors_.erase(it);
+      // Free allocated tensors that will not be used anymore, i.e., whose live intervals end
+      // before this line.
+      int pos = analyzer_->GetLinePosition(curr_let_);
+      while (!live_tensors_.empty() && live_tensors_.begin()->first < pos) {
+        FreeTensor(scope, live_tensors_.begin()->second);
+        live_tensors_.erase(live_tensors_.begin());
+      }
+      auto it = gapped_tensors_.begin();
+      while (it != gapped_tensors_.end()) {
+        if (!analyzer_->IsLiveAt(tensor_groups_.GetTensorVar(*it), curr_let_)) {
+          FreeTensor(scope, *it);
+          it = gapped_tensors_.erase(it);
         } else {
           it++;
         }
@@ -322,7 +359,7 @@ class MemoryPlanner : public ExprMutator {
       }
     } else if (op_node && GetRef<Op>(op_node) == alloc_tensor_op) {
       // Reassign alloc_tensor to the alloc_storage indicated by the tensor group.
-      live_tensors_.insert(curr_let_);
+      TrackLiveTensor(curr_let_);
 
       Array<Expr> new_args;
       for (auto& arg : call->args) {
@@ -354,7 +391,7 @@ class MemoryPlanner : public ExprMutator {
     } else if (op_node && GetRef<Op>(op_node) == reshape_tensor_op) {
       // Other ops that will also create a new tensor/view. We do not need to mutate them,
       // but have to trace their life-cycle to know the right place of inserting free storage.
-      live_tensors_.insert(curr_let_);
+      TrackLiveTensor(curr_let_);
     }
     return ExprMutator::VisitExpr_(node);
   }
@@ -369,6 +406,36 @@ class MemoryPlanner : public ExprMutator {
     return Call(op, {memory_var});
   }
 
+  /*! \brief Track the tensor until the end of its live interval. */
+  void TrackLiveTensor(const Var& let_var) {
+    const auto& interval = analyzer_->GetLiveInterval(tensor_groups_.GetTensorVar(let_var));
+    if (interval.IsContiguous()) {
+      live_tensors_.emplace(interval.end, let_var);
+    } else {
+      gapped_tensors_.insert(let_var);
+    }
+  }
+
+  /*! \brief Remove the dead tensor from its group, and free the storage of the group if the
+   * tensor is its last member.
+   */
+  void FreeTensor(LetList* scope, const Var& let_var) {
+    auto group_id = tensor_groups_.FindGroupIdByMember(let_var);
+    // If a tensor does not belong to any group, meaning that we its storage is not
+    // allocated by us (i.e., parameters), so simply remove it from the live set.
+    if (group_id != -1) {
+      // Remove the freed tensor from the tensor group when its life is eneded.
+      // Note that we do not need to insert vm.free for tensors as only the storage
+      // should hold the memory pointer.
+      tensor_groups_.RemoveFromGroup(group_id, let_var);
+
+      // Free allocated storages that will not be used anymore.
+      if (tensor_groups_.groups[group_id].members.size() == 0) {
+        scope->Push(MakeFreeMemory(tensor_groups_.groups[group_id].storage));
+      }
+    }
+  }
+
  private:
   /*! \brief The scope stack of the let list. */
   std::vector<std::unique_ptr<LetList>> scopes_;
@@ -384,8 +451,10 @@ class MemoryPlanner : public ExprMutator {
   TensorGroups tensor_groups_;
   /*! \brief Used storage vars. */
   VSet used_storages_;
-  /*! \brief Current live tensor vars. */
-  VSet live_tensors_;
+  /*! \brief Current live tensor vars, ordered by the last lines where they are live. */
+  std::multimap<int, Var> live_tensors_;
+  /*! \brief Current live tensor vars that are only live in some branches of an if. */
+  VSet gapped_tensors_;
 };
 
 /*! \brief A visitor to group tensors generated by alloc_tensor according to
@@ -493,13 +562,189 @@ TensorGroups MemoryPlanner::Group() {
   return TensorGrouper(func_, analyzer_).Run();
 }
 
+/*! \brief Plan the planned storages into a single static memory arena of the function.
+ * A storage is placed in the arena if its size is static and it holds no final output.
+ * Its lifetime spans from its alloc_storage to its vm.free, or to the end of the function
+ * if it is never freed. Storages are placed in the decreasing order of their sizes, each at
+ * the lowest aligned offset that does not overlap with any placed storage whose lifetime
+ * intersects with it. The greedy packing may leave holes, so the arena size is an upper bound
+ * of the peak memory of these storages, which is at least that peak.
+ */
+class ArenaPlanner {
+ public:
+  /*! \brief A storage placed in the arena. */
+  struct ArenaStorage {
+    /*! \brief The index of the alloc_storage in the let list. */
+    int start;
+    /*! \brief The index of the vm.free in the let list. */
+    int end;
+    /*! \brief The storage size in bytes. */
+    int64_t size;
+    /*! \brief The storage alignment in bytes. */
+    int64_t alignment;
+    /*! \brief The offset in the arena. */
+    int64_t offset = -1;
+  };
+
+  explicit ArenaPlanner(const Function& func)
+      : func_(func), ell_(ExplicitLetList::make(func->body)) {
+  }
+
+  Function Run() {
+    static const Op& alloc_storage_op = Op::Get("raf.op.vm.alloc_storage");
+    static const Op& free_op = Op::Get("raf.op.vm.free");
+    static const Op& set_stream_op = Op::Get("raf.op.set_stream");
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    int n = exprs.size();
+
+    for (int i = 0; i < n; ++i) {
+      if (exprs[i].as<IfNode>() || exprs[i].as<LetNode>()) {
+        // Storage lifetimes are not linear with control flows.
+        return func_;
+      }
+      const auto* call = exprs[i].as<CallNode>();
+      const auto* op_node = call ? call->op.as<OpNode>() : nullptr;
+      if (op_node == nullptr) {
+        continue;
+      }
+      auto op = GetRef<Op>(op_node);
+      if (op == set_stream_op) {
+        // Storages on different streams may be used out of the program order.
+        return func_;
+      } else if (op == alloc_storage_op) {
+        AddStorage(vars[i], call, i, n);
+      } else if (op == free_op) {
+        auto it = storage_index_.find(Downcast<Var>(call->args[0]));
+        if (it != storage_index_.end()) {
+          storages_[it->second].end = i;
+        }
+      }
+    }
+    if (storages_.empty()) {
+      return func_;
+    }
+
+    Pack();
+
+    for (const auto& kv : storage_index_) {
+      const auto& storage = storages_[kv.second];
+      auto call = Downcast<Call>(exprs[storage.start]);
+      Array<Expr> new_args = call->args;
+      new_args.push_back(MakeConstant(ScalarValue::make(storage.offset)));
+      ell_->exprs[storage.start] = Call(call->op, new_args, call->attrs, call->type_args);
+    }
+    DLOG(INFO) << "Planned " << storages_.size() << " storages into a static arena of "
+               << arena_size_ << " bytes";
+    auto func = Function(func_->params, ell_->AsExpr(), func_->ret_type, func_->type_params,
+                         func_->attrs);
+    func = WithAttr(std::move(func), attr::kArenaSize, tvm::IntImm(DataType::Int(64), arena_size_));
+    return WithAttr(std::move(func), attr::kArenaAlignment,
+                    tvm::IntImm(DataType::Int(64), arena_alignment_));
+  }
+
+ private:
+  /*! \brief Add the storage to the arena if it is static, planned by MemoryPlanner (i.e.,
+   * having the alloc_async flag), holds no final output, and is on the arena device. */
+  void AddStorage(const Var& var, const CallNode* call, int start, int end) {
+    if (call->args.size() != 6U) {
+      return;
+    }
+    const auto* size = call->args[0].as<ConstantNode>();
+    const auto* alignment = call->args[1].as<ConstantNode>();
+    const auto* device_type = call->args[2].as<ConstantNode>();
+    const auto* device_id = call->args[3].as<ConstantNode>();
+    const auto* alloc_async = call->args[5].as<ConstantNode>();
+    if (!size || !alignment || !device_type || !device_id || !alloc_async ||
+        !alloc_async->value.as<BoolValueObj>()->value) {
+      return;
+    }
+    auto dev = std::make_pair(device_type->value.as<IntValueObj>()->value,
+                              device_id->value.as<IntValueObj>()->value);
+    if (storages_.empty()) {
+      device_ = dev;
+    } else if (device_ != dev) {
+      return;
+    }
+    ArenaStorage storage;
+    storage.start = start;
+    storage.end = end;
+    storage.size = size->value.as<IntValueObj>()->value;
+    storage.alignment = alignment->value.as<IntValueObj>()->value;
+    if (storage.size <= 0) {
+      return;
+    }
+    storage_index_[var] = storages_.size();
+    storages_.push_back(storage);
+  }
+
+  /*! \brief Assign arena offsets to all storages. */
+  void Pack() {
+    std::vector<size_t> order(storages_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t lhs, size_t rhs) {
+      return storages_[lhs].size > storages_[rhs].size;
+    });
+
+    std::vector<const ArenaStorage*> placed;
+    for (auto idx : order) {
+      auto& storage = storages_[idx];
+      // Placed storages whose lifetime intersects with the current one, ordered by offsets.
+      std::vector<const ArenaStorage*> conflicts;
+      for (const auto* other : placed) {
+        if (storage.start <= other->end && other->start <= storage.end) {
+          conflicts.push_back(other);
+        }
+      }
+      std::sort(conflicts.begin(), conflicts.end(),
+                [](const ArenaStorage* lhs, const ArenaStorage* rhs) {
+                  return lhs->offset < rhs->offset;
+                });
+
+      // Find the first gap that fits.
+      int64_t offset = 0;
+      for (const auto* other : conflicts) {
+        if (RoundUp(offset, storage.alignment) + storage.size <= other->offset) {
+          break;
+        }
+        offset = std::max(offset, other->offset + other->size);
+      }
+      storage.offset = RoundUp(offset, storage.alignment);
+      arena_size_ = std::max(arena_size_, storage.offset + storage.size);
+      arena_alignment_ = std::max(arena_alignment_, storage.alignment);
+      placed.push_back(&storage);
+    }
+  }
+
+  inline int64_t RoundUp(int64_t value, int64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+
+  /*! \brief The function to be planned. */
+  const Function& func_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_{nullptr};
+  /*! \brief The storages in the arena. */
+  std::vector<ArenaStorage> storages_;
+  /*! \brief Map from the storage var to its index in storages_. */
+  StdMap<size_t> storage_index_;
+  /*! \brief The device type and ID of the arena. */
+  std::pair<int64_t, int64_t> device_;
+  /*! \brief The arena size in bytes. */
+  int64_t arena_size_ = 0;
+  /*! \brief The arena alignment in bytes. */
+  int64_t arena_alignment_ = 1;
+};
+
 }  // namespace memory_plan
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_plan.dump_liveness_stat", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_plan.static_arena", Bool);
 
 Pass MemoryPlan() {
   PassContext pass_ctx = PassContext::Current();
   Bool dump_stat = pass_ctx->GetConfig("raf.memory_plan.dump_liveness_stat", Bool(false)).value();
+  Bool static_arena = pass_ctx->GetConfig("raf.memory_plan.static_arena", Bool(false)).value();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
     auto func = f;
@@ -512,20 +757,28 @@ Pass MemoryPlan() {
 
     auto analyzer = liveness_analysis::LivenessAnalyzer(func);
     try {
-      auto live_in = analyzer.Run();
+      analyzer.Run();
       if (!analyzer.IsSuccess()) {
         throw;
       }
       if (dump_stat) {
-        liveness_analysis::DumpLivenessStat(live_in);
+        liveness_analysis::DumpLivenessStat(analyzer);
       }
     } catch (const dmlc::Error& e) {
       LOG(WARNING) << "Memory planning is disabled because liveness analysis was failed";
       return func;
     }
-    return Downcast<ir::Function>(memory_plan::MemoryPlanner(func, &analyzer).Run());
+    func = Downcast<ir::Function>(memory_plan::MemoryPlanner(func, &analyzer).Run());
+    if (static_arena) {
+      try {
+        func = memory_plan::ArenaPlanner(func).Run();
+      } catch (const dmlc::Error& e) {
+        LOG(WARNING) << "Static arena is disabled because the function is not in ANF";
+      }
+    }
+    return func;
   };
-  return CreateRAFFunctionPass(pass_func, 2, "MemoryPlan", {});
+  return CreateRAFFunctionPass(pass_func, 2, "MemoryPlan", {}, true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.MemoryPlan").set_body_typed(MemoryPlan);
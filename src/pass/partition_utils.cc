@@ -47,12 +47,10 @@ void PartitionFunction::TrimOutputs(liveness_analysis::LivenessAnalyzer& analyze
   if (is_final_ret) {
     outs_ = {next_var};
   } else if (analyzer.IsSuccess()) {
-    std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> live_var =
-        analyzer.GetLiveVars(next_var);
     std::vector<Expr> trimmed_outs;
     for (auto out_expr : outs_) {
       Var out = Downcast<Var>(out_expr);
-      if (analyzer.IsAlive(out, live_var)) {
+      if (analyzer.IsAlive(out, next_var)) {
         trimmed_outs.push_back(out);
       }
     }
@@ -8,7 +8,17 @@
  * \brief Infrastructure for transformation passes.
  */
 #include <tvm/node/repr_printer.h>
-
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "raf/device.h"
 #include "raf/file.h"
 #include "raf/pass.h"
 #include "raf/pass_manager.h"
@@ -22,6 +32,41 @@ using tvm::ReprPrinter;
 using tvm::runtime::TVMArgs;
 using tvm::runtime::TVMRetValue;
 
+/*!
+ * \brief The accumulated wall-clock time of the passes run in RAFSequential when the config
+ * "raf.pass.timing" is set. A pass is keyed by "<sequential>/<pass>", so the same pass run in
+ * different sequentials is timed separately.
+ */
+class PassTimings {
+ public:
+  static PassTimings* Get() {
+    static PassTimings inst;
+    return &inst;
+  }
+
+  void Add(const std::string& name, double ms) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto& entry = timings_[name];
+    entry.first++;
+    entry.second += ms;
+  }
+
+  /*! \brief Get the number of runs and the total milliseconds of each pass. */
+  std::map<std::string, std::pair<int64_t, double>> Timings() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return timings_;
+  }
+
+  void Reset() {
+    std::lock_guard<std::mutex> lock(mu_);
+    timings_.clear();
+  }
+
+ private:
+  std::map<std::string, std::pair<int64_t, double>> timings_;
+  std::mutex mu_;
+};
+
 /*!
  * \brief The RAFSequentialNode contains a set of passes that transform RAF
  * programs from one AST to another semantically equivalent one.
@@ -128,6 +173,19 @@ IRModule RAFSequentialNode::operator()(IRModule mod, const PassContext& pass_ctx
     DumpAfterPassIRToFile(dump_ir_path, mod, 0, "init");
   }
 
+  bool timing = pass_ctx->GetConfig("raf.pass.timing", Bool(false)).value();
+  std::vector<std::pair<std::string, double>> timings;
+  auto run = [&](const Pass& pass, const std::string& name) {
+    if (!timing) {
+      mod = pass(std::move(mod), pass_ctx);
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    mod = pass(std::move(mod), pass_ctx);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    timings.emplace_back(name, elapsed.count());
+  };
+
   size_t pass_cnt = 1;
   for (const Pass& pass : passes) {
     ICHECK(pass.defined()) << "Found undefined pass for optimization.";
@@ -135,11 +193,30 @@ IRModule RAFSequentialNode::operator()(IRModule mod, const PassContext& pass_ctx
     if (!pass_ctx.PassEnabled(pass_info)) continue;
     // resolve dependencies
     for (const auto& it : pass_info->required) {
-      mod = GetPass(it)(std::move(mod), pass_ctx);
+      run(GetPass(it), it);
     }
-    mod = pass(std::move(mod), pass_ctx);
+    run(pass, pass_info->name);
     DumpAfterPassIRToFile(dump_ir_path, mod, pass_cnt++, pass_info->name);
   }
+
+  if (timing && !timings.empty()) {
+    double total = 0;
+    for (const auto& it : timings) {
+      PassTimings::Get()->Add(pass_info->name + "/" + it.first, it.second);
+      total += it.second;
+    }
+    std::ostringstream os;
+    os << "Pass timings of " << pass_info->name << " (ms):" << std::endl;
+    os << std::fixed << std::setprecision(3);
+    for (const auto& it : timings) {
+      os << "  " << std::left << std::setw(40) << it.first << std::right << std::setw(12)
+         << it.second << std::setw(8) << std::setprecision(1)
+         << (total > 0 ? 100.0 * it.second / total : 0.0) << "%" << std::setprecision(3)
+         << std::endl;
+    }
+    os << "  " << std::left << std::setw(40) << "Total" << std::right << std::setw(12) << total;
+    LOG(INFO) << os.str();
+  }
   return mod;
 }
 
@@ -168,10 +245,18 @@ class RAFFunctionPassNode : public PassNode {
    */
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func;
 
+  /*!
+   * \brief Whether pass_func only reads and rewrites the given function, so the functions of a
+   * module can be transformed concurrently. It takes effect when the config
+   * "raf.pass.num_parallel_threads" is set.
+   */
+  bool parallel = false;
+
   RAFFunctionPassNode() = default;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("pass_info", &pass_info);
+    v->Visit("parallel", &parallel);
   }
 
   /*!
@@ -211,18 +296,21 @@ class RAFFunctionPass : public Pass {
    * \brief The constructor
    * \param pass_func The packed function which implements a pass.
    * \param pass_info The pass info.
+   * \param parallel Whether the functions can be transformed concurrently.
    */
   RAFFunctionPass(TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func,
-                  PassInfo pass_info);
+                  PassInfo pass_info, bool parallel = false);
 
   RAF_OBJECT_REF(RAFFunctionPass, Pass, RAFFunctionPassNode);
 };
 
 RAFFunctionPass::RAFFunctionPass(
-    TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func, PassInfo pass_info) {
+    TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func, PassInfo pass_info,
+    bool parallel) {
   auto n = make_object<RAFFunctionPassNode>();
   n->pass_func = std::move(pass_func);
   n->pass_info = std::move(pass_info);
+  n->parallel = parallel;
   data_ = std::move(n);
 }
 
@@ -243,9 +331,59 @@ IRModule RAFFunctionPassNode::operator()(IRModule mod, const PassContext& pass_c
   for (const auto& it : updated_mod->functions) {
     // only picks up relay::Function
     if (auto* n = it.second.as<FunctionNode>()) {
-      Function func = GetRef<Function>(n);
-      auto updated_func = SkipFunction(func) ? func : pass_func(func, updated_mod, pass_ctx);
-      updates.push_back({it.first, updated_func});
+      updates.push_back({it.first, GetRef<Function>(n)});
+    }
+  }
+
+  int num_threads = 1;
+  if (parallel && updates.size() > 1) {
+    num_threads = pass_ctx->GetConfig("raf.pass.num_parallel_threads", Integer(0)).value();
+    if (num_threads < 0) {
+      num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    num_threads = std::min(num_threads, static_cast<int>(updates.size()));
+  }
+
+  if (num_threads <= 1) {
+    for (auto& pair : updates) {
+      if (!SkipFunction(pair.second)) {
+        pair.second = pass_func(pair.second, updated_mod, pass_ctx);
+      }
+    }
+  } else {
+    // The workers only read the module, and each of them writes the updated functions to their
+    // own slots, so the result is the same as the sequential one. The pass context and the device
+    // are thread-local, so the workers enter those of the caller.
+    Device device = Device::Current(true);
+    std::atomic<size_t> next{0};
+    std::mutex error_mu;
+    std::exception_ptr error;
+    auto worker = [&]() {
+      tvm::With<PassContext> ctx_scope(pass_ctx);
+      tvm::With<Device> device_scope(device);
+      for (size_t i = next++; i < updates.size(); i = next++) {
+        try {
+          if (!SkipFunction(updates[i].second)) {
+            updates[i].second = pass_func(updates[i].second, updated_mod, pass_ctx);
+          }
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mu);
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+      }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < num_threads; ++i) {
+      workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+      thread.join();
+    }
+    if (error) {
+      std::rethrow_exception(error);
     }
   }
 
@@ -263,9 +401,9 @@ bool RAFFunctionPassNode::SkipFunction(const Function& func) const {
 
 Pass CreateRAFFunctionPass(
     const TypedPackedFunc<Function(Function, IRModule, PassContext)>& pass_func, int opt_level,
-    String name, tvm::Array<String> required) {
+    String name, tvm::Array<String> required, bool parallel) {
   PassInfo pass_info = PassInfo(opt_level, name, required);
-  return RAFFunctionPass(pass_func, pass_info);
+  return RAFFunctionPass(pass_func, pass_info, parallel);
 }
 
 RAF_REGISTER_OBJECT_REFLECT(RAFFunctionPassNode);
@@ -279,7 +417,7 @@ TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
       auto* node = static_cast<const RAFFunctionPassNode*>(ref.get());
       const PassInfo info = node->Info();
       p->stream << "Run Function pass: " << info->name << " at the optimization level "
-                << info->opt_level;
+                << info->opt_level << (node->parallel ? " in parallel" : "");
     });
 
 RAF_REGISTER_GLOBAL("raf.pass_.RAFSequential").set_body([](TVMArgs args, TVMRetValue* ret) {
@@ -291,6 +429,22 @@ RAF_REGISTER_GLOBAL("raf.pass_.RAFSequential").set_body([](TVMArgs args, TVMRetV
   *ret = RAFSequential(passes, pass_info);
 });
 
+RAF_REGISTER_GLOBAL("raf.pass_.GetPassTimings").set_body_typed([]() {
+  Map<String, Array<FloatImm>> ret;
+  for (const auto& it : PassTimings::Get()->Timings()) {
+    ret.Set(it.first, {FloatImm(DataType::Float(64), it.second.first),
+                       FloatImm(DataType::Float(64), it.second.second)});
+  }
+  return ret;
+});
+
+RAF_REGISTER_GLOBAL("raf.pass_.ResetPassTimings").set_body_typed([]() {
+  PassTimings::Get()->Reset();
+});
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.pass.timing", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.pass.num_parallel_threads", Integer);
+
 TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
     .set_dispatch<RAFSequentialNode>([](const ObjectRef& ref, ReprPrinter* p) {
       auto* node = static_cast<const RAFSequentialNode*>(ref.get());
@@ -0,0 +1,462 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file quantize.cc
+ * \brief Post-training int8 quantization of matmul, dense, batch_matmul and conv2d.
+ */
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace quantize {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+template <typename T>
+using VarMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+using VarSet = std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual>;
+
+/*! \brief The smallest range, which keeps the scales of all-zero tensors positive. */
+constexpr float kMinRange = 1e-8f;
+
+/*! \brief How a float32 op maps to its int8 counterpart. */
+struct QuantizedOpInfo {
+  /*! \brief The name of the int8 op. */
+  std::string op_name;
+  /*! \brief Whether the first operand is transposed. */
+  bool transpose_a;
+  /*! \brief Whether the second operand is transposed. */
+  bool transpose_b;
+  /*! \brief The axis of the output channels in the second operand (i.e., the weight). */
+  int weight_axis;
+  /*! \brief The axis of the output channels in the output. */
+  int out_axis;
+};
+
+/*! \brief Get how the op maps to its int8 counterpart, or nullptr if it is not quantizable. */
+const QuantizedOpInfo* GetQuantizedOpInfo(const Op& op) {
+  static const std::unordered_map<std::string, QuantizedOpInfo> infos = {
+      {"raf.op.matmul", {"raf.op.quantized_matmul", false, false, 1, -1}},
+      {"raf.op.matmul_nt", {"raf.op.quantized_matmul", false, true, 0, -1}},
+      {"raf.op.matmul_tn", {"raf.op.quantized_matmul", true, false, 1, -1}},
+      {"raf.op.matmul_tt", {"raf.op.quantized_matmul", true, true, 0, -1}},
+      {"raf.op.dense", {"raf.op.quantized_matmul", false, true, 0, -1}},
+      {"raf.op.batch_matmul", {"raf.op.quantized_batch_matmul", false, false, 2, -1}},
+      {"raf.op.batch_matmul_nt", {"raf.op.quantized_batch_matmul", false, true, 1, -1}},
+      {"raf.op.batch_matmul_tn", {"raf.op.quantized_batch_matmul", true, false, 2, -1}},
+      {"raf.op.batch_matmul_tt", {"raf.op.quantized_batch_matmul", true, true, 1, -1}},
+      {"raf.op.conv2d", {"raf.op.quantized_conv2d", false, false, 0, 1}},
+  };
+  auto it = infos.find(op->name);
+  return it == infos.end() ? nullptr : &it->second;
+}
+
+/*! \brief Whether the type is a float32 tensor type. */
+bool IsFloat32Tensor(const Type& type) {
+  auto ttype = type.as<TensorTypeNode>();
+  return ttype != nullptr && ttype->dtype == DataType::Float(32);
+}
+
+/*!
+ * \brief Find the quantizable ops in a let list, and their operands which are activations, i.e.,
+ * not constants. CollectQuantizeRanges and Quantize both use it, so the ranges collected by the
+ * former are in the order the latter expects.
+ */
+class CandidateFinder {
+ public:
+  explicit CandidateFinder(const ExplicitLetList* ell) {
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      bindings_[ell->vars[i]] = ell->exprs[i];
+    }
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      if (!IsQuantizable(ell->vars[i], ell->exprs[i])) {
+        continue;
+      }
+      ops.push_back(i);
+      auto call = Downcast<Call>(ell->exprs[i]);
+      for (int j = 0; j < 2; ++j) {
+        if (!GetConstantTensor(call->args[j]).defined()) {
+          auto var = Downcast<Var>(call->args[j]);
+          if (!activation_index.count(var)) {
+            activation_index[var] = activations.size();
+            activations.push_back(var);
+          }
+        }
+      }
+    }
+  }
+
+  /*! \brief Get the float32 tensor on CPU that the expression refers to if it is a constant. */
+  TensorValue GetConstantTensor(const Expr& expr) const {
+    Expr value = expr;
+    if (auto var = expr.as<VarNode>()) {
+      auto it = bindings_.find(GetRef<Var>(var));
+      if (it != bindings_.end()) {
+        value = it->second;
+      }
+    }
+    if (!value->IsInstance<RelayConstantNode>()) {
+      return TensorValue();
+    }
+    auto tensor = ConstantExtractValue(Downcast<Constant>(value)).as<TensorValueObj>();
+    if (tensor == nullptr) {
+      return TensorValue();
+    }
+    TensorValue tv = GetRef<TensorValue>(tensor);
+    const DLTensor* dlt = tv;
+    if (dlt->device.device_type != kDLCPU || dlt->dtype.code != kDLFloat || dlt->dtype.bits != 32) {
+      return TensorValue();
+    }
+    return tv;
+  }
+
+  /*! \brief The indices of the quantizable ops in the let list. */
+  std::vector<int> ops;
+  /*! \brief The activations in the order of their first uses by the quantizable ops. */
+  std::vector<Var> activations;
+  /*! \brief The index of each activation in activations. */
+  VarMap<int> activation_index;
+
+ private:
+  /*! \brief Whether the expression bound to the var is a float32 op that can be quantized. */
+  bool IsQuantizable(const Var& var, const Expr& expr) const {
+    auto call = expr.as<CallNode>();
+    if (call == nullptr || !call->op->IsInstance<OpNode>() ||
+        GetQuantizedOpInfo(Downcast<Op>(call->op)) == nullptr || call->args.size() < 2 ||
+        !var->checked_type_.defined() || !IsFloat32Tensor(var->checked_type())) {
+      return false;
+    }
+    for (int j = 0; j < 2; ++j) {
+      const Expr& arg = call->args[j];
+      if (GetConstantTensor(arg).defined()) {
+        continue;
+      }
+      if (!arg->IsInstance<VarNode>() || !arg->checked_type_.defined() ||
+          !IsFloat32Tensor(arg->checked_type())) {
+        return false;
+      }
+    }
+    // The int8 convolution only supports NCHW inputs and OIHW weights.
+    if (Downcast<Op>(call->op)->name == "raf.op.conv2d") {
+      std::vector<std::string> layouts = {"NCHW", "OIHW", "NCHW"};
+      for (size_t j = 0; j < layouts.size() && j + 6 < call->args.size(); ++j) {
+        auto constant = call->args[j + 6].as<RelayConstantNode>();
+        if (constant == nullptr) {
+          return false;
+        }
+        auto layout = ConstantExtractValue(GetRef<Constant>(constant)).as<StringValueObj>();
+        if (layout == nullptr || layout->value != layouts[j]) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /*! \brief The expression bound to each var in the let list. */
+  VarMap<Expr> bindings_;
+};
+
+/*! \brief Make a float32 tensor constant of the given values on CPU. */
+Expr MakeScale(const std::vector<float>& values) {
+  DType dtype(DTypeCode::kFloat(), 32);
+  Device dev(DevType::kCPU(), 0);
+  std::vector<int64_t> shape{static_cast<int64_t>(values.size())};
+  auto tv = TensorValue::Assemble(dev, dtype, shape);
+  tv->tensor = tvm::runtime::NDArray::Empty(shape, dtype, dev);
+  std::copy(values.begin(), values.end(), static_cast<float*>(tv->tensor->data));
+  return MakeConstant(tv);
+}
+
+/*!
+ * \brief Make the function also return the absolute maximum of each activation. The maximum is
+ * computed right before the first quantizable op using the activation.
+ */
+Function CollectRanges(const Function& func) {
+  static const Op& abs_op = Op::Get("raf.op.abs");
+  static const Op& max_op = Op::Get("raf.op.max");
+  auto ell = ExplicitLetList::make(func->body);
+  if (ell->vars.empty()) {
+    return func;
+  }
+  CandidateFinder finder(ell.get());
+  std::unordered_map<int, std::vector<Var>> collect_at;
+  VarSet found;
+  for (int i : finder.ops) {
+    auto call = Downcast<Call>(ell->exprs[i]);
+    for (int j = 0; j < 2; ++j) {
+      auto var = call->args[j].as<VarNode>();
+      if (var && finder.activation_index.count(GetRef<Var>(var)) &&
+          !found.count(GetRef<Var>(var))) {
+        found.insert(GetRef<Var>(var));
+        collect_at[i].push_back(GetRef<Var>(var));
+      }
+    }
+  }
+
+  ExplicitLetList new_ell;
+  VarMap<Var> ranges;
+  for (size_t i = 0; i < ell->vars.size(); ++i) {
+    auto it = collect_at.find(i);
+    if (it != collect_at.end()) {
+      for (const auto& var : it->second) {
+        auto abs_var = MakeVar(var->name_hint() + "_abs", {});
+        auto range_var = MakeVar(var->name_hint() + "_range", {});
+        new_ell.Push(abs_var, Call(abs_op, {var}));
+        auto axis = MakeConstant(TupleValue::make(Array<Value>()));
+        auto keepdims = MakeConstant(BoolValue::make(false));
+        auto exclude = MakeConstant(BoolValue::make(false));
+        new_ell.Push(range_var, Call(max_op, {abs_var, axis, keepdims, exclude}));
+        ranges[var] = range_var;
+      }
+    }
+    new_ell.Push(ell->vars[i], ell->exprs[i]);
+  }
+  Array<Expr> fields;
+  for (const auto& var : finder.activations) {
+    fields.push_back(ranges.at(var));
+  }
+  auto ranges_var = MakeVar("ranges", {});
+  auto ret_var = MakeVar("ret", {});
+  new_ell.Push(ranges_var, Tuple(fields));
+  new_ell.Push(ret_var, Tuple({ell->ret, ranges_var}));
+  new_ell.ret = ret_var;
+  LOG(INFO) << "Collecting the ranges of " << fields.size() << " activations for quantization";
+  return Function(func->params, new_ell.AsExpr(), {}, func->type_params, func->attrs);
+}
+
+/*!
+ * \brief Rewrite the quantizable ops to their int8 counterparts with symmetric quantization, where
+ * a float x is represented by round(x / scale) in [-127, 127]. For example:
+ *
+ *   let %y = dense(%x, %w);
+ *   let %z = relu(%y);
+ *
+ * becomes
+ *
+ *   let %x_q = quantize(%x, %s_x, -1, "int8");
+ *   let %y_acc = quantized_matmul(%x_q, %w_q, false, true);
+ *   let %y = dequantize(%y_acc, %s_x * %s_w, -1, "float32");
+ *   let %z = relu(%y);
+ *
+ * where %w_q and %s_x * %s_w are constants computed at compile time, and %s_x is the calibrated
+ * range of %x divided by 127. Constant weights have one scale per output channel unless
+ * "raf.quantize.per_channel" is false, and activations have one scale per tensor. When the output
+ * of a quantized op is only used by other quantized ops, it is requantized to int8 directly
+ * instead of being dequantized and quantized again.
+ */
+class Quantizer {
+ public:
+  Quantizer(const Array<tvm::FloatImm>& ranges, bool per_channel)
+      : ranges_(ranges), per_channel_(per_channel) {
+  }
+
+  Function Run(const Function& func) {
+    auto ell = ExplicitLetList::make(func->body);
+    if (ell->vars.empty()) {
+      return func;
+    }
+    CandidateFinder finder(ell.get());
+    CHECK_EQ(finder.activations.size(), ranges_.size())
+        << "The number of ranges mismatches the number of activations to quantize";
+    if (finder.ops.empty()) {
+      return func;
+    }
+    std::unordered_set<int> ops(finder.ops.begin(), finder.ops.end());
+    auto int8 = MakeConstant(StringValue::make("int8"));
+    auto float32 = MakeConstant(StringValue::make("float32"));
+
+    // The outputs that are only used as the activations of other quantized ops can stay in int8.
+    VarSet plain_uses;
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      Expr expr = ell->exprs[i];
+      if (ops.count(i)) {
+        auto call = Downcast<Call>(expr);
+        expr = Tuple(Array<Expr>(call->args.begin() + 2, call->args.end()));
+      }
+      for (const auto& var : FreeVars(expr)) {
+        plain_uses.insert(var);
+      }
+    }
+    plain_uses.insert(ell->ret);
+
+    ExplicitLetList new_ell;
+    VarMap<Var> quantized;
+    int n_requantized = 0;
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      const Var& var = ell->vars[i];
+      if (!ops.count(i)) {
+        new_ell.Push(var, ell->exprs[i]);
+        continue;
+      }
+      auto call = Downcast<Call>(ell->exprs[i]);
+      const QuantizedOpInfo* info = GetQuantizedOpInfo(Downcast<Op>(call->op));
+
+      // Quantize the operands, where the weight may have one scale per output channel.
+      Array<Expr> args;
+      std::vector<float> scale{1.0f};
+      for (int j = 0; j < 2; ++j) {
+        std::vector<float> operand_scale;
+        TensorValue weight = finder.GetConstantTensor(call->args[j]);
+        if (weight.defined()) {
+          int axis = per_channel_ && j == 1 ? info->weight_axis : -1;
+          args.push_back(QuantizeWeight(weight, axis, &operand_scale));
+        } else {
+          auto x = Downcast<Var>(call->args[j]);
+          operand_scale = {ActivationScale(finder, x)};
+          if (!quantized.count(x)) {
+            static const Op& quantize_op = Op::Get("raf.op.quantize");
+            auto x_q = MakeVar(x->name_hint() + "_q", {});
+            auto axis = MakeConstant(ScalarValue::make(-1));
+            new_ell.Push(x_q, Call(quantize_op, {x, MakeScale(operand_scale), axis, int8}));
+            quantized[x] = x_q;
+          }
+          args.push_back(quantized.at(x));
+        }
+        scale = MultiplyScales(scale, operand_scale);
+      }
+      if (info->op_name == "raf.op.quantized_conv2d") {
+        args.insert(args.end(), call->args.begin() + 2, call->args.end());
+      } else {
+        args.push_back(MakeConstant(BoolValue::make(info->transpose_a)));
+        args.push_back(MakeConstant(BoolValue::make(info->transpose_b)));
+      }
+      auto acc = MakeVar(var->name_hint() + "_acc", {});
+      new_ell.Push(acc, Call(Op::Get(info->op_name), args));
+
+      // Bring the int32 accumulators back to float32, or requantize them to int8 directly.
+      auto axis = MakeConstant(ScalarValue::make(info->out_axis));
+      if (finder.activation_index.count(var) && !plain_uses.count(var)) {
+        static const Op& requantize_op = Op::Get("raf.op.requantize");
+        auto var_q = MakeVar(var->name_hint() + "_q", {});
+        std::vector<float> out_scale = {ActivationScale(finder, var)};
+        auto in_scale = MakeScale(scale);
+        new_ell.Push(var_q, Call(requantize_op, {acc, in_scale, MakeScale(out_scale), axis, int8}));
+        quantized[var] = var_q;
+        ++n_requantized;
+      } else {
+        static const Op& dequantize_op = Op::Get("raf.op.dequantize");
+        new_ell.Push(var, Call(dequantize_op, {acc, MakeScale(scale), axis, float32}));
+      }
+    }
+    new_ell.ret = ell->ret;
+    LOG(INFO) << "Quantized " << ops.size() << " ops to int8, " << n_requantized
+              << " of which are requantized without dequantization";
+    return Function(func->params, new_ell.AsExpr(), func->ret_type, func->type_params,
+                    func->attrs);
+  }
+
+ private:
+  /*! \brief The scale of the activation from its calibrated range. */
+  float ActivationScale(const CandidateFinder& finder, const Var& var) {
+    float range = ranges_[finder.activation_index.at(var)]->value;
+    return std::max(range, kMinRange) / 127.0f;
+  }
+
+  /*!
+   * \brief Quantize the weight to an int8 constant, with one scale per channel along the axis, or
+   * one scale for the whole tensor if the axis is -1.
+   */
+  Expr QuantizeWeight(const TensorValue& weight, int axis, std::vector<float>* scale) {
+    const DLTensor* w = weight;
+    std::vector<int64_t> shape(w->shape, w->shape + w->ndim);
+    int64_t size = 1, inner = 1;
+    for (int i = 0; i < w->ndim; ++i) {
+      size *= shape[i];
+      inner *= i > axis ? shape[i] : 1;
+    }
+    int64_t channels = axis == -1 ? 1 : shape[axis];
+    inner = axis == -1 ? size : inner;
+    const float* w_data = static_cast<const float*>(w->data);
+
+    std::vector<float> amax(channels, 0.0f);
+    for (int64_t i = 0; i < size; ++i) {
+      float& channel_amax = amax[i / inner % channels];
+      channel_amax = std::max(channel_amax, std::abs(w_data[i]));
+    }
+    scale->resize(channels);
+    for (int64_t c = 0; c < channels; ++c) {
+      (*scale)[c] = std::max(amax[c], kMinRange) / 127.0f;
+    }
+
+    DType dtype(DTypeCode::kInt(), 8);
+    Device dev(DevType::kCPU(), 0);
+    auto tv = TensorValue::Assemble(dev, dtype, shape);
+    tv->tensor = tvm::runtime::NDArray::Empty(shape, dtype, dev);
+    int8_t* q_data = static_cast<int8_t*>(tv->tensor->data);
+    for (int64_t i = 0; i < size; ++i) {
+      // Divide by the scale and round half to even, the same way as the quantize op.
+      float q = std::nearbyint(w_data[i] / (*scale)[i / inner % channels]);
+      q_data[i] = static_cast<int8_t>(std::min(std::max(q, -127.0f), 127.0f));
+    }
+    return MakeConstant(tv);
+  }
+
+  /*! \brief Multiply two scales, either of which may have a single element. */
+  static std::vector<float> MultiplyScales(const std::vector<float>& a,
+                                           const std::vector<float>& b) {
+    std::vector<float> c(std::max(a.size(), b.size()));
+    for (size_t i = 0; i < c.size(); ++i) {
+      c[i] = a[a.size() == 1 ? 0 : i] * b[b.size() == 1 ? 0 : i];
+    }
+    return c;
+  }
+
+  /*! \brief The calibrated ranges of the activations. */
+  Array<tvm::FloatImm> ranges_;
+  /*! \brief Whether the constant weights have one scale per output channel. */
+  bool per_channel_;
+};
+
+}  // namespace quantize
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.quantize.per_channel", Bool);
+
+Pass CollectQuantizeRanges() {
+  // Only main is calibrated, as the ranges are a flat list returned along with its outputs.
+  TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule m, PassContext pc) {
+    ir::IRModule mod = ir::IRModule(m->functions);
+    auto entry = mod->GetGlobalVar("main");
+    auto func = Downcast<Function>(mod->Lookup(entry));
+    mod->Add(entry, quantize::CollectRanges(func), true);
+    return mod;
+  };
+  Pass module_pass = CreateModulePass(pass_func, 1, "CollectQuantizeRangesHelper", {});
+  PassInfo pass_info(1, "CollectQuantizeRanges", {});
+  return RAFSequential({ToANormalForm(), InferType(), module_pass, InferType()}, pass_info);
+}
+
+Pass Quantize(Array<tvm::FloatImm> ranges) {
+  // The ranges are calibrated for main only, so the other functions stay in float32.
+  TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule m, PassContext pc) {
+    bool per_channel = pc->GetConfig("raf.quantize.per_channel", Bool(true)).value();
+    ir::IRModule mod = ir::IRModule(m->functions);
+    auto entry = mod->GetGlobalVar("main");
+    auto func = Downcast<Function>(mod->Lookup(entry));
+    mod->Add(entry, quantize::Quantizer(ranges, per_channel).Run(func), true);
+    return mod;
+  };
+  Pass module_pass = CreateModulePass(pass_func, 1, "QuantizeHelper", {});
+  PassInfo pass_info(1, "Quantize", {});
+  // Drop the float32 weights that are no longer used.
+  return RAFSequential(
+      {ToANormalForm(), InferType(), module_pass, DeadCodeElimination(), InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.CollectQuantizeRanges").set_body_typed(CollectQuantizeRanges);
+RAF_REGISTER_GLOBAL("raf.pass_.Quantize").set_body_typed(Quantize);
+
+}  // namespace pass
+}  // namespace raf
@@ -7,6 +7,7 @@
  * \file rematerialization.cc
  * \brief Perform rematerialization to reduce peak memory footrpint.
  */
+#include <mutex>
 #include <tvm/ir/type_functor.h>
 #include "raf/op.h"
 #include "raf/ir.h"
@@ -266,6 +267,446 @@ class TensorInfos {
   size_t tensor_idx_ = 0;
 };
 
+/*!
+ * \brief A solver that plans which tensors to free under the memory budget, as an alternative to
+ * the greedy selection of Rematerializer. The let-bindings of the function are linearized into
+ * lines, and the lifetime of each tensor is split into segments between two consecutive uses.
+ * Freeing a tensor in a segment saves its size from the first call after the segment begins
+ * until the segment ends, and costs recomputing the tensor (and its producers that are no longer
+ * alive) at the use that ends the segment. Picking the segments with the minimal total cost such
+ * that the memory at each call fits into the budget is a covering problem, which is solved by a
+ * depth-first branch-and-bound that branches on the first call over the budget. The search is
+ * seeded with the greedy plan and bounded by the fractional knapsack relaxation of that call.
+ * When the number of search nodes exceeds the limit, the best plan found so far is used.
+ */
+class RematSolver {
+ public:
+  using TensorInfoPtr = std::shared_ptr<TensorInfo>;
+  using Plan = StdMap<std::vector<TensorInfoPtr>>;
+
+  RematSolver(const Function& func, TensorInfos* tensor_infos, int64_t budget, int64_t max_nodes)
+      : tensor_infos_(tensor_infos), budget_(budget), max_nodes_(max_nodes) {
+    auto ell = ExplicitLetList::make(func);
+    vars_ = ell->vars;
+    exprs_ = ell->exprs;
+    ret_ = ell->ret;
+    for (const auto& var : func->params) {
+      for (auto tensor_info : tensor_infos_->GetTensorInfoFromLetVar(var)) {
+        param_size_ += tensor_info->size;
+      }
+    }
+  }
+
+  /*! \brief Solve the plan, which maps a let var to the tensors to be freed at its call. */
+  Plan Run() {
+    AnalyzeLines();
+    BuildSegments();
+    cover_.resize(vars_.size());
+    state_.assign(segments_.size(), kFree);
+
+    greedy_cost_ = best_cost_ = Greedy(&best_);
+    Search(0, 0);
+    if (best_cost_ == kInfeasible) {
+      LOG(WARNING) << "Rematerialization solver cannot find a plan to meet the memory budget ("
+                   << budget_ / kMegaBytes << " MBs)";
+      return {};
+    }
+
+    Plan plan;
+    for (int s : best_) {
+      plan[vars_[segments_[s].begin]].push_back(segments_[s].tensor_info);
+    }
+    return plan;
+  }
+
+  /*! \brief The predicted recompute cost of the greedy plan on the same model. */
+  double GetGreedyCost() const {
+    return greedy_cost_;
+  }
+
+  /*! \brief The predicted recompute cost of the solved plan. */
+  double GetCost() const {
+    return best_cost_;
+  }
+
+  /*! \brief Whether the search completed, so the solved plan is optimal under the model. */
+  bool IsOptimal() const {
+    return num_nodes_ < max_nodes_;
+  }
+
+  /*! \brief The number of explored search nodes. */
+  int64_t GetNumNodes() const {
+    return num_nodes_;
+  }
+
+ private:
+  /*! \brief Freeing a tensor from the call at line begin until its use at line end. */
+  struct Segment {
+    TensorInfoPtr tensor_info;
+    /*! \brief The first line where the tensor is freed. */
+    int begin;
+    /*! \brief The line of the use that recomputes the tensor. */
+    int end;
+    /*! \brief The latency (or GFLOPS) of the recomputed ops. */
+    double cost = 0;
+    /*! \brief The memory of the recomputed producers and workspace at the end line. */
+    int64_t extra = 0;
+    /*! \brief The tensors that have to be alive at the end line to recompute this tensor. */
+    std::vector<TensorInfoPtr> live_args;
+    /*! \brief The segments freeing one of live_args at the end line. */
+    std::vector<int> conflicts;
+  };
+
+  enum SegmentState { kFree, kSelected, kForbidden };
+
+  static constexpr double kInfeasible = std::numeric_limits<double>::infinity();
+
+  /*! \brief Find the lines defining and using each tensor, and the memory trace without
+   * rematerialization. */
+  void AnalyzeLines() {
+    int n = vars_.size();
+    next_call_.assign(n + 1, n);
+    for (int i = n - 1; i >= 0; --i) {
+      next_call_[i] = exprs_[i].as<CallNode>() ? i : next_call_[i + 1];
+    }
+
+    auto add_use = [this](const Var& var, int line, bool pinned) {
+      for (auto tensor_info : tensor_infos_->GetTensorInfoFromLetVar(var)) {
+        if (tensor_info->is_param) {
+          continue;
+        }
+        auto& uses = uses_[tensor_info];
+        if (!uses.empty() && uses.back().first == line) {
+          uses.back().second |= pinned;
+        } else {
+          uses.emplace_back(line, pinned);
+        }
+        last_[tensor_info] = std::max(last_[tensor_info], line);
+      }
+    };
+
+    std::vector<int64_t> delta(n + 1, 0);
+    for (int i = 0; i < n; ++i) {
+      const auto* extended_var = static_cast<const ExtendedVarNode*>(vars_[i].operator->());
+      for (auto tensor_info : tensor_infos_->GetTensorInfoFromLetVar(vars_[i])) {
+        if (tensor_info->let_var.same_as(vars_[i]) && def_.count(tensor_info) == 0) {
+          def_[tensor_info] = last_[tensor_info] = i;
+          if (!extended_var->may_share.defined()) {
+            allocated_.push_back(tensor_info);
+            delta[i] += tensor_info->workspace_size;
+            delta[i + 1] -= tensor_info->workspace_size;
+          }
+        }
+      }
+      // Only call arguments can be rematerialized. The other references pin the tensor.
+      if (auto call = exprs_[i].as<CallNode>()) {
+        for (const auto& arg : call->args) {
+          if (auto var = arg.as<VarNode>()) {
+            add_use(GetRef<Var>(var), i, false);
+          }
+        }
+        if (auto var = call->op.as<VarNode>()) {
+          add_use(GetRef<Var>(var), i, true);
+        }
+      } else {
+        for (const auto& var : FreeVars(exprs_[i])) {
+          add_use(var, i, true);
+        }
+      }
+    }
+    // The outputs are alive until the end.
+    add_use(ret_, n, true);
+
+    // A tensor sharing the storage with others is freed after all of them are dead.
+    for (auto tensor_info : allocated_) {
+      for (const auto& share_var : tensor_info->share_storage) {
+        auto share_info = tensor_infos_->GetTensorInfoFromLivenessVar(share_var);
+        if (last_.count(share_info)) {
+          last_[tensor_info] = std::max(last_[tensor_info], last_[share_info]);
+        }
+      }
+    }
+    for (auto tensor_info : allocated_) {
+      delta[def_[tensor_info]] += tensor_info->size;
+      delta[std::min(last_[tensor_info] + 1, n)] -= tensor_info->size;
+    }
+
+    mem_.resize(n);
+    int64_t curr = param_size_;
+    for (int i = 0; i < n; ++i) {
+      curr += delta[i];
+      mem_[i] = curr;
+    }
+  }
+
+  /*! \brief Whether the tensor is alive at the given line without rematerialization. */
+  bool IsAlive(const TensorInfoPtr& tensor_info, int line) {
+    if (tensor_info->is_param) {
+      return true;
+    }
+    auto it = def_.find(tensor_info);
+    return it != def_.end() && it->second <= line && line <= last_[tensor_info];
+  }
+
+  /*! \brief Accumulate the cost of recomputing the tensor at the given line into the segment,
+   * including its producers that are no longer alive. Return false if it cannot be recomputed. */
+  bool AddRecompute(const TensorInfoPtr& tensor_info, int line, size_t depth, Segment* seg) {
+    if (depth == MAX_REMAT_DEPTH || def_.count(tensor_info) == 0 ||
+        !tensor_info->share_storage.empty() || tensor_info->tuple_field_idx != -1 ||
+        tensor_info->compute_cost < 0 ||
+        tensor_info->compute_cost == std::numeric_limits<float>::max()) {
+      return false;
+    }
+    auto call = exprs_[def_[tensor_info]].as<CallNode>();
+    if (call == nullptr || call->op.as<VarNode>()) {
+      return false;
+    }
+    seg->cost += tensor_info->compute_cost;
+    seg->extra += tensor_info->workspace_size;
+    for (const auto& arg : call->args) {
+      auto var = arg.as<VarNode>();
+      if (var == nullptr) {
+        continue;
+      }
+      auto arg_infos = tensor_infos_->GetTensorInfoFromLetVar(GetRef<Var>(var));
+      size_t n_alive = 0;
+      for (auto arg_info : arg_infos) {
+        n_alive += IsAlive(arg_info, line) ? 1 : 0;
+      }
+      if (n_alive == arg_infos.size()) {
+        for (auto arg_info : arg_infos) {
+          if (!arg_info->is_param) {
+            seg->live_args.push_back(arg_info);
+          }
+        }
+      } else if (n_alive > 0 || arg_infos.size() > 1 ||
+                 !AddRecompute(arg_infos[0], line, depth + 1, seg)) {
+        return false;
+      } else {
+        seg->extra += arg_infos[0]->size;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Enumerate the segments of the tensors that can be rematerialized. */
+  void BuildSegments() {
+    std::unordered_map<TensorInfoPtr, std::vector<int>> tensor_segments;
+    for (auto tensor_info : allocated_) {
+      // Same as the greedy selection, skip parameters, in-place updates and small tensors.
+      if (!tensor_info->share_storage.empty() || tensor_info->size < kMegaBytes) {
+        continue;
+      }
+      int prev = def_[tensor_info];
+      for (const auto& use : uses_[tensor_info]) {
+        int begin = next_call_[prev + 1];
+        if (!use.second && begin < use.first) {
+          Segment seg;
+          seg.tensor_info = tensor_info;
+          seg.begin = begin;
+          seg.end = use.first;
+          if (AddRecompute(tensor_info, use.first, 1, &seg)) {
+            tensor_segments[tensor_info].push_back(segments_.size());
+            segments_.push_back(std::move(seg));
+          }
+        }
+        prev = use.first;
+      }
+    }
+
+    // The tensors required to recompute a segment cannot be freed at the same time.
+    for (int s = 0; s < segments_.size(); ++s) {
+      for (auto arg_info : segments_[s].live_args) {
+        auto it = tensor_segments.find(arg_info);
+        if (it == tensor_segments.end()) {
+          continue;
+        }
+        for (int t : it->second) {
+          if (segments_[t].begin <= segments_[s].end && segments_[s].end < segments_[t].end) {
+            segments_[s].conflicts.push_back(t);
+            segments_[t].conflicts.push_back(s);
+          }
+        }
+      }
+    }
+  }
+
+  /*! \brief Get the segments saving memory at the given line, cheapest per byte first. */
+  const std::vector<int>& Cover(int line) {
+    auto& cover = cover_[line];
+    if (cover.empty()) {
+      for (int s = 0; s < segments_.size(); ++s) {
+        if (segments_[s].begin <= line && line < segments_[s].end) {
+          cover.push_back(s);
+        }
+      }
+      std::sort(cover.begin(), cover.end(), [this](int a, int b) {
+        const auto& lhs = segments_[a];
+        const auto& rhs = segments_[b];
+        double lhs_ratio = lhs.cost / lhs.tensor_info->size;
+        double rhs_ratio = rhs.cost / rhs.tensor_info->size;
+        return lhs_ratio == rhs_ratio ? lhs.tensor_info->size > rhs.tensor_info->size
+                                      : lhs_ratio < rhs_ratio;
+      });
+    }
+    return cover;
+  }
+
+  /*! \brief Find the first call at or after the given line that exceeds the budget. */
+  int FirstOverBudget(int from) {
+    int n = vars_.size();
+    for (int i = next_call_[from]; i < n; i = next_call_[i + 1]) {
+      if (mem_[i] > budget_) {
+        return i;
+      }
+    }
+    return n;
+  }
+
+  /*! \brief Select a segment and return the segments forbidden by it. */
+  std::vector<int> Select(int s) {
+    const auto& seg = segments_[s];
+    state_[s] = kSelected;
+    selected_.push_back(s);
+    for (int i = seg.begin; i < seg.end; ++i) {
+      mem_[i] -= seg.tensor_info->size;
+    }
+    mem_[seg.end] += seg.extra;
+    std::vector<int> forbidden;
+    for (int t : seg.conflicts) {
+      if (state_[t] == kFree) {
+        state_[t] = kForbidden;
+        forbidden.push_back(t);
+      }
+    }
+    return forbidden;
+  }
+
+  /*! \brief Revert Select. */
+  void Unselect(int s, const std::vector<int>& forbidden) {
+    const auto& seg = segments_[s];
+    for (int t : forbidden) {
+      state_[t] = kFree;
+    }
+    for (int i = seg.begin; i < seg.end; ++i) {
+      mem_[i] += seg.tensor_info->size;
+    }
+    mem_[seg.end] -= seg.extra;
+    selected_.pop_back();
+    state_[s] = kFree;
+  }
+
+  /*! \brief The minimal cost to fit the given line into the budget by fractionally selecting the
+   * free segments. Return kInfeasible if even selecting all of them is not enough. */
+  double LowerBound(int line) {
+    int64_t deficit = mem_[line] - budget_;
+    double bound = 0;
+    for (int s : Cover(line)) {
+      if (state_[s] != kFree) {
+        continue;
+      }
+      const auto& seg = segments_[s];
+      if (seg.tensor_info->size >= deficit) {
+        return bound + seg.cost * deficit / seg.tensor_info->size;
+      }
+      bound += seg.cost;
+      deficit -= seg.tensor_info->size;
+    }
+    return kInfeasible;
+  }
+
+  /*! \brief Greedily select the cheapest segment per byte at each call over the budget. */
+  double Greedy(std::vector<int>* plan) {
+    std::vector<std::pair<int, std::vector<int>>> trail;
+    double cost = 0;
+    int n = vars_.size();
+    for (int i = FirstOverBudget(0); i < n; i = FirstOverBudget(i)) {
+      auto it = std::find_if(Cover(i).begin(), Cover(i).end(),
+                             [this](int s) { return state_[s] == kFree; });
+      if (it == Cover(i).end()) {
+        cost = kInfeasible;
+        break;
+      }
+      cost += segments_[*it].cost;
+      trail.emplace_back(*it, Select(*it));
+    }
+    if (cost != kInfeasible) {
+      *plan = selected_;
+    }
+    for (auto it = trail.rbegin(); it != trail.rend(); ++it) {
+      Unselect(it->first, it->second);
+    }
+    return cost;
+  }
+
+  /*! \brief Depth-first branch-and-bound. Each branch selects one of the free segments covering
+   * the first call over the budget, and forbids the ones tried in the previous branches. */
+  void Search(int from, double cost) {
+    if (num_nodes_++ >= max_nodes_) {
+      return;
+    }
+    int line = FirstOverBudget(from);
+    if (line == vars_.size()) {
+      if (cost < best_cost_) {
+        best_cost_ = cost;
+        best_ = selected_;
+      }
+      return;
+    }
+    std::vector<int> tried;
+    for (int s : Cover(line)) {
+      if (cost + LowerBound(line) >= best_cost_ * (1 - 1e-6) || num_nodes_ >= max_nodes_) {
+        break;
+      }
+      if (state_[s] != kFree) {
+        continue;
+      }
+      auto forbidden = Select(s);
+      Search(line, cost + segments_[s].cost);
+      Unselect(s, forbidden);
+      state_[s] = kForbidden;
+      tried.push_back(s);
+    }
+    for (int s : tried) {
+      state_[s] = kFree;
+    }
+  }
+
+  /*! \brief The tensor infos, which should not be updated before solving. */
+  TensorInfos* tensor_infos_;
+  /*! \brief The memory budget in bytes. */
+  int64_t budget_;
+  /*! \brief The maximum number of search nodes. */
+  int64_t max_nodes_;
+  /*! \brief The let-bindings and the output of the function. */
+  std::vector<Var> vars_;
+  std::vector<Expr> exprs_;
+  Var ret_;
+  /*! \brief The total size of parameters. */
+  int64_t param_size_ = 0;
+  /*! \brief The first call at or after each line. */
+  std::vector<int> next_call_;
+  /*! \brief The defining line and the last line where each tensor is alive. */
+  std::unordered_map<TensorInfoPtr, int> def_, last_;
+  /*! \brief The uses of each tensor, and whether the use cannot rematerialize the tensor. */
+  std::unordered_map<TensorInfoPtr, std::vector<std::pair<int, bool>>> uses_;
+  /*! \brief The tensors allocating memory, in the order of their definitions. */
+  std::vector<TensorInfoPtr> allocated_;
+  /*! \brief The memory trace under the current selection. */
+  std::vector<int64_t> mem_;
+  /*! \brief The candidate segments and their states. */
+  std::vector<Segment> segments_;
+  std::vector<SegmentState> state_;
+  /*! \brief The segments covering each line, computed on demand. */
+  std::vector<std::vector<int>> cover_;
+  /*! \brief The currently selected segments, and the best plan found so far. */
+  std::vector<int> selected_, best_;
+  double best_cost_ = kInfeasible;
+  double greedy_cost_ = kInfeasible;
+  /*! \brief The number of explored search nodes. */
+  int64_t num_nodes_ = 0;
+};
+
 /*!
  * \brief Perform rematerialization algorithm to reduce the peak memory footprint. The algorithm
  * is briefly described as follows:
@@ -286,6 +727,8 @@ class TensorInfos {
  *    3.5. Repeat 3.3 - 3.4 until the total memory consumption is lower than the budget. If the
  *         memory still exceeds the budget but no more tensors can be marked as dead, then error out
  *         to let users adjust the budget.
+ *    When a solver is enabled, the tensors planned by RematSolver are marked as dead before 3.3,
+ *    so the greedy selection only handles the budget violations that the plan does not resolve.
  * Assumptions:
  * 1. Memory plan will be applied later to insert "free" properly to reflect the rematerialization.
  *    If memory plan is not applied, then rematerialization simply brings latency overheads.
@@ -296,11 +739,12 @@ class Rematerializer : public ExprMutator {
  public:
   explicit Rematerializer(liveness_analysis::LivenessAnalyzer* analyzer, const Device& device,
                           const Function& func, const IRModule& mod, const int64_t budget,
-                          op_profiler::OpProfiler* profiler)
+                          op_profiler::OpProfiler* profiler, int64_t solver_max_nodes = 0)
       : analyzer_(analyzer),
         func_(func),
         budget_(budget),
         profiler_(profiler),
+        solver_max_nodes_(solver_max_nodes),
         tensor_infos_(AnalyzeTensors(device, func, mod, analyzer, profiler)) {
     scopes_.emplace_back(new LetList);
     VERBOSE_LOG << "Tensor infos:\n" << tensor_infos_.DebugDump();
@@ -335,6 +779,16 @@ class Rematerializer : public ExprMutator {
         curr_mem_trace_ += tensor_info->size;
       }
     }
+    if (solver_max_nodes_ > 0) {
+      RematSolver solver(func_, &tensor_infos_, budget_, solver_max_nodes_);
+      plan_ = solver.Run();
+      solver_cost_ = solver.GetCost();
+      solver_greedy_cost_ = solver.GetGreedyCost();
+      solver_optimal_ = solver.IsOptimal();
+      VERBOSE_LOG << "Rematerialization solver explored " << solver.GetNumNodes()
+                  << " nodes. Predicted cost: " << solver_cost_ << " (greedy "
+                  << solver_greedy_cost_ << ")";
+    }
     auto ret = this->Mutate(func_);
     std::stringstream ss;
     ss << "Estimated peak memory after rematerialization is " << peak_memory_ / kMegaBytes
@@ -347,6 +801,27 @@ class Rematerializer : public ExprMutator {
     return ret;
   }
 
+  /*! \brief The number of recomputed ops after Run. */
+  int64_t GetNumRecomputeOps() const {
+    return n_recompute_ops_;
+  }
+
+  /*! \brief The total compute cost of the recomputed ops after Run, in the unit of
+   * TensorInfo::compute_cost. */
+  double GetRecomputeCost() const {
+    return total_compute_cost_;
+  }
+
+  /*! \brief The predicted costs of the solved plan and the greedy plan by the solver. */
+  std::pair<double, double> GetSolverCosts() const {
+    return {solver_cost_, solver_greedy_cost_};
+  }
+
+  /*! \brief Whether the solver proved the plan to be optimal. */
+  bool IsSolverOptimal() const {
+    return solver_optimal_;
+  }
+
   Expr VisitExpr_(const LetNode* node) {
     scopes_.emplace_back(new LetList);
     auto scope = scopes_.back().get();
@@ -409,7 +884,10 @@ class Rematerializer : public ExprMutator {
 
   Expr VisitExpr_(const CallNode* node) {
     auto scope = scopes_.back().get();
-    auto live_in_vars = analyzer_->GetLiveVars(curr_let_);
+    // The tensors that become live since the last visited call. The others that are live in at
+    // this line are in curr_live_in_vars_ already, unless they have been marked as dead.
+    auto live_in_vars = analyzer_->GetLiveVarsSince(last_pos_, curr_let_);
+    last_pos_ = std::max(last_pos_, analyzer_->GetLinePosition(curr_let_));
 
     // Release end of life tensors. Note that input parameters cannot be released.
     if (!curr_live_in_vars_.empty()) {
@@ -419,7 +897,7 @@ class Rematerializer : public ExprMutator {
         // Liveness analysis is unaware of our rematerialization decision before we actually
         // rematerialize the tensor. The use_count is maintained by this pass. A tensor
         // actually reaches its end of life only when its use count decreases to 0.
-        if ((!tensor_info->is_param) && (live_in_vars.find(liveness_var) == live_in_vars.end()) &&
+        if ((!tensor_info->is_param) && (!analyzer_->IsLiveAt(liveness_var, curr_let_)) &&
             (tensor_info->GetUseCount() <= 0) && (!tensor_info->IsDead())) {
           tensor_infos_.MarkAsDead(tensor_info);
           vars_to_remove.insert(liveness_var);
@@ -471,6 +949,24 @@ class Rematerializer : public ExprMutator {
     }
     VERBOSE_LOG << "|-CurrMem: " << curr_mem_trace_ / kMegaBytes << " MBs";
 
+    // Free the tensors planned by the solver. The rest of the budget violation, if any, is
+    // resolved by the greedy selection below.
+    auto plan_it = plan_.find(curr_let_);
+    if (plan_it != plan_.end()) {
+      for (auto tensor_info : plan_it->second) {
+        if (tensor_info->IsDead() || tensor_info->let_var == curr_let_ ||
+            std::find(new_args.begin(), new_args.end(), tensor_info->let_var) != new_args.end() ||
+            newly_remat_tensors_.find(tensor_info->let_var) != newly_remat_tensors_.end()) {
+          continue;
+        }
+        tensor_infos_.MarkAsDead(tensor_info);
+        curr_mem_trace_ -= tensor_info->size;
+        curr_live_in_vars_.erase(tensor_info->liveness_var);
+        VERBOSE_LOG << "|-Planned free: " << tensor_info->liveness_var->name_hint() << " for "
+                    << tensor_info->size / kMegaBytes << " MBs";
+      }
+    }
+
     // Need to kill other tensors to fit the given budget.
     if (curr_mem_trace_ > budget_) {
       // Find candidates to be rematerialized from the live tensors.
@@ -716,6 +1212,7 @@ class Rematerializer : public ExprMutator {
 
     // Record for final report.
     n_recompute_ops_++;
+    total_compute_cost_ += tensor_infos[0]->compute_cost;
     if (profiler_) {
       auto exec_time_and_ws_size = profiler_->ProfileOp(remat_call);
       // Default is to repeat once, so we take the first element
@@ -832,6 +1329,8 @@ class Rematerializer : public ExprMutator {
   Var curr_let_;
   /*! \brief The current live-in set. */
   VSet curr_live_in_vars_;
+  /*! \brief The position of the last visited call in the liveness analyzer. */
+  int last_pos_ = -1;
   /*! \brief The analyzed tensor infos. */
   TensorInfos tensor_infos_;
   /*! \brief The mapping from let bound var to its expr. */
@@ -850,8 +1349,19 @@ class Rematerializer : public ExprMutator {
   int64_t n_recompute_ops_ = 0;
   /*! \brief The total recompute cost. */
   float total_recompute_cost_ = 0;
+  /*! \brief The total compute cost of the recomputed ops. */
+  double total_compute_cost_ = 0;
   /*! \brief A set of rematerialized tensors before each call. */
   VSet newly_remat_tensors_;
+  /*! \brief The maximum number of search nodes of the solver. 0 means using the greedy plan. */
+  int64_t solver_max_nodes_;
+  /*! \brief The tensors to be freed at each let var planned by the solver. */
+  RematSolver::Plan plan_;
+  /*! \brief The predicted costs of the solved plan and the greedy plan. */
+  double solver_cost_ = 0;
+  double solver_greedy_cost_ = 0;
+  /*! \brief Whether the solver proved the plan to be optimal. */
+  bool solver_optimal_ = false;
 };
 
 /*!
@@ -994,10 +1504,35 @@ TensorInfos Rematerializer::AnalyzeTensors(const Device& device, const Function&
   return TensorAnalyzer(device, func, mod, analyzer, profiler).Run();
 }
 
+/*! \brief The comparison of the greedy and the solved plans of the last rematerialized function. */
+class RematReport {
+ public:
+  static RematReport* Get() {
+    static RematReport inst;
+    return &inst;
+  }
+
+  void Set(Map<String, FloatImm> report) {
+    std::lock_guard<std::mutex> lock(mu_);
+    report_ = report;
+  }
+
+  Map<String, FloatImm> Get() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return report_;
+  }
+
+ private:
+  mutable std::mutex mu_;
+  Map<String, FloatImm> report_;
+};
+
 }  // namespace rematerialization
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_budget", IntImm);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.use_gflops_cost", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.solver", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.solver.max_nodes", Integer);
 
 Pass Rematerialization() {
   PassContext pass_ctx = PassContext::Current();
@@ -1005,6 +1540,13 @@ Pass Rematerialization() {
       pass_ctx->GetConfig("raf.memory_budget", Integer(static_cast<int>(0))).value();
   // Turn profiler on by default. With caching it is pretty fast now.
   bool use_profiler = !(pass_ctx->GetConfig("raf.remat.use_gflops_cost", Bool(false)).value());
+  // "greedy" uses the greedy plan; "optimal" also solves the plan with branch-and-bound and uses
+  // the cheaper one.
+  String solver = pass_ctx->GetConfig("raf.remat.solver", String("greedy")).value();
+  CHECK(solver == "greedy" || solver == "optimal") << "Unknown rematerialization solver " << solver;
+  Integer max_nodes =
+      pass_ctx->GetConfig("raf.remat.solver.max_nodes", Integer(static_cast<int>(100000))).value();
+  CHECK_GT(max_nodes->value, 0) << "raf.remat.solver.max_nodes must be positive";
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
     // We use budget 0 to diable this pass because it is guaranteed to fail.
@@ -1035,8 +1577,76 @@ Pass Rematerialization() {
     } else {
       LOG(INFO) << "Using GFLOPS-based cost estimation. ";
     }
-    return Downcast<Function>(
-        rematerialization::Rematerializer(&analyzer, device, f, m, memory_budget, profiler).Run());
+    if (solver == "greedy") {
+      return Downcast<Function>(
+          rematerialization::Rematerializer(&analyzer, device, f, m, memory_budget, profiler)
+              .Run());
+    }
+
+    // Apply both plans and keep the cheaper one. A plan fails if it cannot meet the budget.
+    auto apply = [&](int64_t solver_max_nodes, double* cost, int64_t* n_ops,
+                     std::pair<double, double>* solver_costs, bool* optimal) -> Function {
+      try {
+        rematerialization::Rematerializer remat(&analyzer, device, f, m, memory_budget, profiler,
+                                                solver_max_nodes);
+        auto ret = Downcast<Function>(remat.Run());
+        *cost = remat.GetRecomputeCost();
+        *n_ops = remat.GetNumRecomputeOps();
+        *solver_costs = remat.GetSolverCosts();
+        *optimal = remat.IsSolverOptimal();
+        return ret;
+      } catch (const dmlc::Error& e) {
+        VERBOSE_LOG << "Failed to apply the " << (solver_max_nodes > 0 ? "solved" : "greedy")
+                    << " plan: " << e.what();
+        *cost = -1;
+        *n_ops = -1;
+        return Function();
+      }
+    };
+    double greedy_cost, solver_cost;
+    int64_t greedy_ops, solver_ops;
+    std::pair<double, double> predicted_costs;
+    bool optimal = false;
+    Function greedy_func = apply(0, &greedy_cost, &greedy_ops, &predicted_costs, &optimal);
+    Function solver_func =
+        apply(max_nodes->value, &solver_cost, &solver_ops, &predicted_costs, &optimal);
+    CHECK(greedy_func.defined() || solver_func.defined())
+        << "Cannot rematerialize tensors to meet the memory budget requirement ("
+        << memory_budget->value / rematerialization::kMegaBytes
+        << " MBs). Please try a higher memory budget";
+    bool use_solver =
+        !greedy_func.defined() || (solver_func.defined() && solver_cost < greedy_cost);
+
+    // Report the costs in ms with the profiler, or in GFLOPS otherwise.
+    double unit = use_profiler ? 1000.0 : 1.0;
+    std::string unit_name = use_profiler ? " ms" : " GFLOPS";
+    auto show = [&](double cost, int64_t n_ops) {
+      std::ostringstream os;
+      if (n_ops < 0) {
+        os << "failed";
+      } else {
+        os << n_ops << " ops, " << cost / unit << unit_name;
+      }
+      return os.str();
+    };
+    LOG(INFO) << "Rematerialization overhead of the greedy plan: " << show(greedy_cost, greedy_ops)
+              << "; the solved plan: " << show(solver_cost, solver_ops) << " (predicted "
+              << predicted_costs.first / unit << " vs. " << predicted_costs.second / unit
+              << " by greedy, " << (optimal ? "optimal" : "search limit reached")
+              << "). Use the " << (use_solver ? "solved" : "greedy") << " plan";
+
+    auto to_float = [](double value) { return FloatImm(DataType::Float(64), value); };
+    rematerialization::RematReport::Get()->Set({
+        {"greedy_cost", to_float(greedy_cost)},
+        {"greedy_ops", to_float(greedy_ops)},
+        {"solver_cost", to_float(solver_cost)},
+        {"solver_ops", to_float(solver_ops)},
+        {"predicted_solver_cost", to_float(predicted_costs.first)},
+        {"predicted_greedy_cost", to_float(predicted_costs.second)},
+        {"solver_optimal", to_float(optimal)},
+        {"use_solver", to_float(use_solver)},
+    });
+    return use_solver ? solver_func : greedy_func;
   };
 
   Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "RematerializationHelper", {});
@@ -1046,5 +1656,9 @@ Pass Rematerialization() {
 
 RAF_REGISTER_GLOBAL("raf.pass_.Rematerialization").set_body_typed(Rematerialization);
 
+RAF_REGISTER_GLOBAL("raf.pass_.GetRematerializationReport").set_body_typed([]() {
+  return rematerialization::RematReport::Get()->Get();
+});
+
 }  // namespace pass
 }  // namespace raf
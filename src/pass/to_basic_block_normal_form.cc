@@ -50,7 +50,7 @@ Pass ToBasicBlockNormalForm() {
         << ir::AsText(ret) << "should not has free vars: " << FreeVars(ret);
     return Downcast<Function>(ret);
   };
-  return CreateRAFFunctionPass(pass_func, 1, "ToBasicBlockNormalForm", {});
+  return CreateRAFFunctionPass(pass_func, 1, "ToBasicBlockNormalForm", {}, true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.ToBasicBlockNormalForm").set_body_typed(ToBasicBlockNormalForm);
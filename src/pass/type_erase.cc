@@ -40,7 +40,7 @@ Pass EraseType() {
                                                                              PassContext pc) {
     return Downcast<Function>(type_erase::TypeEraser().Mutate(f));
   };
-  return CreateRAFFunctionPass(pass_func, 1, "EraseType", {});
+  return CreateRAFFunctionPass(pass_func, 1, "EraseType", {}, true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.EraseType").set_body_typed([]() { return EraseType(); });
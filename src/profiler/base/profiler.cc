@@ -7,6 +7,7 @@
  * \file src/profiler/base/profiler.cc
  * \brief RAF profiler, a simple implementation
  */
+#include <algorithm>
 #include "raf/registry.h"
 #include "raf/profiler.h"
 
@@ -17,6 +18,7 @@ Profiler::Profiler() {
 }
 
 Profiler::~Profiler() {
+  DisableSampling();
 }
 
 Profiler* Profiler::Get() {
@@ -31,7 +33,156 @@ void Profiler::AddNewProfileStat(std::string categories, std::string name, uint6
   profile_stats_.opr_exec_stats_->enqueue(stat.release());
 }
 
+void Profiler::EnableSampling(int profile_level, int sampling_rate, size_t buffer_size) {
+  CHECK_GT(sampling_rate, 0) << "The sampling rate must be positive";
+  CHECK_GT(buffer_size, 0) << "The buffer size must be positive";
+  {
+    std::lock_guard<std::mutex> lock(buffer_mu_);
+    if (buffer_size != buffer_size_) {
+      // The threads take new buffers of the new size, and release the old ones, which are then
+      // removed once drained.
+      buffer_size_ = buffer_size;
+      buffer_generation_++;
+      free_buffers_.clear();
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(flush_mu_);
+    if (!flusher_.joinable()) {
+      stop_flusher_ = false;
+      flusher_ = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(flush_mu_);
+        while (!stop_flusher_) {
+          flusher_cv_.wait_for(lock, std::chrono::milliseconds(10));
+          lock.unlock();
+          FlushSampledEvents();
+          lock.lock();
+        }
+      });
+    }
+  }
+  sampling_rate_ = sampling_rate;
+  set_profile_level(profile_level);
+}
+
+void Profiler::DisableSampling() {
+  sampling_rate_ = 0;
+  {
+    std::lock_guard<std::mutex> lock(flush_mu_);
+    stop_flusher_ = true;
+  }
+  flusher_cv_.notify_all();
+  if (flusher_.joinable()) {
+    flusher_.join();
+  }
+  FlushSampledEvents();
+}
+
+void Profiler::FlushSampledEvents() {
+  // The ring buffers only have one consumer at a time.
+  std::lock_guard<std::mutex> drain_lock(drain_mu_);
+  std::vector<std::shared_ptr<EventRingBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(buffer_mu_);
+    buffers = buffers_;
+  }
+  if (buffers.empty()) {
+    return;
+  }
+  // The buffers released before draining receive no more events, so they are empty afterwards.
+  std::vector<std::shared_ptr<EventRingBuffer>> released;
+  for (const auto& buffer : buffers) {
+    if (buffer->released()) {
+      released.push_back(buffer);
+    }
+  }
+  uint64_t dropped = 0;
+  {
+    std::lock_guard<std::mutex> name_lock(name_mu_);
+    for (const auto& buffer : buffers) {
+      buffer->Drain([this](const SampledEvent& event) {
+        AddNewProfileStat(names_[event.category_id], names_[event.name_id], event.start_time,
+                          event.end_time, {});
+      });
+      dropped += buffer->TakeDropped();
+    }
+  }
+  if (!released.empty()) {
+    std::lock_guard<std::mutex> lock(buffer_mu_);
+    for (const auto& buffer : released) {
+      buffers_.erase(std::find(buffers_.begin(), buffers_.end(), buffer));
+      if (buffer->capacity() == buffer_size_) {
+        free_buffers_.push_back(buffer);
+      }
+    }
+  }
+  if (dropped > 0) {
+    LOG(WARNING) << "The sampling profiler dropped " << dropped
+                 << " events because the ring buffers are full. Use a larger buffer size, a "
+                 << "larger sampling rate, or get the profile more often";
+  }
+}
+
+uint32_t Profiler::InternName(const std::string& name) {
+  // The IDs are never changed, so each thread caches them to look up without locking.
+  static thread_local std::unordered_map<std::string, uint32_t> cache;
+  auto it = cache.find(name);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  std::lock_guard<std::mutex> lock(name_mu_);
+  auto ret = name_ids_.emplace(name, static_cast<uint32_t>(names_.size()));
+  if (ret.second) {
+    names_.push_back(name);
+  }
+  cache.emplace(name, ret.first->second);
+  return ret.first->second;
+}
+
+namespace {
+
+/*! \brief The ring buffer owned by a thread, which is released when the thread exits. */
+struct ThreadBufferHolder {
+  std::shared_ptr<EventRingBuffer> buffer;
+  uint64_t generation = 0;
+
+  ~ThreadBufferHolder() {
+    if (buffer != nullptr) {
+      buffer->Release();
+    }
+  }
+};
+
+}  // namespace
+
+const std::shared_ptr<EventRingBuffer>& Profiler::ThreadBuffer() {
+  static thread_local ThreadBufferHolder holder;
+  uint64_t current = buffer_generation_.load();
+  if (holder.buffer == nullptr || holder.generation != current) {
+    if (holder.buffer != nullptr) {
+      holder.buffer->Release();
+    }
+    std::lock_guard<std::mutex> lock(buffer_mu_);
+    if (!free_buffers_.empty()) {
+      holder.buffer = std::move(free_buffers_.back());
+      free_buffers_.pop_back();
+      holder.buffer->Reuse();
+    } else {
+      holder.buffer = std::make_shared<EventRingBuffer>(buffer_size_);
+    }
+    buffers_.push_back(holder.buffer);
+    holder.generation = buffer_generation_.load();
+  }
+  return holder.buffer;
+}
+
+size_t Profiler::NumThreadBuffers() {
+  std::lock_guard<std::mutex> lock(buffer_mu_);
+  return buffers_.size();
+}
+
 std::string Profiler::GetProfile() {
+  FlushSampledEvents();
   std::lock_guard<std::recursive_mutex> lock{this->m_};
   std::stringstream ss;
   ss << "{" << std::endl;
@@ -57,6 +208,7 @@ std::string Profiler::GetProfile() {
 }
 
 std::vector<ProfileStat> Profiler::GetProfileStats() {
+  FlushSampledEvents();
   std::lock_guard<std::recursive_mutex> lock{this->m_};
   std::vector<ProfileStat> results;
 
@@ -127,7 +279,12 @@ void EnableProfiler(int profile_level) {
   Profiler::Get()->set_profile_level(profile_level);
 }
 
+void EnableSamplingProfiler(int profile_level, int sampling_rate, int buffer_size) {
+  Profiler::Get()->EnableSampling(profile_level, sampling_rate, buffer_size);
+}
+
 void DisableProfiler() {
+  Profiler::Get()->DisableSampling();
   Profiler::Get()->set_profile_level(0);
 }
 
@@ -140,6 +297,7 @@ std::string GetProfile() {
 }
 
 RAF_REGISTER_GLOBAL("raf.profiler.EnableProfiler").set_body_typed(EnableProfiler);
+RAF_REGISTER_GLOBAL("raf.profiler.EnableSamplingProfiler").set_body_typed(EnableSamplingProfiler);
 RAF_REGISTER_GLOBAL("raf.profiler.DisableProfiler").set_body_typed(DisableProfiler);
 RAF_REGISTER_GLOBAL("raf.profiler.CollectBaseProfile").set_body_typed(CollectBaseProfile);
 RAF_REGISTER_GLOBAL("raf.profiler.GetProfile").set_body_typed(GetProfile);
@@ -7,6 +7,9 @@
  * \file src/profiler/memory_profiler.cc
  * \brief Memory profiler implementation
  */
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
 #include "raf/registry.h"
 #include "raf/memory_profiler.h"
 #include "raf/memory_pool.h"
@@ -14,12 +17,57 @@
 namespace raf {
 namespace memory_profiler {
 
+namespace {
+
+/*! \brief The allocation site of the current thread. */
+thread_local const AllocationSite* current_site = nullptr;
+
+/*! \brief Escape a string in JSON. */
+std::string Quote(const std::string& str) {
+  std::ostringstream os;
+  os << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+         << std::dec;
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+  return os.str();
+}
+
+/*! \brief The label of an allocation site, e.g., "main@12:raf.op.matmul". */
+std::string SiteLabel(const AllocationSite& site) {
+  if (site.function.empty()) {
+    return site.name.empty() ? "unknown" : site.name;
+  }
+  std::ostringstream os;
+  os << site.function << "@" << site.pc << ":" << site.name;
+  return os.str();
+}
+
+}  // namespace
+
+AllocationSiteScope::AllocationSiteScope(AllocationSite site)
+    : prev_(current_site), site_(std::move(site)) {
+  current_site = &site_;
+}
+
+AllocationSiteScope::~AllocationSiteScope() {
+  current_site = prev_;
+}
+
 MemoryProfiler::~MemoryProfiler() {
 }
 
 MemoryProfiler* MemoryProfiler::Get() {
-  static MemoryProfiler prof;
-  return &prof;
+  // Never destroyed, since the memory released at exit may still record its release.
+  static MemoryProfiler* prof = new MemoryProfiler();
+  return prof;
 }
 
 void MemoryProfiler::Record(const Device& device, const std::string& tag) {
@@ -37,6 +85,197 @@ void MemoryProfiler::Record(const Device& device, const std::string& tag) {
 
 void MemoryProfiler::Reset() {
   memory_stats_.clear();
+  std::lock_guard<std::mutex> lock(events_mu_);
+  timelines_.clear();
+  generation_++;
+  start_time_ = std::chrono::steady_clock::now();
+}
+
+void MemoryProfiler::SetRecordEvents(bool record) {
+  std::lock_guard<std::mutex> lock(events_mu_);
+  if (record && !is_recording_events_.load(std::memory_order_relaxed) && timelines_.empty()) {
+    start_time_ = std::chrono::steady_clock::now();
+  }
+  is_recording_events_.store(record, std::memory_order_relaxed);
+}
+
+double MemoryProfiler::NowUs() {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time_)
+      .count();
+}
+
+std::shared_ptr<memory_pool::Memory> MemoryProfiler::RecordAlloc(
+    const Device& device, std::shared_ptr<memory_pool::Memory> mem, int64_t requested_bytes,
+    int64_t rounded_bytes) {
+  std::string device_str = device.c_str();
+  size_t id;
+  uint64_t generation;
+  bool new_peak = false;
+  {
+    std::lock_guard<std::mutex> lock(events_mu_);
+    generation = generation_;
+    auto& timeline = timelines_[device_str];
+    id = timeline.events.size();
+    timeline.events.emplace_back();
+    auto& event = timeline.events.back();
+    event.requested_bytes = requested_bytes;
+    event.rounded_bytes = rounded_bytes;
+    event.alloc_us = NowUs();
+    event.alloc_seq = timeline.next_seq++;
+    if (current_site != nullptr) {
+      event.site = *current_site;
+    }
+    timeline.live_requested_bytes += requested_bytes;
+    timeline.live_rounded_bytes += rounded_bytes;
+    if (timeline.live_rounded_bytes > timeline.peak_rounded_bytes) {
+      timeline.peak_seq = event.alloc_seq;
+      timeline.peak_requested_bytes = timeline.live_requested_bytes;
+      timeline.peak_rounded_bytes = timeline.live_rounded_bytes;
+      timeline.peak_us = event.alloc_us;
+      new_peak = true;
+    }
+  }
+  if (new_peak) {
+    // Only sample the pool at a new peak, since querying the pool size may walk the pool.
+    auto pool_size = memory_pool::Memory::GetPoolSize(device);
+    std::lock_guard<std::mutex> lock(events_mu_);
+    // Skip if the events have been reset or the peak has moved since the allocation.
+    if (generation == generation_) {
+      auto& timeline = timelines_.at(device_str);
+      if (timeline.peak_seq == timeline.events[id].alloc_seq) {
+        timeline.peak_pool_bytes = static_cast<int64_t>(pool_size.second * 1048576.0);
+      }
+    }
+  }
+  // The returned memory shares the chunk of the pool, which is released after the event.
+  auto* data = mem.get();
+  return std::shared_ptr<memory_pool::Memory>(
+      data, [this, device_str, id, generation, mem = std::move(mem)](memory_pool::Memory*) mutable {
+        RecordFree(device_str, id, generation);
+        mem.reset();
+      });
+}
+
+void MemoryProfiler::RecordFree(const std::string& device_str, size_t id, uint64_t generation) {
+  std::lock_guard<std::mutex> lock(events_mu_);
+  if (generation != generation_) {
+    // The events have been reset since the allocation.
+    return;
+  }
+  auto& timeline = timelines_.at(device_str);
+  auto& event = timeline.events[id];
+  event.free_us = NowUs();
+  event.free_seq = timeline.next_seq++;
+  timeline.live_requested_bytes -= event.requested_bytes;
+  timeline.live_rounded_bytes -= event.rounded_bytes;
+}
+
+std::string MemoryProfiler::GetAllocationReport(const Device& device) {
+  std::lock_guard<std::mutex> lock(events_mu_);
+  auto it = timelines_.find(std::string(device.c_str()));
+  if (it == timelines_.end()) {
+    return "";
+  }
+  const auto& timeline = it->second;
+  int64_t total_requested = 0;
+  int64_t total_rounded = 0;
+  std::vector<size_t> live_at_peak;
+  for (size_t i = 0; i < timeline.events.size(); ++i) {
+    const auto& event = timeline.events[i];
+    total_requested += event.requested_bytes;
+    total_rounded += event.rounded_bytes;
+    if (event.alloc_seq <= timeline.peak_seq && timeline.peak_seq < event.free_seq) {
+      live_at_peak.push_back(i);
+    }
+  }
+  std::sort(live_at_peak.begin(), live_at_peak.end(), [&](size_t a, size_t b) {
+    return timeline.events[a].rounded_bytes > timeline.events[b].rounded_bytes;
+  });
+  auto ratio = [](int64_t part, int64_t whole) {
+    return whole > 0 ? std::max(0.0, 1.0 - static_cast<double>(part) / whole) : 0.0;
+  };
+
+  std::ostringstream os;
+  os << "{\"num_allocations\": " << timeline.events.size()
+     << ", \"total_requested_bytes\": " << total_requested
+     << ", \"total_rounded_bytes\": " << total_rounded
+     << ", \"live_requested_bytes\": " << timeline.live_requested_bytes
+     << ", \"live_rounded_bytes\": " << timeline.live_rounded_bytes
+     << ", \"peak_us\": " << timeline.peak_us
+     << ", \"peak_requested_bytes\": " << timeline.peak_requested_bytes
+     << ", \"peak_rounded_bytes\": " << timeline.peak_rounded_bytes
+     << ", \"peak_pool_bytes\": " << timeline.peak_pool_bytes
+     // The bytes wasted by rounding the live allocations at the peak.
+     << ", \"internal_fragmentation\": "
+     << ratio(timeline.peak_requested_bytes, timeline.peak_rounded_bytes)
+     // The bytes of the pool that are not used by the live allocations at the peak.
+     << ", \"pool_fragmentation\": "
+     << ratio(timeline.peak_rounded_bytes, timeline.peak_pool_bytes) << ", \"live_at_peak\": [";
+  for (size_t i = 0; i < live_at_peak.size(); ++i) {
+    const auto& event = timeline.events[live_at_peak[i]];
+    os << (i ? ", " : "") << "{\"id\": " << live_at_peak[i]
+       << ", \"requested_bytes\": " << event.requested_bytes
+       << ", \"rounded_bytes\": " << event.rounded_bytes
+       << ", \"function\": " << Quote(event.site.function) << ", \"pc\": " << event.site.pc
+       << ", \"name\": " << Quote(event.site.name) << ", \"alloc_us\": " << event.alloc_us
+       << ", \"free_us\": " << event.free_us << "}";
+  }
+  os << "]}";
+  return os.str();
+}
+
+std::string MemoryProfiler::GetAllocationChromeTrace() {
+  std::lock_guard<std::mutex> lock(events_mu_);
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "{\"traceEvents\": [";
+  bool first = true;
+  auto sep = [&]() -> std::ostream& {
+    os << (first ? "\n" : ",\n");
+    first = false;
+    return os;
+  };
+  int pid = 0;
+  for (const auto& kv : timelines_) {
+    sep() << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid
+          << ", \"args\": {\"name\": " << Quote(kv.first) << "}}";
+    // Replay the events in order to emit the counters of the live bytes.
+    // The (sequence number, event index) of the allocations, and (sequence number, ~index) of
+    // the releases.
+    std::vector<std::pair<int64_t, int64_t>> deltas;
+    const auto& events = kv.second.events;
+    for (size_t i = 0; i < events.size(); ++i) {
+      const auto& event = events[i];
+      // The IDs of the async events are unique across the devices.
+      std::ostringstream head;
+      head << "{\"name\": " << Quote(SiteLabel(event.site)) << ", \"cat\": \"alloc\", \"id\": \""
+           << pid << "." << i << "\", \"pid\": " << pid << ", \"tid\": 0";
+      sep() << head.str() << ", \"ph\": \"b\", \"ts\": " << event.alloc_us
+            << ", \"args\": {\"requested_bytes\": " << event.requested_bytes
+            << ", \"rounded_bytes\": " << event.rounded_bytes << "}}";
+      if (event.free_seq != INT64_MAX) {
+        sep() << head.str() << ", \"ph\": \"e\", \"ts\": " << event.free_us << "}";
+        deltas.emplace_back(event.free_seq, ~static_cast<int64_t>(i));
+      }
+      deltas.emplace_back(event.alloc_seq, static_cast<int64_t>(i));
+    }
+    std::sort(deltas.begin(), deltas.end());
+    int64_t live_requested = 0;
+    int64_t live_rounded = 0;
+    for (const auto& delta : deltas) {
+      bool is_free = delta.second < 0;
+      const auto& event = events[is_free ? ~delta.second : delta.second];
+      live_requested += is_free ? -event.requested_bytes : event.requested_bytes;
+      live_rounded += is_free ? -event.rounded_bytes : event.rounded_bytes;
+      sep() << "{\"name\": \"live bytes\", \"ph\": \"C\", \"pid\": " << pid
+            << ", \"ts\": " << (is_free ? event.free_us : event.alloc_us)
+            << ", \"args\": {\"requested\": " << live_requested << ", \"rounded\": " << live_rounded
+            << "}}";
+    }
+    ++pid;
+  }
+  os << "\n]}";
+  return os.str();
 }
 
 Map<String, FloatImm> MemoryProfiler::GetMaxMemoryInfo(const Device& device) {
@@ -108,6 +347,18 @@ std::string GetMemoryTrace(const Device& device) {
   return MemoryProfiler::Get()->GetMemoryTrace(device);
 }
 
+void SetRecordAllocationEvents(bool record) {
+  MemoryProfiler::Get()->SetRecordEvents(record);
+}
+
+std::string GetAllocationReport(const Device& device) {
+  return MemoryProfiler::Get()->GetAllocationReport(device);
+}
+
+std::string GetAllocationChromeTrace() {
+  return MemoryProfiler::Get()->GetAllocationChromeTrace();
+}
+
 RAF_REGISTER_GLOBAL("raf.memory_profiler.EnableMemoryProfiler")
     .set_body_typed(EnableMemoryProfiler);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.DisableMemoryeProfiler")
@@ -115,6 +366,11 @@ RAF_REGISTER_GLOBAL("raf.memory_profiler.DisableMemoryeProfiler")
 RAF_REGISTER_GLOBAL("raf.memory_profiler.ResetMemoryProfiler").set_body_typed(ResetMemoryProfiler);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.GetMaxMemoryInfo").set_body_typed(GetMaxMemoryInfo);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.GetMemoryTrace").set_body_typed(GetMemoryTrace);
+RAF_REGISTER_GLOBAL("raf.memory_profiler.SetRecordAllocationEvents")
+    .set_body_typed(SetRecordAllocationEvents);
+RAF_REGISTER_GLOBAL("raf.memory_profiler.GetAllocationReport").set_body_typed(GetAllocationReport);
+RAF_REGISTER_GLOBAL("raf.memory_profiler.GetAllocationChromeTrace")
+    .set_body_typed(GetAllocationChromeTrace);
 
 }  // namespace memory_profiler
 }  // namespace raf
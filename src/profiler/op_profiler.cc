@@ -66,11 +66,8 @@ OpWithData::OpWithData(const Device device, const Expr& op, const int stream_id)
   // Allocate the workspace.
   workspace_size = 0;
   std::shared_ptr<requests::Requests> requests = op_env->GetRequests();
-  for (size_t i = 0; i < requests->workspace.size(); i++) {
-    requests::Requests::WorkspaceRequest& entry = requests->workspace[i];
-    auto buf = memory_pool::Memory::Alloc(entry.device, entry.nbytes);
-    entry.memory = buf;
-    *entry.dest = buf->data;
+  for (const auto& entry : requests->workspace) {
+    workspace.push_back(memory_pool::Memory::Alloc(entry.device, entry.nbytes));
     workspace_size += entry.nbytes;
   }
 }
@@ -81,14 +78,7 @@ OpWithData::~OpWithData() {
   }
 
   // Free the workspace.
-  std::shared_ptr<requests::Requests> requests = op_env->GetRequests();
-  for (size_t i = 0; i < requests->workspace.size(); ++i) {
-    requests::Requests::WorkspaceRequest& entry = requests->workspace[i];
-    if (entry.nbytes > 0 && entry.memory != nullptr) {
-      *entry.dest = nullptr;
-      entry.memory.reset();
-    }
-  }
+  workspace.clear();
 
   // Free the input and output buffers.
   try {
@@ -98,6 +88,15 @@ OpWithData::~OpWithData() {
   }
 }
 
+void OpWithData::Execute() {
+  std::vector<void*> workspace_data;
+  for (const auto& buf : workspace) {
+    workspace_data.push_back(buf->data);
+  }
+  op::WorkspaceBinding binding(std::move(workspace_data));
+  op_env->Execute(inputs, output);
+}
+
 OpEnvPtr OpProfiler::GetOpEnv(const Expr& op) {
   if (auto call_node = op.as<CallNode>()) {
     auto call = GetRef<Call>(call_node);
@@ -187,7 +186,7 @@ std::vector<float> CPUOpProfiler::RunOp(const OpWithDataPtr& op_with_data, int32
 
   // Warm up first
   for (int i = 0; i < warmup; i++) {
-    op_with_data->op_env->Execute(op_with_data->inputs, op_with_data->output);
+    op_with_data->Execute();
   }
 
   std::vector<float> elapsed_times;
@@ -197,7 +196,7 @@ std::vector<float> CPUOpProfiler::RunOp(const OpWithDataPtr& op_with_data, int32
     m_starttime = std::chrono::system_clock::now();
     // Set up timer and run
     for (int i = 0; i < exec_number; i++) {
-      op_with_data->op_env->Execute(op_with_data->inputs, op_with_data->output);
+      op_with_data->Execute();
     }
     m_endtime = std::chrono::system_clock::now();
     float elapsed_time =
@@ -209,27 +208,51 @@ std::vector<float> CPUOpProfiler::RunOp(const OpWithDataPtr& op_with_data, int32
 
 std::vector<float> CPUOpProfiler::RunOpGroup(const std::vector<OpWithDataPtr>& op_with_datas,
                                              int32_t warmup, int32_t exec_number, int32_t repeat) {
-  // CPU does not support multi-stream, so just run ops one-by-one.
+  std::vector<float> elapsed_times;
 
-  // Warm up
-  for (int i = 0; i < warmup; i++) {
+  // Create streams. Ops on different streams run concurrently on the stream worker threads, and
+  // ops without a stream run on the calling thread.
+  streams_[-1] = nullptr;
+  for (auto op_with_data : op_with_datas) {
+    if (streams_.count(op_with_data->stream_id) == 0) {
+      streams_[op_with_data->stream_id] = cpu_api_->CreateStream(device_);
+    }
+  }
+
+  // Only wait for the streams of this group instead of all the CPU streams in the process.
+  auto wait_streams = [&]() {
+    for (const auto& it : streams_) {
+      cpu_api_->WaitStream(it.second);
+    }
+  };
+
+  auto issue_ops = [&]() {
     for (auto op_with_data : op_with_datas) {
-      op_with_data->op_env->Execute(op_with_data->inputs, op_with_data->output);
+      if (!op_with_data->profilable()) {
+        continue;
+      }
+      cpu_api_->LaunchOnStream(streams_[op_with_data->stream_id], [op_with_data]() {
+        op_with_data->Execute();
+      });
     }
+  };
+
+  // Warm up first
+  for (int i = 0; i < warmup; i++) {
+    issue_ops();
   }
+  wait_streams();
 
   // Profiling
-  std::vector<float> elapsed_times;
   std::chrono::time_point<std::chrono::system_clock> m_starttime;
   std::chrono::time_point<std::chrono::system_clock> m_endtime;
   for (size_t r = 0; r < repeat; ++r) {
     m_starttime = std::chrono::system_clock::now();
     // Set up timer and run
     for (int i = 0; i < exec_number; i++) {
-      for (auto op_with_data : op_with_datas) {
-        op_with_data->op_env->Execute(op_with_data->inputs, op_with_data->output);
-      }
+      issue_ops();
     }
+    wait_streams();
     m_endtime = std::chrono::system_clock::now();
     float elapsed_time =
         std::chrono::duration_cast<std::chrono::microseconds>(m_endtime - m_starttime).count();
@@ -249,7 +272,7 @@ std::vector<float> CUDAOpProfiler::RunOp(const OpWithDataPtr& op_with_data, int3
 
   // Warm up first
   for (int i = 0; i < warmup; i++) {
-    op_with_data->op_env->Execute(op_with_data->inputs, op_with_data->output);
+    op_with_data->Execute();
   }
 
   // Set up timer and run
@@ -258,7 +281,7 @@ std::vector<float> CUDAOpProfiler::RunOp(const OpWithDataPtr& op_with_data, int3
     CUDA_CALL(cudaDeviceSynchronize());
     CUDA_CALL(cudaEventRecord(start_event_, nullptr));
     for (int i = 0; i < exec_number; ++i) {
-      op_with_data->op_env->Execute(op_with_data->inputs, op_with_data->output);
+      op_with_data->Execute();
     }
     CUDA_CALL(cudaEventRecord(end_event_, nullptr));
     CUDA_CALL(cudaDeviceSynchronize());
@@ -301,7 +324,7 @@ std::vector<float> CUDAOpProfiler::RunOpGroup(const std::vector<OpWithDataPtr>&
       raf::op::cublas::SetStream(curr_stream);
 
       // Issue kernel.
-      op_with_data->op_env->Execute(op_with_data->inputs, op_with_data->output);
+      op_with_data->Execute();
     }
   }
 
@@ -322,7 +345,7 @@ std::vector<float> CUDAOpProfiler::RunOpGroup(const std::vector<OpWithDataPtr>&
         raf::op::cublas::SetStream(curr_stream);
 
         // Issue kernel.
-        op_with_data->op_env->Execute(op_with_data->inputs, op_with_data->output);
+        op_with_data->Execute();
       }
     }
     CUDA_CALL(cudaEventRecord(end_event_, nullptr));
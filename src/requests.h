@@ -27,10 +27,8 @@ class Requests {
   };
 
   struct WorkspaceRequest {
-    void** dest;
     Device device;
     int64_t nbytes;
-    std::shared_ptr<memory_pool::Memory> memory;
   };
 
   struct StreamRequest {
@@ -0,0 +1,303 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <raf/cache.h>
+
+using raf::op::MetaCache;
+using raf::op::PersistStore;
+
+namespace {
+
+std::string MakeStorePath(const std::string& name) {
+  std::string path = "/tmp/raf_cpptest_cache_" + name + "_" + std::to_string(getpid());
+  std::string cmd = "rm -rf " + path;
+  EXPECT_EQ(system(cmd.c_str()), 0);
+  return path;
+}
+
+int Put(PersistStore* store, const std::string& key, const std::string& value) {
+  auto dir = store->BeginWrite();
+  std::ofstream(dir + "/value") << value;
+  return store->Commit(key, dir);
+}
+
+std::string Get(PersistStore* store, const std::string& key) {
+  auto dir = store->Lookup(key);
+  if (dir.empty()) {
+    return "";
+  }
+  std::string value;
+  std::ifstream(dir + "/value") >> value;
+  return value;
+}
+
+/*! \brief The mutex-guarded map used by MetaCache before its reads became lock-free. */
+class LockedCache {
+ public:
+  const int* Get(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto iter = cached_.find(key);
+    return iter == cached_.end() ? nullptr : &iter->second;
+  }
+
+  void Set(const std::string& key, int val) {
+    std::lock_guard<std::mutex> lock(mu_);
+    cached_.emplace(key, val);
+  }
+
+ private:
+  std::unordered_map<std::string, int> cached_;
+  std::mutex mu_;
+};
+
+/*! \brief Run lookups on all keys from the reader threads and return lookups per second. */
+template <typename Cache>
+double MeasureLookups(Cache* cache, const std::vector<std::string>& keys, int num_threads,
+                      int num_rounds) {
+  std::atomic<int64_t> num_misses{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int r = 0; r < num_rounds; ++r) {
+        for (size_t i = 0; i < keys.size(); ++i) {
+          const int* val = cache->Get(keys[(i + t) % keys.size()]);
+          if (val == nullptr || *val != static_cast<int>((i + t) % keys.size())) {
+            num_misses++;
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(num_misses.load(), 0);
+  return static_cast<double>(num_threads) * num_rounds * keys.size() / elapsed.count();
+}
+
+}  // namespace
+
+TEST(MetaCache, SetAndGet) {
+  MetaCache<int> cache;
+  std::vector<uint8_t> bytes = {'a', 'b'};
+  ASSERT_EQ(cache.Get("ab"), nullptr);
+  cache.Set(bytes, 1);
+  ASSERT_TRUE(cache.Has("ab"));
+  ASSERT_EQ(*cache.Get("ab"), 1);
+  // Byte-span lookups do not need to materialize the key.
+  const char* buf = "xaby";
+  ASSERT_EQ(*cache.Get(buf + 1, 2), 1);
+  ASSERT_EQ(cache.Get(buf, 2), nullptr);
+  // The values stay at the same address as the table grows.
+  const int* val = cache.Get("ab");
+  for (int i = 0; i < 1000; ++i) {
+    cache.Set(std::to_string(i), i);
+  }
+  ASSERT_EQ(cache.Get("ab"), val);
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(*cache.Get(std::to_string(i)), i);
+  }
+}
+
+TEST(MetaCache, EmptyKey) {
+  MetaCache<int> cache;
+  // The data of an empty key may be null.
+  ASSERT_EQ(cache.Get(nullptr, 0), nullptr);
+  cache.Set(std::vector<uint8_t>(), 1);
+  ASSERT_EQ(*cache.Get(nullptr, 0), 1);
+  ASSERT_EQ(*cache.Get(""), 1);
+}
+
+TEST(MetaCache, ConcurrentReadWrite) {
+  MetaCache<int> cache;
+  const int num_keys = 4096;
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 8; ++t) {
+    readers.emplace_back([&]() {
+      while (!done.load()) {
+        for (int i = 0; i < num_keys; i += 7) {
+          const int* val = cache.Get(std::to_string(i));
+          ASSERT_TRUE(val == nullptr || *val == i);
+        }
+      }
+    });
+  }
+  for (int i = 0; i < num_keys; ++i) {
+    cache.Set(std::to_string(i), i);
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  for (int i = 0; i < num_keys; ++i) {
+    ASSERT_EQ(*cache.Get(std::to_string(i)), i);
+  }
+}
+
+// Disabled by default because it only reports timings. Run it with
+// --gtest_also_run_disabled_tests --gtest_filter=MetaCache.DISABLED_ContendedReadBenchmark.
+TEST(MetaCache, DISABLED_ContendedReadBenchmark) {
+  const int num_threads = std::max(16U, std::thread::hardware_concurrency());
+  const int num_rounds = 200;
+  std::vector<std::string> keys;
+  MetaCache<int> cache;
+  LockedCache locked;
+  for (int i = 0; i < 1024; ++i) {
+    // Keys of the length of a typical serialized op call.
+    keys.push_back(std::string(64, 'k') + std::to_string(i));
+    cache.Set(keys.back(), i);
+    locked.Set(keys.back(), i);
+  }
+  double lock_free = MeasureLookups(&cache, keys, num_threads, num_rounds);
+  double with_lock = MeasureLookups(&locked, keys, num_threads, num_rounds);
+  std::cout << num_threads << " readers: " << lock_free << " lookups/s lock-free vs "
+            << with_lock << " lookups/s with a mutex" << std::endl;
+}
+
+TEST(PersistStore, LookupAndCommit) {
+  auto path = MakeStorePath("basic");
+  PersistStore store(path, 0);
+  ASSERT_EQ(store.Lookup("a"), "");
+  ASSERT_EQ(Put(&store, "a", "1"), 0);
+  ASSERT_EQ(Get(&store, "a"), "1");
+  // Publishing an existing key keeps the published entry.
+  ASSERT_EQ(Put(&store, "a", "2"), 0);
+  ASSERT_EQ(Get(&store, "a"), "1");
+  // A failed write leaves nothing behind.
+  store.Abort(store.BeginWrite());
+  ASSERT_EQ(store.Lookup("b"), "");
+
+  // The entries are visible after reopening the store.
+  PersistStore reopened(path, 0);
+  ASSERT_EQ(Get(&reopened, "a"), "1");
+}
+
+TEST(PersistStore, EvictLRU) {
+  auto path = MakeStorePath("lru");
+  PersistStore store(path, 2500);
+  std::string value(1000, 'x');
+  ASSERT_EQ(Put(&store, "a", value), 0);
+  ASSERT_EQ(Put(&store, "b", value), 0);
+  // Touch "a" so that "b" is the least recently used one.
+  ASSERT_NE(store.Lookup("a"), "");
+  ASSERT_EQ(Put(&store, "c", value), 1);
+  ASSERT_EQ(store.Lookup("b"), "");
+  ASSERT_NE(store.Lookup("a"), "");
+  ASSERT_NE(store.Lookup("c"), "");
+}
+
+TEST(PersistStore, MultiProcess) {
+  auto path = MakeStorePath("mp");
+  const int num_procs = 8;
+  const int num_keys = 200;
+  for (int p = 0; p < num_procs; ++p) {
+    if (fork() == 0) {
+      PersistStore store(path, 0);
+      for (int i = 0; i < num_keys * 4; ++i) {
+        auto key = std::to_string((i * 7 + p) % num_keys);
+        if (store.Lookup(key).empty()) {
+          Put(&store, key, key);
+        }
+      }
+      _exit(0);
+    }
+  }
+  int status;
+  while (wait(&status) > 0) {
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+  }
+  PersistStore store(path, 0);
+  for (int i = 0; i < num_keys; ++i) {
+    ASSERT_EQ(Get(&store, std::to_string(i)), std::to_string(i));
+  }
+}
+
+TEST(PersistStore, RemoveStaleTmpDirs) {
+  auto path = MakeStorePath("stale");
+  PersistStore store(path, 0);
+  auto live_dir = store.BeginWrite();
+  // An unlocked owner directory of a dead process and a directory left before it was locked.
+  auto dead_dir = path + "/tmp/dead";
+  auto unlocked_dir = path + "/tmp/unlocked";
+  ASSERT_EQ(mkdir(dead_dir.c_str(), 0775), 0);
+  ASSERT_EQ(mkdir(unlocked_dir.c_str(), 0775), 0);
+  std::ofstream(dead_dir + "/lock");
+  // Directories modified recently may still be taken by their owners, so they are kept.
+  PersistStore recent(path, 0);
+  ASSERT_EQ(access(dead_dir.c_str(), F_OK), 0);
+  ASSERT_EQ(access(unlocked_dir.c_str(), F_OK), 0);
+
+  struct timeval old_times[2] = {{time(nullptr) - 3600, 0}, {time(nullptr) - 3600, 0}};
+  ASSERT_EQ(utimes((dead_dir + "/lock").c_str(), old_times), 0);
+  ASSERT_EQ(utimes(unlocked_dir.c_str(), old_times), 0);
+  auto owner_dir = live_dir.substr(0, live_dir.rfind('/'));
+  ASSERT_EQ(utimes((owner_dir + "/lock").c_str(), old_times), 0);
+  PersistStore reopened(path, 0);
+  ASSERT_NE(access(dead_dir.c_str(), F_OK), 0);
+  ASSERT_NE(access(unlocked_dir.c_str(), F_OK), 0);
+  // The directory of a live store is locked, however old it is.
+  ASSERT_EQ(access(live_dir.c_str(), F_OK), 0);
+  ASSERT_EQ(Put(&store, "a", "1"), 0);
+  ASSERT_EQ(Get(&reopened, "a"), "1");
+}
+
+TEST(PersistStore, IndexOrphans) {
+  auto path = MakeStorePath("orphan");
+  std::string value(1000, 'x');
+  {
+    PersistStore store(path, 0);
+    ASSERT_EQ(Put(&store, "a", value), 0);
+    ASSERT_EQ(Put(&store, "b", value), 0);
+    ASSERT_EQ(Put(&store, "c", value), 0);
+  }
+  // Lose the index, as if the entries were published by processes that crashed before updating
+  // the index.
+  ASSERT_EQ(truncate((path + "/v1/index").c_str(), 0), 0);
+  PersistStore reopened(path, 2500);
+  int num_found = 0;
+  for (const char* key : {"a", "b", "c"}) {
+    num_found += Get(&reopened, key) == value;
+  }
+  // The entries are indexed again and count toward the capacity, so one of them is evicted.
+  ASSERT_EQ(num_found, 2);
+}
+
+TEST(PersistStore, KeepOtherVersions) {
+  auto path = MakeStorePath("versions");
+  // An entry in the namespace of another layout version.
+  auto other_entry = path + "/v0/entries/0";
+  ASSERT_EQ(system(("mkdir -p " + other_entry).c_str()), 0);
+  PersistStore store(path, 0);
+  ASSERT_EQ(Put(&store, "a", "1"), 0);
+  ASSERT_EQ(access(other_entry.c_str(), F_OK), 0);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <raf/device.h>
+#include <raf/device_api.h>
+
+using raf::Device;
+using raf::DevType;
+using raf::device_api::DeviceAPI;
+
+namespace {
+
+void Sleep(int ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+}  // namespace
+
+TEST(CPUStream, InOrder) {
+  Device dev{DevType::kCPU(), 0};
+  auto api = DeviceAPI::Get(DevType::kCPU());
+  void* stream = api->CreateStream(dev);
+  std::vector<int> order;
+  for (int i = 0; i < 100; ++i) {
+    api->LaunchOnStream(stream, [&order, i]() {
+      if (i % 10 == 0) {
+        Sleep(1);
+      }
+      order.push_back(i);
+    });
+  }
+  api->WaitStream(stream);
+  ASSERT_EQ(order.size(), 100U);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(order[i], i);
+  }
+  api->FreeStream(dev, stream);
+}
+
+TEST(CPUStream, Concurrent) {
+  Device dev{DevType::kCPU(), 0};
+  auto api = DeviceAPI::Get(DevType::kCPU());
+  const int num_streams = 4;
+  std::vector<void*> streams;
+  for (int i = 0; i < num_streams; ++i) {
+    streams.push_back(api->CreateStream(dev));
+  }
+  // Each task only finishes after all of them have started, which requires the streams to run
+  // concurrently.
+  std::atomic<int> num_started{0};
+  for (auto* stream : streams) {
+    api->LaunchOnStream(stream, [&num_started, num_streams]() {
+      num_started++;
+      while (num_started.load() < num_streams) {
+        std::this_thread::yield();
+      }
+    });
+  }
+  api->WaitDevice(dev);
+  ASSERT_EQ(num_started.load(), num_streams);
+  for (auto* stream : streams) {
+    api->FreeStream(dev, stream);
+  }
+}
+
+TEST(CPUStream, Event) {
+  Device dev{DevType::kCPU(), 0};
+  auto api = DeviceAPI::Get(DevType::kCPU());
+  void* producer = api->CreateStream(dev);
+  void* consumer = api->CreateStream(dev);
+  void* start = api->CreateEvent(dev);
+  void* ready = api->CreateEvent(dev);
+  // Waiting for an event that was never recorded does not block.
+  api->StreamWaitEvent(consumer, ready);
+  api->WaitEvent(ready);
+
+  for (int iter = 0; iter < 10; ++iter) {
+    int value = 0;
+    int observed = -1;
+    api->EventRecordOnStream(start, producer);
+    api->LaunchOnStream(producer, [&value]() {
+      Sleep(5);
+      value = 1;
+    });
+    api->EventRecordOnStream(ready, producer);
+    api->StreamWaitEvent(consumer, ready);
+    api->LaunchOnStream(consumer, [&value, &observed]() { observed = value; });
+    api->WaitStream(consumer);
+    ASSERT_EQ(observed, 1);
+    api->WaitEvent(ready);
+    ASSERT_GE(api->EventElapsedTimeInMilliSeconds(start, ready), 4.0f);
+  }
+  api->FreeEvent(dev, start);
+  api->FreeEvent(dev, ready);
+  api->FreeStream(dev, producer);
+  api->FreeStream(dev, consumer);
+}
+
+TEST(CPUStream, NullStreamBarrier) {
+  Device dev{DevType::kCPU(), 0};
+  auto api = DeviceAPI::Get(DevType::kCPU());
+  void* stream = api->CreateStream(dev);
+  void* event = api->CreateEvent(dev);
+  std::atomic<bool> done{false};
+  api->LaunchOnStream(stream, [&done]() {
+    Sleep(5);
+    done = true;
+  });
+  // An event on the null stream covers the work on all streams.
+  api->EventRecordOnStream(event, nullptr);
+  ASSERT_TRUE(done.load());
+  api->FreeEvent(dev, event);
+  api->FreeStream(dev, stream);
+}
+
+TEST(CPUStream, Error) {
+  Device dev{DevType::kCPU(), 0};
+  auto api = DeviceAPI::Get(DevType::kCPU());
+  void* stream = api->CreateStream(dev);
+  int value = 0;
+  api->LaunchOnStream(stream, []() { throw std::runtime_error("task failed"); });
+  api->LaunchOnStream(stream, [&value]() { value = 1; });
+  ASSERT_ANY_THROW(api->WaitStream(stream));
+  // The stream keeps working after a failure is reported.
+  ASSERT_EQ(value, 1);
+  api->LaunchOnStream(stream, [&value]() { value = 2; });
+  api->WaitStream(stream);
+  ASSERT_EQ(value, 2);
+  api->FreeStream(dev, stream);
+}
+
+TEST(CPUStream, ThreadPoolSize) {
+  Device dev{DevType::kCPU(), 0};
+  auto api = DeviceAPI::Get(DevType::kCPU());
+  const int num_streams = 4;
+  const int max_size = raf::device_api::CPUThreadPoolSize();
+  std::vector<void*> streams;
+  for (int i = 0; i < num_streams; ++i) {
+    streams.push_back(api->CreateStream(dev));
+  }
+  // The workers of the streams share the cores instead of each using all of them.
+  std::vector<int> sizes(num_streams, 0);
+  for (int i = 0; i < num_streams; ++i) {
+    api->LaunchOnStream(streams[i],
+                        [&sizes, i]() { sizes[i] = raf::device_api::CPUThreadPoolSize(); });
+  }
+  for (int i = 0; i < num_streams; ++i) {
+    api->WaitStream(streams[i]);
+    ASSERT_GE(sizes[i], 1);
+    ASSERT_LE(sizes[i], std::max(1, max_size / num_streams));
+    api->FreeStream(dev, streams[i]);
+  }
+  // The calling thread is not a stream worker, so it keeps the full pool.
+  ASSERT_EQ(raf::device_api::CPUThreadPoolSize(), max_size);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -5,6 +5,12 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
 #include <raf/device.h>
 #include <raf/memory_pool.h>
 
@@ -63,6 +69,121 @@ TEST(PageUnitPool, CPU) {
   Memory::RemovePool(dev);
 }
 
+TEST(SizeClassPool, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "size_class_pool");
+  {
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 0);
+    ASSERT_EQ(result.use_count(), 1);
+    ASSERT_EQ(result->data, nullptr);
+  }
+  for (int memory : {11, 19, 2019, 1024124, 5000000}) {
+    for (int align : {16, (int)kDefaultMemoryAlignment, 512, 1024, 4096}) {
+      std::shared_ptr<Memory> result = Memory::Alloc(dev, memory, align);
+      ASSERT_EQ(result.use_count(), 1);
+      int64_t address = (int64_t)result->data;
+      ASSERT_EQ(address % align, 0);
+    }
+  }
+  auto pool_size = Memory::GetPoolSize(dev);
+  ASSERT_EQ(pool_size.first, 0);  // No chunk is used.
+
+  std::shared_ptr<Memory> result = Memory::Alloc(dev, 4096, 64);
+  pool_size = Memory::GetPoolSize(dev);
+  auto used_size = pool_size.first * 1048576.0;
+  auto abs_diff = (used_size > 4096) ? used_size - 4096 : 4096 - used_size;
+  ASSERT_LE(abs_diff, 1);
+
+  // A released block of the same size class is reused.
+  void* data = result->data;
+  result.reset();
+  result = Memory::Alloc(dev, 4000, 64);
+  ASSERT_EQ(result->data, data);
+  result.reset();
+  pool_size = Memory::GetPoolSize(dev);
+  ASSERT_EQ(pool_size.first, 0);
+
+  // Released large blocks are split and coalesced, so they fit requests of other sizes.
+  Memory::Alloc(dev, 6 << 20, 64).reset();
+  float total = Memory::GetPoolSize(dev).second;
+  std::shared_ptr<Memory> a = Memory::Alloc(dev, 3 << 20, 64);
+  std::shared_ptr<Memory> b = Memory::Alloc(dev, 3 << 20, 64);
+  ASSERT_EQ(Memory::GetPoolSize(dev).second, total);
+  a.reset();
+  b.reset();
+  std::shared_ptr<Memory> c = Memory::Alloc(dev, 5 << 20, 64);
+  ASSERT_EQ(Memory::GetPoolSize(dev).second, total);
+  c.reset();
+  Memory::RemovePool(dev);
+}
+
+TEST(SizeClassPool, AllocBytes) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "size_class_pool");
+  ASSERT_EQ(Memory::GetAllocBytes(dev, 0), 0);
+  for (int64_t nbytes : {11, 512, 513, 4097, 1024124, 1048577, 5000000}) {
+    // The reported bytes are the size of the block reserved by the pool.
+    int64_t alloc_bytes = Memory::GetAllocBytes(dev, nbytes);
+    ASSERT_GE(alloc_bytes, nbytes);
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, nbytes);
+    ASSERT_NEAR(Memory::GetPoolSize(dev).first * 1048576.0, alloc_bytes, 1);
+  }
+  Memory::RemovePool(dev);
+}
+
+TEST(SizeClassPool, OutliveThePool) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "size_class_pool");
+  std::shared_ptr<Memory> small = Memory::Alloc(dev, 100);
+  std::shared_ptr<Memory> large = Memory::Alloc(dev, 10 << 20);
+  Memory::RemovePool(dev);
+  // The chunks are still valid after the pool is removed.
+  static_cast<char*>(small->data)[99] = 1;
+  static_cast<char*>(large->data)[(10 << 20) - 1] = 1;
+  small.reset();
+  large.reset();
+}
+
+/*!
+ * \brief Allocate and release tensors of many distinct sizes with a sliding window of live
+ * chunks, which mimics the allocation pattern of a model, and report the average latency.
+ */
+double BenchmarkPool(const std::string& pool_name, int num_iters) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, pool_name);
+  std::mt19937 rng(0);
+  std::vector<int64_t> sizes;
+  for (int i = 0; i < 256; ++i) {
+    // Log-uniform sizes between 64B and 16MB.
+    sizes.push_back(static_cast<int64_t>(std::exp2(6 + (rng() % 1800) / 100.0)));
+  }
+  constexpr int kWindow = 32;
+  std::vector<std::shared_ptr<Memory>> live(kWindow);
+  auto run = [&]() {
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      live[i % kWindow] = Memory::Alloc(dev, sizes[i]);
+    }
+  };
+  // The first iteration warms up the pool.
+  run();
+  auto beg = std::chrono::high_resolution_clock::now();
+  for (int iter = 0; iter < num_iters; ++iter) {
+    run();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  live.clear();
+  Memory::RemovePool(dev);
+  double us = std::chrono::duration<double, std::micro>(end - beg).count();
+  return us / (num_iters * sizes.size());
+}
+
+TEST(MemoryPoolBenchmark, CPU) {
+  for (const std::string& pool_name : {"no_pool", "page_unit_pool", "size_class_pool"}) {
+    double latency = BenchmarkPool(pool_name, 20);
+    std::cout << pool_name << ": " << latency << " us per allocation" << std::endl;
+  }
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,73 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#include <raf/device.h>
+#include <raf/profiler.h>
+
+using raf::Device;
+using raf::DevType;
+using raf::profiler::Profiler;
+
+namespace {
+
+int num_names = 0;
+
+std::string GetName() {
+  num_names++;
+  return "test_op";
+}
+
+}  // namespace
+
+TEST(SamplingProfiler, LazyNames) {
+  Device dev(DevType::kCPU(), 0);
+  Profiler* profiler = Profiler::Get();
+  profiler->EnableSampling(1, 4, 64);
+  num_names = 0;
+  std::thread([&]() {
+    for (int i = 0; i < 100; ++i) {
+      WITH_BASE_PROFILER(dev, GetName(), "Test", {}, {});
+    }
+  }).join();
+  profiler->DisableSampling();
+  profiler->set_profile_level(0);
+  profiler->GetProfile();
+  // The names are only evaluated for the sampled scopes.
+  ASSERT_EQ(num_names, 25);
+}
+
+TEST(SamplingProfiler, ReleaseThreadBuffers) {
+  Device dev(DevType::kCPU(), 0);
+  Profiler* profiler = Profiler::Get();
+  profiler->EnableSampling(1, 1, 64);
+  for (int i = 0; i < 100; ++i) {
+    std::thread([&]() { WITH_BASE_PROFILER(dev, "test_op", "Test", {}, {}); }).join();
+  }
+  // The buffers of the exited threads are removed once their events are flushed.
+  profiler->FlushSampledEvents();
+  ASSERT_EQ(profiler->NumThreadBuffers(), 0);
+  std::string profile = profiler->GetProfile();
+  ASSERT_NE(profile.find("test_op"), std::string::npos);
+
+  // Short-lived threads do not accumulate buffers, as the drained ones are reused.
+  for (int i = 0; i < 100; ++i) {
+    std::thread([&]() { WITH_BASE_PROFILER(dev, "test_op", "Test", {}, {}); }).join();
+    profiler->FlushSampledEvents();
+    ASSERT_EQ(profiler->NumThreadBuffers(), 0);
+  }
+  profiler->DisableSampling();
+  profiler->set_profile_level(0);
+  profiler->GetProfile();
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
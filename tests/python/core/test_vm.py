@@ -6,6 +6,7 @@ import numpy as np
 import raf
 from raf._core.executor import VMExecutor
 from raf.testing import check, compile_vm_model, run_vm_model, get_arr_addr, randn
+from raf.testing import get_vm_executor, run_vm_executor
 from raf.testing import get_testable_devices
 
 
@@ -218,5 +219,379 @@ def test_reshape():
     check(out, ref_out)
 
 
+@pytest.mark.parametrize("num_layers", [16, 64])
+def test_inline_op_env_cache(num_layers):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    shape = [1, 4]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            for _ in range(num_layers):
+                x = raf.relu(x)
+            return x
+
+    model = Model()
+    model.infer_mode()
+    device = "cpu"
+    m_x, _ = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    with raf.ir.PassContext(disabled_pass=["FuseTVM", "FuseDialect"]):
+        # Dryrun skips op execution, so only the dispatch runs.
+        executor = VMExecutor(mod, device, dryrun=True)
+        num_instrs = executor.executable.bytecode.count("invoke_jit")
+        assert num_instrs >= num_layers
+        executor.vm.enable_instruction_stats()
+        num_runs = 10
+        for _ in range(num_runs):
+            executor.vm.run(m_x)
+    # Only the first run of each InvokeJit looks up the OpEnv by its key, and the others reuse the
+    # OpEnv of the inline cache.
+    stats = executor.vm.get_instruction_stats()["instructions"]
+    assert sum(instr["inline_cache_hits"] for instr in stats) == num_instrs * (num_runs - 1)
+
+    # Without the inline cache, every InvokeJit looks up the OpEnv by its key.
+    executor.vm.enable_inline_cache(False)
+    executor.vm.enable_instruction_stats()
+    executor.vm.run(m_x)
+    stats = executor.vm.get_instruction_stats()["instructions"]
+    assert sum(instr["inline_cache_hits"] for instr in stats) == 0
+
+
+@pytest.mark.parametrize("num_threads", [1, 2, 4, 8])
+def test_concurrent_run(num_threads):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    import threading
+    import time
+
+    shape = [16, 64]
+    num_runs = 20
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            for _ in range(4):
+                x = raf.relu(raf.matmul(x, w))
+            return x
+
+    model = Model()
+    model.infer_mode()
+    device = "cpu"
+    m_x, _ = randn(shape, device=device)
+    m_w, _ = randn([shape[1], shape[1]], device=device)
+    ref_out = model(m_x, m_w)
+    mod = model._internal(m_x, m_w).mod
+    executor = VMExecutor(mod, device)
+    vm = executor.vm
+    # Warm up the OpEnv cache and the constant pool.
+    vm.run(m_x, m_w)
+
+    outs = [[] for _ in range(num_threads)]
+
+    def worker(tid):
+        # Each call to run creates its own VM context.
+        for _ in range(num_runs):
+            outs[tid].append(vm.run(m_x, m_w))
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(num_threads)]
+    start = time.time()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed = time.time() - start
+    for thread_outs in outs:
+        assert len(thread_outs) == num_runs
+        for out in thread_outs:
+            check(out, ref_out)
+    print(
+        "Throughput with %d threads: %.1f runs/s" % (num_threads, num_threads * num_runs / elapsed)
+    )
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_precompile(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.relu(x)
+            y = raf.sum(y, axis=1)
+            y = raf.tanh(y)
+            return raf.add(y, raf.exp(y))
+
+    model = Model()
+    m_x, _ = randn([11, 23], device=device)
+    ref_out = model(m_x)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device)
+    vm = executor.vm
+    num_built = vm.precompile(m_x, num_threads=4)
+    num_instrs = executor.executable.bytecode.count("invoke_jit")
+    assert 0 < num_built <= num_instrs
+    # All kernels are in the OpEnv cache now.
+    assert vm.precompile(m_x) == 0
+    check(vm.run(m_x), ref_out)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_precompile_data_dependent_branch(device):
+    # pylint: disable=too-many-locals
+    from raf._core.module import IRModule
+    from raf._lib import relay
+
+    x = relay.var("x")
+    cond_p = relay.var("cond_p")
+    cond_q = relay.var("cond_q")
+    a = relay.var("a")
+    cond = relay.var("cond")
+    ret = relay.var("ret")
+    # The branch depends on a kernel output, which is not computed when precompiling.
+    body = relay.Let(
+        a,
+        raf.ir.op.cos(x),
+        relay.Let(
+            cond,
+            raf.ir.op.greater(cond_p, cond_q),
+            relay.Let(
+                ret,
+                relay.If(cond, raf.ir.op.subtract(a, x), raf.ir.op.add(a, x)),
+                ret,
+            ),
+        ),
+    )
+    mod = IRModule.from_expr(relay.Function([x, cond_p, cond_q], body))
+    m_x, n_x = randn([3, 3], device=device)
+    m_p, n_p = randn((), device=device)
+    m_q, n_q = randn((), device=device)
+    vm = VMExecutor(mod, device).vm
+    # The walk stops at the branch, and the kernels in the branches are built when they run.
+    assert vm.precompile(m_x, m_p, m_q, num_threads=4) > 0
+    n_y = np.cos(n_x) - n_x if n_p[()] > n_q[()] else np.cos(n_x) + n_x
+    check(vm.run(m_x, m_p, m_q), n_y)
+
+
+@pytest.mark.parametrize("policy", ["wavefront", "asap"])
+def test_cpu_stream_free_pending(policy):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    num_layers = 4
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            # The chains run on different streams. The VM frees the intermediates of a chain right
+            # after it launches their consumers, so their producers are usually still pending.
+            a, b = x, x
+            for _ in range(num_layers):
+                a = raf.relu(raf.matmul(a, w))
+                b = raf.tanh(raf.matmul(b, w))
+            return raf.add(a, b)
+
+    model = Model()
+    model.infer_mode()
+    device = "cpu"
+    shape = [256, 256]
+    m_x = raf.array(np.random.randn(*shape).astype("float32"), device=device)
+    m_w = raf.array(np.random.randn(*shape).astype("float32") / 16, device=device)
+    record = model._internal(m_x, m_w)
+    ref = run_vm_model(
+        model, device, [m_x, m_w], disable_fusion=True, stream_schedule_policy="sequential"
+    )
+    executor = get_vm_executor(
+        record.mod, device, disable_fusion=True, stream_schedule_policy=policy
+    )
+    # Reused storage would be overwritten by the other chain if it went back to the pool early.
+    for _ in range(10):
+        check(run_vm_executor(executor, record, [m_x, m_w], device), ref, rtol=1e-4, atol=1e-4)
+
+
+def test_cpu_plan():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    num_layers = 16
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            for _ in range(num_layers):
+                x = raf.relu(raf.matmul(x, w))
+            return x, raf.sum(x, axis=1)
+
+    model = Model()
+    model.infer_mode()
+    device = "cpu"
+    m_w, _ = randn([32, 32], device=device)
+    inputs = [randn([8, 32], device=device)[0] for _ in range(3)]
+    mod = model._internal(inputs[0], m_w).mod
+    with raf.ir.PassContext(opt_level=3, disabled_pass=["FuseTVM", "FuseDialect"]):
+        vm = VMExecutor(mod, device, enable_cpu_plan=True).vm
+        ref_vm = VMExecutor(mod, device).vm
+    # The first run captures the plan, and the others replay it.
+    outs = [vm.run(m_x, m_w) for m_x in inputs]
+    for m_x, out in zip(inputs, outs):
+        check(out, model(m_x, m_w))
+        check(out, ref_vm.run(m_x, m_w))
+    assert vm.get_cpu_plan_stats() == {"captures": 1, "replays": len(inputs) - 1}
+    assert ref_vm.get_cpu_plan_stats() == {"captures": 0, "replays": 0}
+
+
+def test_instruction_stats():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            x = raf.relu(raf.matmul(x, w))
+            return raf.sum(x, axis=1)
+
+    model = Model()
+    device = "cpu"
+    m_x, _ = randn([8, 16], device=device)
+    m_w, _ = randn([16, 16], device=device)
+    mod = model._internal(m_x, m_w).mod
+    vm = VMExecutor(mod, device).vm
+    assert vm.get_instruction_stats() == {}
+    vm.enable_instruction_stats()
+    num_runs = 3
+    for _ in range(num_runs):
+        vm.run(m_x, m_w)
+    stats = vm.get_instruction_stats()
+    assert stats["instructions"]
+    for instr in stats["instructions"]:
+        assert instr["count"] == num_runs
+        assert instr["min_us"] <= instr["p50_us"] <= instr["p99_us"] <= instr["max_us"]
+    ops = stats["ops"]
+    assert any("matmul" in name for name in ops)
+    assert sum(op["alloc_bytes"] for op in ops.values()) > 0
+    # The table has a note, a header and the top 3 ops sorted by the total time.
+    rows = [line.split() for line in vm.instruction_stats_table(top=3).strip().split("\n")[2:]]
+    assert 0 < len(rows) <= 3
+    for name, count in (row[:2] for row in rows):
+        assert ops[name]["count"] == int(count)
+        assert ops[name]["count"] % num_runs == 0
+    totals = [float(row[2]) for row in rows]
+    assert totals == sorted(totals, reverse=True)
+    # Enabling the statistics again resets them.
+    vm.enable_instruction_stats()
+    assert vm.get_instruction_stats()["instructions"] == []
+    vm.enable_instruction_stats(False)
+    vm.run(m_x, m_w)
+    assert vm.get_instruction_stats() == {}
+
+
+def test_compile_cache():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    import tvm
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            x = raf.relu(raf.matmul(x, w))
+            return raf.sum(x, axis=1)
+
+    class Aux(raf.Model):
+        def build(self, scale):
+            self.scale = scale
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.multiply(raf.tanh(x), raf.exp(x)) if self.scale else raf.tanh(x)
+
+    model = Model()
+    device = "cpu"
+    m_x, _ = randn([8, 16], device=device)
+    m_w, _ = randn([16, 16], device=device)
+
+    def compile_mod(aux):
+        mod = tvm.IRModule()
+        mod[tvm.ir.GlobalVar("main")] = model._internal(m_x, m_w).mod["main"]
+        mod[tvm.ir.GlobalVar("aux")] = aux._internal(m_x).mod["main"]
+        with raf.ir.PassContext(config={"raf.vm.compile_cache.capacity": 4}):
+            return VMExecutor(mod, device)
+
+    def get_stats():
+        stats = raf._ffi.vm.GetCompileCacheStats()
+        return stats["hits"].value, stats["misses"].value
+
+    raf._ffi.vm.ClearCompileCache()
+    ref_out = model(m_x, m_w)
+    check(compile_mod(Aux(True)).vm.run(m_x, m_w), ref_out)
+    assert get_stats() == (0, 2)
+    executor = compile_mod(Aux(True))
+    assert get_stats() == (2, 2)
+    assert sorted(executor.executable.globals) == ["aux", "main"]
+    check(executor.vm.run(m_x, m_w), ref_out)
+    # Only the changed function is compiled again.
+    check(compile_mod(Aux(False)).vm.run(m_x, m_w), ref_out)
+    assert get_stats() == (3, 3)
+    raf._ffi.vm.ClearCompileCache()
+    assert raf._ffi.vm.GetCompileCacheStats()["size"].value == 0
+
+
+def test_compile_cache_per_function():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    import tvm
+    from raf._lib import relay
+
+    class Helper(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.multiply(raf.tanh(x), raf.exp(x))
+
+    device = "cpu"
+    m_x, n_x = randn([8, 16], device=device)
+    helper = Helper()._internal(m_x).mod["main"]
+
+    def compile_mod(raf_op):
+        # The main function calls the helper function.
+        mod = tvm.IRModule()
+        helper_var = tvm.ir.GlobalVar("helper")
+        mod[helper_var] = helper
+        x = relay.var("x")
+        y = relay.var("y")
+        z = relay.var("z")
+        body = relay.Let(y, relay.Call(helper_var, [x]), relay.Let(z, raf_op(y, x), z))
+        mod[tvm.ir.GlobalVar("main")] = relay.Function([x], body)
+        with raf.ir.PassContext(config={"raf.vm.compile_cache.capacity": 4}):
+            return VMExecutor(mod, device)
+
+    def get_stats():
+        stats = raf._ffi.vm.GetCompileCacheStats()
+        return stats["hits"].value, stats["misses"].value
+
+    raf._ffi.vm.ClearCompileCache()
+    n_y = np.tanh(n_x) * np.exp(n_x)
+    check(compile_mod(raf.ir.op.add).vm.run(m_x), n_y + n_x)
+    assert get_stats() == (0, 2)
+    # Editing main reuses the helper function it calls.
+    executor = compile_mod(raf.ir.op.subtract)
+    assert get_stats() == (1, 3)
+    assert sorted(executor.executable.globals) == ["helper", "main"]
+    check(executor.vm.run(m_x), n_y - n_x)
+    raf._ffi.vm.ClearCompileCache()
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -113,5 +113,55 @@ def test_vm_memory_profiler(device, pool_name):
             assert peak_memory == 0
 
 
+@pytest.mark.parametrize("pool_name", ["page_unit_pool", "size_class_pool"])
+def test_allocation_timeline(pool_name, tmp_path):
+    # pylint: disable=protected-access
+    import json
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init,no-self-use
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.relu(x)
+            y = raf.tanh(y)
+            return raf.exp(y)
+
+    device = "cpu"
+    InitPool(Device(device), pool_name)
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn((3, 1000), device=device)
+    mod = model._internal(m_x).mod
+    with tvm.transform.PassContext(opt_level=1):
+        executor = VMExecutor(mod, device)
+        raf.utils.memory_profiler.reset()
+        raf.utils.memory_profiler.start(record_allocations=True)
+        executor.make_executor()(m_x)
+        raf.utils.memory_profiler.stop()
+
+    report = raf.utils.memory_profiler.get_allocation_report(raf.Device(device))
+    nbytes = 3 * 1000 * 4
+    assert report["num_allocations"] >= 3
+    assert report["peak_requested_bytes"] >= nbytes
+    assert report["peak_rounded_bytes"] >= report["peak_requested_bytes"]
+    assert 0 <= report["internal_fragmentation"] < 1
+    assert 0 <= report["pool_fragmentation"] < 1
+    live = report["live_at_peak"]
+    assert sum(alloc["requested_bytes"] for alloc in live) == report["peak_requested_bytes"]
+    assert any(alloc["name"] == "AllocStorage" and alloc["pc"] >= 0 for alloc in live)
+
+    path = tmp_path / "alloc_trace.json"
+    raf.utils.memory_profiler.dump_allocation_trace(str(path))
+    with open(str(path)) as filep:
+        trace = json.load(filep)
+    phases = [event["ph"] for event in trace["traceEvents"]]
+    assert phases.count("b") == report["num_allocations"]
+    assert "C" in phases
+    InitPool(Device(device), "page_unit_pool")
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -2,6 +2,7 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=invalid-name,protected-access,attribute-defined-outside-init
+import os
 import pytest
 import numpy as np
 import raf
@@ -115,5 +116,39 @@ def test_tuple(fuse):
         check(t, ref_t)
 
 
+@pytest.mark.parametrize("shape", [(3, 5), (1024, 1024)])
+def test_load_exec_file(shape):
+    konst1 = raf.ir.const(np.random.randn(*shape).astype("float32"))
+    konst2 = raf.ir.const(np.random.randn(shape[1]).astype("float32"))
+    x = raf.ir.var("x", shape=shape)
+    y = raf.ir.op.add(x, konst1)
+    y = raf.ir.op.add(y, konst2)
+    mod = raf.ir.IRModule()
+    mod["main"] = relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+
+    executor = VMExecutor(mod, "cpu")
+    m_x, _ = randn(shape)
+    ref_y = executor.make_executor()(m_x)
+
+    code, lib = executor.executable.save()
+    tmp = tvm.contrib.utils.tempdir()
+    lib_path = tmp.relpath("lib.so")
+    lib.export_library(lib_path)
+    code_path = tmp.relpath("code.ro")
+    with open(code_path, "wb") as fo:
+        fo.write(code)
+    loaded_lib = tvm.runtime.load_module(lib_path)
+
+    loaded_exe = Executable.load_exec(bytearray(open(code_path, "rb").read()), loaded_lib)
+    check(run_exec(loaded_exe, [m_x]), ref_y)
+
+    mapped_exe = Executable.load_exec_file(code_path, loaded_lib)
+    check(run_exec(mapped_exe, [m_x]), ref_y)
+    # The mapping keeps the constants valid after the file is removed.
+    os.remove(code_path)
+    check(run_exec(mapped_exe, [m_x]), ref_y)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
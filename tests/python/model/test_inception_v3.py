@@ -63,12 +63,11 @@ def test_vm_forward(fuse):
 #
 
 
-@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize("block_name", ["c"])
+@pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("fuse", [False, True])
 @pytest.mark.parametrize("policy", ["wavefront", "asap"])
-def test_block_vm_multi_stream(block_name, policy, fuse):
-    device = "cuda"
+def test_block_vm_multi_stream(block_name, device, policy, fuse):
     (model, x, _), _ = inception.get_block_and_input(block_name=block_name, device=device)
     model.infer_mode()
 
@@ -27,5 +27,46 @@ def test_mlp(config, device):
     mlp.check_params(m_model, t_model, atol=1e-4, rtol=1e-4)
 
 
+@pytest.mark.parametrize("is_train", [False, True])
+def test_model_cache(is_train):
+    # pylint: disable=attribute-defined-outside-init, protected-access
+    from raf._ffi.model import DumpModelCacheMetric
+
+    class Model(raf.Model):
+        def build(self, w):
+            self.w = w
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(raf.matmul(x, self.w))
+
+    def get_metric(name):
+        metrics = DumpModelCacheMetric()
+        return int(metrics[name]) if name in metrics else 0
+
+    m_w, t_w = randn_torch([16, 16], requires_grad=is_train)
+    model = Model(m_w)
+    if is_train:
+        model.train_mode()
+    else:
+        model.infer_mode()
+    num_hits, num_misses = get_metric("CacheHit"), get_metric("CacheMiss")
+    num_steps = 3
+    for _ in range(num_steps):
+        m_x, t_x = randn_torch([4, 16])
+        m_y = model(m_x)
+        t_y = torch.relu(torch.matmul(t_x, t_w))
+        check(m_y, t_y)
+        if is_train:
+            m_dy, t_dy = randn_torch([4, 16])
+            t_w.grad = None
+            m_y.backward(m_dy)
+            t_y.backward(t_dy)
+            check(m_w.grad, t_w.grad)
+    # Only the first step optimizes the module.
+    assert get_metric("CacheMiss") - num_misses == 1
+    assert get_metric("CacheHit") - num_hits == num_steps - 1
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,416 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments,protected-access,no-self-use
+import numpy as np
+import pytest
+import torch
+
+import raf
+from raf.testing import (
+    check,
+    randint,
+    randn_torch,
+    run_vm_model,
+    with_dialect,
+    DialectChecker,
+)
+
+
+def verify_dispatch(model, args):
+    mod = model._internal(*args).mod
+    with raf.device("cpu"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.DispatchDialect()(mod)
+    DialectChecker("cpu").visit(mod["main"])
+
+
+def run_model(model, args):
+    verify_dispatch(model, args)
+    return model(*args), run_vm_model(model, "cpu", args)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("n", [1, 7, 64])
+@pytest.mark.parametrize("k", [0, 1, 33, 300])
+@pytest.mark.parametrize("m", [1, 17, 100])
+@pytest.mark.parametrize("transpose_a", [True, False])
+@pytest.mark.parametrize("transpose_b", [True, False])
+def test_matmul(n, k, m, transpose_a, transpose_b):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            raf_op = [[raf.matmul, raf.matmul_nt], [raf.matmul_tn, raf.matmul_tt]]
+            return raf_op[transpose_a][transpose_b](m_a, m_b)
+
+    m_a, t_a = randn_torch((n, k) if not transpose_a else (k, n))
+    m_b, t_b = randn_torch((k, m) if not transpose_b else (m, k))
+    m_c, v_c = run_model(TestModel(), [m_a, m_b])
+    t_c = torch.matmul(t_a.T if transpose_a else t_a, t_b.T if transpose_b else t_b)
+    check(m_c, t_c, rtol=1e-4, atol=1e-4)
+    check(v_c, t_c, rtol=1e-4, atol=1e-4)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("shape", [[4, 8, 16], [33, 100, 70]])
+def test_dense(shape):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_x, m_w):
+            return raf.dense(m_x, m_w)
+
+    n, m, k = shape
+    m_x, t_x = randn_torch((n, k))
+    m_w, t_w = randn_torch((m, k))
+    m_y, v_y = run_model(TestModel(), [m_x, m_w])
+    t_y = torch.nn.functional.linear(t_x, t_w)
+    check(m_y, t_y, rtol=1e-4, atol=1e-4)
+    check(v_y, t_y, rtol=1e-4, atol=1e-4)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("shape", [[3, 5, 7, 9], [4, 64, 32, 48]])
+@pytest.mark.parametrize("broadcast", ["none", "a", "b"])
+@pytest.mark.parametrize("transpose_a", [True, False])
+@pytest.mark.parametrize("transpose_b", [True, False])
+def test_batch_matmul(shape, broadcast, transpose_a, transpose_b):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            raf_op = [
+                [raf.batch_matmul, raf.batch_matmul_nt],
+                [raf.batch_matmul_tn, raf.batch_matmul_tt],
+            ]
+            return raf_op[transpose_a][transpose_b](m_a, m_b)
+
+    b, n, k, m = shape
+    b1 = 1 if broadcast == "a" else b
+    b2 = 1 if broadcast == "b" else b
+    m_a, t_a = randn_torch((b1, n, k) if not transpose_a else (b1, k, n))
+    m_b, t_b = randn_torch((b2, k, m) if not transpose_b else (b2, m, k))
+    m_c, v_c = run_model(TestModel(), [m_a, m_b])
+    t_c = torch.matmul(
+        torch.transpose(t_a, 1, 2) if transpose_a else t_a,
+        torch.transpose(t_b, 1, 2) if transpose_b else t_b,
+    )
+    check(m_c, t_c, rtol=1e-4, atol=1e-4)
+    check(v_c, t_c, rtol=1e-4, atol=1e-4)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("shape", [[7], [3, 100], [64, 1025]])
+def test_cast_bf16(shape):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_x):
+            return raf.cast(raf.cast(m_x, "bfloat16"), "float32")
+
+    m_x, t_x = randn_torch(shape)
+    m_y, v_y = run_model(TestModel(), [m_x])
+    t_y = t_x.bfloat16().float()
+    check(m_y, t_y, rtol=0, atol=0)
+    check(v_y, t_y, rtol=0, atol=0)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize(
+    "ops",
+    [
+        (raf._op.sym.matmul, torch.matmul, False, False),
+        (raf._op.sym.matmul_nt, lambda a, b: torch.matmul(a, b.T), False, True),
+        (raf._op.sym.dense, lambda a, b: torch.matmul(a, b.T), False, True),
+        (raf._op.sym.matmul_tt, lambda a, b: torch.matmul(a.T, b.T), True, True),
+    ],
+)
+@pytest.mark.parametrize("shape", [[1, 33, 17], [64, 300, 100]])
+def test_matmul_bf16(ops, shape):
+    m_op, t_op, transpose_a, transpose_b = ops
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            m_c = m_op(raf.cast(m_a, "bfloat16"), raf.cast(m_b, "bfloat16"))
+            return raf.cast(m_c, "float32")
+
+    n, k, m = shape
+    m_a, t_a = randn_torch((n, k) if not transpose_a else (k, n))
+    m_b, t_b = randn_torch((k, m) if not transpose_b else (m, k))
+    m_c, v_c = run_model(TestModel(), [m_a, m_b])
+    # The products are accumulated in float32, and the output is rounded to bfloat16 only once.
+    t_c = t_op(t_a.bfloat16().float(), t_b.bfloat16().float()).bfloat16().float()
+    check(v_c, t_c, rtol=1e-2, atol=1e-2)
+    check(m_c, t_c, rtol=1e-2, atol=1e-2)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("shape", [[3, 5, 7, 9], [4, 64, 32, 48]])
+@pytest.mark.parametrize("transpose_b", [True, False])
+def test_batch_matmul_bf16(shape, transpose_b):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            raf_op = raf.batch_matmul_nt if transpose_b else raf.batch_matmul
+            m_c = raf_op(raf.cast(m_a, "bfloat16"), raf.cast(m_b, "bfloat16"))
+            return raf.cast(m_c, "float32")
+
+    b, n, k, m = shape
+    m_a, t_a = randn_torch((b, n, k))
+    m_b, t_b = randn_torch((b, m, k) if transpose_b else (b, k, m))
+    m_c, v_c = run_model(TestModel(), [m_a, m_b])
+    t_b = torch.transpose(t_b, 1, 2) if transpose_b else t_b
+    t_c = torch.matmul(t_a.bfloat16().float(), t_b.bfloat16().float()).bfloat16().float()
+    check(v_c, t_c, rtol=1e-2, atol=1e-2)
+    check(m_c, t_c, rtol=1e-2, atol=1e-2)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("shape", [[5], [3, 7], [2, 3, 1000]])
+def test_softmax(shape):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_x):
+            return raf.softmax(m_x, axis=-1)
+
+    m_x, t_x = randn_torch(shape)
+    m_y, v_y = run_model(TestModel(), [m_x])
+    t_y = torch.softmax(t_x, dim=-1)
+    check(m_y, t_y)
+    check(v_y, t_y)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("shape", [[3, 7], [2, 16, 1024]])
+@pytest.mark.parametrize("affine", [True, False])
+def test_layer_norm(shape, affine):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, *args):
+            return raf.layer_norm(*args, axis=-1, eps=1e-5)
+
+    m_x, t_x = randn_torch(shape)
+    args = [m_x]
+    t_scale, t_bias = None, None
+    if affine:
+        m_scale, t_scale = randn_torch(shape[-1:])
+        m_bias, t_bias = randn_torch(shape[-1:])
+        args += [m_scale, m_bias]
+    m_y, v_y = run_model(TestModel(), args)
+    t_y = torch.nn.functional.layer_norm(t_x, shape[-1:], t_scale, t_bias, eps=1e-5)
+    check(m_y, t_y, rtol=1e-4, atol=1e-4)
+    check(v_y, t_y, rtol=1e-4, atol=1e-4)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("dtype", ["int32", "int64"])
+@pytest.mark.parametrize("shape", [[[10, 3], [4]], [[1000, 64], [8, 32]]])
+def test_embedding(dtype, shape):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_x, m_indices):
+            return raf.embedding(m_x, m_indices)
+
+    x_shape, indices_shape = shape
+    m_x, t_x = randn_torch(x_shape)
+    m_indices, n_indices = randint(indices_shape, low=0, high=x_shape[0], dtype=dtype)
+    m_y, v_y = run_model(TestModel(), [m_x, m_indices])
+    t_y = torch.nn.functional.embedding(torch.tensor(n_indices.astype("int64")), t_x)
+    check(m_y, t_y)
+    check(v_y, t_y)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize(
+    "ops",
+    [
+        (raf._op.sym.relu, torch.relu),
+        (raf._op.sym.gelu, torch.nn.functional.gelu),
+        (raf._op.sym.tanh, torch.tanh),
+        (raf._op.sym.sigmoid, torch.sigmoid),
+    ],
+)
+@pytest.mark.parametrize("shape", [[7], [3, 100], [64, 1025]])
+def test_unary(ops, shape):
+    m_op, t_op = ops
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_x):
+            return m_op(m_x)
+
+    m_x, t_x = randn_torch(shape, std=4.0)
+    m_y, v_y = run_model(TestModel(), [m_x])
+    t_y = t_op(t_x)
+    check(m_y, t_y)
+    check(v_y, t_y)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("shape", [[1, 7, 1, 5], [3, 33, 65, 100]])
+@pytest.mark.parametrize("batch", [None, "none", "b"])
+@pytest.mark.parametrize("transpose_a", [True, False])
+@pytest.mark.parametrize("transpose_b", [True, False])
+def test_quantized_matmul(shape, batch, transpose_a, transpose_b):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            raf_op = raf.quantized_matmul if batch is None else raf.quantized_batch_matmul
+            return raf_op(m_a, m_b, transpose_a, transpose_b)
+
+    b, n, k, m = shape
+    a_shape = (k, n) if transpose_a else (n, k)
+    b_shape = (m, k) if transpose_b else (k, m)
+    if batch is not None:
+        a_shape = (b,) + a_shape
+        b_shape = (1 if batch == "b" else b,) + b_shape
+    m_a, n_a = randint(a_shape, low=-127, high=128, dtype="int8")
+    m_b, n_b = randint(b_shape, low=-127, high=128, dtype="int8")
+    m_c, v_c = run_model(TestModel(), [m_a, m_b])
+    n_c = np.matmul(
+        np.swapaxes(n_a, -1, -2).astype("int32") if transpose_a else n_a.astype("int32"),
+        np.swapaxes(n_b, -1, -2).astype("int32") if transpose_b else n_b.astype("int32"),
+    )
+    assert m_c.dtype == "int32"
+    check(m_c, n_c, rtol=0, atol=0)
+    check(v_c, n_c, rtol=0, atol=0)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize(
+    "xshape,wshape,stride,padding,dilation,groups",
+    [
+        [(1, 3, 9, 9), (8, 3, 3, 3), 1, 1, 1, 1],
+        [(2, 16, 14, 14), (32, 16, 1, 1), 2, 0, 1, 1],
+        [(2, 8, 11, 13), (8, 2, 3, 5), (2, 1), (1, 2), 2, 4],
+    ],
+)
+def test_quantized_conv2d(xshape, wshape, stride, padding, dilation, groups):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_x, m_w):
+            return raf.quantized_conv2d(m_x, m_w, stride, padding, dilation, groups)
+
+    m_x, n_x = randint(xshape, low=-127, high=128, dtype="int8")
+    m_w, n_w = randint(wshape, low=-127, high=128, dtype="int8")
+    m_y, v_y = run_model(TestModel(), [m_x, m_w])
+    # The sums are exact in float64.
+    t_y = torch.nn.functional.conv2d(
+        torch.from_numpy(n_x.astype("float64")),
+        torch.from_numpy(n_w.astype("float64")),
+        stride=stride,
+        padding=padding,
+        dilation=dilation,
+        groups=groups,
+    )
+    n_y = t_y.numpy().astype("int32")
+    check(m_y, n_y, rtol=0, atol=0)
+    check(v_y, n_y, rtol=0, atol=0)
+
+
+def broadcast_scale(n_scale, ndim, axis):
+    shape = [1] * ndim
+    shape[axis] = -1
+    return n_scale.reshape(shape) if n_scale.size > 1 else n_scale
+
+
+def quantize_ref(n_x, n_scale, axis):
+    n_q = np.rint(n_x / broadcast_scale(n_scale, n_x.ndim, axis))
+    return np.clip(n_q, -127, 127).astype("int8")
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("shape", [[7], [3, 100], [4, 5, 1000]])
+@pytest.mark.parametrize("axis", [None, 0, -1])
+def test_quantize(shape, axis):
+    axis_ = -1 if axis is None else axis
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_x, m_scale):
+            m_q = raf.quantize(m_x, m_scale, axis_, "int8")
+            return m_q, raf.dequantize(m_q, m_scale, axis_, "float32")
+
+    m_x, n_x = randn(shape)
+    channels = 1 if axis is None else shape[axis]
+    n_scale = (np.random.rand(channels) * 0.02 + 0.01).astype("float32")
+    m_scale = raf.array(n_scale)
+    (m_q, m_y), (v_q, v_y) = run_model(TestModel(), [m_x, m_scale])
+    n_q = quantize_ref(n_x, n_scale, axis_)
+    n_y = n_q.astype("float32") * broadcast_scale(n_scale, len(shape), axis_)
+    check(m_q, n_q, rtol=0, atol=0)
+    check(v_q, n_q, rtol=0, atol=0)
+    check(m_y, n_y)
+    check(v_y, n_y)
+
+
+@with_dialect(["cpu", "tvm"])
+@pytest.mark.parametrize("shape", [[3, 100], [2, 16, 9, 9]])
+@pytest.mark.parametrize("axis", [None, 1])
+def test_requantize(shape, axis):
+    axis_ = -1 if axis is None else axis
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_x, m_in_scale, m_out_scale):
+            m_q = raf.requantize(m_x, m_in_scale, m_out_scale, axis_, "int8")
+            return m_q, raf.dequantize(m_x, m_in_scale, axis_, "float32")
+
+    m_x, n_x = randint(shape, low=-50000, high=50000, dtype="int32")
+    channels = 1 if axis is None else shape[axis]
+    n_in_scale = (np.random.rand(channels) * 1e-3 + 1e-4).astype("float32")
+    n_out_scale = np.array([np.abs(n_x).max() * 1e-3 / 127], dtype="float32")
+    m_in_scale, m_out_scale = raf.array(n_in_scale), raf.array(n_out_scale)
+    (m_q, m_y), (v_q, v_y) = run_model(TestModel(), [m_x, m_in_scale, m_out_scale])
+    n_q = quantize_ref(n_x.astype("float32"), n_out_scale / n_in_scale, axis_)
+    n_y = n_x.astype("float32") * broadcast_scale(n_in_scale, len(shape), axis_)
+    # The reference divides by the inverse multiplier, so ties may round the other way.
+    assert np.abs(m_q.numpy().astype("int32") - n_q).max() <= 1
+    assert np.abs(v_q.numpy().astype("int32") - n_q).max() <= 1
+    check(m_y, n_y)
+    check(v_y, n_y)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -1,11 +1,14 @@
 # Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
 # SPDX-License-Identifier: Apache-2.0
 
+import time
+
 import numpy as np
 import pytest
 
 import raf
-from raf.testing import get_testable_devices, run_vm_model
+from raf._core.executor import VMExecutor
+from raf.testing import check, get_testable_devices, randn, run_vm_model
 
 
 @pytest.mark.parametrize("device", get_testable_devices())
@@ -46,5 +49,32 @@ def test_avg_pool2d_dx_fuse_relu_dx(device):
     run_vm_model(model, device, [x])
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_async_build(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            y = raf.relu(y)
+            return raf.multiply(y, y)
+
+    model = Model()
+    # Use an uncommon shape so that the fused op is not in the build cache.
+    m_x, _ = randn((7, 13, 29), device=device)
+    ref_out = model(m_x)
+    mod = model._internal(m_x).mod
+    with raf.ir.PassContext(config={"raf.tvm.async_build": True}):
+        executor = VMExecutor(mod, device)
+        # The first runs execute the fallback while the fused op is being built in the
+        # background, and the later runs execute the built one. All of them must be correct.
+        for _ in range(10):
+            check(executor.vm.run(m_x), ref_out)
+            time.sleep(0.1)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
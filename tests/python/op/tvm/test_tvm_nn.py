@@ -117,6 +117,69 @@ def test_dense(n, m, k, device):
     check(m_b.grad, np.matmul(n_dyt, n_a))
 
 
+@with_dialect("tvm")
+@pytest.mark.parametrize("batch", [None, 1, 3])
+@pytest.mark.parametrize("transpose_a", [True, False])
+@pytest.mark.parametrize("transpose_b", [True, False])
+def test_quantized_matmul(batch, transpose_a, transpose_b):
+    class QuantizedMatmul(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            raf_op = raf.quantized_matmul if batch is None else raf.quantized_batch_matmul
+            return raf_op(m_a, m_b, transpose_a, transpose_b)
+
+    n, k, m = 5, 37, 9
+    a_shape = (k, n) if transpose_a else (n, k)
+    b_shape = (m, k) if transpose_b else (k, m)
+    if batch is not None:
+        # The second operand is broadcast along the batch.
+        a_shape, b_shape = (batch,) + a_shape, (1,) + b_shape
+    m_a, n_a = randint(a_shape, low=-127, high=128, dtype="int8")
+    m_b, n_b = randint(b_shape, low=-127, high=128, dtype="int8")
+    model = QuantizedMatmul()
+    m_c = model(m_a, m_b)
+    v_c = run_vm_model(model, "cpu", [m_a, m_b])
+    n_a = np.swapaxes(n_a, -1, -2) if transpose_a else n_a
+    n_b = np.swapaxes(n_b, -1, -2) if transpose_b else n_b
+    n_c = np.matmul(n_a.astype("int32"), n_b.astype("int32"))
+    assert m_c.dtype == "int32"
+    check(m_c, n_c, rtol=0, atol=0)
+    check(v_c, n_c, rtol=0, atol=0)
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("groups", [1, 2])
+@pytest.mark.parametrize("stride", [1, 2])
+@pytest.mark.parametrize("padding", [0, 1])
+def test_quantized_conv2d(groups, stride, padding):
+    class QuantizedConv2D(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_x, m_w):
+            return raf.quantized_conv2d(m_x, m_w, stride, padding, 1, groups)
+
+    m_x, n_x = randint((2, 4, 9, 9), low=-127, high=128, dtype="int8")
+    m_w, n_w = randint((6, 4 // groups, 3, 3), low=-127, high=128, dtype="int8")
+    model = QuantizedConv2D()
+    m_y = model(m_x, m_w)
+    v_y = run_vm_model(model, "cpu", [m_x, m_w])
+    t_y = F.conv2d(
+        torch.from_numpy(n_x.astype("float64")),
+        torch.from_numpy(n_w.astype("float64")),
+        stride=stride,
+        padding=padding,
+        groups=groups,
+    )
+    n_y = t_y.numpy().astype("int32")
+    check(m_y, n_y, rtol=0, atol=0)
+    check(v_y, n_y, rtol=0, atol=0)
+
+
 # pylint: disable=no-member
 # pylint: disable=protected-access
 @with_dialect("tvm")
@@ -628,6 +691,38 @@ def test_matmul(device, dtype, n, k, m, transpose_a, transpose_b):
     check(m_b.grad, t_b.grad, rtol=1e-4, atol=1e-4)
 
 
+@with_dialect("tvm")
+@pytest.mark.parametrize("op_name", ["dense", "matmul", "matmul_tn", "matmul_nt", "matmul_tt"])
+@pytest.mark.parametrize("n,k,m", [(4, 512, 8), (17, 300, 33)])
+def test_matmul_bf16(op_name, n, k, m):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            out = getattr(raf, op_name)(raf.cast(m_a, "bfloat16"), raf.cast(m_b, "bfloat16"))
+            return raf.cast(out, "float32")
+
+    def np_float2bf162float(arr):
+        orig = arr.view("<u4")
+        bias = np.bitwise_and(np.right_shift(orig, 16), 1) + 0x7FFF
+        return np.left_shift(np.right_shift(orig + bias, 16), 16).astype("uint32").view("<f4")
+
+    device = "cpu"
+    transpose_a = op_name in ["matmul_tn", "matmul_tt"]
+    transpose_b = op_name in ["dense", "matmul_nt", "matmul_tt"]
+    m_a, n_a = randn((k, n) if transpose_a else (n, k), device=device)
+    m_b, n_b = randn((m, k) if transpose_b else (k, m), device=device)
+    v_c = run_vm_model(TestModel(), device, [m_a, m_b])
+    n_a = np_float2bf162float(n_a)
+    n_b = np_float2bf162float(n_b)
+    n_c = np.matmul(n_a.T if transpose_a else n_a, n_b.T if transpose_b else n_b)
+    # The result is accumulated in float32, so the only error comes from the final rounding
+    # to bfloat16, which has 8 bits of mantissa.
+    check(v_c, n_c, rtol=1e-2, atol=1e-2)
+
+
 @with_dialect("tvm")
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("shape", [[8, 8, 8, 8], [8, 8, 8, 8, 8]])
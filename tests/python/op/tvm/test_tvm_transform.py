@@ -19,6 +19,7 @@ from raf.testing import (
     randint,
     check,
     run_vm_model,
+    with_dialect,
 )
 import tvm.topi.testing as npx  # pylint: disable=no-name-in-module
 
@@ -769,6 +770,29 @@ def test_cast(shape, device, itype, otype):
     check(m_x.grad, n_dy.astype(itype))
 
 
+@with_dialect("tvm")
+@pytest.mark.parametrize("shape", [(3, 4, 2), (37,), (64, 65)])
+def test_cast_bf16(shape):
+    class CastModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            return raf.cast(raf.cast(x, "bfloat16"), "float32")
+
+    def np_float2bf162float(arr):
+        """Round float32 to bfloat16 (round to nearest even) and convert it back."""
+        orig = arr.view("<u4")
+        bias = np.bitwise_and(np.right_shift(orig, 16), 1) + 0x7FFF
+        return np.left_shift(np.right_shift(orig + bias, 16), 16).astype("uint32").view("<f4")
+
+    device = "cpu"
+    m_x, n_x = randn(shape, device=device)
+    m_y = run_vm_model(CastModel(), device, [m_x])
+    check(m_y, np_float2bf162float(n_x), rtol=0, atol=0)
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("dshape", [[2, 2, 2], [2, 3]])
 @pytest.mark.parametrize("axis", [0, 1])
@@ -1150,5 +1174,83 @@ def test_group_cast(shape, device, itype, otype):
     check(group_out[2], out[2])
 
 
+@pytest.mark.parametrize("shape", [(4, 64), (3, 5, 7)])
+@pytest.mark.parametrize("block_size", [32, 256])
+def test_quantize_blockwise(shape, block_size):
+    class BlockwiseModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            out = raf.quantize_blockwise(x, block_size)
+            return raf.dequantize_blockwise(out[0], out[1], shape, "float32")
+
+    device = "cpu"
+    model = BlockwiseModel()
+    m_x, n_x = randn(shape, device=device)
+    m_y = run_vm_model(model, device, [m_x])
+
+    # Each element is off by at most half of the scale of its block.
+    size = reduce(operator.mul, shape, 1)
+    n_blocks = (size + block_size - 1) // block_size
+    n_flat = np.zeros((n_blocks * block_size,), dtype="float32")
+    n_flat[:size] = n_x.flatten()
+    n_scale = np.abs(n_flat.reshape(n_blocks, block_size)).max(axis=1) / 127
+    n_tol = np.repeat(n_scale, block_size)[:size].reshape(shape) / 2 + 1e-6
+    assert (np.abs(m_y.numpy() - n_x) <= n_tol).all()
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("shape", [(7,), (4, 64), (2, 3, 5)])
+@pytest.mark.parametrize("per_channel", [False, True])
+def test_quantize(shape, per_channel):
+    class QuantizeModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, scale):  # pylint: disable=no-self-use
+            q = raf.quantize(x, scale, 0, "int8")
+            return q, raf.dequantize(q, scale, 0, "float32")
+
+    device = "cpu"
+    model = QuantizeModel()
+    m_x, n_x = randn(shape, device=device)
+    n_scale = np.random.uniform(0.005, 0.02, (shape[0] if per_channel else 1,))
+    n_scale = n_scale.astype("float32")
+    m_scale = raf.array(n_scale, device=device)
+    m_q, m_y = run_vm_model(model, device, [m_x, m_scale])
+
+    # Divide by the scale, round half to even and saturate to [-127, 127].
+    n_bscale = n_scale.reshape((-1,) + (1,) * (len(shape) - 1))
+    n_q = np.clip(np.rint(n_x / n_bscale), -127, 127).astype("int8")
+    check(m_q, n_q, rtol=0, atol=0)
+    check(m_y, n_q.astype("float32") * n_bscale)
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("shape", [(16,), (3, 32)])
+def test_requantize(shape):
+    class RequantizeModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, in_scale, out_scale):  # pylint: disable=no-self-use
+            return raf.requantize(x, in_scale, out_scale, -1, "int8")
+
+    device = "cpu"
+    model = RequantizeModel()
+    m_x, n_x = randint(shape, low=-20000, high=20000, device=device, dtype="int32")
+    n_in_scale = np.random.uniform(1e-4, 1e-3, (shape[-1],)).astype("float32")
+    n_out_scale = np.array([0.05], dtype="float32")
+    m_in_scale = raf.array(n_in_scale, device=device)
+    m_out_scale = raf.array(n_out_scale, device=device)
+    m_y = run_vm_model(model, device, [m_x, m_in_scale, m_out_scale])
+    n_y = np.clip(np.rint(n_x * (n_in_scale / n_out_scale)), -127, 127)
+    assert np.abs(m_y.numpy().astype("int32") - n_y).max() <= 1
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -414,5 +414,67 @@ def test_where():
         verify_correctness(model, "cpu", args, tol=1)
 
 
+def test_bf16():
+    """With bfloat16, conv2d stays in float32 while dense and exp are casted."""
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, w2):
+            y = raf.conv2d(x, w)
+            y = raf.batch_flatten(y)
+            y = raf.dense(y, w2)
+            return raf.exp(y)
+
+    model = Model()
+    m_x, _ = randn((1, 3, 8, 8), dtype="float32")
+    m_w, _ = randn((4, 3, 3, 3), dtype="float32")
+    m_w2, _ = randn((16, 144), dtype="float32")
+    args = [m_x, m_w, m_w2]
+
+    amp_model = raf.amp.autocast(model, args, amp_dtype="bfloat16")
+    mod = raf._ffi.pass_.InferType()(amp_model._internal(*args).mod)
+    arg_dtypes = {}
+
+    def visit(node):
+        if isinstance(node, relay.Call) and isinstance(node.op, tvm.ir.Op):
+            arg_dtypes[node.op.name] = node.args[0].checked_type.dtype
+
+    relay.analysis.post_order_visit(mod["main"], visit)
+    assert arg_dtypes["raf.op.conv2d"] == "float32"
+    assert arg_dtypes["raf.op.dense"] == "bfloat16"
+    assert arg_dtypes["raf.op.exp"] == "bfloat16"
+    assert mod["main"].checked_type.ret_type.dtype == "bfloat16"
+
+    with raf.ir.PassContext(config={"raf.amp.dtype": "bfloat16", "raf.amp.out_dtype": "float32"}):
+        # Cast the inputs of dense, and cast the output back to fp32.
+        verify_cast_num(model, args, 3)
+        verify_correctness(model, "cpu", args, tol=1)
+
+
+def test_bf16_batch_matmul():
+    """With bfloat16, batch_matmul is casted like matmul, as it accumulates in float32."""
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            return raf.batch_matmul_nt(x, w)
+
+    model = Model()
+    m_x, _ = randn((2, 8, 16), dtype="float32")
+    m_w, _ = randn((2, 4, 16), dtype="float32")
+    args = [m_x, m_w]
+
+    with raf.ir.PassContext(config={"raf.amp.dtype": "bfloat16", "raf.amp.out_dtype": "float32"}):
+        # Cast the two inputs, and cast the output back to fp32.
+        verify_cast_num(model, args, 3)
+        verify_correctness(model, "cpu", args, tol=1)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
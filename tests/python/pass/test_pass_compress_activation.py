@@ -0,0 +1,166 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access,invalid-name,attribute-defined-outside-init,no-self-use
+import pytest
+import tvm
+import raf
+from raf._core.device import Device
+from raf._core.vm import VMCompiler
+from raf.ir import RAFSequential
+from raf.optim import with_autodiff
+from raf.testing import randn, check, run_vm_model
+
+
+class ReluMatmul(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, w):
+        a = raf.relu(x)
+        return raf.matmul(a, w)
+
+
+class ReluMatmulChain(raf.Model):
+    def build(self, num_layers):
+        self.num_layers = num_layers
+
+    @raf.model.trace
+    def forward(self, x, w):
+        for _ in range(self.num_layers):
+            x = raf.relu(raf.matmul(x, w))
+        return x
+
+
+def collect_ops(expr):
+    ops = []
+
+    def visit(node):
+        if isinstance(node, tvm.relay.Call) and isinstance(node.op, tvm.ir.Op):
+            ops.append(node.op.name)
+
+    tvm.relay.analysis.post_order_visit(expr, visit)
+    return ops
+
+
+@pytest.mark.parametrize("dtype", ["float16", "bfloat16", "int8"])
+def test_compress_ir(dtype):
+    shape = (16, 16)
+    model = ReluMatmul()
+    model.train_mode()
+    m_x, _ = randn(shape, requires_grad=True)
+    m_w, _ = randn(shape, requires_grad=True)
+    record = model._internal(m_x, m_w)
+    seq = RAFSequential(
+        [
+            raf._ffi.pass_.InferType(),
+            raf._ffi.pass_.AutoDiff(record.requires_grads),
+            raf._ffi.pass_.CompressActivation(),
+        ]
+    )
+    with tvm.transform.PassContext(
+        config={"raf.compress_activation.dtype": dtype, "raf.compress_activation.min_bytes": 0}
+    ):
+        mod = seq(record.mod)
+    ops = collect_ops(mod["main"])
+    if dtype == "int8":
+        assert "raf.op.quantize_blockwise" in ops
+        assert "raf.op.dequantize_blockwise" in ops
+    else:
+        assert ops.count("raf.op.cast") >= 2
+
+    # The closure only captures the compressed activations.
+    closures = []
+    tvm.relay.analysis.post_order_visit(
+        mod["main"],
+        lambda node: closures.append(node) if isinstance(node, tvm.relay.Function) else None,
+    )
+    closure = [func for func in closures if not func.same_as(mod["main"])][0]
+    params = list(mod["main"].params)
+    captured = [var for var in tvm.relay.analysis.free_vars(closure) if var not in params]
+    assert captured and all(var.name_hint.endswith("_c") for var in captured)
+
+
+def test_disabled_by_default():
+    shape = (16, 16)
+    model = ReluMatmul()
+    model.train_mode()
+    m_x, _ = randn(shape, requires_grad=True)
+    m_w, _ = randn(shape, requires_grad=True)
+    record = model._internal(m_x, m_w)
+    seq = RAFSequential(
+        [
+            raf._ffi.pass_.InferType(),
+            raf._ffi.pass_.AutoDiff(record.requires_grads),
+            raf._ffi.pass_.InferType(),
+        ]
+    )
+    mod = seq(record.mod)
+    after = raf._ffi.pass_.CompressActivation()(mod)
+    assert tvm.ir.structural_equal(after["main"], mod["main"])
+
+
+@pytest.mark.parametrize("dtype", ["float16", "int8"])
+def test_compress_grads(dtype):
+    shape = (32, 32)
+    device = "cpu"
+    model = with_autodiff(ReluMatmul())
+    m_x, _ = randn(shape, device=device)
+    m_w, _ = randn(shape, device=device)
+    m_dy, _ = randn(shape, device=device)
+    ref = run_vm_model(model, device, [m_dy, m_x, m_w])
+    with tvm.transform.PassContext(
+        config={"raf.compress_activation.dtype": dtype, "raf.compress_activation.min_bytes": 0}
+    ):
+        out = run_vm_model(model, device, [m_dy, m_x, m_w])
+    check(out[0], ref[0])
+    check(out[1][0], ref[1][0], rtol=5e-2, atol=5e-2)
+    check(out[1][1], ref[1][1], rtol=5e-2, atol=5e-2)
+
+
+def get_peak_memory(mod, device):
+    compiler = VMCompiler()
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=["FuseDialect", "FuseTVM"]):
+        mod, _ = compiler.optimize(mod, device)
+    mod = raf._ffi.pass_.InferType()(mod)
+    trace = raf._ffi.pass_.EstimateMemory(mod, Device(device), False)
+    return max(mem.value for _, mem in trace)
+
+
+@pytest.mark.parametrize("dtype", ["float16", "int8"])
+def test_compress_peak_memory(dtype):
+    shape = (128, 128)
+    device = "cpu"
+    m_x, _ = randn(shape, device=device, requires_grad=True)
+    m_w, _ = randn(shape, device=device, requires_grad=True)
+
+    def get_mod(config):
+        # Trace a new model every time, because the traced IR is cached by the model.
+        model = ReluMatmulChain(4)
+        model.train_mode()
+        record = model._internal(m_x, m_w)
+        # The passes applied by with_autodiff.
+        seq = RAFSequential(
+            [
+                raf._ffi.pass_.InferType(),
+                raf._ffi.pass_.AutoDiff(record.requires_grads),
+                raf._ffi.pass_.InferType(),
+                raf._ffi.pass_.FoldConstant(),
+                raf._ffi.pass_.DeadCodeElimination(),
+                raf._ffi.pass_.CompressActivation(),
+                raf._ffi.pass_.InlineBackward(),
+            ]
+        )
+        with tvm.transform.PassContext(config=config):
+            return seq(record.mod)
+
+    ref_peak = get_peak_memory(get_mod({}), device)
+    config = {"raf.compress_activation.dtype": dtype, "raf.compress_activation.min_bytes": 0}
+    peak = get_peak_memory(get_mod(config), device)
+    # The activations saved for the backward of the 4 layers are held in the compressed form.
+    assert peak < ref_peak
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -8,6 +8,7 @@ import raf
 from raf._lib import tvm, relay
 from raf.ir import ScopeBuilder
 from raf._ffi.pass_ import InferType, LivenessAnalysis, ManifestAlloc, FoldConstant
+from raf._ffi.pass_ import LiveIntervals, MemoryPlan
 from raf.testing import randn
 
 
@@ -516,5 +517,112 @@ def test_fuse_closure():
     verify_live_in_set(mod, expected)
 
 
+def test_if_branches():
+    x = relay.var("x", shape=(5, 5))
+    cond = relay.var("c", shape=(), dtype="bool")
+    a = relay.var("a")
+    b = relay.var("b")
+    t = relay.var("t")
+    f = relay.var("f")
+    true_branch = relay.Let(t, raf.ir.op.add(a, a), t)
+    false_branch = relay.Let(f, raf.ir.op.relu(x), f)
+    body = relay.Let(
+        a, raf.ir.op.add(x, x), relay.Let(b, relay.If(cond, true_branch, false_branch), b)
+    )
+    mod = InferType()(tvm.IRModule.from_expr(relay.Function([x, cond], body)))
+    # fn (%x, %c) {
+    #   let %a = raf.op.add(%x, %x);     # line 0, t_0
+    #   let %b = if (%c) {               # line 1
+    #     let %t = raf.op.add(%a, %a);   # line 2
+    #     %t
+    #   } else {
+    #     let %f = raf.op.relu(%x);      # line 3
+    #     %f
+    #   };
+    #   %b
+    # }
+    live_in = {k.name_hint: {v.name_hint for v in vs} for k, vs in LivenessAnalysis(mod).items()}
+    assert live_in["a"] == {"param_0", "param_1"}
+    assert live_in["b"] == {"param_0", "param_1", "t_0"}
+    assert live_in["t"] == {"t_0"}
+    assert live_in["f"] == {"param_0"}
+
+    # %x is dead in the true branch, so its live interval has a gap.
+    intervals, positions = LiveIntervals(mod)
+    intervals = {k.name_hint: (v[0].value, v[1].value) for k, v in intervals.items()}
+    positions = {k.name_hint: v.value for k, v in positions.items()}
+    assert positions == {"a": 0, "b": 1, "t": 2, "f": 3}
+    assert intervals["param_0"] == (0, 3)
+    assert intervals["param_1"] == (0, 1)
+    assert intervals["t_0"] == (1, 2)
+
+
+@pytest.mark.parametrize("num_layers", [16, 256])
+def test_deep_mlp(num_layers):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            for _ in range(num_layers):
+                x = raf.relu(raf.matmul(x, w))
+            return x
+
+    device = "cpu"
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn((8, 32), device=device)
+    m_w, _ = randn((32, 32), device=device)
+    mod = InferType()(model._internal(m_x, m_w).mod)
+
+    # The live intervals agree with the live-in sets of the straight-line code.
+    # Dummy tensor vars are created by each analysis, so they are matched by names.
+    intervals, positions = LiveIntervals(mod)
+    intervals = {k.name_hint: (v[0].value, v[1].value) for k, v in intervals.items()}
+    num_lines = {}
+    for line, tensors in LivenessAnalysis(mod).items():
+        if line not in positions:
+            continue
+        for tensor in tensors:
+            begin, end = intervals[tensor.name_hint]
+            assert begin <= positions[line].value <= end
+            num_lines[tensor.name_hint] = num_lines.get(tensor.name_hint, 0) + 1
+    assert len(num_lines) == len(intervals)
+    for tensor, (begin, end) in intervals.items():
+        assert num_lines[tensor] == end - begin + 1
+
+
+def test_memory_plan_all_outputs_live():
+    def num_storages(num_layers):
+        class Model(raf.Model):
+            def build(self):
+                pass
+
+            @raf.model.trace
+            def forward(self, x, w):
+                outs = []
+                for _ in range(num_layers):
+                    x = raf.relu(raf.matmul(x, w))
+                    outs.append(x)
+                return raf.concatenate(outs)
+
+        model = Model()
+        model.infer_mode()
+        m_x, _ = randn((8, 32))
+        m_w, _ = randn((32, 32))
+        mod = InferType()(model._internal(m_x, m_w).mod)
+        mod = MemoryPlan()(InferType()(ManifestAlloc()(mod)))
+        return raf.ir.AsText(mod["main"]).count("raf.op.vm.alloc_storage")
+
+    # Every layer output stays live until the concatenate, so each layer keeps one storage of its
+    # own, and the matmul outputs, which die at the relu, share storages across the layers.
+    small, large = num_storages(64), num_storages(512)
+    assert large - small == 512 - 64, "64 layers: %d storages, 512 layers: %d storages" % (
+        small,
+        large,
+    )
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
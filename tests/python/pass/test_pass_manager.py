@@ -156,5 +156,40 @@ def test_sequential_pass():
     assert isinstance(ret_mod["mySub"].body.checked_type, tvm.ir.TensorType)
 
 
+@pytest.mark.parametrize("num_threads", [2, -1])
+def test_parallel_function_pass(num_threads):
+    shape = (10,)
+    tp = relay.TensorType(shape, "float32")
+    funcs = {}
+    for i in range(8):
+        x = relay.var("x", tp)
+        y = relay.log(x)
+        y = relay.add(y, relay.exp(y))
+        funcs[relay.GlobalVar("func%d" % i)] = relay.Function([x], relay.subtract(y, x))
+    mod = FromRelay()(tvm.IRModule(funcs))
+    mod = pass_.ToANormalForm()(mod)
+
+    def run(config):
+        passes = [pass_.ToGraphNormalForm(), pass_.ToBasicBlockNormalForm(), pass_.InlineLet()]
+        sequential = RAFSequential(passes=passes, name="parallel_seq")
+        with PassContext(config=config):
+            return sequential(mod)
+
+    pass_.ResetPassTimings()
+    expected = run({})
+    assert not pass_.GetPassTimings()
+    config = {"raf.pass.num_parallel_threads": num_threads, "raf.pass.timing": True}
+    ret_mod = run(config)
+    assert tvm.ir.structural_equal(ret_mod, expected)
+    assert [gvar.name_hint for gvar in ret_mod.get_global_vars()] == [
+        gvar.name_hint for gvar in expected.get_global_vars()
+    ]
+    timings = pass_.GetPassTimings()
+    for name in ["ToGraphNormalForm", "ToBasicBlockNormalForm", "InlineLet"]:
+        count, total_ms = timings["parallel_seq/" + name]
+        assert count.value == 1 and total_ms.value >= 0
+    pass_.ResetPassTimings()
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
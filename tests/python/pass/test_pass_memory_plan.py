@@ -6,6 +6,7 @@
 import pytest
 import raf
 from raf._lib import tvm
+from raf._core.executor import VMExecutor
 from raf.testing import get_testable_devices, randn, check, run_vm_model
 
 
@@ -167,5 +168,91 @@ def test_set_shape():
     verify_correctness(model, "cpu", args, fusion=False)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_static_arena(device):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, a, b, c, d):
+            t0 = raf.add(a, a)
+            t1 = raf.add(t0, b)
+            t2 = raf.add(t1, c)
+            t3 = raf.add(t2, t0)
+            t4 = raf.add(t3, d)
+            return t4
+
+    shape = (5, 5)
+    model = Model()
+    model.infer_mode()
+    args = [randn(shape, device=device)[0] for _ in range(4)]
+    mod = model._internal(*args).mod
+
+    config = {"raf.memory_plan.static_arena": True}
+    with raf.ir.PassContext(opt_level=3, config=config, disabled_pass=["FuseDialect", "FuseTVM"]):
+        executor = VMExecutor(mod, device)
+    executable = executor.executable
+
+    # The 4 intermediate tensors are planned into the arena, and the output is not.
+    assert executable.bytecode.count("arena[") == 4
+    assert "Static arenas" in executable.stats
+
+    # At least 3 intermediate tensors (t0, t1, t2) are alive at the same time, and each of them
+    # takes 100 bytes with 64-byte alignment. t3 reuses the space of t1.
+    arena_size = executable.get_arena_size("main")
+    assert 128 * 2 + 100 <= arena_size < 128 * 3 + 100
+
+    # The arena is reused across runs.
+    vm = executor.make_executor()
+    ref_out = model(*args)
+    for _ in range(2):
+        check(ref_out, vm(*args))
+
+
+@pytest.mark.parametrize("static_arena", [False, True])
+def test_peak_memory(static_arena):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, a, b):
+            t0 = raf.add(a, a)
+            t1 = raf.matmul(t0, b)
+            t2 = raf.relu(t1)
+            t3 = raf.add(t2, t0)
+            return raf.sum(t3, axis=1)
+
+    device = "cpu"
+    model = Model()
+    model.infer_mode()
+    args = [randn((300, 300), device=device)[0] for _ in range(2)]
+    mod = model._internal(*args).mod
+
+    config = {"raf.memory_plan.static_arena": static_arena}
+    with raf.ir.PassContext(opt_level=3, config=config, disabled_pass=["FuseDialect", "FuseTVM"]):
+        executor = VMExecutor(mod, device)
+    executable = executor.executable
+    peak_memory = executable.get_peak_memory("main")
+    assert "Peak memory" in executable.stats
+    # At least two 300x300 float tensors are alive at the same time.
+    assert peak_memory >= 2 * 300 * 300 * 4
+
+    # The estimate matches the peak allocated from the memory pool at runtime.
+    vm = executor.make_executor()
+    raf.utils.memory_profiler.reset()
+    raf.utils.memory_profiler.start(record_allocations=True)
+    vm(*args)
+    raf.utils.memory_profiler.stop()
+    report = raf.utils.memory_profiler.get_allocation_report(raf.Device(device))
+    assert peak_memory == report["peak_rounded_bytes"]
+
+    # The estimate is kept in the serialized executable.
+    code, lib = executable.save()
+    loaded = raf._core.vm.Executable.load_exec(bytearray(code), lib)
+    assert loaded.get_peak_memory("main") == peak_memory
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,139 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access,invalid-name,attribute-defined-outside-init,no-self-use
+import numpy as np
+import pytest
+import tvm
+import raf
+from raf._core.executor import VMExecutor
+from raf._core.vm import Executable, VirtualMachine
+from raf.model import Conv2d, Linear
+from raf.testing import randn, check, run_vm_model
+
+
+class ConvNet(raf.Model):
+    def build(self):
+        self.conv = Conv2d(3, 8, kernel_size=3, padding=1, bias=True)
+        self.linear = Linear(8 * 8 * 8, 10)
+
+    @raf.model.trace
+    def forward(self, x):
+        x = raf.relu(self.conv(x))
+        x = raf.batch_flatten(x)
+        return self.linear(x)
+
+
+class MatmulChain(raf.Model):
+    def build(self):
+        self.w1 = raf.array(np.random.randn(32, 64).astype("float32"))
+        self.w2 = raf.array(np.random.randn(64, 16).astype("float32"))
+
+    @raf.model.trace
+    def forward(self, x):
+        return raf.matmul(raf.matmul(x, self.w1), self.w2)
+
+
+def collect_ops(expr):
+    ops = []
+
+    def visit(node):
+        if isinstance(node, tvm.relay.Call) and isinstance(node.op, tvm.ir.Op):
+            ops.append(node.op.name)
+
+    tvm.relay.analysis.post_order_visit(expr, visit)
+    return ops
+
+
+def get_dataset(shape, n_batches=4):
+    return [randn(shape)[0] for _ in range(n_batches)]
+
+
+def test_quantize_ir():
+    model = ConvNet()
+    dataset = get_dataset((2, 3, 8, 8))
+    ranges = raf.quantization.calibrate(model, dataset)
+    # The input of the conv2d and the flattened activations of the dense.
+    assert len(ranges) == 2 and all(rng > 0 for rng in ranges)
+
+    qmodel = raf.quantization.quantize(model, dataset)
+    ops = collect_ops(qmodel._internal(dataset[0]).mod["main"])
+    assert "raf.op.quantized_conv2d" in ops
+    assert "raf.op.quantized_matmul" in ops
+    assert ops.count("raf.op.quantize") == 2
+    assert ops.count("raf.op.dequantize") == 2
+    assert "raf.op.conv2d" not in ops and "raf.op.dense" not in ops
+
+
+def test_quantize_keeps_mode():
+    model = MatmulChain()
+    dataset = get_dataset((4, 32))
+    model.train_mode()
+    raf.quantization.quantize(model, dataset)
+    assert model._BaseModel__is_train
+    model.infer_mode()
+    raf.quantization.quantize(model, dataset)
+    assert not model._BaseModel__is_train
+
+
+def test_quantize_main_only():
+    model = MatmulChain()
+    dataset = get_dataset((4, 32))
+    mod = raf.quantization.ptq._freeze_params(model, [dataset[0]])
+    # Add a copy of main as another function, which has to be left untouched.
+    callee = tvm.relay.GlobalVar("callee")
+    mod[callee] = mod["main"]
+
+    collected = raf._ffi.pass_.CollectQuantizeRanges()(mod)
+    assert isinstance(collected["main"].checked_type.ret_type, tvm.relay.TupleType)
+    assert isinstance(collected[callee].checked_type.ret_type, tvm.relay.TensorType)
+
+    ranges = raf.quantization.calibrate(model, dataset)
+    qmod = raf._ffi.pass_.Quantize(ranges)(mod)
+    assert "raf.op.quantized_matmul" in collect_ops(qmod["main"])
+    assert "raf.op.quantized_matmul" not in collect_ops(qmod[callee])
+
+
+def test_requantize_chain():
+    model = MatmulChain()
+    dataset = get_dataset((4, 32))
+    qmodel = raf.quantization.quantize(model, dataset)
+    ops = collect_ops(qmodel._internal(dataset[0]).mod["main"])
+    # The output of the first matmul is only used by the second one, so it stays in int8.
+    assert ops.count("raf.op.quantized_matmul") == 2
+    assert ops.count("raf.op.quantize") == 1
+    assert ops.count("raf.op.requantize") == 1
+    assert ops.count("raf.op.dequantize") == 1
+
+
+@pytest.mark.parametrize("method", ["max", "avg"])
+@pytest.mark.parametrize("per_channel", [True, False])
+def test_quantize_accuracy(method, per_channel):
+    model = ConvNet()
+    model.infer_mode()
+    dataset = get_dataset((2, 3, 8, 8))
+    qmodel = raf.quantization.quantize(model, dataset, method=method, per_channel=per_channel)
+    m_x, _ = randn((2, 3, 8, 8))
+    ref = run_vm_model(model, "cpu", [m_x]).numpy()
+    out = run_vm_model(qmodel, "cpu", [m_x]).numpy()
+    # int8 keeps about 2 significant digits through the two layers.
+    assert np.abs(out - ref).max() <= 0.05 * np.abs(ref).max()
+
+
+def test_quantize_serialization():
+    model = MatmulChain()
+    dataset = get_dataset((4, 32))
+    qmodel = raf.quantization.quantize(model, dataset)
+    m_x = dataset[0]
+    executor = VMExecutor(qmodel._internal(m_x).mod, "cpu")
+    ref = executor.make_executor()(m_x).numpy()
+
+    # The int8 weights and the scales are serialized as constants.
+    code, lib = executor.executable.save()
+    loaded = Executable.load_exec(code, lib)
+    out = VirtualMachine(loaded, raf.Device("cpu")).run(m_x)
+    check(out, ref, rtol=0, atol=0)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -18,7 +18,7 @@ import tvm
 from tvm import relay
 
 
-def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks):
+def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks, solver="greedy"):
     """Verify the result of rematerialization pass.
 
     Parameters
@@ -33,6 +33,9 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
         The expected IR after rematerialization.
     expected_peaks: Tuple[float, float]
         The expected peak memory in MBs without and with rematerialization.
+    solver: str
+        The rematerialization solver. The solved plan may differ from the expected IR, so it is
+        only checked to be no more expensive than the greedy plan and to fit into the budget.
     """
     if not isinstance(model_or_mod, tvm.IRModule):
         record = model_or_mod._internal(*args)
@@ -47,6 +50,7 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
             config={
                 "raf.memory_budget": int(budget_in_mbs * 1048576),
                 "raf.remat.use_gflops_cost": True,
+                "raf.remat.solver": solver,
             }
         ):
             ir_mod = raf._ffi.pass_.InferType()(ir_mod)
@@ -58,6 +62,13 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
                 assert expected_ir is None, "Unexpected rematerialization failure: %s" % str(err)
                 return
 
+    if solver != "greedy":
+        report = {k: v.value for k, v in raf._ffi.pass_.GetRematerializationReport().items()}
+        assert report["predicted_solver_cost"] <= report["predicted_greedy_cost"]
+        if report["greedy_ops"] >= 0:
+            cost = report["solver_cost"] if report["use_solver"] else report["greedy_cost"]
+            assert cost <= report["greedy_cost"]
+        expected_ir = None
     if expected_ir is not None:
         expected_ir = run_infer_type(expected_ir)
         assert tvm.ir.structural_equal(expected_ir, ir_mod["main"]), "\nExpected:\n%s\nGot\n%s" % (
@@ -78,6 +89,7 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
                 "raf.memory_budget": int(budget * 1048576),
                 # Use GFLOPS cost to avoid flaky behavior in tests
                 "raf.remat.use_gflops_cost": True,
+                "raf.remat.solver": solver,
             },
         ):
             raf.utils.memory_profiler.reset()
@@ -89,13 +101,17 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
         # Comparing with the max used memory here since the max allocated memory will be larger
         # The model will not crash as long as the max used memory is below the device memory budget
         peak_memory = ret_map["max_used"].value + param_size
+        if with_remat and solver != "greedy":
+            assert peak_memory < expected_peak + 0.1, "Solved plan exceeds the budget"
+            continue
         assert abs(expected_peak - peak_memory) < 0.1, (
             "Incorrect peak memory with remat=%s" % with_remat
         )
 
 
 @pytest.mark.parametrize("budget_type", ["low", "remat", "high"])
-def test_simple(budget_type):
+@pytest.mark.parametrize("solver", ["greedy", "optimal"])
+def test_simple(budget_type, solver):
     shape = (16, 16, 64, 64)  # 4 MBs
     data_size, weight_size = np.prod(shape), np.prod((16, 16, 3, 3))
 
@@ -239,7 +255,7 @@ def test_simple(budget_type):
         sb.ret(a_9)
         return relay.Function([data, weight], sb.get())
 
-    verify_remat(model, [m_x], budget, expected(), (before_peak, budget))
+    verify_remat(model, [m_x], budget, expected(), (before_peak, budget), solver)
 
 
 def test_closure():
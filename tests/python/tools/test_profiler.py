@@ -95,5 +95,28 @@ def test_profiler_without_cuda(i):
     assert op_count > 0
 
 
+def test_sampling_profiler():
+    shape = (16, 4)
+    m_x, _ = randn(shape)
+    m_y = raf.array(np.random.randint(0, shape[1], size=shape[0]), device="cpu")
+    model = TestNet((0, 1))
+    model.train_mode()
+
+    def profile(sampling_rate):
+        profiler.get()  # Drop the events profiled before.
+        profiler.start(prof_level=2, sampling_rate=sampling_rate)
+        for _ in range(6):
+            loss = model(m_x, m_y)
+            loss.backward()
+        profiler.stop()
+        # Each event is emitted as a pair of begin and end.
+        return [e for e in profiler.get()["traceEvents"] if e["ph"] == "B"]
+
+    events = profile(1)
+    assert any(e["name"] == "raf.op.transpose" for e in events)
+    sampled_events = profile(3)
+    assert 0 < len(sampled_events) < len(events)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])